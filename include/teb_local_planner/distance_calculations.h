@@ -40,6 +40,8 @@
 #define DISTANCE_CALCULATIONS_H
 
 #include <Eigen/Core>
+#include <vector>
+#include <algorithm>
 #include <teb_local_planner/misc.h>
 
 
@@ -156,8 +158,32 @@ inline double distance_segment_to_segment_2d(const Eigen::Ref<const Eigen::Vecto
 }
   
   
+/**
+ * @brief Check whether a point lies in the interior of a closed polygon (crossing number test)
+ *
+ * Points on the boundary may be classified either way. Points and lines (less than three vertices) have no interior.
+ * @param point 2D point
+ * @param vertices Vertices describing the closed polygon (the first vertex is not repeated at the end)
+ * @return \c true if the point lies inside the polygon
+ */
+inline bool check_point_in_polygon_2d(const Eigen::Vector2d& point, const Point2dContainer& vertices)
+{
+  bool inside = false;
+  if (vertices.size() < 3)
+    return inside;
+  for (std::size_t i = 0, j = vertices.size() - 1; i < vertices.size(); j = i++)
+  {
+    if ((vertices[i].y() > point.y()) != (vertices[j].y() > point.y()) &&
+        point.x() < (vertices[j].x() - vertices[i].x()) * (point.y() - vertices[i].y()) / (vertices[j].y() - vertices[i].y()) + vertices[i].x())
+      inside = !inside;
+  }
+  return inside;
+}
+
 /**
  * @brief Helper function to calculate the smallest distance between a point and a closed polygon
+ *
+ * Zero is returned if the point lies inside the polygon (as for distance_polygon_to_polygon_2d()).
  * @param point 2D point
  * @param vertices Vertices describing the closed polygon (the first vertex is not repeated at the end)
  * @return smallest distance between point and polygon
@@ -185,14 +211,19 @@ inline double distance_point_to_polygon_2d(const Eigen::Vector2d& point, const P
   {
     double new_dist = distance_point_to_segment_2d(point, vertices.back(), vertices.front()); // check last edge
     if (new_dist < dist)
-      return new_dist;
+      dist = new_dist;
   }
-  
+
+  if (dist > 0 && check_point_in_polygon_2d(point, vertices))
+    return 0;
+
   return dist;
 }  
 
 /**
  * @brief Helper function to calculate the smallest distance between a line segment and a closed polygon
+ *
+ * Zero is returned if the segment intersects the polygon or lies inside of it (as for distance_polygon_to_polygon_2d()).
  * @param line_start 2D point representing the start of the line segment
  * @param line_end 2D point representing the end of the line segment
  * @param vertices Vertices describing the closed polygon (the first vertex is not repeated at the end)
@@ -221,14 +252,21 @@ inline double distance_segment_to_polygon_2d(const Eigen::Vector2d& line_start,
   {
     double new_dist = distance_segment_to_segment_2d(line_start, line_end, vertices.back(), vertices.front()); // check last edge
     if (new_dist < dist)
-      return new_dist;
+      dist = new_dist;
   }
-  
+
+  // no edges intersect: the segment lies either outside or inside of the polygon
+  if (dist > 0 && check_point_in_polygon_2d(line_start, vertices))
+    return 0;
+
   return dist;
 }
 
 /**
  * @brief Helper function to calculate the smallest distance between two closed polygons
+ *
+ * Zero is returned if the polygons intersect or if one polygon contains the other one
+ * (in agreement with distance_convex_polygon_to_polygon_2d()).
  * @param vertices1 Vertices describing the first closed polygon (the first vertex is not repeated at the end)
  * @param vertices2 Vertices describing the second closed polygon (the first vertex is not repeated at the end)
  * @return smallest distance between point and polygon
@@ -240,7 +278,7 @@ inline double distance_polygon_to_polygon_2d(const Point2dContainer& vertices1,
   // the polygon1 is a point
   if (vertices1.size() == 1)
   {
-    return distance_point_to_polygon_2d(vertices1.front(), vertices2);
+    dist = distance_point_to_polygon_2d(vertices1.front(), vertices2);
   }
     
   // check each edge of polygon1
@@ -255,11 +293,170 @@ inline double distance_polygon_to_polygon_2d(const Point2dContainer& vertices1,
   {
     double new_dist = distance_segment_to_polygon_2d(vertices1.back(), vertices1.front(), vertices2); // check last edge
     if (new_dist < dist)
-      return new_dist;
+      dist = new_dist;
   }
 
+  // no edges intersect: the polygons are either disjoint or one contains the other one
+  if (dist > 0 && !vertices1.empty() && !vertices2.empty()
+      && (check_point_in_polygon_2d(vertices1.front(), vertices2) || check_point_in_polygon_2d(vertices2.front(), vertices1)))
+    return 0;
+
   return dist;
 }
+
+
+/** @name Batch distance kernels
+ *  The polygon distances above evaluate one pair of edges at a time. The following variants operate on
+ *  a structure-of-arrays copy of the polygon (PolygonSoA) and process several edges per instruction (AVX2 on x86-64,
+ *  NEON on ARMv8). The instruction set is selected at runtime, the scalar implementation serves as fallback.
+ *  The results match the functions above up to rounding.
+ */
+//@{
+
+/**
+ * @brief Polygon stored as structure of arrays for the batch distance kernels
+ *
+ * \c x and \c y contain the vertices in the same order as the Point2dContainer. For closed polygons (more than two vertices)
+ * the first vertex is repeated at the end, such that edge i always connects vertex i and i+1.
+ */
+struct PolygonSoA
+{
+  PolygonSoA() : num_vertices(0), num_edges(0) {}
+
+  //! Construct from the vertices of a closed polygon (the first vertex is not repeated at the end)
+  explicit PolygonSoA(const Point2dContainer& vertices) {assign(vertices);}
+
+  //! Copy the vertices of a closed polygon (the first vertex is not repeated at the end)
+  void assign(const Point2dContainer& vertices)
+  {
+    resize((int)vertices.size());
+    for (int i = 0; i < num_vertices; ++i)
+      setVertex(i, vertices[i].x(), vertices[i].y());
+  }
+
+  //! Change the number of vertices (the coordinates must be set with setVertex() afterwards)
+  void resize(int no_vertices)
+  {
+    num_vertices = no_vertices;
+    num_edges = no_vertices > 2 ? no_vertices : std::max(no_vertices - 1, 0);
+    x.resize(num_vertices > 2 ? num_vertices + 1 : num_vertices);
+    y.resize(x.size());
+  }
+
+  //! Set the coordinates of a vertex (the closing copy of the first vertex is updated as well)
+  void setVertex(int i, double vx, double vy)
+  {
+    x[i] = vx;
+    y[i] = vy;
+    if (i == 0 && num_vertices > 2)
+    {
+      x[num_vertices] = vx;
+      y[num_vertices] = vy;
+    }
+  }
+
+  std::vector<double> x; //!< x-coordinates of the vertices (including the closing vertex)
+  std::vector<double> y; //!< y-coordinates of the vertices (including the closing vertex)
+  int num_vertices; //!< Number of distinct vertices
+  int num_edges; //!< Number of edges (0 for a point, 1 for a line, num_vertices for a closed polygon)
+};
+
+/**
+ * @brief Instruction sets of the batch distance kernels
+ */
+enum class SimdInstructionSet
+{
+  Scalar, //!< Portable implementation
+  AVX2,   //!< 4 doubles per instruction (x86-64, selected if the CPU supports it)
+  NEON    //!< 2 doubles per instruction (ARMv8)
+};
+
+/**
+ * @brief Get the instruction set currently used by the batch distance kernels
+ */
+SimdInstructionSet getDistanceInstructionSet();
+
+/**
+ * @brief Select the instruction set of the batch distance kernels (e.g. for benchmarks)
+ * @param instruction_set desired instruction set
+ * @return \c false if the instruction set is not supported by this build or CPU (the selection remains unchanged)
+ */
+bool setDistanceInstructionSet(SimdInstructionSet instruction_set);
+
+/**
+ * @brief Batch version of distance_point_to_polygon_2d()
+ * @param point 2D point
+ * @param polygon polygon in SoA layout
+ * @return smallest distance between point and polygon
+ */
+double distance_point_to_polygon_2d(const Eigen::Vector2d& point, const PolygonSoA& polygon);
+
+/**
+ * @brief Batch version of distance_segment_to_polygon_2d()
+ * @param line_start 2D point representing the start of the line segment
+ * @param line_end 2D point representing the end of the line segment
+ * @param polygon polygon in SoA layout
+ * @return smallest distance between segment and polygon
+ */
+double distance_segment_to_polygon_2d(const Eigen::Vector2d& line_start, const Eigen::Vector2d& line_end, const PolygonSoA& polygon);
+
+/**
+ * @brief Batch version of distance_polygon_to_polygon_2d()
+ *
+ * If no pair of edges intersects, the distance is attained between a vertex of one polygon and an edge of the other one.
+ * Hence all vertex-edge pairs are evaluated in batches instead of all edge-edge pairs.
+ * As for the scalar version, zero is returned if one polygon contains the other one.
+ * @param polygon1 first polygon in SoA layout
+ * @param polygon2 second polygon in SoA layout
+ * @return smallest distance between both polygons
+ */
+double distance_polygon_to_polygon_2d(const PolygonSoA& polygon1, const PolygonSoA& polygon2);
+
+//@}
+
+
+/** @name Convex polygon distance
+ *  The distance between two convex polygons is computed with the GJK algorithm in O(n+m) per iteration.
+ *  Support vertices are found by hill climbing, hence warm starting from the witness vertices of the previous query
+ *  (e.g. the previous optimizer iteration) reduces the effort to a few vertices per query.
+ */
+//@{
+
+/**
+ * @brief Check whether a closed polygon is convex
+ *
+ * Points and lines (two distinct vertices) are considered convex.
+ * Polygons with repeated vertices, spikes or self-intersections are not.
+ * Collinear vertices are allowed.
+ * @param vertices Vertices describing the closed polygon (the first vertex is not repeated at the end)
+ * @return \c true if the polygon is convex
+ */
+bool check_polygon_convexity_2d(const Point2dContainer& vertices);
+
+/**
+ * @brief Witness vertices of a convex polygon distance query (used to warm start the next query)
+ */
+struct ConvexDistanceWitness
+{
+  ConvexDistanceWitness() : vertex1(-1), vertex2(-1) {}
+
+  int vertex1; //!< Vertex index of the first polygon (-1 if unknown)
+  int vertex2; //!< Vertex index of the second polygon (-1 if unknown)
+};
+
+/**
+ * @brief Calculate the smallest distance between two convex polygons (GJK)
+ *
+ * Both polygons must be convex (see check_polygon_convexity_2d()). As distance_polygon_to_polygon_2d(),
+ * zero is returned if the polygons intersect or if one polygon contains the other one.
+ * @param polygon1 first convex polygon in SoA layout
+ * @param polygon2 second convex polygon in SoA layout
+ * @param[in,out] witness optional witness vertices of the previous query, updated with the current ones
+ * @return smallest distance between both polygons
+ */
+double distance_convex_polygon_to_polygon_2d(const PolygonSoA& polygon1, const PolygonSoA& polygon2, ConvexDistanceWitness* witness = NULL);
+
+//@}
   
   
   
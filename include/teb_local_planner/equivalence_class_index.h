@@ -0,0 +1,126 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Christoph Rösmann
+ *********************************************************************/
+
+
+#ifndef EQUIVALENCE_CLASS_INDEX_H_
+#define EQUIVALENCE_CLASS_INDEX_H_
+
+#include <vector>
+#include <unordered_map>
+
+#include <teb_local_planner/equivalence_relations.h>
+
+namespace teb_local_planner
+{
+
+/**
+ * @class EquivalenceClassIndex
+ * @brief Hash index of equivalence classes for the detection of duplicates
+ *
+ * Each class is stored in the bucket EquivalenceClass::hashKey() and a lookup only compares (EquivalenceClass::isEqual())
+ * against the classes in the buckets returned by EquivalenceClass::candidateKeys(), e.g. the neighbouring cells of a quantized H-signature.
+ * If the candidate buckets are not conclusive (EquivalenceClass::candidateKeys() returns \c false), all other classes are checked afterwards.
+ * @remarks The lookups use an internal buffer and must not be called concurrently.
+ */
+class EquivalenceClassIndex
+{
+public:
+
+  /**
+   * @brief Remove all classes
+   */
+  void clear() {buckets_.clear();}
+
+  /**
+   * @brief Add a class (duplicates are not checked)
+   * @param eq_class equivalence class
+   */
+  void insert(const EquivalenceClassPtr& eq_class);
+
+  /**
+   * @brief Remove a class that has been added before
+   * @param eq_class equivalence class (the same instance passed to insert())
+   */
+  void erase(const EquivalenceClassPtr& eq_class);
+
+  /**
+   * @brief Check if a class equal to \c eq_class is stored
+   * @param eq_class equivalence class to look up
+   * @return \c true if an equal class exists, \c false otherwise
+   */
+  bool contains(const EquivalenceClass& eq_class) const;
+
+  /**
+   * @brief Count the stored classes that are equal to \c eq_class
+   * @param eq_class equivalence class to look up
+   * @return number of equal classes
+   */
+  int count(const EquivalenceClass& eq_class) const;
+
+  /**
+   * @brief Number of stored classes
+   */
+  std::size_t size() const {return buckets_.size();}
+
+private:
+
+  /**
+   * @brief Count the equal classes in the candidate buckets of \c eq_class
+   * @param eq_class equivalence class to look up
+   * @param stop_at_first stop after the first equal class has been found
+   * @param[out] conclusive \c true if no other bucket can contain an equal class
+   * @return number of equal classes found in the candidate buckets
+   */
+  int countInCandidates(const EquivalenceClass& eq_class, bool stop_at_first, bool& conclusive) const;
+
+  /**
+   * @brief Count the equal classes in all buckets that are not candidate buckets of \c eq_class
+   * @param eq_class equivalence class to look up
+   * @param stop_at_first stop after the first equal class has been found
+   * @return number of equal classes found
+   */
+  int countInOthers(const EquivalenceClass& eq_class, bool stop_at_first) const;
+
+  typedef std::unordered_multimap<std::size_t, EquivalenceClassPtr> BucketMap;
+  BucketMap buckets_; //!< Classes by their hash key
+  mutable std::vector<std::size_t> keys_; //!< Buffer for the candidate keys of a lookup
+};
+
+} // namespace teb_local_planner
+
+#endif /* EQUIVALENCE_CLASS_INDEX_H_ */
@@ -40,6 +40,8 @@
 #define EQUIVALENCE_RELATIONS_H_
 
 #include <boost/shared_ptr.hpp>
+#include <cstddef>
+#include <vector>
 
 namespace teb_local_planner
 {
@@ -92,6 +94,21 @@ public:
     */
    virtual bool isReasonable() const = 0;
 
+   /**
+    * @brief Key of the hash bucket this class is stored in (see EquivalenceClassIndex)
+    *
+    * The default implementation stores all classes in a single bucket.
+    */
+   virtual std::size_t hashKey() const {return 0;}
+
+   /**
+    * @brief Keys of all hash buckets that might contain a class equal to this one (see EquivalenceClassIndex)
+    * @param[out] keys bucket keys (including hashKey())
+    * @return \c true if every equal class is stored in one of the returned buckets,
+    *         \c false if the buckets are only checked first and any other bucket might contain an equal class as well
+    */
+   virtual bool candidateKeys(std::vector<std::size_t>& keys) const {keys.assign(1, hashKey()); return true;}
+
 };
 
 using EquivalenceClassPtr = boost::shared_ptr<EquivalenceClass>;
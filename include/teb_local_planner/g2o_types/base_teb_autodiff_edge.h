@@ -0,0 +1,278 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ * 
+ * Notes:
+ * The following class is derived from a class defined by the
+ * g2o-framework. g2o is licensed under the terms of the BSD License.
+ * Refer to the base class source for detailed licensing information.
+ *
+ * Author: Christoph Rösmann
+ *********************************************************************/
+
+
+#ifndef _BASE_TEB_AUTODIFF_EDGE_H_
+#define _BASE_TEB_AUTODIFF_EDGE_H_
+
+#include <teb_local_planner/g2o_types/base_teb_edges.h>
+#include <teb_local_planner/g2o_types/penalties.h>
+#include <teb_local_planner/misc.h>
+
+#include <g2o/stuff/misc.h>
+
+#include <unsupported/Eigen/AutoDiff>
+
+#include <cmath>
+
+namespace teb_local_planner
+{
+
+/**
+ * @brief Sum of the (compile-time) vertex dimensions of an edge
+ */
+template <int... Dims>
+struct VertexDimSum;
+
+template <>
+struct VertexDimSum<>
+{
+  static const int value = 0;
+};
+
+template <int Dim, int... Dims>
+struct VertexDimSum<Dim, Dims...>
+{
+  static const int value = Dim + VertexDimSum<Dims...>::value;
+};
+
+
+/**
+ * @class BaseTebAutoDiffEdge
+ * @brief Base edge that derives its Jacobians by forward-mode automatic differentiation
+ *
+ * The derived class implements the cost function once as a template
+ * \code
+ *   template <typename T>
+ *   void evaluate(const T* const* x, T* error) const;
+ * \endcode
+ * in which \c x[i] points to the estimate of the i-th vertex as returned by getEstimateData()
+ * (x, y, theta for VertexPose and dt for VertexTimeDiff).
+ * computeError() evaluates it with doubles and linearizeOplus() with Eigen::AutoDiffScalar
+ * of fixed size, which yields exact Jacobians in a single pass instead of 2*dim evaluations
+ * of the numeric differentiation. All vertex updates must be additive (as for VertexPose and VertexTimeDiff).
+ *
+ * Derived edges may still provide a hand-written linearizeOplus(); linearizeOplusAutoDiff()
+ * remains available for verification and benchmarks.
+ * @tparam Derived edge type implementing evaluate() (CRTP)
+ * @tparam D dimension of the error vector
+ * @tparam E measurement type
+ * @tparam VertexDims dimensions of the connected vertices in the order of setVertex()
+ * @see BaseTebMultiEdge
+ */
+template <typename Derived, int D, typename E, int... VertexDims>
+class BaseTebAutoDiffEdge : public BaseTebMultiEdge<D, E>
+{
+public:
+
+  static const int NumVertices = sizeof...(VertexDims); //!< Number of vertices connected to the edge
+  static const int NumParameters = VertexDimSum<VertexDims...>::value; //!< Sum of all vertex dimensions
+
+  //! Scalar type carrying the derivatives w.r.t. all parameters of the edge
+  typedef Eigen::AutoDiffScalar<Eigen::Matrix<double, NumParameters, 1> > Jet;
+
+  /**
+   * @brief Construct edge.
+   */
+  BaseTebAutoDiffEdge()
+  {
+    this->resize(NumVertices);
+  }
+
+  /**
+   * @brief Actual cost function, forwarded to Derived::evaluate()
+   */
+  virtual void computeError()
+  {
+    double values[NumParameters];
+    const double* params[NumVertices];
+    gatherParameters(values, params);
+
+    derived().evaluate(params, this->_error.data());
+
+    ROS_ASSERT_MSG(this->_error.allFinite(), "BaseTebAutoDiffEdge::computeError() error vector is not finite\n");
+  }
+
+  /**
+   * @brief Jacobi matrix of the cost function, obtained by automatic differentiation
+   */
+  virtual void linearizeOplus()
+  {
+    linearizeOplusAutoDiff();
+  }
+
+  /**
+   * @brief Evaluate Derived::evaluate() with dual numbers and store the Jacobians w.r.t. all vertices
+   */
+  void linearizeOplusAutoDiff()
+  {
+    double values[NumParameters];
+    const double* params[NumVertices];
+    gatherParameters(values, params);
+
+    Jet jets[NumParameters];
+    for (int k = 0; k < NumParameters; ++k)
+      jets[k] = Jet(values[k], NumParameters, k);
+
+    const Jet* jet_params[NumVertices];
+    for (int i = 0; i < NumVertices; ++i)
+      jet_params[i] = jets + (params[i] - values);
+
+    Jet error[D];
+    derived().evaluate(jet_params, error);
+
+    const int dims[NumVertices] = {VertexDims...};
+    int offset = 0;
+    for (int i = 0; i < NumVertices; ++i)
+    {
+      for (int row = 0; row < D; ++row)
+      {
+        for (int col = 0; col < dims[i]; ++col)
+          this->_jacobianOplus[i](row, col) = error[row].derivatives()[offset + col];
+      }
+      offset += dims[i];
+    }
+  }
+
+protected:
+
+  /**
+   * @brief Copy the estimates of all vertices into a contiguous array
+   * @param[out] values array with NumParameters elements
+   * @param[out] params pointer to the first element of each vertex inside \c values
+   */
+  void gatherParameters(double* values, const double** params) const
+  {
+    const int dims[NumVertices] = {VertexDims...};
+    int offset = 0;
+    for (int i = 0; i < NumVertices; ++i)
+    {
+      const g2o::OptimizableGraph::Vertex* vertex = static_cast<const g2o::OptimizableGraph::Vertex*>(this->_vertices[i]);
+      ROS_ASSERT_MSG(vertex && vertex->estimateDimension() == dims[i], "BaseTebAutoDiffEdge: vertex %d is missing or has the wrong dimension", i);
+      vertex->getEstimateData(values + offset);
+      params[i] = values + offset;
+      offset += dims[i];
+    }
+  }
+
+  Derived& derived() {return *static_cast<Derived*>(this);}
+
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+
+/**
+ * @name Scalar functions for automatic differentiation
+ * Overloads of the helpers used inside the cost functions of the edges. The double versions
+ * compute exactly the same values as the original functions; the AutoDiffScalar versions
+ * propagate the derivatives of the (piecewise) smooth parts.
+ */
+//@{
+
+//! Same as g2o::normalize_theta()
+inline double normalize_theta(double theta)
+{
+  return g2o::normalize_theta(theta);
+}
+
+//! The normalization only adds multiples of 2*pi, hence the derivative is passed through
+template <typename DerType>
+inline Eigen::AutoDiffScalar<DerType> normalize_theta(const Eigen::AutoDiffScalar<DerType>& theta)
+{
+  return Eigen::AutoDiffScalar<DerType>(g2o::normalize_theta(theta.value()), theta.derivatives());
+}
+
+//! Euclidean norm of the vector (x, y)
+inline double norm2d(double x, double y)
+{
+  return std::sqrt(x*x + y*y);
+}
+
+//! Euclidean norm of the vector (x, y), with a zero derivative at the origin instead of NaN
+template <typename DerType>
+inline Eigen::AutoDiffScalar<DerType> norm2d(const Eigen::AutoDiffScalar<DerType>& x, const Eigen::AutoDiffScalar<DerType>& y)
+{
+  const double norm = std::sqrt(x.value()*x.value() + y.value()*y.value());
+  if (norm == 0)
+    return Eigen::AutoDiffScalar<DerType>(0., 0. * x.derivatives());
+  return Eigen::AutoDiffScalar<DerType>(norm, (x.value() * x.derivatives() + y.value() * y.derivatives()) / norm);
+}
+
+//! fast_sigmoid() with derivative \f$ 1 / (1 + |x|)^2 \f$
+template <typename DerType>
+inline Eigen::AutoDiffScalar<DerType> fast_sigmoid(const Eigen::AutoDiffScalar<DerType>& x)
+{
+  const double denom = 1 + std::fabs(x.value());
+  return Eigen::AutoDiffScalar<DerType>(fast_sigmoid(x.value()), x.derivatives() / (denom*denom));
+}
+
+//! penaltyBoundToInterval() (symmetric version) for dual numbers
+template <typename DerType>
+inline Eigen::AutoDiffScalar<DerType> penaltyBoundToInterval(const Eigen::AutoDiffScalar<DerType>& var, const double& a, const double& epsilon)
+{
+  return Eigen::AutoDiffScalar<DerType>(penaltyBoundToInterval(var.value(), a, epsilon),
+                                        penaltyBoundToIntervalDerivative(var.value(), a, epsilon) * var.derivatives());
+}
+
+//! penaltyBoundToInterval() for dual numbers
+template <typename DerType>
+inline Eigen::AutoDiffScalar<DerType> penaltyBoundToInterval(const Eigen::AutoDiffScalar<DerType>& var, const double& a, const double& b, const double& epsilon)
+{
+  return Eigen::AutoDiffScalar<DerType>(penaltyBoundToInterval(var.value(), a, b, epsilon),
+                                        penaltyBoundToIntervalDerivative(var.value(), a, b, epsilon) * var.derivatives());
+}
+
+//! penaltyBoundFromBelow() for dual numbers
+template <typename DerType>
+inline Eigen::AutoDiffScalar<DerType> penaltyBoundFromBelow(const Eigen::AutoDiffScalar<DerType>& var, const double& a, const double& epsilon)
+{
+  return Eigen::AutoDiffScalar<DerType>(penaltyBoundFromBelow(var.value(), a, epsilon),
+                                        penaltyBoundFromBelowDerivative(var.value(), a, epsilon) * var.derivatives());
+}
+
+//@}
+
+} // end namespace
+
+#endif
@@ -47,8 +47,10 @@
 #include <teb_local_planner/g2o_types/vertex_pose.h>
 #include <teb_local_planner/g2o_types/vertex_timediff.h>
 #include <teb_local_planner/g2o_types/penalties.h>
+#include <teb_local_planner/g2o_types/edge_velocity.h>
 #include <teb_local_planner/teb_config.h>
 #include <teb_local_planner/g2o_types/base_teb_edges.h>
+#include <teb_local_planner/g2o_types/base_teb_autodiff_edge.h>
 
 #include <geometry_msgs/Twist.h>
 
@@ -75,191 +77,98 @@ namespace teb_local_planner
  * @remarks Do not forget to call setTebConfig()
  * @remarks Refer to EdgeAccelerationStart() and EdgeAccelerationGoal() for defining boundary values!
  */    
-class EdgeAcceleration : public BaseTebMultiEdge<2, double>
+class EdgeAcceleration : public BaseTebAutoDiffEdge<EdgeAcceleration, 2, double, 3, 3, 3, 1, 1>
 {
 public:
 
   /**
-   * @brief Construct edge.
-   */ 
-  EdgeAcceleration()
-  {
-    this->resize(5);
-  }
-    
-  /**
-   * @brief Actual cost function
+   * @brief Actual cost function (called by computeError() and linearizeOplusAutoDiff())
+   * @param x estimates of pose1, pose2, pose3 (x, y, theta), dt1 and dt2
+   * @param[out] error penalties of the translational and rotational acceleration
    */   
-  void computeError()
+  template <typename T>
+  void evaluate(const T* const* x, T* error) const
   {
     ROS_ASSERT_MSG(cfg_, "You must call setTebConfig on EdgeAcceleration()");
-    const VertexPose* pose1 = static_cast<const VertexPose*>(_vertices[0]);
-    const VertexPose* pose2 = static_cast<const VertexPose*>(_vertices[1]);
-    const VertexPose* pose3 = static_cast<const VertexPose*>(_vertices[2]);
-    const VertexTimeDiff* dt1 = static_cast<const VertexTimeDiff*>(_vertices[3]);
-    const VertexTimeDiff* dt2 = static_cast<const VertexTimeDiff*>(_vertices[4]);
+    const T* pose1 = x[0];
+    const T* pose2 = x[1];
+    const T* pose3 = x[2];
+    const T& dt1 = x[3][0];
+    const T& dt2 = x[4][0];
 
     // VELOCITY & ACCELERATION
-    const Eigen::Vector2d diff1 = pose2->position() - pose1->position();
-    const Eigen::Vector2d diff2 = pose3->position() - pose2->position();
-        
-    double dist1 = diff1.norm();
-    double dist2 = diff2.norm();
-    const double angle_diff1 = g2o::normalize_theta(pose2->theta() - pose1->theta());
-    const double angle_diff2 = g2o::normalize_theta(pose3->theta() - pose2->theta());
+    const T vel1 = segmentVelocity(pose1, pose2, dt1, cfg_->trajectory.exact_arc_length);
+    const T vel2 = segmentVelocity(pose2, pose3, dt2, cfg_->trajectory.exact_arc_length);
     
-    if (cfg_->trajectory.exact_arc_length) // use exact arc length instead of Euclidean approximation
-    {
-        if (angle_diff1 != 0)
-        {
-            const double radius =  dist1/(2*sin(angle_diff1/2));
-            dist1 = fabs( angle_diff1 * radius ); // actual arg length!
-        }
-        if (angle_diff2 != 0)
-        {
-            const double radius =  dist2/(2*sin(angle_diff2/2));
-            dist2 = fabs( angle_diff2 * radius ); // actual arg length!
-        }
-    }
-    
-    double vel1 = dist1 / dt1->dt();
-    double vel2 = dist2 / dt2->dt();
-    
-    
-    // consider directions
-//     vel1 *= g2o::sign(diff1[0]*cos(pose1->theta()) + diff1[1]*sin(pose1->theta())); 
-//     vel2 *= g2o::sign(diff2[0]*cos(pose2->theta()) + diff2[1]*sin(pose2->theta())); 
-    vel1 *= fast_sigmoid( 100*(diff1.x()*cos(pose1->theta()) + diff1.y()*sin(pose1->theta())) ); 
-    vel2 *= fast_sigmoid( 100*(diff2.x()*cos(pose2->theta()) + diff2.y()*sin(pose2->theta())) ); 
-    
-    const double acc_lin  = (vel2 - vel1)*2 / ( dt1->dt() + dt2->dt() );
-   
+    const T acc_lin  = (vel2 - vel1)*2. / ( dt1 + dt2 );
 
-    _error[0] = penaltyBoundToInterval(acc_lin,cfg_->robot.acc_lim_x,cfg_->optim.penalty_epsilon);
+    error[0] = penaltyBoundToInterval(acc_lin,cfg_->robot.acc_lim_x,cfg_->optim.penalty_epsilon);
     
     // ANGULAR ACCELERATION
-    const double omega1 = angle_diff1 / dt1->dt();
-    const double omega2 = angle_diff2 / dt2->dt();
-    const double acc_rot  = (omega2 - omega1)*2 / ( dt1->dt() + dt2->dt() );
+    const T omega1 = normalize_theta(T(pose2[2] - pose1[2])) / dt1;
+    const T omega2 = normalize_theta(T(pose3[2] - pose2[2])) / dt2;
+    const T acc_rot  = (omega2 - omega1)*2. / ( dt1 + dt2 );
       
-    _error[1] = penaltyBoundToInterval(acc_rot,cfg_->robot.acc_lim_theta,cfg_->optim.penalty_epsilon);
-
-    
-    ROS_ASSERT_MSG(std::isfinite(_error[0]), "EdgeAcceleration::computeError() translational: _error[0]=%f\n",_error[0]);
-    ROS_ASSERT_MSG(std::isfinite(_error[1]), "EdgeAcceleration::computeError() rotational: _error[1]=%f\n",_error[1]);
+    error[1] = penaltyBoundToInterval(acc_rot,cfg_->robot.acc_lim_theta,cfg_->optim.penalty_epsilon);
   }
 
-
-
 #ifdef USE_ANALYTIC_JACOBI
-#if 0
-  /*
+  /**
    * @brief Jacobi matrix of the cost function specified in computeError().
+   *
+   * Both segment velocities are differentiated with segmentVelocityWithDerivatives().
    */
   void linearizeOplus()
   {
     ROS_ASSERT_MSG(cfg_, "You must call setTebConfig on EdgeAcceleration()");
-    const VertexPointXY* conf1 = static_cast<const VertexPointXY*>(_vertices[0]);
-    const VertexPointXY* conf2 = static_cast<const VertexPointXY*>(_vertices[1]);
-    const VertexPointXY* conf3 = static_cast<const VertexPointXY*>(_vertices[2]);
-    const VertexTimeDiff* deltaT1 = static_cast<const VertexTimeDiff*>(_vertices[3]);
-    const VertexTimeDiff* deltaT2 = static_cast<const VertexTimeDiff*>(_vertices[4]);
-    const VertexOrientation* angle1 = static_cast<const VertexOrientation*>(_vertices[5]);
-    const VertexOrientation* angle2 = static_cast<const VertexOrientation*>(_vertices[6]);
-    const VertexOrientation* angle3 = static_cast<const VertexOrientation*>(_vertices[7]);
-
-    Eigen::Vector2d deltaS1 = conf2->estimate() - conf1->estimate();
-    Eigen::Vector2d deltaS2 = conf3->estimate() - conf2->estimate();
-    double dist1 = deltaS1.norm();
-    double dist2 = deltaS2.norm();
-    
-    double sum_time = deltaT1->estimate() + deltaT2->estimate();
-    double sum_time_inv = 1 / sum_time;
-    double dt1_inv = 1/deltaT1->estimate();
-    double dt2_inv = 1/deltaT2->estimate();
-    double aux0 = 2/sum_time_inv;
-    double aux1 = dist1 * deltaT1->estimate();
-    double aux2 = dist2 * deltaT2->estimate();
-
-    double vel1 = dist1 * dt1_inv;
-    double vel2 = dist2 * dt2_inv;
-    double omega1 = g2o::normalize_theta( angle2->estimate() - angle1->estimate() ) * dt1_inv;
-    double omega2 = g2o::normalize_theta( angle3->estimate() - angle2->estimate() ) * dt2_inv;
-    double acc = (vel2 - vel1) * aux0;
-    double omegadot = (omega2 - omega1) * aux0;
-    double aux3 = -acc/2;
-    double aux4 = -omegadot/2;
-    
-    double dev_border_acc = penaltyBoundToIntervalDerivative(acc, tebConfig.robot_acceleration_max_trans,optimizationConfig.optimization_boundaries_epsilon,optimizationConfig.optimization_boundaries_scale,optimizationConfig.optimization_boundaries_order);
-    double dev_border_omegadot = penaltyBoundToIntervalDerivative(omegadot, tebConfig.robot_acceleration_max_rot,optimizationConfig.optimization_boundaries_epsilon,optimizationConfig.optimization_boundaries_scale,optimizationConfig.optimization_boundaries_order);
-    
-    _jacobianOplus[0].resize(2,2); // conf1
-    _jacobianOplus[1].resize(2,2); // conf2
-    _jacobianOplus[2].resize(2,2); // conf3
-    _jacobianOplus[3].resize(2,1); // deltaT1
-    _jacobianOplus[4].resize(2,1); // deltaT2
-    _jacobianOplus[5].resize(2,1); // angle1
-    _jacobianOplus[6].resize(2,1); // angle2
-    _jacobianOplus[7].resize(2,1); // angle3
-    
-    if (aux1==0) aux1=1e-20;
-    if (aux2==0) aux2=1e-20;
-  
-    if (dev_border_acc!=0)
-    {
-      // TODO: double aux = aux0 * dev_border_acc;
-      // double aux123 = aux / aux1;
-      _jacobianOplus[0](0,0) = aux0 * deltaS1[0] / aux1 * dev_border_acc; // acc x1
-      _jacobianOplus[0](0,1) = aux0 * deltaS1[1] / aux1 * dev_border_acc; // acc y1
-      _jacobianOplus[1](0,0) = -aux0 * ( deltaS1[0] / aux1 + deltaS2[0] / aux2 ) * dev_border_acc; // acc x2
-      _jacobianOplus[1](0,1) = -aux0 * ( deltaS1[1] / aux1 + deltaS2[1] / aux2 ) * dev_border_acc; // acc y2
-      _jacobianOplus[2](0,0) = aux0 * deltaS2[0] / aux2 * dev_border_acc; // acc x3
-      _jacobianOplus[2](0,1) = aux0 * deltaS2[1] / aux2 * dev_border_acc; // acc y3	
-      _jacobianOplus[2](0,0) = 0;
-      _jacobianOplus[2](0,1) = 0;
-      _jacobianOplus[3](0,0) = aux0 * (aux3 + vel1 * dt1_inv) * dev_border_acc; // acc deltaT1
-      _jacobianOplus[4](0,0) = aux0 * (aux3 - vel2 * dt2_inv) * dev_border_acc; // acc deltaT2
-    }
-    else
-    {
-      _jacobianOplus[0](0,0) = 0; // acc x1
-      _jacobianOplus[0](0,1) = 0; // acc y1	
-      _jacobianOplus[1](0,0) = 0; // acc x2
-      _jacobianOplus[1](0,1) = 0; // acc y2
-      _jacobianOplus[2](0,0) = 0; // acc x3
-      _jacobianOplus[2](0,1) = 0; // acc y3	
-      _jacobianOplus[3](0,0) = 0; // acc deltaT1
-      _jacobianOplus[4](0,0) = 0; // acc deltaT2
-    }
-    
-    if (dev_border_omegadot!=0)
-    {
-      _jacobianOplus[3](1,0) = aux0 * ( aux4 + omega1 * dt1_inv ) * dev_border_omegadot; // omegadot deltaT1
-      _jacobianOplus[4](1,0) = aux0 * ( aux4 - omega2 * dt2_inv ) * dev_border_omegadot; // omegadot deltaT2
-      _jacobianOplus[5](1,0) = aux0 * dt1_inv * dev_border_omegadot; // omegadot angle1
-      _jacobianOplus[6](1,0) = -aux0 * ( dt1_inv + dt2_inv ) * dev_border_omegadot; // omegadot angle2
-      _jacobianOplus[7](1,0) = aux0 * dt2_inv * dev_border_omegadot; // omegadot angle3
-    }
-    else
-    {
-      _jacobianOplus[3](1,0) = 0; // omegadot deltaT1
-      _jacobianOplus[4](1,0) = 0; // omegadot deltaT2
-      _jacobianOplus[5](1,0) = 0; // omegadot angle1
-      _jacobianOplus[6](1,0) = 0; // omegadot angle2
-      _jacobianOplus[7](1,0) = 0; // omegadot angle3			
-    }
+    const VertexPose* pose1 = static_cast<const VertexPose*>(_vertices[0]);
+    const VertexPose* pose2 = static_cast<const VertexPose*>(_vertices[1]);
+    const VertexPose* pose3 = static_cast<const VertexPose*>(_vertices[2]);
+    const VertexTimeDiff* dt1 = static_cast<const VertexTimeDiff*>(_vertices[3]);
+    const VertexTimeDiff* dt2 = static_cast<const VertexTimeDiff*>(_vertices[4]);
+
+    Eigen::Vector2d dvel1_dpos2, dvel2_dpos3;
+    double dvel1_dtheta1, dvel1_dtheta2, dvel1_ddt1;
+    double dvel2_dtheta2, dvel2_dtheta3, dvel2_ddt2;
+    const double vel1 = segmentVelocityWithDerivatives(pose1->pose(), pose2->pose(), dt1->dt(), cfg_->trajectory.exact_arc_length,
+                                                       dvel1_dpos2, dvel1_dtheta1, dvel1_dtheta2, dvel1_ddt1);
+    const double vel2 = segmentVelocityWithDerivatives(pose2->pose(), pose3->pose(), dt2->dt(), cfg_->trajectory.exact_arc_length,
+                                                       dvel2_dpos3, dvel2_dtheta2, dvel2_dtheta3, dvel2_ddt2);
+
+    const double aux0 = 2 / ( dt1->dt() + dt2->dt() );
+    const double acc_lin = (vel2 - vel1) * aux0;
+
+    const double omega1 = g2o::normalize_theta(pose2->theta() - pose1->theta()) / dt1->dt();
+    const double omega2 = g2o::normalize_theta(pose3->theta() - pose2->theta()) / dt2->dt();
+    const double acc_rot = (omega2 - omega1) * aux0;
+
+    const double dev_acc = penaltyBoundToIntervalDerivative(acc_lin, cfg_->robot.acc_lim_x, cfg_->optim.penalty_epsilon) * aux0;
+    const double dev_rot = penaltyBoundToIntervalDerivative(acc_rot, cfg_->robot.acc_lim_theta, cfg_->optim.penalty_epsilon) * aux0;
+
+    _jacobianOplus[0](0,0) = dev_acc * dvel1_dpos2.x(); // acc x1
+    _jacobianOplus[0](0,1) = dev_acc * dvel1_dpos2.y(); // acc y1
+    _jacobianOplus[0](0,2) = -dev_acc * dvel1_dtheta1; // acc angle1
+    _jacobianOplus[1](0,0) = -dev_acc * ( dvel1_dpos2.x() + dvel2_dpos3.x() ); // acc x2
+    _jacobianOplus[1](0,1) = -dev_acc * ( dvel1_dpos2.y() + dvel2_dpos3.y() ); // acc y2
+    _jacobianOplus[1](0,2) = dev_acc * ( dvel2_dtheta2 - dvel1_dtheta2 ); // acc angle2
+    _jacobianOplus[2](0,0) = dev_acc * dvel2_dpos3.x(); // acc x3
+    _jacobianOplus[2](0,1) = dev_acc * dvel2_dpos3.y(); // acc y3
+    _jacobianOplus[2](0,2) = dev_acc * dvel2_dtheta3; // acc angle3
+    _jacobianOplus[3](0,0) = -dev_acc * ( dvel1_ddt1 + acc_lin/2 ); // acc deltaT1
+    _jacobianOplus[4](0,0) = dev_acc * ( dvel2_ddt2 - acc_lin/2 ); // acc deltaT2
 
     _jacobianOplus[0](1,0) = 0; // omegadot x1
     _jacobianOplus[0](1,1) = 0; // omegadot y1
+    _jacobianOplus[0](1,2) = dev_rot / dt1->dt(); // omegadot angle1
     _jacobianOplus[1](1,0) = 0; // omegadot x2
     _jacobianOplus[1](1,1) = 0; // omegadot y2
+    _jacobianOplus[1](1,2) = -dev_rot * ( 1/dt1->dt() + 1/dt2->dt() ); // omegadot angle2
     _jacobianOplus[2](1,0) = 0; // omegadot x3
     _jacobianOplus[2](1,1) = 0; // omegadot y3
-    _jacobianOplus[5](0,0) = 0; // acc angle1
-    _jacobianOplus[6](0,0) = 0; // acc angle2
-    _jacobianOplus[7](0,0) = 0; // acc angle3
-    }
-#endif
+    _jacobianOplus[2](1,2) = dev_rot / dt2->dt(); // omegadot angle3
+    _jacobianOplus[3](1,0) = dev_rot * ( omega1/dt1->dt() - acc_rot/2 ); // omegadot deltaT1
+    _jacobianOplus[4](1,0) = -dev_rot * ( omega2/dt2->dt() + acc_rot/2 ); // omegadot deltaT2
+  }
 #endif
 
       
@@ -288,7 +197,7 @@ public:
  * @remarks Do not forget to call setTebConfig()
  * @remarks Refer to EdgeAccelerationGoal() for defining boundary values at the end of the trajectory!
  */      
-class EdgeAccelerationStart : public BaseTebMultiEdge<2, const geometry_msgs::Twist*>
+class EdgeAccelerationStart : public BaseTebAutoDiffEdge<EdgeAccelerationStart, 2, const geometry_msgs::Twist*, 3, 3, 1>
 {
 public:
 
@@ -298,52 +207,79 @@ public:
   EdgeAccelerationStart()
   {
     _measurement = NULL;
-    this->resize(3);
   }
   
-  
   /**
-   * @brief Actual cost function
+   * @brief Actual cost function (called by computeError() and linearizeOplusAutoDiff())
+   * @param x estimates of pose1, pose2 (x, y, theta) and dt
+   * @param[out] error penalties of the translational and rotational acceleration
    */   
-  void computeError()
+  template <typename T>
+  void evaluate(const T* const* x, T* error) const
   {
     ROS_ASSERT_MSG(cfg_ && _measurement, "You must call setTebConfig() and setStartVelocity() on EdgeAccelerationStart()");
-    const VertexPose* pose1 = static_cast<const VertexPose*>(_vertices[0]);
-    const VertexPose* pose2 = static_cast<const VertexPose*>(_vertices[1]);
-    const VertexTimeDiff* dt = static_cast<const VertexTimeDiff*>(_vertices[2]);
+    const T* pose1 = x[0];
+    const T* pose2 = x[1];
+    const T& dt = x[2][0];
 
     // VELOCITY & ACCELERATION
-    const Eigen::Vector2d diff = pose2->position() - pose1->position();
-    double dist = diff.norm();
-    const double angle_diff = g2o::normalize_theta(pose2->theta() - pose1->theta());
-    if (cfg_->trajectory.exact_arc_length && angle_diff != 0)
-    {
-        const double radius =  dist/(2*sin(angle_diff/2));
-        dist = fabs( angle_diff * radius ); // actual arg length!
-    }
-    
     const double vel1 = _measurement->linear.x;
-    double vel2 = dist / dt->dt();
-
-    // consider directions
-    //vel2 *= g2o::sign(diff[0]*cos(pose1->theta()) + diff[1]*sin(pose1->theta())); 
-    vel2 *= fast_sigmoid( 100*(diff.x()*cos(pose1->theta()) + diff.y()*sin(pose1->theta())) ); 
+    const T vel2 = segmentVelocity(pose1, pose2, dt, cfg_->trajectory.exact_arc_length);
     
-    const double acc_lin  = (vel2 - vel1) / dt->dt();
+    const T acc_lin  = (vel2 - vel1) / dt;
     
-    _error[0] = penaltyBoundToInterval(acc_lin,cfg_->robot.acc_lim_x,cfg_->optim.penalty_epsilon);
+    error[0] = penaltyBoundToInterval(acc_lin,cfg_->robot.acc_lim_x,cfg_->optim.penalty_epsilon);
     
     // ANGULAR ACCELERATION
     const double omega1 = _measurement->angular.z;
-    const double omega2 = angle_diff / dt->dt();
-    const double acc_rot  = (omega2 - omega1) / dt->dt();
+    const T omega2 = normalize_theta(T(pose2[2] - pose1[2])) / dt;
+    const T acc_rot  = (omega2 - omega1) / dt;
       
-    _error[1] = penaltyBoundToInterval(acc_rot,cfg_->robot.acc_lim_theta,cfg_->optim.penalty_epsilon);
-
-    ROS_ASSERT_MSG(std::isfinite(_error[0]), "EdgeAccelerationStart::computeError() translational: _error[0]=%f\n",_error[0]);
-    ROS_ASSERT_MSG(std::isfinite(_error[1]), "EdgeAccelerationStart::computeError() rotational: _error[1]=%f\n",_error[1]);
+    error[1] = penaltyBoundToInterval(acc_rot,cfg_->robot.acc_lim_theta,cfg_->optim.penalty_epsilon);
   }
   
+#ifdef USE_ANALYTIC_JACOBI
+  /**
+   * @brief Jacobi matrix of the cost function specified in computeError().
+   */
+  void linearizeOplus()
+  {
+    ROS_ASSERT_MSG(cfg_ && _measurement, "You must call setTebConfig() and setStartVelocity() on EdgeAccelerationStart()");
+    const VertexPose* pose1 = static_cast<const VertexPose*>(_vertices[0]);
+    const VertexPose* pose2 = static_cast<const VertexPose*>(_vertices[1]);
+    const VertexTimeDiff* dt = static_cast<const VertexTimeDiff*>(_vertices[2]);
+
+    Eigen::Vector2d dvel_dpos2;
+    double dvel_dtheta1, dvel_dtheta2, dvel_ddt;
+    const double vel2 = segmentVelocityWithDerivatives(pose1->pose(), pose2->pose(), dt->dt(), cfg_->trajectory.exact_arc_length,
+                                                       dvel_dpos2, dvel_dtheta1, dvel_dtheta2, dvel_ddt);
+    const double inv_dt = 1.0 / dt->dt();
+    const double acc_lin = (vel2 - _measurement->linear.x) * inv_dt;
+
+    const double omega2 = g2o::normalize_theta(pose2->theta() - pose1->theta()) * inv_dt;
+    const double acc_rot = (omega2 - _measurement->angular.z) * inv_dt;
+
+    const double dev_acc = penaltyBoundToIntervalDerivative(acc_lin, cfg_->robot.acc_lim_x, cfg_->optim.penalty_epsilon) * inv_dt;
+    const double dev_rot = penaltyBoundToIntervalDerivative(acc_rot, cfg_->robot.acc_lim_theta, cfg_->optim.penalty_epsilon) * inv_dt;
+
+    _jacobianOplus[0](0,0) = -dev_acc * dvel_dpos2.x(); // acc x1
+    _jacobianOplus[0](0,1) = -dev_acc * dvel_dpos2.y(); // acc y1
+    _jacobianOplus[0](0,2) = dev_acc * dvel_dtheta1; // acc angle1
+    _jacobianOplus[1](0,0) = dev_acc * dvel_dpos2.x(); // acc x2
+    _jacobianOplus[1](0,1) = dev_acc * dvel_dpos2.y(); // acc y2
+    _jacobianOplus[1](0,2) = dev_acc * dvel_dtheta2; // acc angle2
+    _jacobianOplus[2](0,0) = dev_acc * ( dvel_ddt - acc_lin ); // acc deltaT
+
+    _jacobianOplus[0](1,0) = 0; // omegadot x1
+    _jacobianOplus[0](1,1) = 0; // omegadot y1
+    _jacobianOplus[0](1,2) = -dev_rot * inv_dt; // omegadot angle1
+    _jacobianOplus[1](1,0) = 0; // omegadot x2
+    _jacobianOplus[1](1,1) = 0; // omegadot y2
+    _jacobianOplus[1](1,2) = dev_rot * inv_dt; // omegadot angle2
+    _jacobianOplus[2](1,0) = -dev_rot * ( omega2*inv_dt + acc_rot ); // omegadot deltaT
+  }
+#endif
+
   /**
    * @brief Set the initial velocity that is taken into account for calculating the acceleration
    * @param vel_start twist message containing the translational and rotational velocity
@@ -379,7 +315,7 @@ public:
  * @remarks Do not forget to call setTebConfig()
  * @remarks Refer to EdgeAccelerationStart() for defining boundary (initial) values at the end of the trajectory
  */  
-class EdgeAccelerationGoal : public BaseTebMultiEdge<2, const geometry_msgs::Twist*>
+class EdgeAccelerationGoal : public BaseTebAutoDiffEdge<EdgeAccelerationGoal, 2, const geometry_msgs::Twist*, 3, 3, 1>
 {
 public:
 
@@ -389,53 +325,79 @@ public:
   EdgeAccelerationGoal()
   {
     _measurement = NULL;
-    this->resize(3);
   }
   
-
   /**
-   * @brief Actual cost function
+   * @brief Actual cost function (called by computeError() and linearizeOplusAutoDiff())
+   * @param x estimates of pose_pre_goal, pose_goal (x, y, theta) and dt
+   * @param[out] error penalties of the translational and rotational acceleration
    */ 
-  void computeError()
+  template <typename T>
+  void evaluate(const T* const* x, T* error) const
   {
     ROS_ASSERT_MSG(cfg_ && _measurement, "You must call setTebConfig() and setGoalVelocity() on EdgeAccelerationGoal()");
-    const VertexPose* pose_pre_goal = static_cast<const VertexPose*>(_vertices[0]);
-    const VertexPose* pose_goal = static_cast<const VertexPose*>(_vertices[1]);
-    const VertexTimeDiff* dt = static_cast<const VertexTimeDiff*>(_vertices[2]);
+    const T* pose_pre_goal = x[0];
+    const T* pose_goal = x[1];
+    const T& dt = x[2][0];
 
     // VELOCITY & ACCELERATION
-
-    const Eigen::Vector2d diff = pose_goal->position() - pose_pre_goal->position();  
-    double dist = diff.norm();
-    const double angle_diff = g2o::normalize_theta(pose_goal->theta() - pose_pre_goal->theta());
-    if (cfg_->trajectory.exact_arc_length  && angle_diff != 0)
-    {
-        double radius =  dist/(2*sin(angle_diff/2));
-        dist = fabs( angle_diff * radius ); // actual arg length!
-    }
-    
-    double vel1 = dist / dt->dt();
+    const T vel1 = segmentVelocity(pose_pre_goal, pose_goal, dt, cfg_->trajectory.exact_arc_length);
     const double vel2 = _measurement->linear.x;
     
-    // consider directions
-    //vel1 *= g2o::sign(diff[0]*cos(pose_pre_goal->theta()) + diff[1]*sin(pose_pre_goal->theta())); 
-    vel1 *= fast_sigmoid( 100*(diff.x()*cos(pose_pre_goal->theta()) + diff.y()*sin(pose_pre_goal->theta())) ); 
-    
-    const double acc_lin  = (vel2 - vel1) / dt->dt();
+    const T acc_lin  = (vel2 - vel1) / dt;
 
-    _error[0] = penaltyBoundToInterval(acc_lin,cfg_->robot.acc_lim_x,cfg_->optim.penalty_epsilon);
+    error[0] = penaltyBoundToInterval(acc_lin,cfg_->robot.acc_lim_x,cfg_->optim.penalty_epsilon);
     
     // ANGULAR ACCELERATION
-    const double omega1 = angle_diff / dt->dt();
+    const T omega1 = normalize_theta(T(pose_goal[2] - pose_pre_goal[2])) / dt;
     const double omega2 = _measurement->angular.z;
-    const double acc_rot  = (omega2 - omega1) / dt->dt();
+    const T acc_rot  = (omega2 - omega1) / dt;
       
-    _error[1] = penaltyBoundToInterval(acc_rot,cfg_->robot.acc_lim_theta,cfg_->optim.penalty_epsilon);
-
-    ROS_ASSERT_MSG(std::isfinite(_error[0]), "EdgeAccelerationGoal::computeError() translational: _error[0]=%f\n",_error[0]);
-    ROS_ASSERT_MSG(std::isfinite(_error[1]), "EdgeAccelerationGoal::computeError() rotational: _error[1]=%f\n",_error[1]);
+    error[1] = penaltyBoundToInterval(acc_rot,cfg_->robot.acc_lim_theta,cfg_->optim.penalty_epsilon);
   }
     
+#ifdef USE_ANALYTIC_JACOBI
+  /**
+   * @brief Jacobi matrix of the cost function specified in computeError().
+   */
+  void linearizeOplus()
+  {
+    ROS_ASSERT_MSG(cfg_ && _measurement, "You must call setTebConfig() and setGoalVelocity() on EdgeAccelerationGoal()");
+    const VertexPose* pose_pre_goal = static_cast<const VertexPose*>(_vertices[0]);
+    const VertexPose* pose_goal = static_cast<const VertexPose*>(_vertices[1]);
+    const VertexTimeDiff* dt = static_cast<const VertexTimeDiff*>(_vertices[2]);
+
+    Eigen::Vector2d dvel_dpos2;
+    double dvel_dtheta1, dvel_dtheta2, dvel_ddt;
+    const double vel1 = segmentVelocityWithDerivatives(pose_pre_goal->pose(), pose_goal->pose(), dt->dt(), cfg_->trajectory.exact_arc_length,
+                                                       dvel_dpos2, dvel_dtheta1, dvel_dtheta2, dvel_ddt);
+    const double inv_dt = 1.0 / dt->dt();
+    const double acc_lin = (_measurement->linear.x - vel1) * inv_dt;
+
+    const double omega1 = g2o::normalize_theta(pose_goal->theta() - pose_pre_goal->theta()) * inv_dt;
+    const double acc_rot = (_measurement->angular.z - omega1) * inv_dt;
+
+    const double dev_acc = penaltyBoundToIntervalDerivative(acc_lin, cfg_->robot.acc_lim_x, cfg_->optim.penalty_epsilon) * inv_dt;
+    const double dev_rot = penaltyBoundToIntervalDerivative(acc_rot, cfg_->robot.acc_lim_theta, cfg_->optim.penalty_epsilon) * inv_dt;
+
+    _jacobianOplus[0](0,0) = dev_acc * dvel_dpos2.x(); // acc x1
+    _jacobianOplus[0](0,1) = dev_acc * dvel_dpos2.y(); // acc y1
+    _jacobianOplus[0](0,2) = -dev_acc * dvel_dtheta1; // acc angle1
+    _jacobianOplus[1](0,0) = -dev_acc * dvel_dpos2.x(); // acc x2
+    _jacobianOplus[1](0,1) = -dev_acc * dvel_dpos2.y(); // acc y2
+    _jacobianOplus[1](0,2) = -dev_acc * dvel_dtheta2; // acc angle2
+    _jacobianOplus[2](0,0) = -dev_acc * ( dvel_ddt + acc_lin ); // acc deltaT
+
+    _jacobianOplus[0](1,0) = 0; // omegadot x1
+    _jacobianOplus[0](1,1) = 0; // omegadot y1
+    _jacobianOplus[0](1,2) = dev_rot * inv_dt; // omegadot angle1
+    _jacobianOplus[1](1,0) = 0; // omegadot x2
+    _jacobianOplus[1](1,1) = 0; // omegadot y2
+    _jacobianOplus[1](1,2) = -dev_rot * inv_dt; // omegadot angle2
+    _jacobianOplus[2](1,0) = dev_rot * ( omega1*inv_dt - acc_rot ); // omegadot deltaT
+  }
+#endif
+
   /**
    * @brief Set the goal / final velocity that is taken into account for calculating the acceleration
    * @param vel_goal twist message containing the translational and rotational velocity
@@ -471,71 +433,144 @@ public:
  * @remarks Do not forget to call setTebConfig()
  * @remarks Refer to EdgeAccelerationHolonomicStart() and EdgeAccelerationHolonomicGoal() for defining boundary values!
  */    
-class EdgeAccelerationHolonomic : public BaseTebMultiEdge<3, double>
+class EdgeAccelerationHolonomic : public BaseTebAutoDiffEdge<EdgeAccelerationHolonomic, 3, double, 3, 3, 3, 1, 1>
 {
 public:
 
   /**
-   * @brief Construct edge.
-   */    
-  EdgeAccelerationHolonomic()
-  {
-    this->resize(5);
-  }
-    
-  /**
-   * @brief Actual cost function
+   * @brief Actual cost function (called by computeError() and linearizeOplusAutoDiff())
+   * @param x estimates of pose1, pose2, pose3 (x, y, theta), dt1 and dt2
+   * @param[out] error penalties of the accelerations w.r.t. x, y and theta
    */   
-  void computeError()
+  template <typename T>
+  void evaluate(const T* const* x, T* error) const
   {
     ROS_ASSERT_MSG(cfg_, "You must call setTebConfig on EdgeAcceleration()");
-    const VertexPose* pose1 = static_cast<const VertexPose*>(_vertices[0]);
-    const VertexPose* pose2 = static_cast<const VertexPose*>(_vertices[1]);
-    const VertexPose* pose3 = static_cast<const VertexPose*>(_vertices[2]);
-    const VertexTimeDiff* dt1 = static_cast<const VertexTimeDiff*>(_vertices[3]);
-    const VertexTimeDiff* dt2 = static_cast<const VertexTimeDiff*>(_vertices[4]);
+    using std::cos;
+    using std::sin;
+    const T* pose1 = x[0];
+    const T* pose2 = x[1];
+    const T* pose3 = x[2];
+    const T& dt1 = x[3][0];
+    const T& dt2 = x[4][0];
 
     // VELOCITY & ACCELERATION
-    Eigen::Vector2d diff1 = pose2->position() - pose1->position();
-    Eigen::Vector2d diff2 = pose3->position() - pose2->position();
+    const T diff1_x = pose2[0] - pose1[0];
+    const T diff1_y = pose2[1] - pose1[1];
+    const T diff2_x = pose3[0] - pose2[0];
+    const T diff2_y = pose3[1] - pose2[1];
     
-    double cos_theta1 = std::cos(pose1->theta());
-    double sin_theta1 = std::sin(pose1->theta()); 
-    double cos_theta2 = std::cos(pose2->theta());
-    double sin_theta2 = std::sin(pose2->theta()); 
+    const T cos_theta1 = cos(pose1[2]);
+    const T sin_theta1 = sin(pose1[2]); 
+    const T cos_theta2 = cos(pose2[2]);
+    const T sin_theta2 = sin(pose2[2]); 
     
     // transform pose2 into robot frame pose1 (inverse 2d rotation matrix)
-    double p1_dx =  cos_theta1*diff1.x() + sin_theta1*diff1.y();
-    double p1_dy = -sin_theta1*diff1.x() + cos_theta1*diff1.y();
+    const T p1_dx =  cos_theta1*diff1_x + sin_theta1*diff1_y;
+    const T p1_dy = -sin_theta1*diff1_x + cos_theta1*diff1_y;
     // transform pose3 into robot frame pose2 (inverse 2d rotation matrix)
-    double p2_dx =  cos_theta2*diff2.x() + sin_theta2*diff2.y();
-    double p2_dy = -sin_theta2*diff2.x() + cos_theta2*diff2.y();
+    const T p2_dx =  cos_theta2*diff2_x + sin_theta2*diff2_y;
+    const T p2_dy = -sin_theta2*diff2_x + cos_theta2*diff2_y;
     
-    double vel1_x = p1_dx / dt1->dt();
-    double vel1_y = p1_dy / dt1->dt();
-    double vel2_x = p2_dx / dt2->dt();
-    double vel2_y = p2_dy / dt2->dt();
+    const T vel1_x = p1_dx / dt1;
+    const T vel1_y = p1_dy / dt1;
+    const T vel2_x = p2_dx / dt2;
+    const T vel2_y = p2_dy / dt2;
     
-    double dt12 = dt1->dt() + dt2->dt();
+    const T dt12 = dt1 + dt2;
     
-    double acc_x  = (vel2_x - vel1_x)*2 / dt12;
-    double acc_y  = (vel2_y - vel1_y)*2 / dt12;
+    const T acc_x  = (vel2_x - vel1_x)*2. / dt12;
+    const T acc_y  = (vel2_y - vel1_y)*2. / dt12;
    
-    _error[0] = penaltyBoundToInterval(acc_x,cfg_->robot.acc_lim_x,cfg_->optim.penalty_epsilon);
-    _error[1] = penaltyBoundToInterval(acc_y,cfg_->robot.acc_lim_y,cfg_->optim.penalty_epsilon);
+    error[0] = penaltyBoundToInterval(acc_x,cfg_->robot.acc_lim_x,cfg_->optim.penalty_epsilon);
+    error[1] = penaltyBoundToInterval(acc_y,cfg_->robot.acc_lim_y,cfg_->optim.penalty_epsilon);
     
     // ANGULAR ACCELERATION
-    double omega1 = g2o::normalize_theta(pose2->theta() - pose1->theta()) / dt1->dt();
-    double omega2 = g2o::normalize_theta(pose3->theta() - pose2->theta()) / dt2->dt();
-    double acc_rot  = (omega2 - omega1)*2 / dt12;
+    const T omega1 = normalize_theta(T(pose2[2] - pose1[2])) / dt1;
+    const T omega2 = normalize_theta(T(pose3[2] - pose2[2])) / dt2;
+    const T acc_rot  = (omega2 - omega1)*2. / dt12;
       
-    _error[2] = penaltyBoundToInterval(acc_rot,cfg_->robot.acc_lim_theta,cfg_->optim.penalty_epsilon);
+    error[2] = penaltyBoundToInterval(acc_rot,cfg_->robot.acc_lim_theta,cfg_->optim.penalty_epsilon);
+  }
 
-    
-    ROS_ASSERT_MSG(std::isfinite(_error[0]), "EdgeAcceleration::computeError() translational: _error[0]=%f\n",_error[0]);
-    ROS_ASSERT_MSG(std::isfinite(_error[1]), "EdgeAcceleration::computeError() strafing: _error[1]=%f\n",_error[1]);
-    ROS_ASSERT_MSG(std::isfinite(_error[2]), "EdgeAcceleration::computeError() rotational: _error[2]=%f\n",_error[2]);
+#ifdef USE_ANALYTIC_JACOBI
+  /**
+   * @brief Jacobi matrix of the cost function specified in computeError().
+   */
+  void linearizeOplus()
+  {
+    ROS_ASSERT_MSG(cfg_, "You must call setTebConfig on EdgeAcceleration()");
+    const VertexPose* pose1 = static_cast<const VertexPose*>(_vertices[0]);
+    const VertexPose* pose2 = static_cast<const VertexPose*>(_vertices[1]);
+    const VertexPose* pose3 = static_cast<const VertexPose*>(_vertices[2]);
+    const VertexTimeDiff* dt1 = static_cast<const VertexTimeDiff*>(_vertices[3]);
+    const VertexTimeDiff* dt2 = static_cast<const VertexTimeDiff*>(_vertices[4]);
+
+    Eigen::Vector2d diff1 = pose2->position() - pose1->position();
+    Eigen::Vector2d diff2 = pose3->position() - pose2->position();
+
+    double cos_theta1 = std::cos(pose1->theta());
+    double sin_theta1 = std::sin(pose1->theta());
+    double cos_theta2 = std::cos(pose2->theta());
+    double sin_theta2 = std::sin(pose2->theta());
+    double inv_dt1 = 1.0 / dt1->dt();
+    double inv_dt2 = 1.0 / dt2->dt();
+    double aux0 = 2 / ( dt1->dt() + dt2->dt() );
+
+    // velocities in the robot frames of pose1 and pose2
+    double vel1_x = ( cos_theta1*diff1.x() + sin_theta1*diff1.y()) * inv_dt1;
+    double vel1_y = (-sin_theta1*diff1.x() + cos_theta1*diff1.y()) * inv_dt1;
+    double vel2_x = ( cos_theta2*diff2.x() + sin_theta2*diff2.y()) * inv_dt2;
+    double vel2_y = (-sin_theta2*diff2.x() + cos_theta2*diff2.y()) * inv_dt2;
+
+    double acc_x = (vel2_x - vel1_x) * aux0;
+    double acc_y = (vel2_y - vel1_y) * aux0;
+
+    double omega1 = g2o::normalize_theta(pose2->theta() - pose1->theta()) * inv_dt1;
+    double omega2 = g2o::normalize_theta(pose3->theta() - pose2->theta()) * inv_dt2;
+    double acc_rot = (omega2 - omega1) * aux0;
+
+    double dev_x = penaltyBoundToIntervalDerivative(acc_x, cfg_->robot.acc_lim_x, cfg_->optim.penalty_epsilon) * aux0;
+    double dev_y = penaltyBoundToIntervalDerivative(acc_y, cfg_->robot.acc_lim_y, cfg_->optim.penalty_epsilon) * aux0;
+    double dev_rot = penaltyBoundToIntervalDerivative(acc_rot, cfg_->robot.acc_lim_theta, cfg_->optim.penalty_epsilon) * aux0;
+
+    _jacobianOplus[0](0,0) = dev_x * cos_theta1 * inv_dt1; // acc_x x1
+    _jacobianOplus[0](0,1) = dev_x * sin_theta1 * inv_dt1; // acc_x y1
+    _jacobianOplus[0](0,2) = -dev_x * vel1_y; // acc_x angle1
+    _jacobianOplus[1](0,0) = -dev_x * ( cos_theta1*inv_dt1 + cos_theta2*inv_dt2 ); // acc_x x2
+    _jacobianOplus[1](0,1) = -dev_x * ( sin_theta1*inv_dt1 + sin_theta2*inv_dt2 ); // acc_x y2
+    _jacobianOplus[1](0,2) = dev_x * vel2_y; // acc_x angle2
+    _jacobianOplus[2](0,0) = dev_x * cos_theta2 * inv_dt2; // acc_x x3
+    _jacobianOplus[2](0,1) = dev_x * sin_theta2 * inv_dt2; // acc_x y3
+    _jacobianOplus[2](0,2) = 0; // acc_x angle3
+    _jacobianOplus[3](0,0) = dev_x * ( vel1_x*inv_dt1 - acc_x/2 ); // acc_x deltaT1
+    _jacobianOplus[4](0,0) = -dev_x * ( vel2_x*inv_dt2 + acc_x/2 ); // acc_x deltaT2
+
+    _jacobianOplus[0](1,0) = -dev_y * sin_theta1 * inv_dt1; // acc_y x1
+    _jacobianOplus[0](1,1) = dev_y * cos_theta1 * inv_dt1; // acc_y y1
+    _jacobianOplus[0](1,2) = dev_y * vel1_x; // acc_y angle1
+    _jacobianOplus[1](1,0) = dev_y * ( sin_theta1*inv_dt1 + sin_theta2*inv_dt2 ); // acc_y x2
+    _jacobianOplus[1](1,1) = -dev_y * ( cos_theta1*inv_dt1 + cos_theta2*inv_dt2 ); // acc_y y2
+    _jacobianOplus[1](1,2) = -dev_y * vel2_x; // acc_y angle2
+    _jacobianOplus[2](1,0) = -dev_y * sin_theta2 * inv_dt2; // acc_y x3
+    _jacobianOplus[2](1,1) = dev_y * cos_theta2 * inv_dt2; // acc_y y3
+    _jacobianOplus[2](1,2) = 0; // acc_y angle3
+    _jacobianOplus[3](1,0) = dev_y * ( vel1_y*inv_dt1 - acc_y/2 ); // acc_y deltaT1
+    _jacobianOplus[4](1,0) = -dev_y * ( vel2_y*inv_dt2 + acc_y/2 ); // acc_y deltaT2
+
+    _jacobianOplus[0](2,0) = 0; // omegadot x1
+    _jacobianOplus[0](2,1) = 0; // omegadot y1
+    _jacobianOplus[0](2,2) = dev_rot * inv_dt1; // omegadot angle1
+    _jacobianOplus[1](2,0) = 0; // omegadot x2
+    _jacobianOplus[1](2,1) = 0; // omegadot y2
+    _jacobianOplus[1](2,2) = -dev_rot * ( inv_dt1 + inv_dt2 ); // omegadot angle2
+    _jacobianOplus[2](2,0) = 0; // omegadot x3
+    _jacobianOplus[2](2,1) = 0; // omegadot y3
+    _jacobianOplus[2](2,2) = dev_rot * inv_dt2; // omegadot angle3
+    _jacobianOplus[3](2,0) = dev_rot * ( omega1*inv_dt1 - acc_rot/2 ); // omegadot deltaT1
+    _jacobianOplus[4](2,0) = -dev_rot * ( omega2*inv_dt2 + acc_rot/2 ); // omegadot deltaT2
   }
+#endif
 
 public: 
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
@@ -563,62 +598,118 @@ public:
  * @remarks Do not forget to call setTebConfig()
  * @remarks Refer to EdgeAccelerationHolonomicGoal() for defining boundary values at the end of the trajectory!
  */      
-class EdgeAccelerationHolonomicStart : public BaseTebMultiEdge<3, const geometry_msgs::Twist*>
+class EdgeAccelerationHolonomicStart : public BaseTebAutoDiffEdge<EdgeAccelerationHolonomicStart, 3, const geometry_msgs::Twist*, 3, 3, 1>
 {
 public:
 
   /**
    * @brief Construct edge.
-   */   
+   */	 
   EdgeAccelerationHolonomicStart()
   {
-    this->resize(3);
     _measurement = NULL;
   }
     
   /**
-   * @brief Actual cost function
+   * @brief Actual cost function (called by computeError() and linearizeOplusAutoDiff())
+   * @param x estimates of pose1, pose2 (x, y, theta) and dt
+   * @param[out] error penalties of the accelerations w.r.t. x, y and theta
    */   
-  void computeError()
+  template <typename T>
+  void evaluate(const T* const* x, T* error) const
   {
     ROS_ASSERT_MSG(cfg_ && _measurement, "You must call setTebConfig() and setStartVelocity() on EdgeAccelerationStart()");
-    const VertexPose* pose1 = static_cast<const VertexPose*>(_vertices[0]);
-    const VertexPose* pose2 = static_cast<const VertexPose*>(_vertices[1]);
-    const VertexTimeDiff* dt = static_cast<const VertexTimeDiff*>(_vertices[2]);
+    using std::cos;
+    using std::sin;
+    const T* pose1 = x[0];
+    const T* pose2 = x[1];
+    const T& dt = x[2][0];
 
     // VELOCITY & ACCELERATION
-    Eigen::Vector2d diff = pose2->position() - pose1->position();
+    const T diff_x = pose2[0] - pose1[0];
+    const T diff_y = pose2[1] - pose1[1];
             
-    double cos_theta1 = std::cos(pose1->theta());
-    double sin_theta1 = std::sin(pose1->theta()); 
+    const T cos_theta1 = cos(pose1[2]);
+    const T sin_theta1 = sin(pose1[2]); 
     
     // transform pose2 into robot frame pose1 (inverse 2d rotation matrix)
-    double p1_dx =  cos_theta1*diff.x() + sin_theta1*diff.y();
-    double p1_dy = -sin_theta1*diff.x() + cos_theta1*diff.y();
+    const T p1_dx =  cos_theta1*diff_x + sin_theta1*diff_y;
+    const T p1_dy = -sin_theta1*diff_x + cos_theta1*diff_y;
     
-    double vel1_x = _measurement->linear.x;
-    double vel1_y = _measurement->linear.y;
-    double vel2_x = p1_dx / dt->dt();
-    double vel2_y = p1_dy / dt->dt();
+    const double vel1_x = _measurement->linear.x;
+    const double vel1_y = _measurement->linear.y;
+    const T vel2_x = p1_dx / dt;
+    const T vel2_y = p1_dy / dt;
 
-    double acc_lin_x  = (vel2_x - vel1_x) / dt->dt();
-    double acc_lin_y  = (vel2_y - vel1_y) / dt->dt();
+    const T acc_lin_x  = (vel2_x - vel1_x) / dt;
+    const T acc_lin_y  = (vel2_y - vel1_y) / dt;
     
-    _error[0] = penaltyBoundToInterval(acc_lin_x,cfg_->robot.acc_lim_x,cfg_->optim.penalty_epsilon);
-    _error[1] = penaltyBoundToInterval(acc_lin_y,cfg_->robot.acc_lim_y,cfg_->optim.penalty_epsilon);
+    error[0] = penaltyBoundToInterval(acc_lin_x,cfg_->robot.acc_lim_x,cfg_->optim.penalty_epsilon);
+    error[1] = penaltyBoundToInterval(acc_lin_y,cfg_->robot.acc_lim_y,cfg_->optim.penalty_epsilon);
     
     // ANGULAR ACCELERATION
-    double omega1 = _measurement->angular.z;
-    double omega2 = g2o::normalize_theta(pose2->theta() - pose1->theta()) / dt->dt();
-    double acc_rot  = (omega2 - omega1) / dt->dt();
+    const double omega1 = _measurement->angular.z;
+    const T omega2 = normalize_theta(T(pose2[2] - pose1[2])) / dt;
+    const T acc_rot  = (omega2 - omega1) / dt;
       
-    _error[2] = penaltyBoundToInterval(acc_rot,cfg_->robot.acc_lim_theta,cfg_->optim.penalty_epsilon);
-
-    ROS_ASSERT_MSG(std::isfinite(_error[0]), "EdgeAccelerationStart::computeError() translational: _error[0]=%f\n",_error[0]);
-    ROS_ASSERT_MSG(std::isfinite(_error[1]), "EdgeAccelerationStart::computeError() strafing: _error[1]=%f\n",_error[1]);
-    ROS_ASSERT_MSG(std::isfinite(_error[2]), "EdgeAccelerationStart::computeError() rotational: _error[2]=%f\n",_error[2]);
+    error[2] = penaltyBoundToInterval(acc_rot,cfg_->robot.acc_lim_theta,cfg_->optim.penalty_epsilon);
   }
   
+#ifdef USE_ANALYTIC_JACOBI
+  /**
+   * @brief Jacobi matrix of the cost function specified in computeError().
+   */
+  void linearizeOplus()
+  {
+    ROS_ASSERT_MSG(cfg_ && _measurement, "You must call setTebConfig() and setStartVelocity() on EdgeAccelerationStart()");
+    const VertexPose* pose1 = static_cast<const VertexPose*>(_vertices[0]);
+    const VertexPose* pose2 = static_cast<const VertexPose*>(_vertices[1]);
+    const VertexTimeDiff* dt = static_cast<const VertexTimeDiff*>(_vertices[2]);
+
+    Eigen::Vector2d diff = pose2->position() - pose1->position();
+
+    double cos_theta1 = std::cos(pose1->theta());
+    double sin_theta1 = std::sin(pose1->theta());
+    double inv_dt = 1.0 / dt->dt();
+
+    double vel2_x = ( cos_theta1*diff.x() + sin_theta1*diff.y()) * inv_dt;
+    double vel2_y = (-sin_theta1*diff.x() + cos_theta1*diff.y()) * inv_dt;
+    double omega2 = g2o::normalize_theta(pose2->theta() - pose1->theta()) * inv_dt;
+
+    double acc_lin_x = (vel2_x - _measurement->linear.x) * inv_dt;
+    double acc_lin_y = (vel2_y - _measurement->linear.y) * inv_dt;
+    double acc_rot = (omega2 - _measurement->angular.z) * inv_dt;
+
+    double dev_x = penaltyBoundToIntervalDerivative(acc_lin_x, cfg_->robot.acc_lim_x, cfg_->optim.penalty_epsilon) * inv_dt;
+    double dev_y = penaltyBoundToIntervalDerivative(acc_lin_y, cfg_->robot.acc_lim_y, cfg_->optim.penalty_epsilon) * inv_dt;
+    double dev_rot = penaltyBoundToIntervalDerivative(acc_rot, cfg_->robot.acc_lim_theta, cfg_->optim.penalty_epsilon) * inv_dt;
+
+    _jacobianOplus[0](0,0) = -dev_x * cos_theta1 * inv_dt; // acc_x x1
+    _jacobianOplus[0](0,1) = -dev_x * sin_theta1 * inv_dt; // acc_x y1
+    _jacobianOplus[0](0,2) = dev_x * vel2_y; // acc_x angle1
+    _jacobianOplus[1](0,0) = dev_x * cos_theta1 * inv_dt; // acc_x x2
+    _jacobianOplus[1](0,1) = dev_x * sin_theta1 * inv_dt; // acc_x y2
+    _jacobianOplus[1](0,2) = 0; // acc_x angle2
+    _jacobianOplus[2](0,0) = -dev_x * ( vel2_x*inv_dt + acc_lin_x ); // acc_x deltaT
+
+    _jacobianOplus[0](1,0) = dev_y * sin_theta1 * inv_dt; // acc_y x1
+    _jacobianOplus[0](1,1) = -dev_y * cos_theta1 * inv_dt; // acc_y y1
+    _jacobianOplus[0](1,2) = -dev_y * vel2_x; // acc_y angle1
+    _jacobianOplus[1](1,0) = -dev_y * sin_theta1 * inv_dt; // acc_y x2
+    _jacobianOplus[1](1,1) = dev_y * cos_theta1 * inv_dt; // acc_y y2
+    _jacobianOplus[1](1,2) = 0; // acc_y angle2
+    _jacobianOplus[2](1,0) = -dev_y * ( vel2_y*inv_dt + acc_lin_y ); // acc_y deltaT
+
+    _jacobianOplus[0](2,0) = 0; // omegadot x1
+    _jacobianOplus[0](2,1) = 0; // omegadot y1
+    _jacobianOplus[0](2,2) = -dev_rot * inv_dt; // omegadot angle1
+    _jacobianOplus[1](2,0) = 0; // omegadot x2
+    _jacobianOplus[1](2,1) = 0; // omegadot y2
+    _jacobianOplus[1](2,2) = dev_rot * inv_dt; // omegadot angle2
+    _jacobianOplus[2](2,0) = -dev_rot * ( omega2*inv_dt + acc_rot ); // omegadot deltaT
+  }
+#endif
+
   /**
    * @brief Set the initial velocity that is taken into account for calculating the acceleration
    * @param vel_start twist message containing the translational and rotational velocity
@@ -654,7 +745,7 @@ public:
  * @remarks Do not forget to call setTebConfig()
  * @remarks Refer to EdgeAccelerationHolonomicStart() for defining boundary (initial) values at the end of the trajectory
  */  
-class EdgeAccelerationHolonomicGoal : public BaseTebMultiEdge<3, const geometry_msgs::Twist*>
+class EdgeAccelerationHolonomicGoal : public BaseTebAutoDiffEdge<EdgeAccelerationHolonomicGoal, 3, const geometry_msgs::Twist*, 3, 3, 1>
 {
 public:
 
@@ -664,54 +755,108 @@ public:
   EdgeAccelerationHolonomicGoal()
   {
     _measurement = NULL;
-    this->resize(3);
   }
   
   /**
-   * @brief Actual cost function
+   * @brief Actual cost function (called by computeError() and linearizeOplusAutoDiff())
+   * @param x estimates of pose_pre_goal, pose_goal (x, y, theta) and dt
+   * @param[out] error penalties of the accelerations w.r.t. x, y and theta
    */ 
-  void computeError()
+  template <typename T>
+  void evaluate(const T* const* x, T* error) const
   {
     ROS_ASSERT_MSG(cfg_ && _measurement, "You must call setTebConfig() and setGoalVelocity() on EdgeAccelerationGoal()");
-    const VertexPose* pose_pre_goal = static_cast<const VertexPose*>(_vertices[0]);
-    const VertexPose* pose_goal = static_cast<const VertexPose*>(_vertices[1]);
-    const VertexTimeDiff* dt = static_cast<const VertexTimeDiff*>(_vertices[2]);
+    using std::cos;
+    using std::sin;
+    const T* pose_pre_goal = x[0];
+    const T* pose_goal = x[1];
+    const T& dt = x[2][0];
 
     // VELOCITY & ACCELERATION
-
-    Eigen::Vector2d diff = pose_goal->position() - pose_pre_goal->position();    
+    const T diff_x = pose_goal[0] - pose_pre_goal[0];
+    const T diff_y = pose_goal[1] - pose_pre_goal[1];
     
-    double cos_theta1 = std::cos(pose_pre_goal->theta());
-    double sin_theta1 = std::sin(pose_pre_goal->theta()); 
+    const T cos_theta1 = cos(pose_pre_goal[2]);
+    const T sin_theta1 = sin(pose_pre_goal[2]); 
     
     // transform pose2 into robot frame pose1 (inverse 2d rotation matrix)
-    double p1_dx =  cos_theta1*diff.x() + sin_theta1*diff.y();
-    double p1_dy = -sin_theta1*diff.x() + cos_theta1*diff.y();
+    const T p1_dx =  cos_theta1*diff_x + sin_theta1*diff_y;
+    const T p1_dy = -sin_theta1*diff_x + cos_theta1*diff_y;
    
-    double vel1_x = p1_dx / dt->dt();
-    double vel1_y = p1_dy / dt->dt();
-    double vel2_x = _measurement->linear.x;
-    double vel2_y = _measurement->linear.y;
+    const T vel1_x = p1_dx / dt;
+    const T vel1_y = p1_dy / dt;
+    const double vel2_x = _measurement->linear.x;
+    const double vel2_y = _measurement->linear.y;
     
-    double acc_lin_x  = (vel2_x - vel1_x) / dt->dt();
-    double acc_lin_y  = (vel2_y - vel1_y) / dt->dt();
+    const T acc_lin_x  = (vel2_x - vel1_x) / dt;
+    const T acc_lin_y  = (vel2_y - vel1_y) / dt;
 
-    _error[0] = penaltyBoundToInterval(acc_lin_x,cfg_->robot.acc_lim_x,cfg_->optim.penalty_epsilon);
-    _error[1] = penaltyBoundToInterval(acc_lin_y,cfg_->robot.acc_lim_y,cfg_->optim.penalty_epsilon);
+    error[0] = penaltyBoundToInterval(acc_lin_x,cfg_->robot.acc_lim_x,cfg_->optim.penalty_epsilon);
+    error[1] = penaltyBoundToInterval(acc_lin_y,cfg_->robot.acc_lim_y,cfg_->optim.penalty_epsilon);
     
     // ANGULAR ACCELERATION
-    double omega1 = g2o::normalize_theta(pose_goal->theta() - pose_pre_goal->theta()) / dt->dt();
-    double omega2 = _measurement->angular.z;
-    double acc_rot  = (omega2 - omega1) / dt->dt();
+    const T omega1 = normalize_theta(T(pose_goal[2] - pose_pre_goal[2])) / dt;
+    const double omega2 = _measurement->angular.z;
+    const T acc_rot  = (omega2 - omega1) / dt;
       
-    _error[2] = penaltyBoundToInterval(acc_rot,cfg_->robot.acc_lim_theta,cfg_->optim.penalty_epsilon);
-
-    ROS_ASSERT_MSG(std::isfinite(_error[0]), "EdgeAccelerationGoal::computeError() translational: _error[0]=%f\n",_error[0]);
-    ROS_ASSERT_MSG(std::isfinite(_error[1]), "EdgeAccelerationGoal::computeError() strafing: _error[1]=%f\n",_error[1]);
-    ROS_ASSERT_MSG(std::isfinite(_error[2]), "EdgeAccelerationGoal::computeError() rotational: _error[2]=%f\n",_error[2]);
+    error[2] = penaltyBoundToInterval(acc_rot,cfg_->robot.acc_lim_theta,cfg_->optim.penalty_epsilon);
   }
   
-  
+#ifdef USE_ANALYTIC_JACOBI
+  /**
+   * @brief Jacobi matrix of the cost function specified in computeError().
+   */
+  void linearizeOplus()
+  {
+    ROS_ASSERT_MSG(cfg_ && _measurement, "You must call setTebConfig() and setGoalVelocity() on EdgeAccelerationGoal()");
+    const VertexPose* pose_pre_goal = static_cast<const VertexPose*>(_vertices[0]);
+    const VertexPose* pose_goal = static_cast<const VertexPose*>(_vertices[1]);
+    const VertexTimeDiff* dt = static_cast<const VertexTimeDiff*>(_vertices[2]);
+
+    Eigen::Vector2d diff = pose_goal->position() - pose_pre_goal->position();
+
+    double cos_theta1 = std::cos(pose_pre_goal->theta());
+    double sin_theta1 = std::sin(pose_pre_goal->theta());
+    double inv_dt = 1.0 / dt->dt();
+
+    double vel1_x = ( cos_theta1*diff.x() + sin_theta1*diff.y()) * inv_dt;
+    double vel1_y = (-sin_theta1*diff.x() + cos_theta1*diff.y()) * inv_dt;
+    double omega1 = g2o::normalize_theta(pose_goal->theta() - pose_pre_goal->theta()) * inv_dt;
+
+    double acc_lin_x = (_measurement->linear.x - vel1_x) * inv_dt;
+    double acc_lin_y = (_measurement->linear.y - vel1_y) * inv_dt;
+    double acc_rot = (_measurement->angular.z - omega1) * inv_dt;
+
+    double dev_x = penaltyBoundToIntervalDerivative(acc_lin_x, cfg_->robot.acc_lim_x, cfg_->optim.penalty_epsilon) * inv_dt;
+    double dev_y = penaltyBoundToIntervalDerivative(acc_lin_y, cfg_->robot.acc_lim_y, cfg_->optim.penalty_epsilon) * inv_dt;
+    double dev_rot = penaltyBoundToIntervalDerivative(acc_rot, cfg_->robot.acc_lim_theta, cfg_->optim.penalty_epsilon) * inv_dt;
+
+    _jacobianOplus[0](0,0) = dev_x * cos_theta1 * inv_dt; // acc_x x1
+    _jacobianOplus[0](0,1) = dev_x * sin_theta1 * inv_dt; // acc_x y1
+    _jacobianOplus[0](0,2) = -dev_x * vel1_y; // acc_x angle1
+    _jacobianOplus[1](0,0) = -dev_x * cos_theta1 * inv_dt; // acc_x x2
+    _jacobianOplus[1](0,1) = -dev_x * sin_theta1 * inv_dt; // acc_x y2
+    _jacobianOplus[1](0,2) = 0; // acc_x angle2
+    _jacobianOplus[2](0,0) = dev_x * ( vel1_x*inv_dt - acc_lin_x ); // acc_x deltaT
+
+    _jacobianOplus[0](1,0) = -dev_y * sin_theta1 * inv_dt; // acc_y x1
+    _jacobianOplus[0](1,1) = dev_y * cos_theta1 * inv_dt; // acc_y y1
+    _jacobianOplus[0](1,2) = dev_y * vel1_x; // acc_y angle1
+    _jacobianOplus[1](1,0) = dev_y * sin_theta1 * inv_dt; // acc_y x2
+    _jacobianOplus[1](1,1) = -dev_y * cos_theta1 * inv_dt; // acc_y y2
+    _jacobianOplus[1](1,2) = 0; // acc_y angle2
+    _jacobianOplus[2](1,0) = dev_y * ( vel1_y*inv_dt - acc_lin_y ); // acc_y deltaT
+
+    _jacobianOplus[0](2,0) = 0; // omegadot x1
+    _jacobianOplus[0](2,1) = 0; // omegadot y1
+    _jacobianOplus[0](2,2) = dev_rot * inv_dt; // omegadot angle1
+    _jacobianOplus[1](2,0) = 0; // omegadot x2
+    _jacobianOplus[1](2,1) = 0; // omegadot y2
+    _jacobianOplus[1](2,2) = -dev_rot * inv_dt; // omegadot angle2
+    _jacobianOplus[2](2,0) = dev_rot * ( omega1*inv_dt - acc_rot ); // omegadot deltaT
+  }
+#endif
+
   /**
    * @brief Set the goal / final velocity that is taken into account for calculating the acceleration
    * @param vel_goal twist message containing the translational and rotational velocity
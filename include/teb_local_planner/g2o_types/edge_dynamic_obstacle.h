@@ -135,6 +135,15 @@ public:
     _measurement = obstacle;
   }
 
+  /**
+   * @brief Set the time for the associated pose (allows to reuse the edge for several poses)
+   * @param t Estimated time until current pose is reached
+   */
+  void setTime(double t)
+  {
+    t_ = t;
+  }
+
 protected:
   
   const BaseRobotFootprintModel* robot_model_; //!< Store pointer to robot_model
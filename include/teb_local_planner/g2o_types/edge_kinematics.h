@@ -47,6 +47,7 @@
 #include <teb_local_planner/g2o_types/vertex_pose.h>
 #include <teb_local_planner/g2o_types/penalties.h>
 #include <teb_local_planner/g2o_types/base_teb_edges.h>
+#include <teb_local_planner/g2o_types/base_teb_autodiff_edge.h>
 #include <teb_local_planner/teb_config.h>
 
 #include <cmath>
@@ -70,7 +71,7 @@ namespace teb_local_planner
  * @see TebOptimalPlanner::AddEdgesKinematics, EdgeKinematicsCarlike
  * @remarks Do not forget to call setTebConfig()
  */    
-class EdgeKinematicsDiffDrive : public BaseTebBinaryEdge<2, double, VertexPose, VertexPose>
+class EdgeKinematicsDiffDrive : public BaseTebAutoDiffEdge<EdgeKinematicsDiffDrive, 2, double, 3, 3>
 {
 public:
   
@@ -83,25 +84,29 @@ public:
   }
   
   /**
-   * @brief Actual cost function
+   * @brief Actual cost function (called by computeError() and linearizeOplusAutoDiff())
+   * @param x estimates of conf1 and conf2 (x, y, theta)
+   * @param[out] error non-holonomic and positive-drive-direction penalty
    */    
-  void computeError()
+  template <typename T>
+  void evaluate(const T* const* x, T* error) const
   {
     ROS_ASSERT_MSG(cfg_, "You must call setTebConfig on EdgeKinematicsDiffDrive()");
-    const VertexPose* conf1 = static_cast<const VertexPose*>(_vertices[0]);
-    const VertexPose* conf2 = static_cast<const VertexPose*>(_vertices[1]);
+    using std::abs;
+    using std::cos;
+    using std::sin;
+    const T* conf1 = x[0];
+    const T* conf2 = x[1];
     
-    Eigen::Vector2d deltaS = conf2->position() - conf1->position();
+    const T dx = conf2[0] - conf1[0];
+    const T dy = conf2[1] - conf1[1];
 
     // non holonomic constraint
-    _error[0] = fabs( ( cos(conf1->theta())+cos(conf2->theta()) ) * deltaS[1] - ( sin(conf1->theta())+sin(conf2->theta()) ) * deltaS[0] );
+    error[0] = abs( ( cos(conf1[2])+cos(conf2[2]) ) * dy - ( sin(conf1[2])+sin(conf2[2]) ) * dx );
 
     // positive-drive-direction constraint
-    Eigen::Vector2d angle_vec ( cos(conf1->theta()), sin(conf1->theta()) );	   
-    _error[1] = penaltyBoundFromBelow(deltaS.dot(angle_vec), 0,0);
+    error[1] = penaltyBoundFromBelow(T(dx*cos(conf1[2]) + dy*sin(conf1[2])), 0., 0.);
     // epsilon=0, otherwise it pushes the first bandpoints away from start
-
-    ROS_ASSERT_MSG(std::isfinite(_error[0]) && std::isfinite(_error[1]), "EdgeKinematicsDiffDrive::computeError() _error[0]=%f _error[1]=%f\n",_error[0],_error[1]);
   }
 
 #ifdef USE_ANALYTIC_JACOBI
@@ -132,20 +137,20 @@ public:
 	      ( sin(conf1->theta())+sin(conf2->theta()) ) * deltaS[0] );
 	    
     // conf1
-    _jacobianOplusXi(0,0) = aux1 * dev_nh_abs; // nh x1
-    _jacobianOplusXi(0,1) = -aux2 * dev_nh_abs; // nh y1
-    _jacobianOplusXi(1,0) = -cos1 * dd_dev; // drive-dir x1
-    _jacobianOplusXi(1,1) = -sin1 * dd_dev; // drive-dir y1
-    _jacobianOplusXi(0,2) = (-dd_error_2 - dd_error_1) * dev_nh_abs; // nh angle
-    _jacobianOplusXi(1,2) = ( -sin1*deltaS[0] + cos1*deltaS[1] ) * dd_dev; // drive-dir angle1
+    _jacobianOplus[0](0,0) = aux1 * dev_nh_abs; // nh x1
+    _jacobianOplus[0](0,1) = -aux2 * dev_nh_abs; // nh y1
+    _jacobianOplus[0](1,0) = -cos1 * dd_dev; // drive-dir x1
+    _jacobianOplus[0](1,1) = -sin1 * dd_dev; // drive-dir y1
+    _jacobianOplus[0](0,2) = (-dd_error_2 - dd_error_1) * dev_nh_abs; // nh angle
+    _jacobianOplus[0](1,2) = ( -sin1*deltaS[0] + cos1*deltaS[1] ) * dd_dev; // drive-dir angle1
     
     // conf2
-    _jacobianOplusXj(0,0) = -aux1 * dev_nh_abs; // nh x2
-    _jacobianOplusXj(0,1) = aux2 * dev_nh_abs; // nh y2
-    _jacobianOplusXj(1,0) = cos1 * dd_dev; // drive-dir x2
-    _jacobianOplusXj(1,1) = sin1 * dd_dev; // drive-dir y2
-    _jacobianOplusXj(0,2) = (-sin2*deltaS[1] - cos2*deltaS[0]) * dev_nh_abs; // nh angle
-    _jacobianOplusXj(1,2) = 0; // drive-dir angle1					
+    _jacobianOplus[1](0,0) = -aux1 * dev_nh_abs; // nh x2
+    _jacobianOplus[1](0,1) = aux2 * dev_nh_abs; // nh y2
+    _jacobianOplus[1](1,0) = cos1 * dd_dev; // drive-dir x2
+    _jacobianOplus[1](1,1) = sin1 * dd_dev; // drive-dir y2
+    _jacobianOplus[1](0,2) = (-sin2*deltaS[1] - cos2*deltaS[0]) * dev_nh_abs; // nh angle
+    _jacobianOplus[1](1,2) = 0; // drive-dir angle1					
   }
 #endif
 #endif
@@ -179,7 +184,7 @@ public:
  *          the user might add an extra margin to the min_turning_radius param.
  * @remarks Do not forget to call setTebConfig()
  */    
-class EdgeKinematicsCarlike : public BaseTebBinaryEdge<2, double, VertexPose, VertexPose>
+class EdgeKinematicsCarlike : public BaseTebAutoDiffEdge<EdgeKinematicsCarlike, 2, double, 3, 3>
 {
 public:
   
@@ -192,30 +197,35 @@ public:
   }
   
   /**
-   * @brief Actual cost function
+   * @brief Actual cost function (called by computeError() and linearizeOplusAutoDiff())
+   * @param x estimates of conf1 and conf2 (x, y, theta)
+   * @param[out] error non-holonomic and minimum turning radius penalty
    */    
-  void computeError()
+  template <typename T>
+  void evaluate(const T* const* x, T* error) const
   {
     ROS_ASSERT_MSG(cfg_, "You must call setTebConfig on EdgeKinematicsCarlike()");
-    const VertexPose* conf1 = static_cast<const VertexPose*>(_vertices[0]);
-    const VertexPose* conf2 = static_cast<const VertexPose*>(_vertices[1]);
+    using std::abs;
+    using std::cos;
+    using std::sin;
+    const T* conf1 = x[0];
+    const T* conf2 = x[1];
     
-    Eigen::Vector2d deltaS = conf2->position() - conf1->position();
+    const T dx = conf2[0] - conf1[0];
+    const T dy = conf2[1] - conf1[1];
 
     // non holonomic constraint
-    _error[0] = fabs( ( cos(conf1->theta())+cos(conf2->theta()) ) * deltaS[1] - ( sin(conf1->theta())+sin(conf2->theta()) ) * deltaS[0] );
+    error[0] = abs( ( cos(conf1[2])+cos(conf2[2]) ) * dy - ( sin(conf1[2])+sin(conf2[2]) ) * dx );
 
     // limit minimum turning radius
-    double angle_diff = g2o::normalize_theta( conf2->theta() - conf1->theta() );
-    if (angle_diff == 0)
-      _error[1] = 0; // straight line motion
+    const T angle_diff = normalize_theta(T(conf2[2] - conf1[2]));
+    if (angle_diff == 0.)
+      error[1] = T(0.); // straight line motion
     else if (cfg_->trajectory.exact_arc_length) // use exact computation of the radius
-      _error[1] = penaltyBoundFromBelow(fabs(deltaS.norm()/(2*sin(angle_diff/2))), cfg_->robot.min_turning_radius, 0.0);
+      error[1] = penaltyBoundFromBelow(T(abs(norm2d(dx, dy)/(2.*sin(angle_diff/2.)))), cfg_->robot.min_turning_radius, 0.0);
     else
-      _error[1] = penaltyBoundFromBelow(deltaS.norm() / fabs(angle_diff), cfg_->robot.min_turning_radius, 0.0); 
+      error[1] = penaltyBoundFromBelow(T(norm2d(dx, dy) / abs(angle_diff)), cfg_->robot.min_turning_radius, 0.0); 
     // This edge is not affected by the epsilon parameter, the user might add an exra margin to the min_turning_radius parameter.
-    
-    ROS_ASSERT_MSG(std::isfinite(_error[0]) && std::isfinite(_error[1]), "EdgeKinematicsCarlike::computeError() _error[0]=%f _error[1]=%f\n",_error[0],_error[1]);
   }
   
 public:
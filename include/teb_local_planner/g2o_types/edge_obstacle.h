@@ -87,7 +87,14 @@ public:
     ROS_ASSERT_MSG(cfg_ && _measurement && robot_model_, "You must call setTebConfig(), setObstacle() and setRobotModel() on EdgeObstacle()");
     const VertexPose* bandpt = static_cast<const VertexPose*>(_vertices[0]);
 
-    double dist = robot_model_->calculateDistance(bandpt->pose(), _measurement);
+    // the penalty vanishes beyond min_obstacle_dist + penalty_epsilon, skip the exact distance computation for distant obstacles
+    if (robot_model_->isBeyondDistance(bandpt->pose(), _measurement, cfg_->obstacles.min_obstacle_dist + cfg_->optim.penalty_epsilon))
+    {
+      _error[0] = 0;
+      return;
+    }
+
+    double dist = calculateRobotObstacleDistance(*robot_model_, bandpt->pose(), _measurement, &witness_);
 
     // Original obstacle cost.
     _error[0] = penaltyBoundFromBelow(dist, cfg_->obstacles.min_obstacle_dist, cfg_->optim.penalty_epsilon);
@@ -157,6 +164,7 @@ public:
   void setObstacle(const Obstacle* obstacle)
   {
     _measurement = obstacle;
+    witness_ = ConvexDistanceWitness();
   }
     
   /**
@@ -179,11 +187,13 @@ public:
     cfg_ = &cfg;
     robot_model_ = robot_model;
     _measurement = obstacle;
+    witness_ = ConvexDistanceWitness();
   }
   
 protected:
 
   const BaseRobotFootprintModel* robot_model_; //!< Store pointer to robot_model
+  ConvexDistanceWitness witness_; //!< Witness vertices of the previous distance query (warm start for convex polygons)
   
 public: 	
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
@@ -226,7 +236,15 @@ public:
     ROS_ASSERT_MSG(cfg_ && _measurement && robot_model_, "You must call setTebConfig(), setObstacle() and setRobotModel() on EdgeInflatedObstacle()");
     const VertexPose* bandpt = static_cast<const VertexPose*>(_vertices[0]);
 
-    double dist = robot_model_->calculateDistance(bandpt->pose(), _measurement);
+    // both penalties vanish beyond the larger threshold, skip the exact distance computation for distant obstacles
+    if (robot_model_->isBeyondDistance(bandpt->pose(), _measurement,
+                                       std::max(cfg_->obstacles.min_obstacle_dist + cfg_->optim.penalty_epsilon, cfg_->obstacles.inflation_dist)))
+    {
+      _error.setZero();
+      return;
+    }
+
+    double dist = calculateRobotObstacleDistance(*robot_model_, bandpt->pose(), _measurement, &witness_);
 
     // Original "straight line" obstacle cost. The max possible value
     // before weighting is min_obstacle_dist
@@ -256,6 +274,7 @@ public:
   void setObstacle(const Obstacle* obstacle)
   {
     _measurement = obstacle;
+    witness_ = ConvexDistanceWitness();
   }
     
   /**
@@ -278,11 +297,13 @@ public:
     cfg_ = &cfg;
     robot_model_ = robot_model;
     _measurement = obstacle;
+    witness_ = ConvexDistanceWitness();
   }
   
 protected:
 
   const BaseRobotFootprintModel* robot_model_; //!< Store pointer to robot_model
+  ConvexDistanceWitness witness_; //!< Witness vertices of the previous distance query (warm start for convex polygons)
   
 public:         
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
@@ -45,8 +45,8 @@
 
 #include <teb_local_planner/g2o_types/vertex_pose.h>
 #include <teb_local_planner/g2o_types/base_teb_edges.h>
+#include <teb_local_planner/g2o_types/base_teb_autodiff_edge.h>
 #include <teb_local_planner/g2o_types/penalties.h>
-#include "g2o/core/base_unary_edge.h"
 
 
 namespace teb_local_planner
@@ -62,7 +62,7 @@ namespace teb_local_planner
  * \e weight can be set using setInformation(). \n
  * @see TebOptimalPlanner::AddEdgePreferRotDir
  */     
-class EdgePreferRotDir : public BaseTebBinaryEdge<1, double, VertexPose, VertexPose>
+class EdgePreferRotDir : public BaseTebAutoDiffEdge<EdgePreferRotDir, 1, double, 3, 3>
 {
 public:
     
@@ -75,16 +75,17 @@ public:
   }
  
   /**
-   * @brief Actual cost function
+   * @brief Actual cost function (called by computeError() and linearizeOplusAutoDiff())
+   * @param x estimates of conf1 and conf2 (x, y, theta)
+   * @param[out] error penalty of rotations into the non-preferred direction
    */    
-  void computeError()
+  template <typename T>
+  void evaluate(const T* const* x, T* error) const
   {
-    const VertexPose* conf1 = static_cast<const VertexPose*>(_vertices[0]);
-    const VertexPose* conf2 = static_cast<const VertexPose*>(_vertices[1]);
+    const T* conf1 = x[0];
+    const T* conf2 = x[1];
     
-    _error[0] = penaltyBoundFromBelow( _measurement*g2o::normalize_theta(conf2->theta()-conf1->theta()) , 0, 0);
-
-    ROS_ASSERT_MSG(std::isfinite(_error[0]), "EdgePreferRotDir::computeError() _error[0]=%f\n",_error[0]);
+    error[0] = penaltyBoundFromBelow( T(_measurement*normalize_theta(T(conf2[2]-conf1[2]))) , 0., 0.);
   }
 
   /**
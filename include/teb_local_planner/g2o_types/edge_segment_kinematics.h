@@ -0,0 +1,271 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ * 
+ * Notes:
+ * The following class is derived from a class defined by the
+ * g2o-framework. g2o is licensed under the terms of the BSD License.
+ * Refer to the base class source for detailed licensing information.
+ *
+ * Author: Christoph Rösmann
+ *********************************************************************/
+
+
+#ifndef EDGE_SEGMENT_KINEMATICS_H_
+#define EDGE_SEGMENT_KINEMATICS_H_
+
+#include <teb_local_planner/g2o_types/vertex_pose.h>
+#include <teb_local_planner/g2o_types/vertex_timediff.h>
+#include <teb_local_planner/g2o_types/penalties.h>
+#include <teb_local_planner/g2o_types/base_teb_edges.h>
+#include <teb_local_planner/teb_config.h>
+#include <teb_local_planner/misc.h>
+
+#include <cmath>
+
+namespace teb_local_planner
+{
+
+/**
+ * @class EdgeSegmentKinematics
+ * @brief Fused edge for a single trajectory segment of a non-holonomic robot (velocity, kinematics and time optimality).
+ *
+ * The edge depends on three vertices \f$ \mathbf{s}_i, \mathbf{s}_{ip1}, \Delta T_i \f$ and replaces
+ * EdgeVelocity, EdgeKinematicsDiffDrive (resp. EdgeKinematicsCarlike) and EdgeTimeOptimal of the same segment.
+ * The shared intermediate values (position difference, distance, angle difference, sin/cos of both headings)
+ * are computed only once. The stacked error vector is: \n
+ * [0] translational velocity (see EdgeVelocity) \n
+ * [1] rotational velocity (see EdgeVelocity) \n
+ * [2] non-holonomic constraint (see EdgeKinematicsDiffDrive) \n
+ * [3] positive drive direction (diff-drive) or minimum turning radius (car-like, see EdgeKinematicsCarlike) \n
+ * [4] time difference (see EdgeTimeOptimal) \n
+ * The corresponding weights are set on the diagonal of the information matrix.
+ * The Jacobian is computed analytically (numerically if \c exact_arc_length is enabled).
+ * @see TebOptimalPlanner::AddEdgesSegmentKinematics
+ * @remarks Do not forget to call setTebConfig()
+ */
+class EdgeSegmentKinematics : public BaseTebMultiEdge<5, double>
+{
+public:
+
+  //! Index of the individual components of the stacked error vector
+  enum Component { VelocityX = 0, VelocityTheta = 1, NonHolonomic = 2, DriveDirOrTurningRadius = 3, TimeOptimal = 4 };
+
+  /**
+   * @brief Construct edge.
+   */
+  EdgeSegmentKinematics()
+  {
+    this->resize(3); // Since we derive from a g2o::BaseMultiEdge, set the desired number of vertices
+  }
+
+  /**
+   * @brief Actual cost function
+   */
+  void computeError()
+  {
+    ROS_ASSERT_MSG(cfg_, "You must call setTebConfig on EdgeSegmentKinematics()");
+    const VertexPose* conf1 = static_cast<const VertexPose*>(_vertices[0]);
+    const VertexPose* conf2 = static_cast<const VertexPose*>(_vertices[1]);
+    const VertexTimeDiff* deltaT = static_cast<const VertexTimeDiff*>(_vertices[2]);
+
+    const Eigen::Vector2d deltaS = conf2->position() - conf1->position();
+    const double dist = deltaS.norm();
+    const double angle_diff = g2o::normalize_theta(conf2->theta() - conf1->theta());
+    const double cos1 = std::cos(conf1->theta());
+    const double sin1 = std::sin(conf1->theta());
+    const double cos2 = std::cos(conf2->theta());
+    const double sin2 = std::sin(conf2->theta());
+    const double dt = deltaT->estimate();
+    const double proj = deltaS.x()*cos1 + deltaS.y()*sin1; // projection onto the heading of conf1
+
+    // velocity
+    double arc_length = dist;
+    if (cfg_->trajectory.exact_arc_length && angle_diff != 0)
+      arc_length = std::fabs(angle_diff * dist / (2*std::sin(angle_diff/2)));
+    const double vel = arc_length / dt * fast_sigmoid(100 * proj); // consider direction
+    const double omega = angle_diff / dt;
+    _error[VelocityX] = penaltyBoundToInterval(vel, -cfg_->robot.max_vel_x_backwards, cfg_->robot.max_vel_x, cfg_->optim.penalty_epsilon);
+    _error[VelocityTheta] = penaltyBoundToInterval(omega, cfg_->robot.max_vel_theta, cfg_->optim.penalty_epsilon);
+
+    // non holonomic constraint
+    _error[NonHolonomic] = std::fabs((cos1 + cos2) * deltaS.y() - (sin1 + sin2) * deltaS.x());
+
+    if (isCarlike())
+    {
+      // limit minimum turning radius
+      if (angle_diff == 0)
+        _error[DriveDirOrTurningRadius] = 0; // straight line motion
+      else if (cfg_->trajectory.exact_arc_length)
+        _error[DriveDirOrTurningRadius] = penaltyBoundFromBelow(std::fabs(dist/(2*std::sin(angle_diff/2))), cfg_->robot.min_turning_radius, 0.0);
+      else
+        _error[DriveDirOrTurningRadius] = penaltyBoundFromBelow(dist / std::fabs(angle_diff), cfg_->robot.min_turning_radius, 0.0);
+    }
+    else
+    {
+      // positive-drive-direction constraint
+      _error[DriveDirOrTurningRadius] = penaltyBoundFromBelow(proj, 0, 0);
+    }
+
+    _error[TimeOptimal] = dt;
+
+    ROS_ASSERT_MSG(std::isfinite(_error[0]) && std::isfinite(_error[3]), "EdgeSegmentKinematics::computeError() _error[0]=%f _error[3]=%f\n",_error[0],_error[3]);
+  }
+
+  /**
+   * @brief Jacobi matrix of the cost function specified in computeError().
+   */
+  void linearizeOplus()
+  {
+    ROS_ASSERT_MSG(cfg_, "You must call setTebConfig on EdgeSegmentKinematics()");
+    if (cfg_->trajectory.exact_arc_length)
+    {
+      g2o::BaseMultiEdge<5, double>::linearizeOplus(); // numeric differentiation
+      return;
+    }
+
+    const VertexPose* conf1 = static_cast<const VertexPose*>(_vertices[0]);
+    const VertexPose* conf2 = static_cast<const VertexPose*>(_vertices[1]);
+    const VertexTimeDiff* deltaT = static_cast<const VertexTimeDiff*>(_vertices[2]);
+
+    const Eigen::Vector2d deltaS = conf2->position() - conf1->position();
+    const double dist = deltaS.norm();
+    const double angle_diff = g2o::normalize_theta(conf2->theta() - conf1->theta());
+    const double cos1 = std::cos(conf1->theta());
+    const double sin1 = std::sin(conf1->theta());
+    const double cos2 = std::cos(conf2->theta());
+    const double sin2 = std::sin(conf2->theta());
+    const double inv_dt = 1.0 / deltaT->estimate();
+    const double proj = deltaS.x()*cos1 + deltaS.y()*sin1;
+    const double dproj_dtheta1 = -deltaS.x()*sin1 + deltaS.y()*cos1;
+    const Eigen::Vector2d dir1(cos1, sin1);
+    const Eigen::Vector2d unit_deltaS = dist > 0 ? Eigen::Vector2d(deltaS / dist) : Eigen::Vector2d::Zero();
+
+    _jacobianOplus[0].setZero(); // conf1
+    _jacobianOplus[1].setZero(); // conf2
+    _jacobianOplus[2].setZero(); // deltaT
+
+    // translational velocity: vel = dist/dt * sigmoid(100*proj)
+    const double sig_arg = 100 * proj;
+    const double sig = fast_sigmoid(sig_arg);
+    const double dsig_dproj = 100 / ((1 + std::fabs(sig_arg)) * (1 + std::fabs(sig_arg)));
+    const double vel = dist * inv_dt * sig;
+    const double dev_vel = penaltyBoundToIntervalDerivative(vel, -cfg_->robot.max_vel_x_backwards, cfg_->robot.max_vel_x, cfg_->optim.penalty_epsilon);
+    if (dev_vel != 0)
+    {
+      const Eigen::Vector2d dvel_ddeltaS = dev_vel * inv_dt * (sig * unit_deltaS + dist * dsig_dproj * dir1);
+      _jacobianOplus[0].block<1,2>(VelocityX,0) = -dvel_ddeltaS.transpose();
+      _jacobianOplus[1].block<1,2>(VelocityX,0) = dvel_ddeltaS.transpose();
+      _jacobianOplus[0](VelocityX,2) = dev_vel * dist * inv_dt * dsig_dproj * dproj_dtheta1;
+      _jacobianOplus[2](VelocityX,0) = -dev_vel * vel * inv_dt;
+    }
+
+    // rotational velocity
+    const double omega = angle_diff * inv_dt;
+    const double dev_omega = penaltyBoundToIntervalDerivative(omega, cfg_->robot.max_vel_theta, cfg_->optim.penalty_epsilon);
+    if (dev_omega != 0)
+    {
+      _jacobianOplus[0](VelocityTheta,2) = -dev_omega * inv_dt;
+      _jacobianOplus[1](VelocityTheta,2) = dev_omega * inv_dt;
+      _jacobianOplus[2](VelocityTheta,0) = -dev_omega * omega * inv_dt;
+    }
+
+    // non holonomic constraint
+    const double sum_cos = cos1 + cos2;
+    const double sum_sin = sin1 + sin2;
+    const double dev_nh = g2o::sign(sum_cos * deltaS.y() - sum_sin * deltaS.x());
+    _jacobianOplus[0](NonHolonomic,0) = sum_sin * dev_nh;
+    _jacobianOplus[0](NonHolonomic,1) = -sum_cos * dev_nh;
+    _jacobianOplus[0](NonHolonomic,2) = (-sin1*deltaS.y() - cos1*deltaS.x()) * dev_nh;
+    _jacobianOplus[1](NonHolonomic,0) = -sum_sin * dev_nh;
+    _jacobianOplus[1](NonHolonomic,1) = sum_cos * dev_nh;
+    _jacobianOplus[1](NonHolonomic,2) = (-sin2*deltaS.y() - cos2*deltaS.x()) * dev_nh;
+
+    if (isCarlike())
+    {
+      // turning radius: r = dist/|angle_diff|
+      if (angle_diff != 0)
+      {
+        const double abs_angle = std::fabs(angle_diff);
+        const double dev_radius = penaltyBoundFromBelowDerivative(dist / abs_angle, cfg_->robot.min_turning_radius, 0.0);
+        if (dev_radius != 0)
+        {
+          const Eigen::Vector2d dr_ddeltaS = dev_radius / abs_angle * unit_deltaS;
+          const double dr_dangle = -dev_radius * dist / (angle_diff * abs_angle);
+          _jacobianOplus[0].block<1,2>(DriveDirOrTurningRadius,0) = -dr_ddeltaS.transpose();
+          _jacobianOplus[1].block<1,2>(DriveDirOrTurningRadius,0) = dr_ddeltaS.transpose();
+          _jacobianOplus[0](DriveDirOrTurningRadius,2) = -dr_dangle;
+          _jacobianOplus[1](DriveDirOrTurningRadius,2) = dr_dangle;
+        }
+      }
+    }
+    else
+    {
+      // positive-drive-direction constraint
+      const double dev_dir = penaltyBoundFromBelowDerivative(proj, 0, 0);
+      _jacobianOplus[0].block<1,2>(DriveDirOrTurningRadius,0) = -dev_dir * dir1.transpose();
+      _jacobianOplus[1].block<1,2>(DriveDirOrTurningRadius,0) = dev_dir * dir1.transpose();
+      _jacobianOplus[0](DriveDirOrTurningRadius,2) = dev_dir * dproj_dtheta1;
+    }
+
+    // time optimality
+    _jacobianOplus[2](TimeOptimal,0) = 1;
+  }
+
+  /**
+   * @brief Return the weighted squared error of a single component (the information matrix is diagonal)
+   * @param component index of the component, see Component
+   * @return contribution of the component to chi2()
+   */
+  double componentChi2(int component) const
+  {
+    return _error[component] * _information(component, component) * _error[component];
+  }
+
+  /**
+   * @brief Check whether the minimum turning radius (car-like robot) or the drive direction is penalized by component 3
+   * @return \c true for car-like robots (same condition as in TebOptimalPlanner::buildGraph)
+   */
+  bool isCarlike() const
+  {
+    return cfg_->robot.min_turning_radius != 0 && cfg_->optim.weight_kinematics_turning_radius != 0;
+  }
+
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+} // end namespace
+
+#endif // EDGE_SEGMENT_KINEMATICS_H_
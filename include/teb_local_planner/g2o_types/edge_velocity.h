@@ -47,8 +47,10 @@
 #include <teb_local_planner/g2o_types/vertex_pose.h>
 #include <teb_local_planner/g2o_types/vertex_timediff.h>
 #include <teb_local_planner/g2o_types/base_teb_edges.h>
+#include <teb_local_planner/g2o_types/base_teb_autodiff_edge.h>
 #include <teb_local_planner/g2o_types/penalties.h>
 #include <teb_local_planner/teb_config.h>
+#include <teb_local_planner/misc.h>
 
 
 #include <iostream>
@@ -56,6 +58,91 @@
 namespace teb_local_planner
 {
 
+/**
+ * @brief Compute the signed translational velocity of a trajectory segment
+ *
+ * Generic version of the velocity computed in segmentVelocityWithDerivatives() that is shared by the cost
+ * functions of the velocity and acceleration edges (and their automatic differentiation).
+ * @param pose1 estimate (x, y, theta) of the pose at the beginning of the segment
+ * @param pose2 estimate (x, y, theta) of the pose at the end of the segment
+ * @param dt time difference of the segment
+ * @param exact_arc_length if \c true, the exact arc length is used instead of the chord
+ * @tparam T double or Eigen::AutoDiffScalar
+ * @return signed translational velocity
+ */
+template <typename T>
+inline T segmentVelocity(const T* pose1, const T* pose2, const T& dt, bool exact_arc_length)
+{
+  using std::sin;
+  using std::cos;
+  using std::abs;
+  const T dx = pose2[0] - pose1[0];
+  const T dy = pose2[1] - pose1[1];
+
+  T dist = norm2d(dx, dy);
+  const T angle_diff = normalize_theta(T(pose2[2] - pose1[2]));
+  if (exact_arc_length && angle_diff != 0.)
+  {
+    const T radius = dist / (2. * sin(angle_diff / 2.));
+    dist = abs(angle_diff * radius); // actual arg length!
+  }
+  // consider direction
+  return dist / dt * fast_sigmoid(T(100. * (dx*cos(pose1[2]) + dy*sin(pose1[2]))));
+}
+
+/**
+ * @brief Compute the signed translational velocity of a trajectory segment and its partial derivatives
+ *
+ * The velocity is computed as in EdgeVelocity::computeError(): the length of the segment (chord or exact arc length)
+ * divided by the time difference and multiplied by fast_sigmoid(100 * deltaS^T [cos(theta1), sin(theta1)]^T)
+ * in order to consider the driving direction.
+ * @param pose1 pose at the beginning of the segment
+ * @param pose2 pose at the end of the segment
+ * @param dt time difference of the segment
+ * @param exact_arc_length if \c true, the exact arc length is used instead of the chord
+ * @param[out] dvel_dpos2 derivative w.r.t. the position of \c pose2 (the one w.r.t. the position of \c pose1 is its negative)
+ * @param[out] dvel_dtheta1 derivative w.r.t. the heading of \c pose1
+ * @param[out] dvel_dtheta2 derivative w.r.t. the heading of \c pose2
+ * @param[out] dvel_ddt derivative w.r.t. the time difference
+ * @return signed translational velocity
+ */
+inline double segmentVelocityWithDerivatives(const PoseSE2& pose1, const PoseSE2& pose2, double dt, bool exact_arc_length,
+                                             Eigen::Vector2d& dvel_dpos2, double& dvel_dtheta1, double& dvel_dtheta2, double& dvel_ddt)
+{
+  const Eigen::Vector2d deltaS = pose2.position() - pose1.position();
+  const double dist = deltaS.norm();
+  const double angle_diff = g2o::normalize_theta(pose2.theta() - pose1.theta());
+  const double cos1 = std::cos(pose1.theta());
+  const double sin1 = std::sin(pose1.theta());
+
+  // arc length = dist * f(angle_diff) with f(a) = a / (2*sin(a/2)) > 0 for |a| <= pi
+  double length_factor = 1;
+  double dlength_factor = 0;
+  if (exact_arc_length && angle_diff != 0)
+  {
+    const double sin_half = std::sin(angle_diff/2);
+    length_factor = std::fabs(angle_diff / (2*sin_half));
+    dlength_factor = (2*sin_half - angle_diff*std::cos(angle_diff/2)) / (4*sin_half*sin_half);
+  }
+  const double length = dist * length_factor;
+
+  // direction: derivative of the fast sigmoid x/(1+|x|) is 1/(1+|x|)^2
+  const double proj = deltaS.x()*cos1 + deltaS.y()*sin1;
+  const double sig_arg = 100 * proj;
+  const double sig = fast_sigmoid(sig_arg);
+  const double dsig_dproj = 100 / ((1 + std::fabs(sig_arg)) * (1 + std::fabs(sig_arg)));
+
+  const double inv_dt = 1.0 / dt;
+  const double vel = length * inv_dt * sig;
+
+  const Eigen::Vector2d unit_deltaS = dist > 0 ? Eigen::Vector2d(deltaS / dist) : Eigen::Vector2d::Zero();
+  dvel_dpos2 = inv_dt * (length_factor * sig * unit_deltaS + length * dsig_dproj * Eigen::Vector2d(cos1, sin1));
+  dvel_dtheta1 = inv_dt * (length * dsig_dproj * (-deltaS.x()*sin1 + deltaS.y()*cos1) - dist * dlength_factor * sig);
+  dvel_dtheta2 = inv_dt * dist * dlength_factor * sig;
+  dvel_ddt = -vel * inv_dt;
+  return vel;
+}
+
   
 /**
  * @class EdgeVelocity
@@ -72,57 +159,36 @@ namespace teb_local_planner
  * @see TebOptimalPlanner::AddEdgesVelocity
  * @remarks Do not forget to call setTebConfig()
  */  
-class EdgeVelocity : public BaseTebMultiEdge<2, double>
+class EdgeVelocity : public BaseTebAutoDiffEdge<EdgeVelocity, 2, double, 3, 3, 1>
 {
 public:
   
   /**
-   * @brief Construct edge.
-   */	      
-  EdgeVelocity()
-  {
-    this->resize(3); // Since we derive from a g2o::BaseMultiEdge, set the desired number of vertices
-  }
-  
-  /**
-   * @brief Actual cost function
+   * @brief Actual cost function (called by computeError() and linearizeOplusAutoDiff())
+   * @param x estimates of conf1 (x, y, theta), conf2 (x, y, theta) and deltaT
+   * @param[out] error penalties of the translational and rotational velocity
    */  
-  void computeError()
+  template <typename T>
+  void evaluate(const T* const* x, T* error) const
   {
     ROS_ASSERT_MSG(cfg_, "You must call setTebConfig on EdgeVelocity()");
-    const VertexPose* conf1 = static_cast<const VertexPose*>(_vertices[0]);
-    const VertexPose* conf2 = static_cast<const VertexPose*>(_vertices[1]);
-    const VertexTimeDiff* deltaT = static_cast<const VertexTimeDiff*>(_vertices[2]);
-    
-    const Eigen::Vector2d deltaS = conf2->estimate().position() - conf1->estimate().position();
+    const T* conf1 = x[0];
+    const T* conf2 = x[1];
+    const T& deltaT = x[2][0];
     
-    double dist = deltaS.norm();
-    const double angle_diff = g2o::normalize_theta(conf2->theta() - conf1->theta());
-    if (cfg_->trajectory.exact_arc_length && angle_diff != 0)
-    {
-        double radius =  dist/(2*sin(angle_diff/2));
-        dist = fabs( angle_diff * radius ); // actual arg length!
-    }
-    double vel = dist / deltaT->estimate();
-    
-//     vel *= g2o::sign(deltaS[0]*cos(conf1->theta()) + deltaS[1]*sin(conf1->theta())); // consider direction
-    vel *= fast_sigmoid( 100 * (deltaS.x()*cos(conf1->theta()) + deltaS.y()*sin(conf1->theta())) ); // consider direction
-    
-    const double omega = angle_diff / deltaT->estimate();
+    const T vel = segmentVelocity(conf1, conf2, deltaT, cfg_->trajectory.exact_arc_length);
+    const T omega = normalize_theta(T(conf2[2] - conf1[2])) / deltaT;
   
     // 以頂點和時間差計算速度，如果速度在區間內，懲罰值為 0 ，否則照比例增加。
-    _error[0] = penaltyBoundToInterval(vel, -cfg_->robot.max_vel_x_backwards, cfg_->robot.max_vel_x,cfg_->optim.penalty_epsilon);
-    _error[1] = penaltyBoundToInterval(omega, cfg_->robot.max_vel_theta,cfg_->optim.penalty_epsilon);
-
-    ROS_ASSERT_MSG(std::isfinite(_error[0]), "EdgeVelocity::computeError() _error[0]=%f _error[1]=%f\n",_error[0],_error[1]);
+    error[0] = penaltyBoundToInterval(vel, -cfg_->robot.max_vel_x_backwards, cfg_->robot.max_vel_x,cfg_->optim.penalty_epsilon);
+    error[1] = penaltyBoundToInterval(omega, cfg_->robot.max_vel_theta,cfg_->optim.penalty_epsilon);
   }
 
 #ifdef USE_ANALYTIC_JACOBI
-#if 0 //TODO the hardcoded jacobian does not include the changing direction (just the absolute value)
-      // Change accordingly...
-
   /**
    * @brief Jacobi matrix of the cost function specified in computeError().
+   *
+   * Includes the direction term (fast_sigmoid) and the exact arc length, see segmentVelocityWithDerivatives().
    */
   void linearizeOplus()
   {
@@ -130,66 +196,34 @@ public:
     const VertexPose* conf1 = static_cast<const VertexPose*>(_vertices[0]);
     const VertexPose* conf2 = static_cast<const VertexPose*>(_vertices[1]);
     const VertexTimeDiff* deltaT = static_cast<const VertexTimeDiff*>(_vertices[2]);
-    
-    Eigen::Vector2d deltaS = conf2->position() - conf1->position();
-    double dist = deltaS.norm();
-    double aux1 = dist*deltaT->estimate();
-    double aux2 = 1/deltaT->estimate();
-    
-    double vel = dist * aux2;
-    double omega = g2o::normalize_theta(conf2->theta() - conf1->theta()) * aux2;
-    
-    double dev_border_vel = penaltyBoundToIntervalDerivative(vel, -cfg_->robot.max_vel_x_backwards, cfg_->robot.max_vel_x,cfg_->optim.penalty_epsilon);
-    double dev_border_omega = penaltyBoundToIntervalDerivative(omega, cfg_->robot.max_vel_theta,cfg_->optim.penalty_epsilon);
-    
-    _jacobianOplus[0].resize(2,3); // conf1
-    _jacobianOplus[1].resize(2,3); // conf2
-    _jacobianOplus[2].resize(2,1); // deltaT
-    
-//  if (aux1==0) aux1=1e-6;
-//  if (aux2==0) aux2=1e-6;
-    
-    if (dev_border_vel!=0)
-    {
-      double aux3 = dev_border_vel / aux1;
-      _jacobianOplus[0](0,0) = -deltaS[0] * aux3; // vel x1
-      _jacobianOplus[0](0,1) = -deltaS[1] * aux3; // vel y1	
-      _jacobianOplus[1](0,0) = deltaS[0] * aux3; // vel x2
-      _jacobianOplus[1](0,1) = deltaS[1] * aux3; // vel y2
-      _jacobianOplus[2](0,0) = -vel * aux2 * dev_border_vel; // vel deltaT
-    }
-    else
-    {
-      _jacobianOplus[0](0,0) = 0; // vel x1
-      _jacobianOplus[0](0,1) = 0; // vel y1	
-      _jacobianOplus[1](0,0) = 0; // vel x2
-      _jacobianOplus[1](0,1) = 0; // vel y2	
-      _jacobianOplus[2](0,0) = 0; // vel deltaT
-    }
-    
-    if (dev_border_omega!=0)
-    {
-      double aux4 = aux2 * dev_border_omega;
-      _jacobianOplus[2](1,0) = -omega * aux4; // omega deltaT
-      _jacobianOplus[0](1,2) = -aux4; // omega angle1
-      _jacobianOplus[1](1,2) = aux4; // omega angle2
-    }
-    else
-    {
-      _jacobianOplus[2](1,0) = 0; // omega deltaT
-      _jacobianOplus[0](1,2) = 0; // omega angle1
-      _jacobianOplus[1](1,2) = 0; // omega angle2			
-    }
 
+    Eigen::Vector2d dvel_dpos2;
+    double dvel_dtheta1, dvel_dtheta2, dvel_ddt;
+    const double vel = segmentVelocityWithDerivatives(conf1->pose(), conf2->pose(), deltaT->estimate(), cfg_->trajectory.exact_arc_length,
+                                                      dvel_dpos2, dvel_dtheta1, dvel_dtheta2, dvel_ddt);
+    const double omega = g2o::normalize_theta(conf2->theta() - conf1->theta()) / deltaT->estimate();
+
+    const double dev_border_vel = penaltyBoundToIntervalDerivative(vel, -cfg_->robot.max_vel_x_backwards, cfg_->robot.max_vel_x,cfg_->optim.penalty_epsilon);
+    const double dev_border_omega = penaltyBoundToIntervalDerivative(omega, cfg_->robot.max_vel_theta,cfg_->optim.penalty_epsilon);
+
+    _jacobianOplus[0](0,0) = -dev_border_vel * dvel_dpos2.x(); // vel x1
+    _jacobianOplus[0](0,1) = -dev_border_vel * dvel_dpos2.y(); // vel y1
+    _jacobianOplus[0](0,2) = dev_border_vel * dvel_dtheta1; // vel angle1
+    _jacobianOplus[1](0,0) = dev_border_vel * dvel_dpos2.x(); // vel x2
+    _jacobianOplus[1](0,1) = dev_border_vel * dvel_dpos2.y(); // vel y2
+    _jacobianOplus[1](0,2) = dev_border_vel * dvel_dtheta2; // vel angle2
+    _jacobianOplus[2](0,0) = dev_border_vel * dvel_ddt; // vel deltaT
+
+    const double aux = dev_border_omega / deltaT->estimate();
     _jacobianOplus[0](1,0) = 0; // omega x1
     _jacobianOplus[0](1,1) = 0; // omega y1
+    _jacobianOplus[0](1,2) = -aux; // omega angle1
     _jacobianOplus[1](1,0) = 0; // omega x2
     _jacobianOplus[1](1,1) = 0; // omega y2
-    _jacobianOplus[0](0,2) = 0; // vel angle1
-    _jacobianOplus[1](0,2) = 0; // vel angle2
+    _jacobianOplus[1](1,2) = aux; // omega angle2
+    _jacobianOplus[2](1,0) = -omega * aux; // omega deltaT
   }
 #endif
-#endif
  
   
 public:
@@ -219,47 +253,95 @@ public:
  * @see TebOptimalPlanner::AddEdgesVelocity
  * @remarks Do not forget to call setTebConfig()
  */  
-class EdgeVelocityHolonomic : public BaseTebMultiEdge<3, double>
+class EdgeVelocityHolonomic : public BaseTebAutoDiffEdge<EdgeVelocityHolonomic, 3, double, 3, 3, 1>
 {
 public:
   
   /**
-   * @brief Construct edge.
-   */       
-  EdgeVelocityHolonomic()
+   * @brief Actual cost function (called by computeError() and linearizeOplusAutoDiff())
+   * @param x estimates of conf1 (x, y, theta), conf2 (x, y, theta) and deltaT
+   * @param[out] error penalties of the velocities w.r.t. x, y and theta
+   */  
+  template <typename T>
+  void evaluate(const T* const* x, T* error) const
   {
-    this->resize(3); // Since we derive from a g2o::BaseMultiEdge, set the desired number of vertices
+    ROS_ASSERT_MSG(cfg_, "You must call setTebConfig on EdgeVelocityHolonomic()");
+    using std::cos;
+    using std::sin;
+    const T* conf1 = x[0];
+    const T* conf2 = x[1];
+    const T& deltaT = x[2][0];
+    const T dx = conf2[0] - conf1[0];
+    const T dy = conf2[1] - conf1[1];
+    
+    const T cos_theta1 = cos(conf1[2]);
+    const T sin_theta1 = sin(conf1[2]); 
+    
+    // transform conf2 into current robot frame conf1 (inverse 2d rotation matrix)
+    const T r_dx =  cos_theta1*dx + sin_theta1*dy;
+    const T r_dy = -sin_theta1*dx + cos_theta1*dy;
+    
+    const T vx = r_dx / deltaT;
+    const T vy = r_dy / deltaT;
+    const T omega = normalize_theta(T(conf2[2] - conf1[2])) / deltaT;
+    
+    error[0] = penaltyBoundToInterval(vx, -cfg_->robot.max_vel_x_backwards, cfg_->robot.max_vel_x, cfg_->optim.penalty_epsilon);
+    error[1] = penaltyBoundToInterval(vy, cfg_->robot.max_vel_y, 0.0); // we do not apply the penalty epsilon here, since the velocity could be close to zero
+    error[2] = penaltyBoundToInterval(omega, cfg_->robot.max_vel_theta,cfg_->optim.penalty_epsilon);
   }
-  
+
+#ifdef USE_ANALYTIC_JACOBI
   /**
-   * @brief Actual cost function
-   */  
-  void computeError()
+   * @brief Jacobi matrix of the cost function specified in computeError().
+   */
+  void linearizeOplus()
   {
     ROS_ASSERT_MSG(cfg_, "You must call setTebConfig on EdgeVelocityHolonomic()");
     const VertexPose* conf1 = static_cast<const VertexPose*>(_vertices[0]);
     const VertexPose* conf2 = static_cast<const VertexPose*>(_vertices[1]);
     const VertexTimeDiff* deltaT = static_cast<const VertexTimeDiff*>(_vertices[2]);
     Eigen::Vector2d deltaS = conf2->position() - conf1->position();
-    
+
     double cos_theta1 = std::cos(conf1->theta());
-    double sin_theta1 = std::sin(conf1->theta()); 
-    
-    // transform conf2 into current robot frame conf1 (inverse 2d rotation matrix)
-    double r_dx =  cos_theta1*deltaS.x() + sin_theta1*deltaS.y();
-    double r_dy = -sin_theta1*deltaS.x() + cos_theta1*deltaS.y();
-    
-    double vx = r_dx / deltaT->estimate();
-    double vy = r_dy / deltaT->estimate();
-    double omega = g2o::normalize_theta(conf2->theta() - conf1->theta()) / deltaT->estimate();
-    
-    _error[0] = penaltyBoundToInterval(vx, -cfg_->robot.max_vel_x_backwards, cfg_->robot.max_vel_x, cfg_->optim.penalty_epsilon);
-    _error[1] = penaltyBoundToInterval(vy, cfg_->robot.max_vel_y, 0.0); // we do not apply the penalty epsilon here, since the velocity could be close to zero
-    _error[2] = penaltyBoundToInterval(omega, cfg_->robot.max_vel_theta,cfg_->optim.penalty_epsilon);
+    double sin_theta1 = std::sin(conf1->theta());
+    double inv_dt = 1.0 / deltaT->estimate();
+
+    double vx = ( cos_theta1*deltaS.x() + sin_theta1*deltaS.y()) * inv_dt;
+    double vy = (-sin_theta1*deltaS.x() + cos_theta1*deltaS.y()) * inv_dt;
+    double omega = g2o::normalize_theta(conf2->theta() - conf1->theta()) * inv_dt;
 
-    ROS_ASSERT_MSG(std::isfinite(_error[0]) && std::isfinite(_error[1]) && std::isfinite(_error[2]),
-                   "EdgeVelocityHolonomic::computeError() _error[0]=%f _error[1]=%f _error[2]=%f\n",_error[0],_error[1],_error[2]);
+    double dev_vx = penaltyBoundToIntervalDerivative(vx, -cfg_->robot.max_vel_x_backwards, cfg_->robot.max_vel_x, cfg_->optim.penalty_epsilon) * inv_dt;
+    double dev_vy = penaltyBoundToIntervalDerivative(vy, cfg_->robot.max_vel_y, 0.0) * inv_dt;
+    double dev_omega = penaltyBoundToIntervalDerivative(omega, cfg_->robot.max_vel_theta,cfg_->optim.penalty_epsilon) * inv_dt;
+
+    // vx = R(theta1)^T * deltaS (first row) / dt
+    _jacobianOplus[0](0,0) = -cos_theta1 * dev_vx; // vx x1
+    _jacobianOplus[0](0,1) = -sin_theta1 * dev_vx; // vx y1
+    _jacobianOplus[0](0,2) = vy * deltaT->estimate() * dev_vx; // vx angle1
+    _jacobianOplus[1](0,0) = cos_theta1 * dev_vx; // vx x2
+    _jacobianOplus[1](0,1) = sin_theta1 * dev_vx; // vx y2
+    _jacobianOplus[1](0,2) = 0; // vx angle2
+    _jacobianOplus[2](0,0) = -vx * dev_vx; // vx deltaT
+
+    // vy = R(theta1)^T * deltaS (second row) / dt
+    _jacobianOplus[0](1,0) = sin_theta1 * dev_vy; // vy x1
+    _jacobianOplus[0](1,1) = -cos_theta1 * dev_vy; // vy y1
+    _jacobianOplus[0](1,2) = -vx * deltaT->estimate() * dev_vy; // vy angle1
+    _jacobianOplus[1](1,0) = -sin_theta1 * dev_vy; // vy x2
+    _jacobianOplus[1](1,1) = cos_theta1 * dev_vy; // vy y2
+    _jacobianOplus[1](1,2) = 0; // vy angle2
+    _jacobianOplus[2](1,0) = -vy * dev_vy; // vy deltaT
+
+    // omega
+    _jacobianOplus[0](2,0) = 0; // omega x1
+    _jacobianOplus[0](2,1) = 0; // omega y1
+    _jacobianOplus[0](2,2) = -dev_omega; // omega angle1
+    _jacobianOplus[1](2,0) = 0; // omega x2
+    _jacobianOplus[1](2,1) = 0; // omega y2
+    _jacobianOplus[1](2,2) = dev_omega; // omega angle2
+    _jacobianOplus[2](2,0) = -omega * dev_omega; // omega deltaT
   }
+#endif
  
   
 public:
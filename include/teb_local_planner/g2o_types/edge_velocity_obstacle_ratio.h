@@ -45,6 +45,8 @@
 #include <teb_local_planner/g2o_types/base_teb_edges.h>
 #include <teb_local_planner/g2o_types/vertex_timediff.h>
 #include <teb_local_planner/g2o_types/vertex_pose.h>
+#include <teb_local_planner/g2o_types/penalties.h>
+#include <teb_local_planner/g2o_types/edge_velocity.h>
 #include <teb_local_planner/robot_footprint_model.h>
 
 namespace teb_local_planner
@@ -102,17 +104,10 @@ public:
 
     const double omega = angle_diff / deltaT->estimate();
 
-    double dist_to_obstacle = robot_model_->calculateDistance(conf1->pose(), _measurement);
+    double dist_to_obstacle = calculateRobotObstacleDistance(*robot_model_, conf1->pose(), _measurement);
 
-    double ratio;
-    if (dist_to_obstacle < cfg_->obstacles.obstacle_proximity_lower_bound)
-      ratio = 0;
-    else if (dist_to_obstacle > cfg_->obstacles.obstacle_proximity_upper_bound)
-      ratio = 1;
-    else
-      ratio = (dist_to_obstacle - cfg_->obstacles.obstacle_proximity_lower_bound) /
-      (cfg_->obstacles.obstacle_proximity_upper_bound - cfg_->obstacles.obstacle_proximity_lower_bound);
-    ratio *= cfg_->obstacles.obstacle_proximity_ratio_max_vel;
+    double dratio_ddist;
+    const double ratio = velocityRatio(dist_to_obstacle, dratio_ddist);
 
     const double max_vel_fwd = ratio * cfg_->robot.max_vel_x;
     const double max_omega = ratio * cfg_->robot.max_vel_theta;
@@ -122,6 +117,77 @@ public:
     ROS_ASSERT_MSG(std::isfinite(_error[0]) || std::isfinite(_error[1]), "EdgeVelocityObstacleRatio::computeError() _error[0]=%f , _error[1]=%f\n",_error[0],_error[1]);
   }
 
+#ifdef USE_ANALYTIC_JACOBI
+  /**
+   * @brief Jacobi matrix of the cost function specified in computeError().
+   *
+   * The velocity part is analytic (see segmentVelocityWithDerivatives()). The distance to the obstacle depends
+   * on the footprint model and the obstacle type, hence only its gradient w.r.t. the first pose is obtained by central
+   * differences, and only if the velocity bound is active and the distance lies within the proximity bounds.
+   */
+  void linearizeOplus()
+  {
+    ROS_ASSERT_MSG(cfg_ && _measurement && robot_model_, "You must call setTebConfig(), setObstacle() and setRobotModel() on EdgeVelocityObstacleRatio()");
+    const VertexPose* conf1 = static_cast<const VertexPose*>(_vertices[0]);
+    const VertexPose* conf2 = static_cast<const VertexPose*>(_vertices[1]);
+    const VertexTimeDiff* deltaT = static_cast<const VertexTimeDiff*>(_vertices[2]);
+
+    Eigen::Vector2d dvel_dpos2;
+    double dvel_dtheta1, dvel_dtheta2, dvel_ddt;
+    const double vel = segmentVelocityWithDerivatives(conf1->pose(), conf2->pose(), deltaT->estimate(), cfg_->trajectory.exact_arc_length,
+                                                      dvel_dpos2, dvel_dtheta1, dvel_dtheta2, dvel_ddt);
+    const double inv_dt = 1.0 / deltaT->estimate();
+    const double omega = g2o::normalize_theta(conf2->theta() - conf1->theta()) * inv_dt;
+
+    double dratio_ddist;
+    const double ratio = velocityRatio(calculateRobotObstacleDistance(*robot_model_, conf1->pose(), _measurement), dratio_ddist);
+
+    const double dev_vel = penaltyBoundToIntervalDerivative(vel, ratio * cfg_->robot.max_vel_x, 0);
+    const double dev_omega = penaltyBoundToIntervalDerivative(omega, ratio * cfg_->robot.max_vel_theta, 0);
+
+    // an active penalty |v| - ratio*v_max decreases with an increasing distance to the obstacle
+    Eigen::Vector3d ddist_dconf1 = Eigen::Vector3d::Zero();
+    if (dratio_ddist != 0 && (dev_vel != 0 || dev_omega != 0))
+    {
+      const double h = 1e-6;
+      for (int i = 0; i < 3; ++i)
+      {
+        PoseSE2 pose_plus = conf1->pose();
+        PoseSE2 pose_minus = conf1->pose();
+        if (i < 2)
+        {
+          pose_plus.position()[i] += h;
+          pose_minus.position()[i] -= h;
+        }
+        else
+        {
+          pose_plus.theta() = g2o::normalize_theta(pose_plus.theta() + h);
+          pose_minus.theta() = g2o::normalize_theta(pose_minus.theta() - h);
+        }
+        ddist_dconf1[i] = (calculateRobotObstacleDistance(*robot_model_, pose_plus, _measurement) - calculateRobotObstacleDistance(*robot_model_, pose_minus, _measurement)) / (2*h);
+      }
+    }
+    const double dbound_vel = dev_vel != 0 ? -dratio_ddist * cfg_->robot.max_vel_x : 0;
+    const double dbound_omega = dev_omega != 0 ? -dratio_ddist * cfg_->robot.max_vel_theta : 0;
+
+    _jacobianOplus[0](0,0) = -dev_vel * dvel_dpos2.x() + dbound_vel * ddist_dconf1.x(); // vel x1
+    _jacobianOplus[0](0,1) = -dev_vel * dvel_dpos2.y() + dbound_vel * ddist_dconf1.y(); // vel y1
+    _jacobianOplus[0](0,2) = dev_vel * dvel_dtheta1 + dbound_vel * ddist_dconf1.z(); // vel angle1
+    _jacobianOplus[1](0,0) = dev_vel * dvel_dpos2.x(); // vel x2
+    _jacobianOplus[1](0,1) = dev_vel * dvel_dpos2.y(); // vel y2
+    _jacobianOplus[1](0,2) = dev_vel * dvel_dtheta2; // vel angle2
+    _jacobianOplus[2](0,0) = dev_vel * dvel_ddt; // vel deltaT
+
+    _jacobianOplus[0](1,0) = dbound_omega * ddist_dconf1.x(); // omega x1
+    _jacobianOplus[0](1,1) = dbound_omega * ddist_dconf1.y(); // omega y1
+    _jacobianOplus[0](1,2) = -dev_omega * inv_dt + dbound_omega * ddist_dconf1.z(); // omega angle1
+    _jacobianOplus[1](1,0) = 0; // omega x2
+    _jacobianOplus[1](1,1) = 0; // omega y2
+    _jacobianOplus[1](1,2) = dev_omega * inv_dt; // omega angle2
+    _jacobianOplus[2](1,0) = -dev_omega * omega * inv_dt; // omega deltaT
+  }
+#endif
+
   /**
    * @brief Set pointer to associated obstacle for the underlying cost function
    * @param obstacle 2D position vector containing the position of the obstacle
@@ -155,6 +221,29 @@ public:
 
 protected:
 
+  /**
+   * @brief Ratio of the maximum velocities that is allowed at a given distance to the obstacle
+   * @param dist_to_obstacle distance between the robot footprint and the obstacle
+   * @param[out] dratio_ddist derivative of the ratio w.r.t. the distance (zero outside the proximity bounds)
+   * @return velocity ratio
+   */
+  double velocityRatio(double dist_to_obstacle, double& dratio_ddist) const
+  {
+    dratio_ddist = 0;
+    double ratio;
+    if (dist_to_obstacle < cfg_->obstacles.obstacle_proximity_lower_bound)
+      ratio = 0;
+    else if (dist_to_obstacle > cfg_->obstacles.obstacle_proximity_upper_bound)
+      ratio = 1;
+    else
+    {
+      dratio_ddist = 1.0 / (cfg_->obstacles.obstacle_proximity_upper_bound - cfg_->obstacles.obstacle_proximity_lower_bound);
+      ratio = (dist_to_obstacle - cfg_->obstacles.obstacle_proximity_lower_bound) * dratio_ddist;
+    }
+    dratio_ddist *= cfg_->obstacles.obstacle_proximity_ratio_max_vel;
+    return ratio * cfg_->obstacles.obstacle_proximity_ratio_max_vel;
+  }
+
   const BaseRobotFootprintModel* robot_model_; //!< Store pointer to robot_model
 
 public:
@@ -45,8 +45,7 @@
 
 #include <teb_local_planner/g2o_types/vertex_pose.h>
 #include <teb_local_planner/g2o_types/base_teb_edges.h>
-
-#include "g2o/core/base_unary_edge.h"
+#include <teb_local_planner/g2o_types/base_teb_autodiff_edge.h>
 
 
 namespace teb_local_planner
@@ -63,7 +62,7 @@ namespace teb_local_planner
  * @see TebOptimalPlanner::AddEdgesViaPoints
  * @remarks Do not forget to call setTebConfig() and setViaPoint()
  */     
-class EdgeViaPoint : public BaseTebUnaryEdge<1, const Eigen::Vector2d*, VertexPose>
+class EdgeViaPoint : public BaseTebAutoDiffEdge<EdgeViaPoint, 1, const Eigen::Vector2d*, 3>
 {
 public:
     
@@ -76,16 +75,17 @@ public:
   }
  
   /**
-   * @brief Actual cost function
+   * @brief Actual cost function (called by computeError() and linearizeOplusAutoDiff())
+   * @param x estimate of the pose (x, y, theta)
+   * @param[out] error distance to the via-point
    */    
-  void computeError()
+  template <typename T>
+  void evaluate(const T* const* x, T* error) const
   {
     ROS_ASSERT_MSG(cfg_ && _measurement, "You must call setTebConfig(), setViaPoint() on EdgeViaPoint()");
-    const VertexPose* bandpt = static_cast<const VertexPose*>(_vertices[0]);
-
-    _error[0] = (bandpt->position() - *_measurement).norm();
+    const T* bandpt = x[0];
 
-    ROS_ASSERT_MSG(std::isfinite(_error[0]), "EdgeViaPoint::computeError() _error[0]=%f\n",_error[0]);
+    error[0] = norm2d(T(bandpt[0] - _measurement->x()), T(bandpt[1] - _measurement->y()));
   }
 
   /**
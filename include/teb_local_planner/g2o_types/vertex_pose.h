@@ -197,6 +197,27 @@ public:
     _estimate.plus(update);
   }
 
+  /**
+    * @brief Copy the estimate (x, y, theta) into a plain array, e.g. for automatic differentiation.
+    * @param estimate array with at least 3 elements
+    * @return always \c true
+    */
+  virtual bool getEstimateData(double* estimate) const override
+  {
+    estimate[0] = _estimate.x();
+    estimate[1] = _estimate.y();
+    estimate[2] = _estimate.theta();
+    return true;
+  }
+
+  /**
+    * @brief Dimension of the array filled by getEstimateData()
+    */
+  virtual int estimateDimension() const override
+  {
+    return 3;
+  }
+
   /**
     * @brief Read an estimate from an input stream.
     * First the x-coordinate followed by y and the yaw angle.
@@ -115,6 +115,25 @@ public:
       _estimate += *update;
   }
 
+  /**
+    * @brief Copy the estimate \f$ \Delta T \f$ into a plain array, e.g. for automatic differentiation.
+    * @param estimate array with at least 1 element
+    * @return always \c true
+    */
+  virtual bool getEstimateData(double* estimate) const override
+  {
+    *estimate = _estimate;
+    return true;
+  }
+
+  /**
+    * @brief Dimension of the array filled by getEstimateData()
+    */
+  virtual int estimateDimension() const override
+  {
+    return 1;
+  }
+
   /**
     * @brief Read an estimate of \f$ \Delta T \f$ from an input stream
     * @param is input stream
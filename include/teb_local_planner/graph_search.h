@@ -39,29 +39,24 @@
 #ifndef GRAPH_SEARCH_INTERFACE_H
 #define GRAPH_SEARCH_INTERFACE_H
 
-#ifdef BOOST_NO_CXX11_DEFAULTED_FUNCTIONS
-  #include <boost/graph/adjacency_list.hpp>
-#else
-  // Workaround for a bug in boost graph library (concerning directed graphs), boost version 1.48:
-  // boost::add_vertex requires a move constructor/assignment operator in one of the underlying boost objects if C++11 is activated,
-  // but they are missing. The compiler fails due to an implicit deletion. We just deactivate C++11 default functions for now.
-  #define BOOST_NO_CXX11_DEFAULTED_FUNCTIONS
-  #include <boost/graph/adjacency_list.hpp>
-  #undef BOOST_NO_CXX11_DEFAULTED_FUNCTIONS
-#endif
-
 #include <boost/graph/graph_traits.hpp>
-#include <boost/graph/depth_first_search.hpp>
+#include <boost/iterator/counting_iterator.hpp>
 #include <boost/utility.hpp>
 #include <boost/random.hpp>
 
 #include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include <algorithm>
+#include <vector>
 
 #include <geometry_msgs/Twist.h>
 
 #include <teb_local_planner/equivalence_relations.h>
+#include <teb_local_planner/h_signature.h>
 #include <teb_local_planner/pose_se2.h>
 #include <teb_local_planner/teb_config.h>
+#include <teb_local_planner/obstacle_spatial_index.h>
 
 namespace teb_local_planner
 {
@@ -76,8 +71,140 @@ public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 };
 
-//! Abbrev. for the homotopy class search-graph type @see HcGraphVertex
-typedef boost::adjacency_list < boost::listS, boost::vecS, boost::directedS, HcGraphVertex, boost::no_property > HcGraph;
+/**
+ * @class HcGraph
+ * @brief Directed graph that is used to find homotopy classes, stored in a compressed sparse row (CSR) layout
+ *
+ * The vertices and the targets of all edges are stored in flat vectors (no allocation per vertex or edge).
+ * Edges must be added in ascending order of their source vertex (as done by the graph construction of the
+ * GraphSearchInterface subclasses), vertices may be added at any time. \n
+ * clear() keeps the reserved capacity, hence rebuilding the graph every planning cycle does not allocate in steady state. \n
+ * The free functions below (add_vertex(), add_edge(), vertices(), adjacent_vertices(), ...) provide the
+ * boost graph library interface that is used by the graph search.
+ * @see HcGraphVertex
+ */
+class HcGraph
+{
+public:
+  // boost graph traits
+  typedef std::size_t vertex_descriptor;
+  typedef std::size_t edge_descriptor; // edge index
+  typedef boost::counting_iterator<std::size_t> vertex_iterator;
+  typedef const std::size_t* adjacency_iterator;
+  typedef void out_edge_iterator;
+  typedef void in_edge_iterator;
+  typedef boost::counting_iterator<std::size_t> edge_iterator;
+  typedef boost::directed_tag directed_category;
+  typedef boost::allow_parallel_edge_tag edge_parallel_category;
+  struct traversal_category : public boost::vertex_list_graph_tag, public boost::edge_list_graph_tag, public boost::adjacency_graph_tag {};
+  typedef std::size_t vertices_size_type;
+  typedef std::size_t edges_size_type;
+  typedef std::size_t degree_size_type;
+
+  /**
+   * @brief Remove all vertices and edges (the capacity is kept)
+   */
+  void clear() {vertices_.clear(); row_begin_.clear(); targets_.clear();}
+
+  /**
+   * @brief Reserve memory for the specified number of vertices and edges
+   * @param num_vertices expected number of vertices
+   * @param num_edges expected number of edges
+   */
+  void reserve(std::size_t num_vertices, std::size_t num_edges) {vertices_.reserve(num_vertices); row_begin_.reserve(num_vertices); targets_.reserve(num_edges);}
+
+  /**
+   * @brief Append a new vertex
+   * @return descriptor of the new vertex
+   */
+  vertex_descriptor addVertex() {vertices_.push_back(HcGraphVertex()); return vertices_.size() - 1;}
+
+  /**
+   * @brief Append a new edge
+   * @param source source vertex, must not be smaller than the source of the previously added edge
+   * @param target target vertex
+   */
+  void addEdge(vertex_descriptor source, vertex_descriptor target)
+  {
+    ROS_ASSERT_MSG(row_begin_.empty() || source + 1 >= row_begin_.size(), "HcGraph: edges must be added in ascending order of their source vertex");
+    while (row_begin_.size() <= source)
+      row_begin_.push_back(targets_.size());
+    targets_.push_back(target);
+  }
+
+  std::size_t numVertices() const {return vertices_.size();} //!< Return the number of vertices
+  std::size_t numEdges() const {return targets_.size();} //!< Return the number of edges
+
+  /**
+   * @brief Index of the first out-edge of a vertex (the out-edges of a vertex are stored contiguously)
+   * @param vertex vertex descriptor
+   * @return edge index in [0, numEdges()]
+   */
+  std::size_t firstOutEdge(vertex_descriptor vertex) const {return vertex < row_begin_.size() ? row_begin_[vertex] : targets_.size();}
+
+  /**
+   * @brief Index past the last out-edge of a vertex
+   * @param vertex vertex descriptor
+   * @return edge index in [0, numEdges()]
+   */
+  std::size_t endOutEdge(vertex_descriptor vertex) const {return vertex + 1 < row_begin_.size() ? row_begin_[vertex + 1] : targets_.size();}
+
+  /**
+   * @brief Return the range of vertices adjacent to a vertex (targets of its out-edges)
+   * @param vertex vertex descriptor
+   * @return begin and end iterator
+   */
+  std::pair<adjacency_iterator, adjacency_iterator> adjacentVertices(vertex_descriptor vertex) const
+  {
+    const std::size_t* targets = targets_.data();
+    return std::make_pair(targets + firstOutEdge(vertex), targets + endOutEdge(vertex));
+  }
+
+  /**
+   * @brief Return the source vertex of an edge
+   * @param edge edge index
+   * @return source vertex descriptor
+   */
+  vertex_descriptor source(edge_descriptor edge) const {return std::upper_bound(row_begin_.begin(), row_begin_.end(), edge) - row_begin_.begin() - 1;}
+
+  vertex_descriptor target(edge_descriptor edge) const {return targets_[edge];} //!< Return the target vertex of an edge
+
+  HcGraphVertex& operator[](vertex_descriptor vertex) {return vertices_[vertex];} //!< Access vertex properties
+  const HcGraphVertex& operator[](vertex_descriptor vertex) const {return vertices_[vertex];} //!< Access vertex properties (read-only)
+
+private:
+  std::vector<HcGraphVertex, Eigen::aligned_allocator<HcGraphVertex> > vertices_; //!< Vertex properties
+  std::vector<std::size_t> row_begin_; //!< Index of the first out-edge of each vertex (up to the last vertex with out-edges)
+  std::vector<std::size_t> targets_; //!< Target vertices of all edges, grouped by source vertex
+};
+
+//! Add a vertex to the homotopy class search-graph (boost graph interface)
+inline HcGraph::vertex_descriptor add_vertex(HcGraph& g) {return g.addVertex();}
+//! Add an edge to the homotopy class search-graph (boost graph interface), see HcGraph::addEdge()
+inline std::pair<HcGraph::edge_descriptor, bool> add_edge(HcGraph::vertex_descriptor u, HcGraph::vertex_descriptor v, HcGraph& g) {g.addEdge(u, v); return std::make_pair(g.numEdges() - 1, true);}
+//! Range of all vertices of the homotopy class search-graph (boost graph interface)
+inline std::pair<HcGraph::vertex_iterator, HcGraph::vertex_iterator> vertices(const HcGraph& g) {return std::make_pair(HcGraph::vertex_iterator(0), HcGraph::vertex_iterator(g.numVertices()));}
+//! Range of all edges of the homotopy class search-graph (boost graph interface)
+inline std::pair<HcGraph::edge_iterator, HcGraph::edge_iterator> edges(const HcGraph& g) {return std::make_pair(HcGraph::edge_iterator(0), HcGraph::edge_iterator(g.numEdges()));}
+//! Source vertex of an edge (boost graph interface)
+inline HcGraph::vertex_descriptor source(HcGraph::edge_descriptor e, const HcGraph& g) {return g.source(e);}
+//! Target vertex of an edge (boost graph interface)
+inline HcGraph::vertex_descriptor target(HcGraph::edge_descriptor e, const HcGraph& g) {return g.target(e);}
+//! Range of vertices adjacent to vertex \c u (boost graph interface)
+inline std::pair<HcGraph::adjacency_iterator, HcGraph::adjacency_iterator> adjacent_vertices(HcGraph::vertex_descriptor u, const HcGraph& g) {return g.adjacentVertices(u);}
+//! Number of vertices of the homotopy class search-graph (boost graph interface)
+inline std::size_t num_vertices(const HcGraph& g) {return g.numVertices();}
+//! Number of edges of the homotopy class search-graph (boost graph interface)
+inline std::size_t num_edges(const HcGraph& g) {return g.numEdges();}
+//! Query the edge between \c u and \c v (boost graph interface)
+inline std::pair<HcGraph::edge_descriptor, bool> edge(HcGraph::vertex_descriptor u, HcGraph::vertex_descriptor v, const HcGraph& g)
+{
+  HcGraph::adjacency_iterator it, end;
+  boost::tie(it, end) = g.adjacentVertices(u);
+  HcGraph::adjacency_iterator found = std::find(it, end, v);
+  return std::make_pair(g.firstOutEdge(u) + (found - it), found != end);
+}
+
 //! Abbrev. for vertex type descriptors in the homotopy class search-graph
 typedef boost::graph_traits<HcGraph>::vertex_descriptor HcGraphVertexType;
 //! Abbrev. for edge type descriptors in the homotopy class search-graph
@@ -116,7 +243,6 @@ public:
   void clearGraph() {graph_.clear();}
 
   // HcGraph graph() const {return graph_;}
-  // Workaround. graph_ is public for now, beacuse otherwise the compilation fails with the same boost bug mentioned above.
   HcGraph graph_; //!< Store the graph that is utilized to find alternative homotopy classes.
 
 protected:
@@ -140,11 +266,71 @@ protected:
    */
   void DepthFirst(HcGraph& g, std::vector<HcGraphVertexType>& visited, const HcGraphVertexType& goal, double start_orientation, double goal_orientation, const geometry_msgs::Twist* start_velocity, bool free_goal_vel = false);
 
+  /**
+   * @brief Best-first search for the shortest paths between the start and the goal vertex in distinct homotopy classes.
+   *
+   * In contrast to DepthFirst(), the search does not enumerate all paths. It explores the H-augmented graph:
+   * a search state is a vertex together with the (2D) H-signature of the path leading to it, and states at the same vertex with
+   * similar signatures are merged (the shorter path is expanded first, A* with the euclidean distance to the goal).
+   * Each complete path is checked against the known equivalence classes before a TEB is initialized and the search
+   * terminates as soon as the maximum number of classes is reached.
+   * If dynamic obstacles are included, the 3D H-signature of a complete path is computed with an approximated timing.
+   * @param g Graph on which the search should be performed
+   * @param start Start vertex
+   * @param goal Desired goal vertex
+   * @param start_orientation Orientation of the first trajectory pose, required to initialize the trajectory/TEB
+   * @param goal_orientation Orientation of the goal trajectory pose, required to initialize the trajectory/TEB
+   * @param start_velocity start velocity (optional)
+   * @param free_goal_vel if \c true, a nonzero final velocity at the goal pose is allowed, otherwise the final velocity will be zero (default: false)
+   */
+  void BestFirst(HcGraph& g, const HcGraphVertexType& start, const HcGraphVertexType& goal, double start_orientation, double goal_orientation, const geometry_msgs::Twist* start_velocity, bool free_goal_vel = false);
+
+  /**
+   * @brief Get a spatial index of the current obstacles of the planner
+   *
+   * The index of the HomotopyClassPlanner is reused if it is up to date, otherwise a local index is built.
+   * Call it once before checking the edges of a new graph.
+   * @return obstacle index that covers hcp_->obstacles() (must not be NULL)
+   */
+  const ObstacleSpatialIndex& obstacleIndex();
+
+  /**
+   * @brief Check if an edge of the graph collides with any obstacle of the planner
+   * @param index obstacle index obtained from obstacleIndex()
+   * @param start first vertex position of the edge
+   * @param end second vertex position of the edge
+   * @param min_dist minimum distance to the obstacles (see Obstacle::checkLineIntersection())
+   * @return \c true if the edge collides, \c false otherwise
+   */
+  bool checkEdgeCollision(const ObstacleSpatialIndex& index, const Eigen::Vector2d& start, const Eigen::Vector2d& end, double min_dist) const;
+
 
 protected:
     const TebConfig* cfg_; //!< Config class that stores and manages all related parameters
     HomotopyClassPlanner* const hcp_; //!< Raw pointer to the HomotopyClassPlanner. The HomotopyClassPlanner itself is guaranteed to outlive the graph search class it is holding.
 
+    ObstacleSpatialIndex local_obstacle_index_; //!< Fallback index if the index of the planner is not up to date
+
+    //! State of the best-first search: vertex and (2D) h-signature of the path leading to it
+    struct SearchState
+    {
+      HcGraphVertexType vertex;
+      int parent; //!< index of the predecessor state (-1 for the start)
+      double length; //!< path length
+      std::complex<long double> h; //!< partial h-signature
+    };
+    typedef std::pair<double, int> QueueEntry; //!< (estimated total length, state index)
+
+    // Buffers of BestFirst(), kept to reuse their capacity in the next planning cycle
+    HSignatureSegmentTerms search_h_terms_; //!< Obstacle coefficients of the h-signature
+    std::vector<SearchState> search_states_; //!< All states created by the search
+    std::vector<QueueEntry> search_queue_; //!< Open list (binary heap)
+    std::vector< std::complex<long double> > search_expanded_h_; //!< h-signatures of the expanded states (max_number_classes per vertex)
+    std::vector<int> search_expanded_count_; //!< Number of expanded states per vertex
+    std::vector< std::complex<long double> > search_edge_h_; //!< h-signature contribution of each edge
+    std::vector<char> search_edge_h_valid_; //!< Flag per vertex if search_edge_h_ is computed for its out-edges
+    std::vector<HcGraphVertexType> search_path_; //!< Reconstructed path
+
 public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 };
@@ -183,7 +369,8 @@ public:
 class ProbRoadmapGraph : public GraphSearchInterface
 {
 public:
-  ProbRoadmapGraph(const TebConfig& cfg, HomotopyClassPlanner* hcp) : GraphSearchInterface(cfg, hcp){}
+  ProbRoadmapGraph(const TebConfig& cfg, HomotopyClassPlanner* hcp) : GraphSearchInterface(cfg, hcp), sample_edges_dist_(-1), halton_index_(0),
+    occupancy_rows_(0), occupancy_cols_(0), occupancy_cell_size_(1), occupancy_unbounded_(true) {}
 
   virtual ~ProbRoadmapGraph(){}
 
@@ -192,8 +379,13 @@ public:
    * @brief Create a graph and sample points in the global frame that can be used to explore new possible paths between start and goal.
    *
    * This version of the graph samples keypoints in a predefined area (config) in the current frame between start and goal. \n
+   * The samples follow a Halton sequence over the free space of the area, a fraction of them is placed close to
+   * obstacle boundaries instead (see TebConfig::HomotopyClasses::roadmap_graph_boundary_bias). \n
    * Afterwards all feasible paths between start and goal point are extracted using a Depth First Search. \n
    * Use the sampling method for complex, non-point or huge obstacles. \n
+   * If TebConfig::HomotopyClasses::roadmap_graph_persistent is set, the samples and the collision checks of the edges between them
+   * are kept across planning cycles: only samples that left the sampling area or became occupied are replaced and
+   * only edges close to added, removed or moved obstacles are checked again. \n
    * You may call createGraph() instead.
    *
    * @see createGraph
@@ -207,8 +399,132 @@ public:
    */
   virtual void createGraph(const PoseSE2& start, const PoseSE2& goal, double dist_to_obst, double obstacle_heading_threshold, const geometry_msgs::Twist* start_velocity, bool free_goal_vel = false);
 
+  /**
+   * @brief Access the current roadmap samples (global frame, without start and goal)
+   * @return const reference to the sample container
+   */
+  const std::vector<Eigen::Vector2d, Eigen::aligned_allocator<Eigen::Vector2d> >& samples() const {return samples_;}
+
+  /**
+   * @brief Check whether the collision check of the edge between two samples is cached
+   * @param i index of the first sample
+   * @param j index of the second sample
+   * @return \c true if the edge does not need to be checked again, \c false otherwise
+   */
+  bool isEdgeCached(int i, int j) const {return sample_edges_[i * samples_.size() + j] >= 0;}
+
+protected:
+
+  /**
+   * @brief Obstacle state that is compared between planning cycles to detect changed obstacles
+   */
+  struct ObstacleSnapshot
+  {
+    double x; //!< Centroid x
+    double y; //!< Centroid y
+    double radius; //!< Bounding radius
+    std::size_t shape; //!< Hash of the line end points or polygon vertices (rotated or reshaped obstacles keep centroid and radius)
+
+    bool operator<(const ObstacleSnapshot& other) const
+    {
+      return x < other.x || (x == other.x && (y < other.y || (y == other.y && (radius < other.radius || (radius == other.radius && shape < other.shape)))));
+    }
+  };
+
+  /**
+   * @brief Compute the snapshot of an obstacle of a built-in type
+   * @param obstacle obstacle with a finite bounding radius
+   * @return snapshot of the obstacle
+   */
+  static ObstacleSnapshot snapshotObstacle(const Obstacle& obstacle);
+
+  /**
+   * @brief Update the persistent samples for the current sampling area
+   *
+   * Removes samples outside of the area or close to obstacles, invalidates the cached edge checks
+   * close to obstacles that changed since the previous call and adds new samples until
+   * TebConfig::HomotopyClasses::roadmap_graph_no_samples is reached. \n
+   * Obstacles are compared by their bounding circle and the hash of their shape (see ObstacleSnapshot).
+   * The shape of custom obstacle types is unknown, hence the edge checks close to their previous and current bounding circles are always invalidated.
+   * Obstacles without a bounding circle invalidate all edge checks.
+   * @param obst_index Spatial index of the current obstacles
+   * @param area_origin Bottom left corner of the sampling area
+   * @param area_rotation Orientation of the sampling area
+   * @param area_length Length of the sampling area (along the start-goal direction)
+   * @param area_width Width of the sampling area
+   * @param dist_to_obst Allowed distance to obstacles
+   */
+  void updateSamples(const ObstacleSpatialIndex& obst_index, const Eigen::Vector2d& area_origin, const Eigen::Rotation2D<double>& area_rotation,
+                     double area_length, double area_width, double dist_to_obst);
+
+  /**
+   * @brief Check if a point is closer than \c dist_to_obst to any obstacle
+   * @param obst_index Spatial index of the current obstacles
+   * @param point Point to check
+   * @param dist_to_obst Allowed distance to obstacles
+   * @param[out] candidates Buffer for the index query (avoids reallocations)
+   * @return \c true if the point is occupied, \c false otherwise
+   */
+  bool isOccupied(const ObstacleSpatialIndex& obst_index, const Eigen::Vector2d& point, double dist_to_obst, std::vector<int>& candidates) const;
+
+  /**
+   * @brief Build the coarse occupancy map of the sampling area (see isSampleOccupied())
+   *
+   * A cell is marked if it intersects the bounding circle of an obstacle inflated by \c dist_to_obst.
+   * @param area_origin Bottom left corner of the sampling area
+   * @param area_rotation Orientation of the sampling area
+   * @param area_length Length of the sampling area (along the start-goal direction)
+   * @param area_width Width of the sampling area
+   * @param dist_to_obst Allowed distance to obstacles
+   */
+  void buildOccupancyMap(const Eigen::Vector2d& area_origin, const Eigen::Rotation2D<double>& area_rotation,
+                         double area_length, double area_width, double dist_to_obst);
+
+  /**
+   * @brief Check if a point of the sampling area is occupied
+   *
+   * Points in cells of the occupancy map that are not marked are free, all others are checked with isOccupied().
+   * @param obst_index Spatial index of the current obstacles
+   * @param point Point to check (global frame)
+   * @param local The same point in the frame of the sampling area
+   * @param dist_to_obst Allowed distance to obstacles
+   * @param[out] candidates Buffer for the index query (avoids reallocations)
+   * @return \c true if the point is occupied, \c false otherwise
+   */
+  bool isSampleOccupied(const ObstacleSpatialIndex& obst_index, const Eigen::Vector2d& point, const Eigen::Vector2d& local,
+                        double dist_to_obst, std::vector<int>& candidates) const;
+
+  /**
+   * @brief Element of the radical inverse (Halton) sequence
+   * @param index index of the element (starting at 1)
+   * @param base prime base of the sequence
+   * @return value in the interval [0,1)
+   */
+  static double halton(unsigned int index, unsigned int base);
+
 private:
     boost::random::mt19937 rnd_generator_; //!< Random number generator used by createProbRoadmapGraph to sample graph keypoints.
+
+    std::vector<Eigen::Vector2d, Eigen::aligned_allocator<Eigen::Vector2d> > samples_; //!< Roadmap samples (global frame), vertex i+1 of the graph
+    std::vector<signed char> sample_edges_; //!< Cached collision checks between the samples (row-major samples_.size() x samples_.size(); -1: unknown, 0: free, 1: collision)
+    std::vector<ObstacleSnapshot> obstacle_snapshot_; //!< Sorted snapshots of the (built-in) obstacles of the previous cycle
+    std::vector<ObstacleSnapshot> custom_snapshot_; //!< Snapshots of the custom obstacles of the previous cycle
+    double sample_edges_dist_; //!< Obstacle distance the cached edge checks refer to
+    unsigned int halton_index_; //!< Index of the last Halton point (continued across planning cycles)
+
+    std::vector<unsigned char> occupancy_map_; //!< Coarse occupancy map of the sampling area (row-major, 1: possibly occupied)
+    int occupancy_rows_; //!< Number of cells along the width of the area
+    int occupancy_cols_; //!< Number of cells along the length of the area
+    double occupancy_cell_size_; //!< Edge length of the (square) cells
+    bool occupancy_unbounded_; //!< Some obstacles do not provide a bounding radius, hence all points are checked with isOccupied()
+
+    // Buffers of updateSamples(), kept to reuse their capacity in the next planning cycle
+    std::vector<ObstacleSnapshot> snapshot_buffer_; //!< Obstacle snapshot of the current cycle
+    std::vector<ObstacleSnapshot> custom_buffer_; //!< Custom obstacle snapshot of the current cycle
+    std::vector<ObstacleSnapshot> changed_obstacles_; //!< Obstacles added, removed, moved or reshaped since the previous cycle (and custom obstacles)
+    std::vector<int> kept_samples_; //!< Indices of the samples that are kept
+    std::vector<signed char> sample_edges_buffer_; //!< Compacted edge checks of the kept samples
+    std::vector<int> index_candidates_; //!< Result buffer of the obstacle index queries
 };
 } // end namespace
 
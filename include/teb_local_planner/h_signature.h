@@ -46,6 +46,7 @@
 #include <teb_local_planner/timed_elastic_band.h>
 
 #include <ros/ros.h>
+#include <boost/functional/hash.hpp>
 #include <math.h>
 #include <algorithm>
 #include <functional>
@@ -56,6 +57,320 @@
 namespace teb_local_planner
 {
 
+/**
+ * @brief Contributions of the line segments of a path to its (2D) H-signature
+ *
+ * The H-signature of a path is the sum of the contributions of its line segments.
+ * The obstacle dependent coefficients only depend on the obstacles and on the start and end of the path,
+ * hence they are computed once and shared by all segments (and all paths between the same start and end).
+ * @sa HSignature
+ */
+class HSignatureSegmentTerms
+{
+public:
+
+    typedef std::complex<long double> cplx;
+
+   /**
+    * @brief Compute the obstacle coefficients
+    * @param cfg TebConfig storing the prescaler of the H-signature
+    * @param path_start start of the paths
+    * @param path_end end of the paths
+    * @param obstacles obstacle container
+    */
+    void initialize(const TebConfig& cfg, const cplx& path_start, const cplx& path_end, const ObstContainer& obstacles)
+    {
+        obstacles_.clear();
+        obstacles_.reserve(obstacles.size());
+        for (const ObstaclePtr& obst : obstacles)
+            obstacles_.push_back(obst->getCentroidCplx());
+        computeCoefficients(cfg, path_start, path_end);
+    }
+
+   /**
+    * @brief Compute the obstacle coefficients for given obstacle centroids
+    * @param cfg TebConfig storing the prescaler of the H-signature
+    * @param path_start start of the paths
+    * @param path_end end of the paths
+    * @param obstacle_centroids centroids of the obstacles
+    */
+    void initialize(const TebConfig& cfg, const cplx& path_start, const cplx& path_end, const std::vector<cplx>& obstacle_centroids)
+    {
+        obstacles_ = obstacle_centroids;
+        computeCoefficients(cfg, path_start, path_end);
+    }
+
+   /**
+    * @brief Contribution of the line segment from \c z1 to \c z2
+    */
+    cplx segment(const cplx& z1, const cplx& z2) const
+    {
+        cplx value = 0;
+        for (std::size_t l=0; l<obstacles_.size(); ++l)
+            value += coeffs_[l]*logTerm(l, z1, z2);
+        return value;
+    }
+
+   /**
+    * @brief Logarithmic term of obstacle \c l for the line segment from \c z1 to \c z2 (independent of the coefficients)
+    *
+    * The contribution of a segment is the sum of coefficient(l) * logTerm(l, z1, z2) over all obstacles.
+    */
+    cplx logTerm(std::size_t l, const cplx& z1, const cplx& z2) const
+    {
+        const cplx& obst_l = obstacles_[l];
+        // compute log value
+        double diff2 = std::abs(z2-obst_l);
+        double diff1 = std::abs(z1-obst_l);
+        if (diff2 == 0 || diff1 == 0)
+            return 0;
+        double log_real = std::log(diff2)-std::log(diff1);
+        // complex ln has more than one solution -> choose minimum abs angle -> paper
+        double arg_diff = std::arg(z2-obst_l)-std::arg(z1-obst_l);
+        double imag_proposals[5];
+        imag_proposals[0] = arg_diff;
+        imag_proposals[1] = arg_diff+2*M_PI;
+        imag_proposals[2] = arg_diff-2*M_PI;
+        imag_proposals[3] = arg_diff+4*M_PI;
+        imag_proposals[4] = arg_diff-4*M_PI;
+        double log_imag = *std::min_element(imag_proposals, imag_proposals+5, smaller_than_abs);
+        //cplx log_value = std::log(z2-obst_l)-std::log(z1-obst_l); // the principal solution doesn't seem to work
+        return cplx(log_real,log_imag);
+    }
+
+    std::size_t numObstacles() const {return obstacles_.size();} //!< Number of obstacles
+    const cplx& coefficient(std::size_t l) const {return coeffs_[l];} //!< Coefficient A_l of obstacle \c l
+
+private:
+
+    void computeCoefficients(const TebConfig& cfg, const cplx& path_start, const cplx& path_end)
+    {
+        coeffs_.clear();
+        if (obstacles_.empty())
+            return;
+
+        ROS_ASSERT_MSG(cfg.hcp.h_signature_prescaler>0.1 && cfg.hcp.h_signature_prescaler<=1, "Only a prescaler on the interval (0.1,1] ist allowed.");
+
+        // guess values for f0
+        // paper proposes a+b=N-1 && |a-b|<=1, 1...N obstacles
+        int m = std::max( (int)obstacles_.size()-1, 5 );  // for only a few obstacles we need a min threshold in order to get significantly high H-Signatures
+
+        int a = (int) std::ceil(double(m)/2.0);
+        int b = m-a;
+
+        // guess map size (only a really really coarse guess is required
+        // use distance from start to goal as distance to each direction
+        cplx delta = path_end-path_start;
+        cplx normal(-delta.imag(), delta.real());
+        cplx map_bottom_left;
+        cplx map_top_right;
+        if (std::abs(delta) < 3.0)
+        { // set minimum bound on distance (we do not want to have numerical instabilities) and 3.0 performs fine...
+            map_bottom_left = path_start + cplx(0, -3);
+            map_top_right = path_start + cplx(3, 3);
+        }
+        else
+        {
+            map_bottom_left = path_start - normal;
+            map_top_right = path_start + delta + normal;
+        }
+
+        coeffs_.reserve(obstacles_.size());
+        for (std::size_t l=0; l<obstacles_.size(); ++l) // iterate all obstacles
+        {
+            const cplx& obst_l = obstacles_[l];
+            //cplx f0 = (long double) prescaler * std::pow(obst_l-map_bottom_left,a) * std::pow(obst_l-map_top_right,b);
+            cplx f0 = (long double) cfg.hcp.h_signature_prescaler * (long double)a*(obst_l-map_bottom_left) * (long double)b*(obst_l-map_top_right);
+
+            // denum contains product with all obstacles exepct j==l
+            cplx Al = f0;
+            for (std::size_t j=0; j<obstacles_.size(); ++j)
+            {
+                if (j==l)
+                    continue;
+                cplx diff = obst_l - obstacles_[j];
+                //if (diff.real()!=0 || diff.imag()!=0)
+                if (std::abs(diff)<0.05) // skip really close obstacles
+                    continue;
+                 else
+                    Al /= diff;
+            }
+            coeffs_.push_back(Al);
+        }
+    }
+
+    std::vector<cplx> obstacles_; //!< Obstacle centroids
+    std::vector<cplx> coeffs_; //!< Coefficient A_l of each obstacle
+};
+
+
+/**
+ * @class IncrementalHSignature
+ * @brief Keeps the (2D) H-signature of a trajectory up to date between planning cycles
+ *
+ * The H-signature is the sum over all obstacles of A_l * S_l, where S_l is the sum of the logarithmic
+ * terms of all path segments w.r.t. obstacle l. Only the coefficients A_l depend on the start and the end of the path,
+ * hence the sums S_l are stored and updated incrementally:
+ * poses that moved by at most \c tolerance keep their stored position, so only the segments whose endpoints moved
+ * and the sums of obstacles that moved are recomputed. After \c full_update_interval incremental updates
+ * (or if the number of obstacles changes) everything is recomputed in order to avoid accumulating rounding errors.
+ *
+ * The resulting value corresponds to the H-signature of the stored path, which deviates at most by \c tolerance from the actual path.
+ * @sa HSignatureSegmentTerms
+ */
+class IncrementalHSignature
+{
+public:
+
+    typedef std::complex<long double> cplx;
+
+    IncrementalHSignature() : updates_since_full_(0), updated_segments_(0) {}
+
+   /**
+    * @brief Update the H-signature for the current path and obstacles
+    * @param cfg TebConfig storing the prescaler of the H-signature
+    * @param path_start Iterator to the first element in the path
+    * @param path_end Iterator to the last element in the path
+    * @param fun_cplx_point function accepting the dereference iterator type and that returns the position as complex number.
+    * @param obstacles obstacle container
+    * @param tolerance poses and obstacles that moved by at most this distance (per coordinate) are considered unchanged
+    * @param full_update_interval number of incremental updates until the H-signature is recomputed from scratch
+    * @tparam BidirIter Bidirectional iterator type
+    * @tparam Fun function of the form std::complex< long double > (const T& point_type)
+    * @return H-signature in complex-number format
+    */
+    template<typename BidirIter, typename Fun>
+    cplx update(const TebConfig& cfg, BidirIter path_start, BidirIter path_end, Fun fun_cplx_point, const ObstContainer& obstacles,
+                double tolerance, int full_update_interval)
+    {
+        new_path_.clear();
+        for (BidirIter it = path_start; it != path_end; ++it)
+            new_path_.push_back(fun_cplx_point(*it));
+
+        if (obstacles.empty() || new_path_.empty())
+        {
+            reset();
+            return 0;
+        }
+
+        bool full = path_.empty() || obstacles.size() != obstacles_.size() || updates_since_full_ >= full_update_interval || !(tolerance > 0);
+
+        // obstacles that moved are updated and their sums recomputed
+        obstacle_changed_.assign(obstacles.size(), full);
+        obstacles_.resize(obstacles.size());
+        for (std::size_t l=0; l<obstacles.size(); ++l)
+        {
+            cplx centroid = obstacles[l]->getCentroidCplx();
+            if (full || !isClose(centroid, obstacles_[l], tolerance))
+            {
+                obstacles_[l] = centroid;
+                obstacle_changed_[l] = true;
+            }
+        }
+
+        // match the new poses with the stored ones (both are ordered along the path)
+        matches_.assign(new_path_.size(), -1);
+        if (!full)
+        {
+            std::size_t first = 0;
+            for (std::size_t j=0; j<new_path_.size() && first<path_.size(); ++j)
+            {
+                for (std::size_t k=first; k<path_.size(); ++k)
+                {
+                    if (isClose(new_path_[j], path_[k], tolerance))
+                    {
+                        matches_[j] = (int)k;
+                        new_path_[j] = path_[k];
+                        first = k+1;
+                        break;
+                    }
+                }
+            }
+        }
+
+        terms_.initialize(cfg, new_path_.front(), new_path_.back(), obstacles_);
+        log_sums_.resize(obstacles_.size());
+
+        // segments of the stored path that are still part of the new one
+        kept_segments_.assign(path_.size(), false);
+        for (std::size_t j=0; j+1<new_path_.size(); ++j)
+        {
+            if (matches_[j] >= 0 && matches_[j+1] == matches_[j]+1)
+                kept_segments_[matches_[j]] = true;
+        }
+
+        updated_segments_ = 0;
+        for (std::size_t l=0; l<obstacles_.size(); ++l)
+        {
+            if (obstacle_changed_[l])
+            {
+                log_sums_[l] = 0;
+                for (std::size_t j=0; j+1<new_path_.size(); ++j)
+                    log_sums_[l] += terms_.logTerm(l, new_path_[j], new_path_[j+1]);
+                continue;
+            }
+            for (std::size_t k=0; k+1<path_.size(); ++k) // remove segments that do not exist anymore
+            {
+                if (!kept_segments_[k])
+                    log_sums_[l] -= terms_.logTerm(l, path_[k], path_[k+1]);
+            }
+            for (std::size_t j=0; j+1<new_path_.size(); ++j) // add new segments
+            {
+                if (matches_[j] < 0 || matches_[j+1] != matches_[j]+1)
+                    log_sums_[l] += terms_.logTerm(l, new_path_[j], new_path_[j+1]);
+            }
+        }
+        for (std::size_t j=0; j+1<new_path_.size(); ++j)
+        {
+            if (full || matches_[j] < 0 || matches_[j+1] != matches_[j]+1)
+                ++updated_segments_;
+        }
+
+        path_.swap(new_path_);
+        updates_since_full_ = full ? 0 : updates_since_full_+1;
+
+        cplx value = 0;
+        for (std::size_t l=0; l<obstacles_.size(); ++l)
+            value += terms_.coefficient(l) * log_sums_[l];
+        return value;
+    }
+
+   /**
+    * @brief Discard the stored state, the next update recomputes the H-signature from scratch
+    */
+    void reset()
+    {
+        path_.clear();
+        obstacles_.clear();
+        log_sums_.clear();
+        updates_since_full_ = 0;
+        updated_segments_ = 0;
+    }
+
+    int numUpdatedSegments() const {return updated_segments_;} //!< Number of segments that were (re-)evaluated by the last update
+
+private:
+
+    static bool isClose(const cplx& a, const cplx& b, double tolerance)
+    {
+        return std::abs(a.real()-b.real()) <= tolerance && std::abs(a.imag()-b.imag()) <= tolerance;
+    }
+
+    std::vector<cplx> path_; //!< Stored path (new poses within the tolerance keep the stored position)
+    std::vector<cplx> obstacles_; //!< Stored obstacle centroids
+    std::vector<cplx> log_sums_; //!< Sum of the logarithmic terms of all segments for each obstacle
+    HSignatureSegmentTerms terms_;
+    int updates_since_full_; //!< Number of incremental updates since the last full recomputation
+    int updated_segments_;
+
+    // buffers reused between updates
+    std::vector<cplx> new_path_;
+    std::vector<int> matches_;
+    std::vector<bool> kept_segments_;
+    std::vector<bool> obstacle_changed_;
+};
+
+
 /**
  * @brief The H-signature defines an equivalence relation based on homology in terms of complex calculus.
  *
@@ -75,6 +390,13 @@ public:
     */
     HSignature(const TebConfig& cfg) : cfg_(&cfg) {}
 
+    /**
+    * @brief Constructor accepting a TebConfig and an already known H-signature value (e.g. accumulated with HSignatureSegmentTerms)
+    * @param cfg TebConfig storing some user configuration options
+    * @param value h-signature in complex-number format
+    */
+    HSignature(const TebConfig& cfg, const std::complex<long double>& value) : cfg_(&cfg), hsignature_(value) {}
+
 
    /**
     * @brief Calculate the H-Signature of a path
@@ -103,86 +425,18 @@ public:
         }
 
 
-        ROS_ASSERT_MSG(cfg_->hcp.h_signature_prescaler>0.1 && cfg_->hcp.h_signature_prescaler<=1, "Only a prescaler on the interval (0.1,1] ist allowed.");
-
-        // guess values for f0
-        // paper proposes a+b=N-1 && |a-b|<=1, 1...N obstacles
-        int m = std::max( (int)obstacles->size()-1, 5 );  // for only a few obstacles we need a min threshold in order to get significantly high H-Signatures
-
-        int a = (int) std::ceil(double(m)/2.0);
-        int b = m-a;
-
         std::advance(path_end, -1); // reduce path_end by 1 (since we check line segments between those path points
 
-        typedef std::complex<long double> cplx;
-        // guess map size (only a really really coarse guess is required
-        // use distance from start to goal as distance to each direction
-        // TODO: one could move the map determination outside this function, since it remains constant for the whole planning interval
-        cplx start = fun_cplx_point(*path_start);
-        cplx end = fun_cplx_point(*path_end); // path_end points to the last point now after calling std::advance before
-        cplx delta = end-start;
-        cplx normal(-delta.imag(), delta.real());
-        cplx map_bottom_left;
-        cplx map_top_right;
-        if (std::abs(delta) < 3.0)
-        { // set minimum bound on distance (we do not want to have numerical instabilities) and 3.0 performs fine...
-            map_bottom_left = start + cplx(0, -3);
-            map_top_right = start + cplx(3, 3);
-        }
-        else
-        {
-            map_bottom_left = start - normal;
-            map_top_right = start + delta + normal;
-        }
+        // the coefficients depend only on the obstacles and the start and end of the path
+        HSignatureSegmentTerms terms;
+        terms.initialize(*cfg_, fun_cplx_point(*path_start), fun_cplx_point(*path_end), *obstacles);
 
         hsignature_ = 0; // reset local signature
 
-        std::vector<double> imag_proposals(5);
-
         // iterate path
         while(path_start != path_end)
         {
-            cplx z1 = fun_cplx_point(*path_start);
-            cplx z2 = fun_cplx_point(*std::next(path_start));
-
-            for (std::size_t l=0; l<obstacles->size(); ++l) // iterate all obstacles
-            {
-                cplx obst_l = obstacles->at(l)->getCentroidCplx();
-                //cplx f0 = (long double) prescaler * std::pow(obst_l-map_bottom_left,a) * std::pow(obst_l-map_top_right,b);
-                cplx f0 = (long double) cfg_->hcp.h_signature_prescaler * (long double)a*(obst_l-map_bottom_left) * (long double)b*(obst_l-map_top_right);
-
-                // denum contains product with all obstacles exepct j==l
-                cplx Al = f0;
-                for (std::size_t j=0; j<obstacles->size(); ++j)
-                {
-                    if (j==l)
-                        continue;
-                    cplx obst_j = obstacles->at(j)->getCentroidCplx();
-                    cplx diff = obst_l - obst_j;
-                    //if (diff.real()!=0 || diff.imag()!=0)
-                    if (std::abs(diff)<0.05) // skip really close obstacles
-                        continue;
-                     else
-                        Al /= diff;
-                }
-                // compute log value
-                double diff2 = std::abs(z2-obst_l);
-                double diff1 = std::abs(z1-obst_l);
-                if (diff2 == 0 || diff1 == 0)
-                    continue;
-                double log_real = std::log(diff2)-std::log(diff1);
-                // complex ln has more than one solution -> choose minimum abs angle -> paper
-                double arg_diff = std::arg(z2-obst_l)-std::arg(z1-obst_l);
-                imag_proposals.at(0) = arg_diff;
-                imag_proposals.at(1) = arg_diff+2*M_PI;
-                imag_proposals.at(2) = arg_diff-2*M_PI;
-                imag_proposals.at(3) = arg_diff+4*M_PI;
-                imag_proposals.at(4) = arg_diff-4*M_PI;
-                double log_imag = *std::min_element(imag_proposals.begin(),imag_proposals.end(),smaller_than_abs);
-                cplx log_value(log_real,log_imag);
-                //cplx log_value = std::log(z2-obst_l)-std::log(z1-obst_l); // the principal solution doesn't seem to work
-                hsignature_ += Al*log_value;
-            }
+            hsignature_ += terms.segment(fun_cplx_point(*path_start), fun_cplx_point(*std::next(path_start)));
             ++path_start;
         }
     }
@@ -226,6 +480,36 @@ public:
       return true;
     }
 
+    /**
+     * @brief Key of the hash bucket: cell of the h-signature on a grid with the resolution h_signature_threshold
+     */
+    virtual std::size_t hashKey() const
+    {
+        if (!(cfg_->hcp.h_signature_threshold > 0))
+            return EquivalenceClass::hashKey();
+        return cellKey(cell(hsignature_.real()), cell(hsignature_.imag()));
+    }
+
+    /**
+     * @brief Keys of the hash buckets that might contain an equal h-signature
+     *
+     * Equal h-signatures differ by at most h_signature_threshold per component, hence they are stored in the same or a neighbouring cell.
+     */
+    virtual bool candidateKeys(std::vector<std::size_t>& keys) const
+    {
+        if (!(cfg_->hcp.h_signature_threshold > 0))
+            return EquivalenceClass::candidateKeys(keys);
+        const double cell_real = cell(hsignature_.real());
+        const double cell_imag = cell(hsignature_.imag());
+        keys.clear();
+        for (int dx = -1; dx <= 1; ++dx)
+        {
+            for (int dy = -1; dy <= 1; ++dy)
+                keys.push_back(cellKey(cell_real + dx, cell_imag + dy));
+        }
+        return true;
+    }
+
     /**
      * @brief Get the current value of the h-signature (read-only)
      * @return h-signature in complex-number format
@@ -235,6 +519,16 @@ public:
 
 private:
 
+    double cell(long double value) const {return std::floor(double(value / cfg_->hcp.h_signature_threshold));}
+
+    static std::size_t cellKey(double cell_real, double cell_imag)
+    {
+        std::size_t seed = 0;
+        boost::hash_combine(seed, cell_real);
+        boost::hash_combine(seed, cell_imag);
+        return seed;
+    }
+
     const TebConfig* cfg_;
     std::complex<long double> hsignature_;
 };
@@ -287,6 +581,7 @@ public:
       std::advance(path_end, -1); // reduce path_end by 1 (since we check line segments between those path points)
 
       constexpr int num_int_steps_per_segment = 10;
+      const bool timing_provided = timediff_start != boost::none && timediff_end != boost::none;
 
       for (std::size_t l = 0; l < obstacles->size(); ++l) // iterate all obstacles
       {
@@ -305,19 +600,22 @@ public:
         double ds_sq_norm = ds.squaredNorm(); // by definition not zero as t > 0 (3rd component)
 
         // iterate path
-        for (path_iter = path_start, timediff_iter = timediff_start.get(); path_iter != path_end; ++path_iter, ++timediff_iter)
+        if (timing_provided)
+          timediff_iter = timediff_start.get();
+        for (path_iter = path_start; path_iter != path_end; ++path_iter)
         {
           std::complex<long double> z1 = fun_cplx_point(*path_iter);
           std::complex<long double> z2 = fun_cplx_point(*std::next(path_iter));
 
           transition_time = next_transition_time;
-          if (timediff_start == boost::none || timediff_end == boost::none) // if no time information is provided yet, approximate transition time
+          if (!timing_provided) // if no time information is provided yet, approximate transition time
             next_transition_time += std::abs(z2 - z1) / cfg_->robot.max_vel_x; // Approximate the time, if no time is known
           else // otherwise use the time information from the teb trajectory
           {
             if (std::distance(path_iter, path_end) != std::distance(timediff_iter, timediff_end.get()))
               ROS_ERROR("Size of poses and timediff vectors does not match. This is a bug.");
             next_transition_time += (*timediff_iter)->dt();
+            ++timediff_iter;
           }
 
           Eigen::Vector3d direction_vec;
@@ -382,6 +680,28 @@ public:
       return false;
     }
 
+    /**
+     * @brief Key of the hash bucket: pattern of the signs of all components (components below h_signature_threshold are zero)
+     */
+    virtual std::size_t hashKey() const
+    {
+      std::size_t seed = hsignature3d_.size();
+      for (const double& value : hsignature3d_)
+        boost::hash_combine(seed, std::abs(value) < cfg_->hcp.h_signature_threshold ? 0 : (int)boost::math::sign(value));
+      return seed;
+    }
+
+    /**
+     * @brief Keys of the hash buckets that are checked first for an equal class
+     *
+     * Components below the threshold match any sign (see isEqual()), hence an equal class might be stored in any other bucket as well.
+     */
+    virtual bool candidateKeys(std::vector<std::size_t>& keys) const
+    {
+      keys.assign(1, hashKey());
+      return false;
+    }
+
     /**
      * @brief Check if the equivalence value is detected correctly
      * @return Returns false, if the equivalence class detection failed, e.g. if nan- or inf values occur.
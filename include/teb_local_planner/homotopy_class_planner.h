@@ -45,6 +45,7 @@
 #include <vector>
 #include <iterator>
 #include <random>
+#include <unordered_map>
 
 #include <boost/shared_ptr.hpp>
 
@@ -62,7 +63,10 @@
 #include <teb_local_planner/visualization.h>
 #include <teb_local_planner/robot_footprint_model.h>
 #include <teb_local_planner/equivalence_relations.h>
+#include <teb_local_planner/equivalence_class_index.h>
 #include <teb_local_planner/graph_search.h>
+#include <teb_local_planner/warm_start_cache.h>
+#include <teb_local_planner/obstacle_spatial_index.h>
 
 
 namespace teb_local_planner
@@ -75,6 +79,13 @@ inline std::complex<long double> getCplxFromVertexPosePtr(const VertexPose* pose
 };
 
 
+//!< Inline function used for calculateHSignature() in combination with PoseSE2 objects
+inline std::complex<long double> getCplxFromPoseSE2(const PoseSE2& pose)
+{
+  return std::complex<long double>(pose.x(), pose.y());
+};
+
+
 //!< Inline function used for calculateHSignature() in combination with geometry_msgs::PoseStamped
 inline std::complex<long double> getCplxFromMsgPoseStamped(const geometry_msgs::PoseStamped& pose)
 {
@@ -296,12 +307,15 @@ public:
    * @param goal_orientation Orientation of the last pose of the trajectory (optional, otherwise use goal heading)
    * @param start_velocity start velocity (optional)
    * @param free_goal_vel if \c true, a nonzero final velocity at the goal pose is allowed, otherwise the final velocity will be zero (default: false)
+   * @param path_class equivalence class of the path if already known (optional, otherwise it is computed from the path).
+   *                   The path is rejected before a planner is set up if its class is not new.
    * @tparam BidirIter Bidirectional iterator type
    * @tparam Fun unyary function that transforms the dereferenced iterator into an Eigen::Vector2d
    * @return Shared pointer to the newly created teb optimal planner
    */
   template<typename BidirIter, typename Fun>
-  TebOptimalPlannerPtr addAndInitNewTeb(BidirIter path_start, BidirIter path_end, Fun fun_position, double start_orientation, double goal_orientation, const geometry_msgs::Twist* start_velocity, bool free_goal_vel = false);
+  TebOptimalPlannerPtr addAndInitNewTeb(BidirIter path_start, BidirIter path_end, Fun fun_position, double start_orientation, double goal_orientation, const geometry_msgs::Twist* start_velocity, bool free_goal_vel = false,
+                                        EquivalenceClassPtr path_class = EquivalenceClassPtr());
 
   /**
    * @brief Add a new Teb to the internal trajectory container, if this teb constitutes a new equivalence class. Initialize it with a simple straight line between a given start and goal
@@ -335,11 +349,24 @@ public:
    * @brief Optimize all available trajectories by invoking the optimizer on each one.
    *
    * Depending on the configuration parameters, the optimization is performed either single or multi threaded.
+   * The outer iterations are split into rounds of 1, 2, 4, ... iterations. After each round the fraction
+   * TebConfig::HomotopyClasses::selection_pruning_ratio of the candidates with the highest cost is not optimized
+   * any further (successive halving), except for the current best TEB and the TEB of the initial plan.
+   * If candidates have been pruned, the costs of all candidates are evaluated again with unscaled weights afterwards,
+   * since the weights of the optimization graph depend on the number of outer iterations.
    * @param iter_innerloop Number of inner iterations (see TebOptimalPlanner::optimizeTEB())
    * @param iter_outerloop Number of outer iterations (see TebOptimalPlanner::optimizeTEB())
    */
   void optimizeAllTEBs(int iter_innerloop, int iter_outerloop);
 
+  /**
+   * @brief Optimize the trajectories in optimization_candidates_ and store the results in optimization_succeeded_
+   * @param iter_innerloop Number of inner iterations (see TebOptimalPlanner::optimizeTEB())
+   * @param iter_outerloop Number of outer iterations (see TebOptimalPlanner::optimizeTEB())
+   * @param first_outerloop_iteration Number of outer iterations already performed in the current cycle
+   */
+  void optimizeCandidates(int iter_innerloop, int iter_outerloop, int first_outerloop_iteration);
+
   /**
    * @brief Returns a shared pointer to the TEB related to the initial plan
    * @return A non-empty shared ptr is returned if a match was found; Otherwise the shared ptr is empty.
@@ -361,8 +388,9 @@ public:
     * @brief Reset the planner.
     *
     * Clear all previously found H-signatures, paths, tebs and the hcgraph.
+    * The current best teb is moved to the warm-start cache (if enabled).
     */
-  virtual void clearPlanner() {clearGraph(); equivalence_classes_.clear(); tebs_.clear(); initial_plan_ = NULL;}
+  virtual void clearPlanner() {commitBestTebToWarmStartCache(); clearGraph(); equivalence_classes_.clear(); equivalence_class_index_.clear(); clearTebs(); initial_plan_ = NULL;}
 
 
   /**
@@ -400,6 +428,14 @@ public:
 
   bool hasDiverged() const override;
 
+  /**
+   * @brief Compute the axis-aligned bounding box of all trajectory candidates
+   * @param[out] min_corner lower left corner of the bounding box
+   * @param[out] max_corner upper right corner of the bounding box
+   * @return \c true if the bounding box is valid, \c false if no trajectory is available
+   */
+  virtual bool getTrajectoryBoundingBox(Eigen::Vector2d& min_corner, Eigen::Vector2d& max_corner) const;
+
   /**
    * Compute and return the cost of the current optimization graph (supports multiple trajectories)
    * @param[out] cost current cost value for each trajectory
@@ -456,6 +492,14 @@ public:
    */
   const ObstContainer* obstacles() const {return obstacles_;}
 
+  /**
+   * @brief Access the spatial index of the current obstacle container (read-only)
+   * @remarks The index is rebuilt once per plan() call and shared by the graph search and all candidate trajectories.
+   *          Check ObstacleSpatialIndex::covers() before relying on it.
+   * @return const reference to the obstacle index
+   */
+  const ObstacleSpatialIndex& obstacleIndex() const {return obstacle_index_;}
+
   /**
    * @brief Returns true if the planner is initialized
    */
@@ -482,6 +526,46 @@ public:
    */
   bool addEquivalenceClassIfNew(const EquivalenceClassPtr& eq_class, bool lock=false);
 
+  /**
+   * @brief Check if addEquivalenceClassIfNew() would accept an equivalence class (without adding it)
+   *
+   * This allows to reject candidate paths before a TEB is allocated for them.
+   * @param eq_class equivalence class that should be tested
+   * @return \c true if the equivalence class is valid and new (or an allowed duplicate of the best class), \c false otherwise
+   */
+  bool isNewEquivalenceClass(const EquivalenceClassPtr& eq_class) const;
+
+  /**
+   * @brief Get a planner for a new trajectory candidate
+   *
+   * A planner of a previously removed trajectory is reinitialized if available (see TebOptimalPlanner::reinitialize()),
+   * otherwise a new one is created.
+   * @return Shared pointer to a planner with an empty trajectory
+   */
+  TebOptimalPlannerPtr acquireTebPlanner();
+
+  /**
+   * @brief Return a planner that is not used anymore to the pool
+   *
+   * The planner is only recycled if it is not referenced anywhere else (e.g. by best_teb_).
+   * @param teb planner to recycle
+   */
+  void releaseTebPlanner(const TebOptimalPlannerPtr& teb);
+
+  /**
+   * @brief Remove a teb from the trajectory container and recycle its planner
+   *
+   * The cached equivalence class of the teb is dropped, the list of equivalence classes is not modified.
+   * @param it iterator of the teb to be removed
+   * @return Iterator to the next teb
+   */
+  TebOptPlannerContainer::iterator eraseTeb(TebOptPlannerContainer::iterator it);
+
+  /**
+   * @brief Remove all tebs from the trajectory container and recycle their planners (and drop their cached equivalence classes)
+   */
+  void clearTebs();
+
   /**
    * @brief Return the current set of equivalence erelations (read-only)
    * @return reference to the internal set of currently tracked equivalence relations
@@ -514,6 +598,9 @@ protected:
 
   /**
    * @brief Check if a h-signature exists already.
+   *
+   * The lookup is constant-time for 2D h-signatures (HSignature) only, which compare to the classes in the neighbouring buckets.
+   * A 3D h-signature (HSignature3d) that is not found in its buckets is compared to all other classes.
    * @param eq_class equivalence class that should be tested
    * @return \c true if the h-signature is found, \c false otherwise
    */
@@ -531,6 +618,48 @@ protected:
    */
   void renewAndAnalyzeOldTebs(bool delete_detours);
 
+  /**
+   * @brief Compute the equivalence class of an existing trajectory or reuse the one of the previous cycle
+   *
+   * The class is reused if neither the poses and time differences of the trajectory nor the obstacles changed
+   * by more than TebConfig::HomotopyClasses::h_signature_reuse_tolerance.
+   * Otherwise the h-signature is updated incrementally (see IncrementalHSignature and TebConfig::HomotopyClasses::h_signature_full_update_interval),
+   * unless dynamic obstacles are included.
+   * @param teb planner of the trajectory
+   * @param obstacles_unchanged \c true if the obstacles did not change since the cached classes have been computed
+   * @return equivalence class of the trajectory
+   */
+  EquivalenceClassPtr calculateEquivalenceClassOfTeb(const TebOptimalPlannerPtr& teb, bool obstacles_unchanged);
+
+  /**
+   * @brief Compare the obstacles with those the cached equivalence classes refer to (see calculateEquivalenceClassOfTeb())
+   *
+   * The reference is updated if the obstacles changed.
+   * @return \c true if no obstacle changed by more than TebConfig::HomotopyClasses::h_signature_reuse_tolerance
+   */
+  bool updateObstacleSnapshot();
+
+  /**
+   * @brief Check if two trajectories of the same equivalence class are almost identical
+   *
+   * The Fréchet distance of their fingerprints (see TebOptimalPlanner::getTrajectoryFingerprint()) is compared
+   * with TebConfig::HomotopyClasses::duplicate_trajectory_distance.
+   * @param teb1 first trajectory
+   * @param class1 equivalence class of the first trajectory
+   * @param teb2 second trajectory
+   * @param class2 equivalence class of the second trajectory
+   * @return \c true if the trajectories are duplicates, \c false otherwise or if a fingerprint or class is not available
+   */
+  bool isDuplicateTrajectory(const TebOptimalPlanner& teb1, const EquivalenceClassPtr& class1,
+                             const TebOptimalPlanner& teb2, const EquivalenceClassPtr& class2) const;
+
+  /**
+   * @brief Equivalence class of a trajectory in tebs_ (stored at the same index in equivalence_classes_)
+   * @param teb trajectory
+   * @return equivalence class, empty if the trajectory is not found or the classes of some trajectories are not known yet
+   */
+  EquivalenceClassPtr equivalenceClassOfTeb(const TebOptimalPlannerPtr& teb) const;
+
   /**
    * @brief Associate trajectories with via-points
    *
@@ -543,6 +672,21 @@ protected:
 
   //@}
 
+  /**
+   * @brief Move the last feasible best teb into the warm-start cache before the trajectories are discarded (if enabled)
+   */
+  void commitBestTebToWarmStartCache();
+
+  /**
+   * @brief Add a new teb seeded from the closest matching solution of the warm-start cache (if enabled and available)
+   *
+   * Its equivalence class is determined afterwards in renewAndAnalyzeOldTebs().
+   * @param start start pose
+   * @param goal goal pose
+   * @return \c true if a teb has been added, \c false otherwise
+   */
+  bool addTebFromWarmStartCache(const PoseSE2& start, const PoseSE2& goal);
+
 
   // external objects (store weak pointers)
   const TebConfig* cfg_; //!< Config class that stores and manages all related parameters
@@ -573,6 +717,29 @@ protected:
 
   TebOptimalPlannerPtr last_best_teb_;  //!< Points to the plan used in the previous control cycle
 
+  WarmStartCache warm_start_cache_; //!< Recently selected trajectories used to seed a reinitialization
+
+  ObstacleSpatialIndex obstacle_index_; //!< Uniform grid over obstacles_, rebuilt in each plan() call
+
+  EquivalenceClassIndex equivalence_class_index_; //!< Hash index of equivalence_classes_ for the detection of duplicates
+
+  //! Equivalence class of a trajectory together with the state it has been computed for
+  struct CachedEquivalenceClass
+  {
+    EquivalenceClassPtr eq_class;
+    std::vector<double> poses; //!< x, y and time difference to the next pose of each pose of the trajectory
+    IncrementalHSignature h_signature; //!< State of the incremental h-signature update (2D only)
+  };
+  typedef std::unordered_map<const TebOptimalPlanner*, CachedEquivalenceClass> EquivalenceClassCache;
+  EquivalenceClassCache teb_eq_class_cache_; //!< Equivalence classes of the trajectories of the previous cycle
+  EquivalenceClassCache teb_eq_class_cache_next_; //!< Equivalence classes of the trajectories of the current cycle (swapped with teb_eq_class_cache_)
+  std::vector<double> obstacle_snapshot_; //!< Centroid and velocity of the obstacles the cached equivalence classes refer to
+
+  std::vector<TebOptimalPlannerPtr> teb_pool_; //!< Planners of removed trajectories, recycled (including their g2o optimizer) by acquireTebPlanner()
+
+  std::vector<TebOptimalPlanner*> optimization_candidates_; //!< Trajectories that are still optimized in the current round of optimizeAllTEBs()
+  std::vector<char> optimization_succeeded_; //!< Result of the last round for each entry of optimization_candidates_ (written by the optimization threads)
+
 
 
 public:
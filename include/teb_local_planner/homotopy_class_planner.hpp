@@ -63,9 +63,23 @@ EquivalenceClassPtr HomotopyClassPlanner::calculateEquivalenceClass(BidirIter pa
 
 
 template<typename BidirIter, typename Fun>
-TebOptimalPlannerPtr HomotopyClassPlanner::addAndInitNewTeb(BidirIter path_start, BidirIter path_end, Fun fun_position, double start_orientation, double goal_orientation, const geometry_msgs::Twist* start_velocity, bool free_goal_vel)
+TebOptimalPlannerPtr HomotopyClassPlanner::addAndInitNewTeb(BidirIter path_start, BidirIter path_end, Fun fun_position, double start_orientation, double goal_orientation, const geometry_msgs::Twist* start_velocity, bool free_goal_vel,
+                                                            EquivalenceClassPtr path_class)
 {
-  TebOptimalPlannerPtr candidate = TebOptimalPlannerPtr( new TebOptimalPlanner(*cfg_, obstacles_, robot_model_));
+  // check the equivalence class of the path before a planner is set up for it
+  if (!path_class)
+  {
+    typedef typename std::iterator_traits<BidirIter>::value_type PathPoint;
+    path_class = calculateEquivalenceClass(path_start, path_end, [&fun_position](const PathPoint& point)
+                                           {
+                                             const Eigen::Vector2d& pos = fun_position(point);
+                                             return std::complex<long double>(pos.x(), pos.y());
+                                           }, obstacles_);
+  }
+  if (!isNewEquivalenceClass(path_class))
+    return TebOptimalPlannerPtr();
+
+  TebOptimalPlannerPtr candidate = acquireTebPlanner();
 
   candidate->teb().initTrajectoryToGoal(path_start, path_end, fun_position, cfg_->robot.max_vel_x, cfg_->robot.max_vel_theta,
                                  cfg_->robot.acc_lim_x, cfg_->robot.acc_lim_theta, start_orientation, goal_orientation, cfg_->trajectory.min_samples,
@@ -74,13 +88,16 @@ TebOptimalPlannerPtr HomotopyClassPlanner::addAndInitNewTeb(BidirIter path_start
   if (start_velocity)
     candidate->setVelocityStart(*start_velocity);
 
-  EquivalenceClassPtr H = calculateEquivalenceClass(candidate->teb().poses().begin(), candidate->teb().poses().end(), getCplxFromVertexPosePtr, obstacles_,
-                                                    candidate->teb().timediffs().begin(), candidate->teb().timediffs().end());
-
-  
   if (free_goal_vel)
     candidate->setVelocityGoalFree();
 
+  // The (2d) h-signature does not change if the path is subdivided during the initialization,
+  // but the 3d h-signature depends on the timing of the trajectory.
+  EquivalenceClassPtr H = path_class;
+  if (cfg_->obstacles.include_dynamic_obstacles)
+    H = calculateEquivalenceClass(candidate->teb().poses().begin(), candidate->teb().poses().end(), getCplxFromVertexPosePtr, obstacles_,
+                                  candidate->teb().timediffs().begin(), candidate->teb().timediffs().end());
+
   if(addEquivalenceClassIfNew(H))
   {
     tebs_.push_back(candidate);
@@ -88,6 +105,7 @@ TebOptimalPlannerPtr HomotopyClassPlanner::addAndInitNewTeb(BidirIter path_start
   }
 
   // If the candidate constitutes no new equivalence class, return a null pointer
+  releaseTebPlanner(candidate);
   return TebOptimalPlannerPtr();
 }
   
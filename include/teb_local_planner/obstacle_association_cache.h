@@ -0,0 +1,152 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Christoph Rösmann
+ *********************************************************************/
+
+
+
+#ifndef OBSTACLE_ASSOCIATION_CACHE_H_
+#define OBSTACLE_ASSOCIATION_CACHE_H_
+
+#include <vector>
+
+#include <teb_local_planner/teb_config.h>
+#include <teb_local_planner/pose_se2.h>
+#include <teb_local_planner/obstacles.h>
+#include <teb_local_planner/robot_footprint_model.h>
+#include <teb_local_planner/teb_cost_evaluator.h>
+
+namespace teb_local_planner
+{
+
+/**
+ * @class ObstacleAssociationCache
+ * @brief Reuse the obstacle association of the trajectory poses across outer iterations
+ *
+ * The poses move only slightly between two outer iterations of TebOptimalPlanner::optimizeTEB,
+ * hence most of the O(poses x obstacles) work of TebCostEvaluator::associateObstacles is redundant.
+ * The association of each pose is stored together with its arc-length position along the trajectory
+ * (indices are not stable, since autoResize() inserts and removes poses) and the ObstacleAssociationMargin.
+ * A cached association is reused for the pose with the closest arc-length if
+ * - the pose moved by less than \c obstacle_association_cache_tolerance,
+ * - the resulting change of the robot-obstacle distances (translation plus rotation of the circumscribed footprint)
+ *   is smaller than the distance margin and the rotation smaller than the angular margin.
+ * In that case the full association provably yields the same result. \n
+ * The cache is bound to an obstacle container and dropped as soon as the container (resp. its size) changes.
+ */
+class ObstacleAssociationCache
+{
+public:
+
+  /**
+   * @brief Construct an empty cache
+   */
+  ObstacleAssociationCache() : search_start_(0), obstacles_(NULL), num_obstacles_(0), index_(NULL), hits_(0), misses_(0) {}
+
+  /**
+   * @brief Start a new pass along the trajectory (call before the first associate() of an outer iteration)
+   * @param obstacles obstacle container used for the association
+   * @param index optional spatial index of the obstacles for the full associations (see TebCostEvaluator::associateObstacles)
+   */
+  void beginPass(const ObstContainer& obstacles, const ObstacleSpatialIndex* index = NULL);
+
+  /**
+   * @brief Associate the relevant obstacles with a trajectory pose, reusing the cached result if it is still valid
+   *
+   * The poses of a pass must be processed in the order of increasing arc-length.
+   * @param cfg Const reference to the TebConfig class for internal parameters
+   * @param robot_model Robot footprint model used for the distance computation
+   * @param pose trajectory pose
+   * @param arc_length arc-length position of the pose along the trajectory
+   * @param[out] relevant associated obstacles are appended to this container
+   * @return \c true if the cached association has been reused
+   */
+  bool associate(const TebConfig& cfg, const BaseRobotFootprintModel& robot_model, const PoseSE2& pose, double arc_length,
+                 ObstContainer& relevant);
+
+  /**
+   * @brief Finish the pass: the associations of the current pass replace the cached ones
+   */
+  void endPass();
+
+  /**
+   * @brief Remove all cached associations (e.g. if the robot model or the parameters changed)
+   */
+  void clear() {entries_.clear(); next_entries_.clear(); obstacles_ = NULL; num_obstacles_ = 0;}
+
+  /**
+   * @brief Number of reused associations since construction
+   */
+  unsigned int hits() const {return hits_;}
+
+  /**
+   * @brief Number of full associations since construction
+   */
+  unsigned int misses() const {return misses_;}
+
+protected:
+
+  //! Association of a single pose
+  struct Entry
+  {
+    double arc_length; //!< Arc-length position of the pose in the last pass
+    PoseSE2 pose; //!< Pose for which the association has been computed
+    ObstacleAssociationMargin margin; //!< Robustness of the association
+    ObstContainer obstacles; //!< Associated obstacles
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+
+  /**
+   * @brief Check whether a cached association is still valid for the given pose
+   */
+  bool isValid(const Entry& entry, const PoseSE2& pose, double tolerance, double circumscribed_radius) const;
+
+  typedef std::vector< Entry, Eigen::aligned_allocator<Entry> > EntryContainer;
+
+  EntryContainer entries_; //!< Associations of the last pass (ordered by arc-length)
+  EntryContainer next_entries_; //!< Associations of the current pass
+  std::size_t search_start_; //!< First candidate in entries_ for the next associate() call
+  const ObstContainer* obstacles_; //!< Obstacle container the entries refer to
+  std::size_t num_obstacles_; //!< Size of the obstacle container the entries refer to
+  const ObstacleSpatialIndex* index_; //!< Spatial index of the obstacles in the current pass (optional)
+  unsigned int hits_; //!< Number of reused associations
+  unsigned int misses_; //!< Number of full associations
+};
+
+} // namespace teb_local_planner
+
+#endif /* OBSTACLE_ASSOCIATION_CACHE_H_ */
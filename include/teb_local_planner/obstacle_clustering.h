@@ -0,0 +1,69 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Christoph Rösmann
+ *********************************************************************/
+
+
+#ifndef OBSTACLE_CLUSTERING_H_
+#define OBSTACLE_CLUSTERING_H_
+
+#include <teb_local_planner/obstacles.h>
+
+namespace teb_local_planner
+{
+
+/**
+ * @brief Cluster a set of point obstacles (e.g. occupied costmap cells) into point, line and polygon obstacles
+ *
+ * This is a lightweight, built-in alternative to the costmap_converter plugins:
+ *   -# The points are downsampled on a grid with the given \c resolution (one centroid per occupied voxel).
+ *   -# Connected voxels (8-neighborhood) are grouped, but a cluster never grows beyond \c max_extent (diameter,
+ *      measured between the voxel centroids), such that the convex hull of a cluster remains a tight approximation
+ *      also for walls and concave shapes.
+ *   -# Each cluster is converted into a PointObstacle (single point), a LineObstacle (collinear points)
+ *      or a PolygonObstacle (convex hull of all points of the cluster, hence every point lies inside or on the obstacle).
+ *
+ * @param points point obstacles to be clustered
+ * @param resolution voxel size [m]
+ * @param max_extent maximum diameter of a single cluster [m]
+ * @param[out] obstacles container to which the resulting obstacles are appended
+ * @return number of obstacles appended to \c obstacles
+ */
+std::size_t clusterPointObstacles(const Point2dContainer& points, double resolution, double max_extent, ObstContainer& obstacles);
+
+} // namespace teb_local_planner
+
+#endif /* OBSTACLE_CLUSTERING_H_ */
@@ -0,0 +1,206 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Christoph Rösmann
+ *********************************************************************/
+
+
+#ifndef OBSTACLE_SPATIAL_INDEX_H_
+#define OBSTACLE_SPATIAL_INDEX_H_
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include <Eigen/Core>
+
+#include <teb_local_planner/obstacles.h>
+#include <teb_local_planner/distance_calculations.h>
+
+namespace teb_local_planner
+{
+
+/**
+ * @class ObstacleSpatialIndex
+ * @brief Uniform grid over the bounding circles of an obstacle container (broadphase for collision and distance queries)
+ *
+ * Testing every roadmap edge resp. every trajectory pose against all obstacles is O(queries x obstacles).
+ * The index stores each obstacle in all grid cells overlapped by its bounding circle (see Obstacle::getBoundingRadius()),
+ * such that a query only visits the cells close to the query segment or circle. Queries return the indices of all obstacles
+ * whose bounding circle is within the query distance, in ascending order (i.e. in the order of the container).
+ * Obstacles without a finite bounding circle (e.g. custom obstacle types) are always returned. \n
+ * The index does not observe the obstacles: it must be rebuilt (once per planning cycle) whenever they are modified.
+ * Queries are const and can be performed from multiple threads.
+ */
+class ObstacleSpatialIndex
+{
+public:
+
+  /**
+   * @brief Construct an empty index
+   */
+  ObstacleSpatialIndex() : obstacles_(NULL), num_obstacles_(0), origin_(Eigen::Vector2d::Zero()), cell_size_(1), cols_(0), rows_(0) {}
+
+  /**
+   * @brief Build the index for the current state of an obstacle container
+   * @param obstacles obstacle container (the index refers to it, see covers())
+   * @param cell_size edge length of the grid cells [m], chosen automatically if not positive
+   */
+  void build(const ObstContainer& obstacles, double cell_size = 0);
+
+  /**
+   * @brief Remove all obstacles from the index
+   */
+  void clear();
+
+  /**
+   * @brief Check whether the index has been built for the given obstacle container (and its size did not change since)
+   */
+  bool covers(const ObstContainer& obstacles) const {return &obstacles == obstacles_ && obstacles.size() == num_obstacles_;}
+
+  /**
+   * @brief Find all obstacles whose bounding circle is closer than \c dist to a line segment
+   *
+   * Every obstacle for which Obstacle::checkLineIntersection(line_start, line_end, dist) might return \c true is included.
+   * @param line_start start of the line segment
+   * @param line_end end of the line segment
+   * @param dist distance to the segment
+   * @param[out] candidates indices of the obstacles (ascending)
+   */
+  void querySegment(const Eigen::Vector2d& line_start, const Eigen::Vector2d& line_end, double dist, std::vector<int>& candidates) const;
+
+  /**
+   * @brief Test the obstacles close to a line segment until the first positive test (e.g. an edge collision check)
+   *
+   * In contrast to querySegment(), the candidates are tested while walking along the cells, starting at \c line_start.
+   * Hence a positive test terminates the query early. Obstacles stored in several cells might be tested more than once.
+   * @param line_start start of the line segment
+   * @param line_end end of the line segment
+   * @param dist distance to the segment
+   * @param test functor <tt>bool(int idx)</tt> called with the index of a candidate obstacle
+   * @return \c true if \c test returned \c true for any candidate, \c false otherwise
+   */
+  template <typename Test>
+  bool anyAlongSegment(const Eigen::Vector2d& line_start, const Eigen::Vector2d& line_end, double dist, Test test) const
+  {
+    if (cols_ > 0)
+    {
+      int c0, c1, r0, r1;
+      segmentColumns(line_start, line_end, dist, c0, c1);
+      const bool backwards = line_end.x() < line_start.x();
+      for (int k = 0; k <= c1 - c0; ++k)
+      {
+        const int c = backwards ? c1 - k : c0 + k;
+        if (!segmentRows(line_start, line_end, dist, c, r0, r1))
+          continue;
+        for (int j = cell_begin_[c * rows_ + r0]; j < cell_begin_[c * rows_ + r1 + 1]; ++j)
+        {
+          const int idx = cell_items_[j];
+          if (isNear(idx, line_start, line_end, dist) && test(idx))
+            return true;
+        }
+      }
+    }
+    for (int idx : large_)
+    {
+      if (isNear(idx, line_start, line_end, dist) && test(idx))
+        return true;
+    }
+    for (int idx : unbounded_)
+    {
+      if (test(idx))
+        return true;
+    }
+    return false;
+  }
+
+  /**
+   * @brief Find all obstacles whose bounding circle intersects a circle
+   * @param center center of the circle
+   * @param radius radius of the circle
+   * @param[out] candidates indices of the obstacles (ascending)
+   */
+  void queryCircle(const Eigen::Vector2d& center, double radius, std::vector<int>& candidates) const;
+
+  /**
+   * @brief Edge length of the grid cells
+   */
+  double cellSize() const {return cell_size_;}
+
+protected:
+
+  //! Range of columns overlapped by a line segment inflated by dist
+  void segmentColumns(const Eigen::Vector2d& line_start, const Eigen::Vector2d& line_end, double dist, int& col_begin, int& col_end) const;
+
+  //! Range of rows of a column overlapped by a line segment inflated by dist (returns false if the column is not overlapped)
+  bool segmentRows(const Eigen::Vector2d& line_start, const Eigen::Vector2d& line_end, double dist, int col, int& row_begin, int& row_end) const;
+
+  //! Check whether the bounding circle of an obstacle is within dist of a line segment
+  bool isNear(int idx, const Eigen::Vector2d& line_start, const Eigen::Vector2d& line_end, double dist) const
+  {
+    return distance_point_to_segment_2d(centers_[idx], line_start, line_end) <= radii_[idx] + dist;
+  }
+
+  //! Append the obstacles of all cells within the given cell range of a column
+  void appendColumn(int col, int row_begin, int row_end, std::vector<int>& candidates) const;
+
+  //! Append the obstacles that are not stored in cells and sort the candidates
+  void finalizeCandidates(std::vector<int>& candidates, const Eigen::Vector2d& line_start, const Eigen::Vector2d& line_end, double dist) const;
+
+  //! Cell coordinate of a position (only clamped to a representable range, positions in front of the grid yield -1)
+  int cellCoord(double pos, double origin) const {return (int)std::max(-1.0, std::min(std::floor((pos - origin) / cell_size_), 1e8));}
+
+  const ObstContainer* obstacles_; //!< Obstacle container the index refers to
+  std::size_t num_obstacles_; //!< Size of the obstacle container at the time of build()
+
+  std::vector<Eigen::Vector2d, Eigen::aligned_allocator<Eigen::Vector2d> > centers_; //!< Bounding circle centers (per obstacle)
+  std::vector<double> radii_; //!< Bounding circle radii (per obstacle, infinity if unbounded)
+
+  Eigen::Vector2d origin_; //!< Lower left corner of the grid
+  double cell_size_; //!< Edge length of the cells
+  int cols_; //!< Number of cells in x-direction
+  int rows_; //!< Number of cells in y-direction
+  std::vector<int> cell_begin_; //!< Offset of the first obstacle of each cell in cell_items_ (column-major, one additional entry at the end)
+  std::vector<int> cell_items_; //!< Obstacle indices of all cells
+  std::vector<int> large_; //!< Obstacles overlapping too many cells (tested with their bounding circle only)
+  std::vector<int> unbounded_; //!< Obstacles without a finite bounding circle (always returned)
+
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+} // namespace teb_local_planner
+
+#endif /* OBSTACLE_SPATIAL_INDEX_H_ */
@@ -45,6 +45,8 @@
 #include <Eigen/Geometry>
 
 #include <complex>
+#include <limits>
+#include <typeinfo>
 
 #include <boost/shared_ptr.hpp>
 #include <boost/pointer_cast.hpp>
@@ -60,6 +62,22 @@
 namespace teb_local_planner
 {
 
+/**
+ * @brief Types of the built-in obstacles
+ *
+ * The type selects the inlined distance kernels of the obstacle/footprint dispatch table (see calculateRobotObstacleDistance()).
+ * User-defined obstacles, including subclasses of the built-in obstacles, are of type \c Custom and use the virtual interface.
+ */
+enum class ObstacleType
+{
+  Point,
+  Circular,
+  Line,
+  Pill,
+  Polygon,
+  Custom
+};
+
 /**
  * @class Obstacle
  * @brief Abstract class that defines the interface for modelling obstacles
@@ -70,8 +88,9 @@ public:
   
   /**
     * @brief Default constructor of the abstract obstacle class
+    * @param type obstacle type (only built-in obstacles pass a type other than ObstacleType::Custom)
     */
-  Obstacle() : dynamic_(false), centroid_velocity_(Eigen::Vector2d::Zero())
+  Obstacle(ObstacleType type = ObstacleType::Custom) : dynamic_(false), centroid_velocity_(Eigen::Vector2d::Zero()), type_(type)
   {
   }
   
@@ -101,6 +120,36 @@ public:
   //@}
 
 
+  /** @name Bounding circle for cheap distance culling */
+  //@{
+
+  /**
+    * @brief Get the radius of a circle around getCentroid() that contains the complete obstacle
+    *
+    * The default (infinity) disables the culling for obstacle types that do not provide a bounding circle.
+    * @return bounding radius
+    */
+  virtual double getBoundingRadius() const {return std::numeric_limits<double>::infinity();}
+
+  /**
+    * @brief Check whether the obstacle is certainly further away than \c dist from a circular region
+    *
+    * Only the bounding circle is tested (a single squared-distance comparison), hence \c false
+    * does not imply that the exact distance is below \c dist.
+    * @param center center of the region
+    * @param radius radius of the region
+    * @param dist distance threshold
+    * @return \c true if the minimum distance between the region and the obstacle is larger than \c dist
+    */
+  bool isBeyond(const Eigen::Vector2d& center, double radius, double dist) const
+  {
+    const double bound = dist + radius + getBoundingRadius();
+    return bound < 0 || (center - getCentroid()).squaredNorm() > bound*bound;
+  }
+
+  //@}
+
+
   /** @name Collision checking and distance calculations (abstract, obstacle type depending) */
   //@{ 
 
@@ -143,6 +192,45 @@ public:
    */
   virtual double getMinimumDistance(const Point2dContainer& polygon) const = 0;
 
+  /**
+   * @brief Get the minimum euclidean distance to the obstacle (polygon in SoA layout as reference)
+   *
+   * Used by the polygonal robot footprint. The default implementation converts the polygon and calls
+   * getMinimumDistance(const Point2dContainer&), derived classes should use the batch distance kernels.
+   * @param polygon closed polygon in structure-of-arrays layout
+   * @return The nearest possible distance to the obstacle
+   */
+  virtual double getMinimumDistance(const PolygonSoA& polygon) const
+  {
+    Point2dContainer vertices(polygon.num_vertices);
+    for (int i = 0; i < polygon.num_vertices; ++i)
+      vertices[i] = Eigen::Vector2d(polygon.x[i], polygon.y[i]);
+    return getMinimumDistance(vertices);
+  }
+
+  /**
+   * @brief Get the minimum euclidean distance to the obstacle (convex polygon as reference)
+   *
+   * Convex obstacles may use the faster distance_convex_polygon_to_polygon_2d() (see PolygonRobotFootprint).
+   * The default implementation calls getMinimumDistance(const PolygonSoA&).
+   * @param convex_polygon closed convex polygon in structure-of-arrays layout
+   * @param[in,out] witness optional witness vertices for warm starting (the obstacle is the second polygon)
+   * @return The nearest possible distance to the obstacle
+   */
+  virtual double getMinimumDistanceToConvex(const PolygonSoA& convex_polygon, ConvexDistanceWitness* witness) const
+  {
+    return getMinimumDistance(convex_polygon);
+  }
+
+  /**
+   * @brief Get the type of the obstacle
+   *
+   * Subclasses of the built-in obstacles might override the distance functions, hence the built-in type
+   * is only returned if the dynamic type is exactly the built-in class.
+   * @return built-in type or ObstacleType::Custom for user-defined obstacles
+   */
+  inline ObstacleType getType() const;
+
   /**
    * @brief Get the closest point on the boundary of the obstacle w.r.t. a specified reference position
    * @param position reference 2d position
@@ -283,6 +371,7 @@ protected:
 	   
   bool dynamic_; //!< Store flag if obstacle is dynamic (resp. a moving obstacle)
   Eigen::Vector2d centroid_velocity_; //!< Store the corresponding velocity (vx, vy) of the centroid (zero, if _dynamic is \c true)
+  ObstacleType type_; //!< Store the obstacle type passed by the built-in class (inherited by its subclasses, see getType())
   
 public:	
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
@@ -309,14 +398,14 @@ public:
   /**
     * @brief Default constructor of the point obstacle class
     */
-  PointObstacle() : Obstacle(), pos_(Eigen::Vector2d::Zero())
+  PointObstacle() : Obstacle(ObstacleType::Point), pos_(Eigen::Vector2d::Zero())
   {}
   
   /**
     * @brief Construct PointObstacle using a 2d position vector
     * @param position 2d position that defines the current obstacle position
     */
-  PointObstacle(const Eigen::Ref< const Eigen::Vector2d>& position) : Obstacle(), pos_(position)
+  PointObstacle(const Eigen::Ref< const Eigen::Vector2d>& position) : Obstacle(ObstacleType::Point), pos_(position)
   {}
   
   /**
@@ -324,7 +413,7 @@ public:
     * @param x x-coordinate
     * @param y y-coordinate
     */      
-  PointObstacle(double x, double y) : Obstacle(), pos_(Eigen::Vector2d(x,y))
+  PointObstacle(double x, double y) : Obstacle(ObstacleType::Point), pos_(Eigen::Vector2d(x,y))
   {}
 
 
@@ -371,6 +460,12 @@ public:
   {
     return distance_point_to_polygon_2d(pos_, polygon);
   }
+
+  // implements getMinimumDistance() of the base class
+  virtual double getMinimumDistance(const PolygonSoA& polygon) const
+  {
+    return distance_point_to_polygon_2d(pos_, polygon);
+  }
   
   // implements getMinimumDistanceVec() of the base class
   virtual Eigen::Vector2d getClosestPoint(const Eigen::Vector2d& position) const
@@ -413,6 +508,9 @@ public:
   {
     return std::complex<double>(pos_[0],pos_[1]);
   }
+
+  // implements getBoundingRadius() of the base class
+  virtual double getBoundingRadius() const {return 0.0;}
   
   // Accessor methods
   const Eigen::Vector2d& position() const {return pos_;} //!< Return the current position of the obstacle (read-only)
@@ -451,7 +549,7 @@ public:
   /**
     * @brief Default constructor of the circular obstacle class
     */
-  CircularObstacle() : Obstacle(), pos_(Eigen::Vector2d::Zero())
+  CircularObstacle() : Obstacle(ObstacleType::Circular), pos_(Eigen::Vector2d::Zero())
   {}
 
   /**
@@ -459,7 +557,7 @@ public:
     * @param position 2d position that defines the current obstacle position
     * @param radius radius of the obstacle
     */
-  CircularObstacle(const Eigen::Ref< const Eigen::Vector2d>& position, double radius) : Obstacle(), pos_(position), radius_(radius)
+  CircularObstacle(const Eigen::Ref< const Eigen::Vector2d>& position, double radius) : Obstacle(ObstacleType::Circular), pos_(position), radius_(radius)
   {}
 
   /**
@@ -468,7 +566,7 @@ public:
     * @param y y-coordinate
     * @param radius radius of the obstacle
     */
-  CircularObstacle(double x, double y, double radius) : Obstacle(), pos_(Eigen::Vector2d(x,y)), radius_(radius)
+  CircularObstacle(double x, double y, double radius) : Obstacle(ObstacleType::Circular), pos_(Eigen::Vector2d(x,y)), radius_(radius)
   {}
 
 
@@ -516,6 +614,12 @@ public:
     return distance_point_to_polygon_2d(pos_, polygon) - radius_;
   }
 
+  // implements getMinimumDistance() of the base class
+  virtual double getMinimumDistance(const PolygonSoA& polygon) const
+  {
+    return distance_point_to_polygon_2d(pos_, polygon) - radius_;
+  }
+
   // implements getMinimumDistanceVec() of the base class
   virtual Eigen::Vector2d getClosestPoint(const Eigen::Vector2d& position) const
   {
@@ -558,6 +662,9 @@ public:
     return std::complex<double>(pos_[0],pos_[1]);
   }
 
+  // implements getBoundingRadius() of the base class
+  virtual double getBoundingRadius() const {return radius_;}
+
   // Accessor methods
   const Eigen::Vector2d& position() const {return pos_;} //!< Return the current position of the obstacle (read-only)
   Eigen::Vector2d& position() {return pos_;} //!< Return the current position of the obstacle
@@ -603,7 +710,7 @@ public:
   /**
     * @brief Default constructor of the point obstacle class
     */
-  LineObstacle() : Obstacle()
+  LineObstacle() : Obstacle(ObstacleType::Line)
   {
     start_.setZero();
     end_.setZero();
@@ -616,7 +723,7 @@ public:
    * @param line_end 2d position that defines the end of the line obstacle
    */
   LineObstacle(const Eigen::Ref< const Eigen::Vector2d>& line_start, const Eigen::Ref< const Eigen::Vector2d>& line_end) 
-                : Obstacle(), start_(line_start), end_(line_end)
+                : Obstacle(ObstacleType::Line), start_(line_start), end_(line_end)
   {
     calcCentroid();
   }
@@ -628,7 +735,7 @@ public:
    * @param x2 x-coordinate of the end of the line
    * @param y2 y-coordinate of the end of the line
    */
-  LineObstacle(double x1, double y1, double x2, double y2) : Obstacle()     
+  LineObstacle(double x1, double y1, double x2, double y2) : Obstacle(ObstacleType::Line)     
   {
     start_.x() = x1;
     start_.y() = y1;
@@ -667,6 +774,12 @@ public:
     return distance_segment_to_polygon_2d(start_, end_, polygon);
   }
 
+  // implements getMinimumDistance() of the base class
+  virtual double getMinimumDistance(const PolygonSoA& polygon) const
+  {
+    return distance_segment_to_polygon_2d(start_, end_, polygon);
+  }
+
   // implements getMinimumDistanceVec() of the base class
   virtual Eigen::Vector2d getClosestPoint(const Eigen::Vector2d& position) const
   {
@@ -705,6 +818,9 @@ public:
   {
     return std::complex<double>(centroid_.x(), centroid_.y());
   }
+
+  // implements getBoundingRadius() of the base class
+  virtual double getBoundingRadius() const {return bounding_radius_;}
   
   // Access or modify line
   const Eigen::Vector2d& start() const {return start_;}
@@ -725,13 +841,14 @@ public:
   }
   
 protected:
-  void calcCentroid()	{	centroid_ = 0.5*(start_ + end_); }
+  void calcCentroid()	{	centroid_ = 0.5*(start_ + end_); bounding_radius_ = 0.5*(end_ - start_).norm(); }
   
 private:
 	Eigen::Vector2d start_;
 	Eigen::Vector2d end_;
 	
   Eigen::Vector2d centroid_;
+  double bounding_radius_ = 0.0; //!< Half length of the line (bounding circle around the centroid)
 
 public:	
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW  
@@ -750,7 +867,7 @@ public:
   /**
     * @brief Default constructor of the point obstacle class
     */
-  PillObstacle() : Obstacle()
+  PillObstacle() : Obstacle(ObstacleType::Pill)
   {
     start_.setZero();
     end_.setZero();
@@ -763,7 +880,7 @@ public:
    * @param line_end 2d position that defines the end of the line obstacle
    */
   PillObstacle(const Eigen::Ref< const Eigen::Vector2d>& line_start, const Eigen::Ref< const Eigen::Vector2d>& line_end, double radius)
-                : Obstacle(), start_(line_start), end_(line_end), radius_(radius)
+                : Obstacle(ObstacleType::Pill), start_(line_start), end_(line_end), radius_(radius)
   {
     calcCentroid();
   }
@@ -775,7 +892,7 @@ public:
    * @param x2 x-coordinate of the end of the line
    * @param y2 y-coordinate of the end of the line
    */
-  PillObstacle(double x1, double y1, double x2, double y2, double radius) : Obstacle(), radius_(radius)
+  PillObstacle(double x1, double y1, double x2, double y2, double radius) : Obstacle(ObstacleType::Pill), radius_(radius)
   {
     start_.x() = x1;
     start_.y() = y1;
@@ -814,6 +931,12 @@ public:
     return distance_segment_to_polygon_2d(start_, end_, polygon) - radius_;
   }
 
+  // implements getMinimumDistance() of the base class
+  virtual double getMinimumDistance(const PolygonSoA& polygon) const
+  {
+    return distance_segment_to_polygon_2d(start_, end_, polygon) - radius_;
+  }
+
   // implements getMinimumDistanceVec() of the base class
   virtual Eigen::Vector2d getClosestPoint(const Eigen::Vector2d& position) const
   {
@@ -854,6 +977,9 @@ public:
     return std::complex<double>(centroid_.x(), centroid_.y());
   }
 
+  // implements getBoundingRadius() of the base class
+  virtual double getBoundingRadius() const {return bounding_radius_ + radius_;}
+
   // Access or modify line
   const Eigen::Vector2d& start() const {return start_;}
   void setStart(const Eigen::Ref<const Eigen::Vector2d>& start) {start_ = start; calcCentroid();}
@@ -875,7 +1001,7 @@ public:
   }
 
 protected:
-  void calcCentroid()    {    centroid_ = 0.5*(start_ + end_); }
+  void calcCentroid()    {    centroid_ = 0.5*(start_ + end_); bounding_radius_ = 0.5*(end_ - start_).norm(); }
 
 private:
     Eigen::Vector2d start_;
@@ -883,6 +1009,7 @@ private:
     double radius_ = 0.0;
 
   Eigen::Vector2d centroid_;
+  double bounding_radius_ = 0.0; //!< Half length of the center line (the radius is added in getBoundingRadius())
 
 public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
@@ -902,7 +1029,7 @@ public:
   /**
     * @brief Default constructor of the polygon obstacle class
     */
-  PolygonObstacle() : Obstacle(), finalized_(false)
+  PolygonObstacle() : Obstacle(ObstacleType::Polygon), bounding_radius_(std::numeric_limits<double>::infinity()), convex_(false), finalized_(false)
   {
     centroid_.setConstant(NAN);
   }
@@ -910,7 +1037,7 @@ public:
   /**
    * @brief Construct polygon obstacle with a list of vertices
    */
-  PolygonObstacle(const Point2dContainer& vertices) : Obstacle(), vertices_(vertices)
+  PolygonObstacle(const Point2dContainer& vertices) : Obstacle(ObstacleType::Polygon), vertices_(vertices)
   {
     finalizePolygon();
   }
@@ -967,20 +1094,42 @@ public:
   // implements getMinimumDistance() of the base class
   virtual double getMinimumDistance(const Eigen::Vector2d& position) const
   {
+    if (finalized_)
+      return distance_point_to_polygon_2d(position, vertices_soa_);
     return distance_point_to_polygon_2d(position, vertices_);
   }
   
   // implements getMinimumDistance() of the base class
   virtual double getMinimumDistance(const Eigen::Vector2d& line_start, const Eigen::Vector2d& line_end) const
   {
+    if (finalized_)
+      return distance_segment_to_polygon_2d(line_start, line_end, vertices_soa_);
     return distance_segment_to_polygon_2d(line_start, line_end, vertices_);
   }
 
   // implements getMinimumDistance() of the base class
   virtual double getMinimumDistance(const Point2dContainer& polygon) const
   {
+    if (finalized_)
+      return distance_polygon_to_polygon_2d(PolygonSoA(polygon), vertices_soa_);
     return distance_polygon_to_polygon_2d(polygon, vertices_);
   }
+
+  // implements getMinimumDistance() of the base class
+  virtual double getMinimumDistance(const PolygonSoA& polygon) const
+  {
+    if (finalized_)
+      return distance_polygon_to_polygon_2d(polygon, vertices_soa_);
+    return Obstacle::getMinimumDistance(polygon);
+  }
+
+  // implements getMinimumDistanceToConvex() of the base class
+  virtual double getMinimumDistanceToConvex(const PolygonSoA& convex_polygon, ConvexDistanceWitness* witness) const
+  {
+    if (finalized_ && convex_)
+      return distance_convex_polygon_to_polygon_2d(convex_polygon, vertices_soa_, witness);
+    return getMinimumDistance(convex_polygon);
+  }
   
   // implements getMinimumDistanceVec() of the base class
   virtual Eigen::Vector2d getClosestPoint(const Eigen::Vector2d& position) const;
@@ -1033,6 +1182,13 @@ public:
     assert(finalized_ && "Finalize the polygon after all vertices are added.");
     return std::complex<double>(centroid_.coeffRef(0), centroid_.coeffRef(1));
   }
+
+  // implements getBoundingRadius() of the base class
+  virtual double getBoundingRadius() const
+  {
+    assert(finalized_ && "Finalize the polygon after all vertices are added.");
+    return bounding_radius_;
+  }
   
   // implements toPolygonMsg() of the base class
   virtual void toPolygonMsg(geometry_msgs::Polygon& polygon);
@@ -1077,6 +1233,9 @@ public:
   {
     fixPolygonClosure();
     calcCentroid();
+    calcBoundingRadius();
+    vertices_soa_.assign(vertices_);
+    convex_ = check_polygon_convexity_2d(vertices_);
     finalized_ = true;
   }
   
@@ -1089,6 +1248,11 @@ public:
     * @brief Get the number of vertices defining the polygon (the first vertex is counted once)
     */
   int noVertices() const {return (int)vertices_.size();}
+
+  /**
+    * @brief Check whether the polygon is convex (determined in finalizePolygon())
+    */
+  bool isConvex() const {return convex_;}
   
   
   ///@}
@@ -1099,9 +1263,14 @@ protected:
 
   void calcCentroid(); //!< Compute the centroid of the polygon (called inside finalizePolygon())
 
+  void calcBoundingRadius(); //!< Compute the radius of the bounding circle around the centroid (called inside finalizePolygon())
+
   
   Point2dContainer vertices_; //!< Store vertices defining the polygon (@see pushBackVertex)
   Eigen::Vector2d centroid_; //!< Store the centroid coordinates of the polygon (@see calcCentroid)
+  double bounding_radius_; //!< Store the radius of the bounding circle around the centroid (@see calcBoundingRadius)
+  PolygonSoA vertices_soa_; //!< Copy of the vertices for the batch distance kernels (updated inside finalizePolygon())
+  bool convex_; //!< Store whether the polygon is convex (updated inside finalizePolygon())
   
   bool finalized_; //!< Flat that keeps track if the polygon was finalized after adding all vertices
   
@@ -1111,6 +1280,82 @@ public:
 };
 
 
+inline ObstacleType Obstacle::getType() const
+{
+  // Comparing the addresses of the type_info objects is cheap compared to type_info::operator==.
+  // A type_info duplicated across shared libraries only results in the (slower) virtual interface.
+  static const std::type_info* const builtin_types[(int)ObstacleType::Custom] = {
+    &typeid(PointObstacle), &typeid(CircularObstacle), &typeid(LineObstacle), &typeid(PillObstacle), &typeid(PolygonObstacle)
+  };
+  return type_ != ObstacleType::Custom && &typeid(*this) == builtin_types[(int)type_] ? type_ : ObstacleType::Custom;
+}
+
+
+/**
+ * @brief Distance functions of an obstacle type without virtual dispatch
+ *
+ * The functions call the implementations of \c ObstacleT directly such that they can be inlined into the
+ * robot footprint models (see calculateRobotObstacleDistance()). The specialization for the abstract
+ * Obstacle class uses the virtual interface.
+ * @tparam ObstacleT built-in obstacle type
+ */
+template <typename ObstacleT>
+struct ObstacleDistance
+{
+  static double toPoint(const ObstacleT& obstacle, const Eigen::Vector2d& position)
+  {
+    return obstacle.ObstacleT::getMinimumDistance(position);
+  }
+
+  static double toSegment(const ObstacleT& obstacle, const Eigen::Vector2d& line_start, const Eigen::Vector2d& line_end)
+  {
+    return obstacle.ObstacleT::getMinimumDistance(line_start, line_end);
+  }
+
+  static double toPolygon(const ObstacleT& obstacle, const PolygonSoA& polygon)
+  {
+    return obstacle.ObstacleT::getMinimumDistance(polygon);
+  }
+
+  // only polygon obstacles benefit from a convex reference polygon (see specialization below)
+  static double toConvexPolygon(const ObstacleT& obstacle, const PolygonSoA& convex_polygon, ConvexDistanceWitness* witness)
+  {
+    return obstacle.ObstacleT::getMinimumDistance(convex_polygon);
+  }
+};
+
+template <>
+inline double ObstacleDistance<PolygonObstacle>::toConvexPolygon(const PolygonObstacle& obstacle, const PolygonSoA& convex_polygon, ConvexDistanceWitness* witness)
+{
+  return obstacle.PolygonObstacle::getMinimumDistanceToConvex(convex_polygon, witness);
+}
+
+//! Virtual dispatch for user-defined obstacles
+template <>
+struct ObstacleDistance<Obstacle>
+{
+  static double toPoint(const Obstacle& obstacle, const Eigen::Vector2d& position)
+  {
+    return obstacle.getMinimumDistance(position);
+  }
+
+  static double toSegment(const Obstacle& obstacle, const Eigen::Vector2d& line_start, const Eigen::Vector2d& line_end)
+  {
+    return obstacle.getMinimumDistance(line_start, line_end);
+  }
+
+  static double toPolygon(const Obstacle& obstacle, const PolygonSoA& polygon)
+  {
+    return obstacle.getMinimumDistance(polygon);
+  }
+
+  static double toConvexPolygon(const Obstacle& obstacle, const PolygonSoA& convex_polygon, ConvexDistanceWitness* witness)
+  {
+    return obstacle.getMinimumDistanceToConvex(convex_polygon, witness);
+  }
+};
+
+
 } // namespace teb_local_planner
 
 #endif /* OBSTACLES_H */
@@ -49,6 +49,10 @@
 #include <teb_local_planner/planner_interface.h>
 #include <teb_local_planner/visualization.h>
 #include <teb_local_planner/robot_footprint_model.h>
+#include <teb_local_planner/warm_start_cache.h>
+#include <teb_local_planner/teb_cost_evaluator.h>
+#include <teb_local_planner/obstacle_association_cache.h>
+#include <teb_local_planner/trajectory_fingerprint.h>
 
 // g2o lib stuff
 #include <g2o/core/sparse_optimizer.h>
@@ -71,6 +75,8 @@
 namespace teb_local_planner
 {
 
+class EdgeSegmentKinematics; //!< Forward Declaration
+
 //! Typedef for the block solver utilized for optimization
 typedef g2o::BlockSolver< g2o::BlockSolverTraits<-1, -1> >  TEBBlockSolver;
 
@@ -133,6 +139,21 @@ public:
   void initialize(const TebConfig& cfg, ObstContainer* obstacles = NULL, RobotFootprintModelPtr robot_model = boost::make_shared<PointRobotFootprint>(),
                   TebVisualizationPtr visual = TebVisualizationPtr(), const ViaPointContainer* via_points = NULL);
 
+  /**
+    * @brief Reinitialize the planner for a new trajectory, but keep the g2o optimizer
+    *
+    * In contrast to initialize(), the optimizer and its linear solver are reused. The trajectory,
+    * the warm-start cache and all results of previous optimizations are cleared.
+    * This allows to recycle planner instances (see HomotopyClassPlanner).
+    * @param cfg Const reference to the TebConfig class for internal parameters
+    * @param obstacles Container storing all relevant obstacles (see Obstacle)
+    * @param robot_model Shared pointer to the robot shape model used for optimization (optional)
+    * @param visual Shared pointer to the TebVisualization class (optional)
+    * @param via_points Container storing via-points (optional)
+    */
+  void reinitialize(const TebConfig& cfg, ObstContainer* obstacles = NULL, RobotFootprintModelPtr robot_model = boost::make_shared<PointRobotFootprint>(),
+                    TebVisualizationPtr visual = TebVisualizationPtr(), const ViaPointContainer* via_points = NULL);
+
   /**
     * @param robot_model Shared pointer to the robot shape model used for optimization (optional)
     */
@@ -228,15 +249,18 @@ public:
    * @param iterations_innerloop Number of iterations for the actual solver loop
    * @param iterations_outerloop Specifies how often the trajectory should be resized followed by the inner solver loop.
    * @param compute_cost_afterwards if \c true Calculate the cost vector according to computeCurrentCost(),
-   *         the vector can be accessed afterwards using getCurrentCost().
+   *         the vector can be accessed afterwards using getCurrentCost(). The trajectory fingerprint is updated as well (see getTrajectoryFingerprint()).
    * @param obst_cost_scale Specify extra scaling for obstacle costs (only used if \c compute_cost_afterwards is true)
    * @param viapoint_cost_scale Specify extra scaling for via-point costs (only used if \c compute_cost_afterwards is true)
    * @param alternative_time_cost Replace the cost for the time optimal objective by the actual (weighted) transition time
    *          (only used if \c compute_cost_afterwards is true).
+   * @param first_outerloop_iteration Number of outer iterations already performed in the current planning cycle,
+   *          allows to continue an optimization in several calls (the weights are adapted accordingly).
    * @return \c true if the optimization terminates successfully, \c false otherwise
    */
   bool optimizeTEB(int iterations_innerloop, int iterations_outerloop, bool compute_cost_afterwards = false,
-                   double obst_cost_scale=1.0, double viapoint_cost_scale=1.0, bool alternative_time_cost=false);
+                   double obst_cost_scale=1.0, double viapoint_cost_scale=1.0, bool alternative_time_cost=false,
+                   int first_outerloop_iteration=0);
 
   //@}
 
@@ -286,6 +310,13 @@ public:
    */
   const ObstContainer& getObstVector() const {return *obstacles_;}
 
+  /**
+   * @brief Assign a spatial index of the obstacle container to speed up the obstacle association
+   * @param index spatial index (can also be a nullptr), it is only used as long as it covers the obstacle container
+   * @remarks The index is owned by the caller, e.g. the HomotopyClassPlanner shares its index with all candidate trajectories.
+   */
+  void setObstacleIndex(const ObstacleSpatialIndex* index) {obstacle_index_ = index;}
+
   //@}
 
   /** @name Take via-points into account */
@@ -334,11 +365,15 @@ public:
 
   /**
    * @brief Reset the planner by clearing the internal graph and trajectory.
+   *
+   * The last feasible trajectory is moved to the warm-start cache (if enabled).
    */
   virtual void clearPlanner()
   {
+    commitToWarmStartCache();
     clearGraph();
     teb_.clearTimedElasticBand();
+    fingerprint_.clear();
   }
 
   /**
@@ -397,6 +432,14 @@ public:
    */
   bool hasDiverged() const override;
 
+  /**
+   * @brief Compute the axis-aligned bounding box of the current trajectory
+   * @param[out] min_corner lower left corner of the bounding box
+   * @param[out] max_corner upper right corner of the bounding box
+   * @return \c true if the bounding box is valid, \c false if the trajectory is empty
+   */
+  virtual bool getTrajectoryBoundingBox(Eigen::Vector2d& min_corner, Eigen::Vector2d& max_corner) const;
+
   /**
    * @brief Compute the cost vector of a given optimization problen (hyper-graph must exist).
    *
@@ -409,8 +452,9 @@ public:
    * Set \c alternative_time_cost to true in order to get the cost calculated using the latter equation, but check the
    * implemented definition, if the value is scaled to match the magnitude of other cost values.
    *
+   * The cost is accumulated per cost term from the edge registries filled in buildGraph (see getCurrentCostBreakdown()).
+   * If the graph has already been cleared, the cost is evaluated by the TebCostEvaluator without rebuilding the graph.
    * @todo Remove the scaling term for the alternative time cost.
-   * @todo Can we use the last error (chi2) calculated from g2o instead of calculating it by ourself?
    * @see getCurrentCost
    * @see optimizeTEB
    * @param obst_cost_scale Specify extra scaling for obstacle costs.
@@ -420,6 +464,19 @@ public:
    */
   void computeCurrentCost(double obst_cost_scale=1.0, double viapoint_cost_scale=1.0, bool alternative_time_cost=false);
 
+  /**
+   * @brief Evaluate the cost of the current trajectory per cost term without updating the stored cost
+   *
+   * The cost is evaluated by the TebCostEvaluator (independent of the optimization graph).
+   * In contrast to computeCurrentCost(), getCurrentCost() and getCurrentCostBreakdown() remain unchanged.
+   * @param[out] breakdown cost per cost term
+   * @param obst_cost_scale Specify extra scaling for obstacle costs.
+   * @param viapoint_cost_scale Specify extra scaling for via points.
+   * @param alternative_time_cost Replace the cost for the time optimal objective by the actual (weighted) transition time.
+   * @return accumulated cost
+   */
+  double evaluateCostBreakdown(TebCostBreakdown& breakdown, double obst_cost_scale=1.0, double viapoint_cost_scale=1.0, bool alternative_time_cost=false);
+
   /**
    * Compute and return the cost of the current optimization graph (supports multiple trajectories)
    * @param[out] cost current cost value for each trajectory
@@ -443,6 +500,22 @@ public:
    */
   double getCurrentCost() const {return cost_;}
 
+  /**
+   * @brief Access the cost breakdown per cost term.
+   *
+   * The breakdown is updated together with the accumulated cost by computeCurrentCost.
+   * @return const reference to the TebCostBreakdown.
+   */
+  const TebCostBreakdown& getCurrentCostBreakdown() const {return cost_breakdown_;}
+
+  /**
+   * @brief Access the fingerprint of the trajectory (see TrajectoryFingerprint).
+   *
+   * The fingerprint is updated together with the cost by calling optimizeTEB with enabled cost flag.
+   * @return const reference to the TrajectoryFingerprint (invalid if it has not been computed yet).
+   */
+  const TrajectoryFingerprint& getTrajectoryFingerprint() const {return fingerprint_;}
+
 
   /**
    * @brief Extract the velocity from consecutive poses and a time difference (including strafing velocity for holonomic robots)
@@ -496,6 +569,7 @@ public:
    *
    * This method currently checks only that the trajectory, or a part of the trajectory is collision free.
    * Obstacles are here represented as costmap instead of the internal ObstacleContainer.
+   * A feasible trajectory is remembered for the warm-start cache (if enabled).
    * @param costmap_model Pointer to the costmap model
    * @param footprint_spec The specification of the footprint of the robot in world coordinates
    * @param inscribed_radius The radius of the inscribed circle of the robot
@@ -668,6 +742,28 @@ protected:
    */
   void AddEdgesVelocityObstacleRatio();
 
+  /**
+   * @brief Add a fused velocity, kinematics and time optimal edge for each segment (non-holonomic robots only)
+   *
+   * Replaces AddEdgesVelocity, AddEdgesKinematicsDiffDrive / AddEdgesKinematicsCarlike and AddEdgesTimeOptimal
+   * if the parameter \c fuse_segment_edges is enabled.
+   * @see EdgeSegmentKinematics
+   * @see buildGraph
+   * @see optimizeGraph
+   */
+  void AddEdgesSegmentKinematics();
+
+  /**
+   * @brief Add an edge to the hyper-graph and register it in the edge registry of its cost term
+   * @param term cost term category of the edge (see computeCurrentCost)
+   * @param edge edge to be added (the optimizer takes the ownership)
+   */
+  void addEdge(CostTerm term, g2o::OptimizableGraph::Edge* edge)
+  {
+    optimizer_->addEdge(edge);
+    edge_registry_[static_cast<int>(term)].push_back(edge);
+  }
+
   //@}
 
 
@@ -677,14 +773,39 @@ protected:
    */
   boost::shared_ptr<g2o::SparseOptimizer> initOptimizer();
 
+  /**
+   * @brief Set the parameters and reset the boundary velocities (shared by initialize() and reinitialize())
+   */
+  void initializeParameters(const TebConfig& cfg, ObstContainer* obstacles, RobotFootprintModelPtr robot_model, TebVisualizationPtr visual, const ViaPointContainer* via_points);
+
+  /**
+   * @brief Move the last feasible trajectory (see isTrajectoryFeasible()) into the warm-start cache (if enabled)
+   * @see WarmStartCache
+   */
+  void commitToWarmStartCache();
+
+  /**
+   * @brief Initialize the (empty) trajectory from the closest matching solution in the warm-start cache
+   * @param start start pose of the new trajectory
+   * @param goal goal pose of the new trajectory
+   * @return \c true if the trajectory has been initialized, \c false if the cache is disabled or no matching solution is available
+   */
+  bool initTrajectoryFromWarmStartCache(const PoseSE2& start, const PoseSE2& goal);
+
 
   // external objects (store weak pointers)
   const TebConfig* cfg_; //!< Config class that stores and manages all related parameters
   ObstContainer* obstacles_; //!< Store obstacles that are relevant for planning
   const ViaPointContainer* via_points_; //!< Store via points for planning
   std::vector<ObstContainer> obstacles_per_vertex_; //!< Store the obstacles associated with the n-1 initial vertices
+  ObstacleAssociationCache obstacle_association_cache_; //!< Reuse the obstacle association across the outer iterations of optimizeTEB()
+  const ObstacleSpatialIndex* obstacle_index_; //!< Optional spatial index of the obstacles (see setObstacleIndex())
 
   double cost_; //!< Store cost value of the current hyper-graph
+  TebCostBreakdown cost_breakdown_; //!< Store the cost of the current hyper-graph per cost term
+  TrajectoryFingerprint fingerprint_; //!< Fingerprint of the trajectory computed together with the cost
+  std::vector<g2o::OptimizableGraph::Edge*> edge_registry_[NUM_COST_TERMS]; //!< Edges of the current hyper-graph grouped by cost term (filled in buildGraph)
+  std::vector<EdgeSegmentKinematics*> segment_kinematics_edges_; //!< Fused segment edges of the current hyper-graph (they contribute to several cost terms)
   RotType prefer_rotdir_; //!< Store whether to prefer a specific initial rotation in optimization (might be activated in case the robot oscillates)
 
   // internal objects (memory management owned)
@@ -694,6 +815,7 @@ protected:
   boost::shared_ptr<g2o::SparseOptimizer> optimizer_; //!< 用于轨迹优化的g2o优化器
   std::pair<bool, geometry_msgs::Twist> vel_start_; //!< 存储初始位姿时带的速度
   std::pair<bool, geometry_msgs::Twist> vel_goal_; //!< 存储目标位姿时带的速度
+  WarmStartCache warm_start_cache_; //!< Recently optimized trajectories used to seed a reinitialization
 
   bool initialized_; //!< Keeps track about the correct initialization of this class
   bool optimized_; //!< This variable is \c true as long as the last optimization has been completed successful
@@ -196,6 +196,17 @@ public:
    * @brief Returns true if the planner has diverged.
    */
   virtual bool hasDiverged() const = 0;
+
+  /**
+   * @brief Compute the axis-aligned bounding box of all trajectories currently maintained by the planner
+   * @param[out] min_corner lower left corner of the bounding box
+   * @param[out] max_corner upper right corner of the bounding box
+   * @return \c true if the bounding box is valid, \c false if no trajectory is available (or not implemented)
+   */
+  virtual bool getTrajectoryBoundingBox(Eigen::Vector2d& min_corner, Eigen::Vector2d& max_corner) const
+  {
+    return false;
+  }
                 
 };
 
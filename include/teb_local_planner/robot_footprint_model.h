@@ -44,9 +44,27 @@
 #include <teb_local_planner/obstacles.h>
 #include <visualization_msgs/Marker.h>
 
+#include <limits>
+
 namespace teb_local_planner
 {
 
+/**
+ * @brief Types of the built-in robot footprint models
+ *
+ * The type selects the inlined distance kernels of the obstacle/footprint dispatch table (see calculateRobotObstacleDistance()).
+ * User-defined footprint models, including subclasses of the built-in models, are of type \c Custom and use the virtual interface.
+ */
+enum class FootprintType
+{
+  Point,
+  Circular,
+  TwoCircles,
+  Line,
+  Polygon,
+  Custom
+};
+
 /**
  * @class BaseRobotFootprintModel
  * @brief Abstract class that defines the interface for robot footprint/contour models
@@ -61,8 +79,9 @@ public:
   
   /**
     * @brief Default constructor of the abstract obstacle class
+    * @param type footprint type (only built-in models pass a type other than FootprintType::Custom)
     */
-  BaseRobotFootprintModel()
+  BaseRobotFootprintModel(FootprintType type = FootprintType::Custom) : type_(type)
   {
   }
   
@@ -82,6 +101,21 @@ public:
     */
   virtual double calculateDistance(const PoseSE2& current_pose, const Obstacle* obstacle) const = 0;
 
+  /**
+    * @brief Calculate the distance between the robot and an obstacle with an optional warm start
+    *
+    * Convex polygonal footprints and obstacles use the witness vertices of the previous query to speed up
+    * the distance calculation (see distance_convex_polygon_to_polygon_2d()). The default implementation ignores the witness.
+    * @param current_pose Current robot pose
+    * @param obstacle Pointer to the obstacle
+    * @param[in,out] witness witness vertices of the previous query with the same obstacle (updated)
+    * @return Euclidean distance to the robot
+    */
+  virtual double calculateDistance(const PoseSE2& current_pose, const Obstacle* obstacle, ConvexDistanceWitness* witness) const
+  {
+    return calculateDistance(current_pose, obstacle);
+  }
+
   /**
     * @brief Estimate the distance between the robot and the predicted location of an obstacle at time t
     * @param current_pose robot pose, from which the distance to the obstacle is estimated
@@ -109,6 +143,43 @@ public:
    */
   virtual double getInscribedRadius() = 0;
 
+  /**
+   * @brief Compute the circumscribed radius of the footprint model
+   *
+   * No point of the footprint is further away from the robot center (0,0).
+   * The default implementation returns infinity (unknown extent), which disables the bounding circle
+   * tests (e.g. isBeyondDistance()) for footprint models that do not override it.
+   * @return circumscribed radius
+   */
+  virtual double getCircumscribedRadius() const {return std::numeric_limits<double>::infinity();}
+
+  /**
+   * @brief Check with a single squared-distance comparison whether an obstacle is certainly further away than \c dist
+   *
+   * The footprint is bounded by the circumscribed circle and the obstacle by its bounding circle (see Obstacle::isBeyond()).
+   * If \c true is returned, calculateDistance() is guaranteed to be larger than \c dist.
+   * @param current_pose Current robot pose
+   * @param obstacle Pointer to the obstacle
+   * @param dist distance threshold
+   * @return \c true if the obstacle is further away than \c dist
+   */
+  bool isBeyondDistance(const PoseSE2& current_pose, const Obstacle* obstacle, double dist) const
+  {
+    return obstacle->isBeyond(current_pose.position(), getCircumscribedRadius(), dist);
+  }
+
+  /**
+   * @brief Get the type of the footprint model
+   *
+   * Subclasses of the built-in models might override calculateDistance(), hence the built-in type
+   * is only returned if the dynamic type is exactly the built-in class.
+   * @return built-in type or FootprintType::Custom for user-defined models
+   */
+  inline FootprintType getType() const;
+
+protected:
+
+  FootprintType type_; //!< Store the footprint type passed by the built-in class (inherited by its subclasses, see getType())
 	
 
 public:	
@@ -138,13 +209,13 @@ public:
   /**
     * @brief Default constructor of the abstract obstacle class
     */
-  PointRobotFootprint() {}
+  PointRobotFootprint() : BaseRobotFootprintModel(FootprintType::Point) {}
 
   /**
     * @brief Default constructor of the abstract obstacle class
     * @param min_obstacle_dist Minimum obstacle distance
     */
-  PointRobotFootprint(const double min_obstacle_dist) : min_obstacle_dist_(min_obstacle_dist) {}
+  PointRobotFootprint(const double min_obstacle_dist) : BaseRobotFootprintModel(FootprintType::Point), min_obstacle_dist_(min_obstacle_dist) {}
   
   /**
    * @brief Virtual destructor.
@@ -159,7 +230,21 @@ public:
     */
   virtual double calculateDistance(const PoseSE2& current_pose, const Obstacle* obstacle) const
   {
-    return obstacle->getMinimumDistance(current_pose.position());
+    return calculateDistanceTo(current_pose, *obstacle);
+  }
+
+  /**
+    * @brief Calculate the distance between the robot and an obstacle of a known type (non-virtual, see calculateRobotObstacleDistance())
+    * @param current_pose Current robot pose
+    * @param obstacle obstacle
+    * @param witness unused (only polygonal footprints use the witness)
+    * @tparam ObstacleT built-in obstacle type (or Obstacle for virtual dispatch)
+    * @return Euclidean distance to the robot
+    */
+  template <typename ObstacleT>
+  double calculateDistanceTo(const PoseSE2& current_pose, const ObstacleT& obstacle, ConvexDistanceWitness* witness = NULL) const
+  {
+    return ObstacleDistance<ObstacleT>::toPoint(obstacle, current_pose.position());
   }
   
   /**
@@ -180,6 +265,12 @@ public:
    */
   virtual double getInscribedRadius() {return 0.0;}
 
+  /**
+   * @brief Compute the circumscribed radius of the footprint model
+   * @return circumscribed radius
+   */
+  virtual double getCircumscribedRadius() const {return 0.0;}
+
   /**
    * @brief Visualize the robot using a markers
    * 
@@ -241,7 +332,7 @@ public:
     * @brief Default constructor of the abstract obstacle class
     * @param radius radius of the robot
     */
-  CircularRobotFootprint(double radius) : radius_(radius) { }
+  CircularRobotFootprint(double radius) : BaseRobotFootprintModel(FootprintType::Circular), radius_(radius) { }
   
   /**
    * @brief Virtual destructor.
@@ -262,7 +353,21 @@ public:
     */
   virtual double calculateDistance(const PoseSE2& current_pose, const Obstacle* obstacle) const
   {
-    return obstacle->getMinimumDistance(current_pose.position()) - radius_;
+    return calculateDistanceTo(current_pose, *obstacle);
+  }
+
+  /**
+    * @brief Calculate the distance between the robot and an obstacle of a known type (non-virtual, see calculateRobotObstacleDistance())
+    * @param current_pose Current robot pose
+    * @param obstacle obstacle
+    * @param witness unused (only polygonal footprints use the witness)
+    * @tparam ObstacleT built-in obstacle type (or Obstacle for virtual dispatch)
+    * @return Euclidean distance to the robot
+    */
+  template <typename ObstacleT>
+  double calculateDistanceTo(const PoseSE2& current_pose, const ObstacleT& obstacle, ConvexDistanceWitness* witness = NULL) const
+  {
+    return ObstacleDistance<ObstacleT>::toPoint(obstacle, current_pose.position()) - radius_;
   }
 
   /**
@@ -303,6 +408,12 @@ public:
    */
   virtual double getInscribedRadius() {return radius_;}
 
+  /**
+   * @brief Compute the circumscribed radius of the footprint model
+   * @return circumscribed radius
+   */
+  virtual double getCircumscribedRadius() const {return radius_;}
+
 private:
     
   double radius_;
@@ -325,7 +436,7 @@ public:
     * @param rear_radius radius of the front circle
     */
   TwoCirclesRobotFootprint(double front_offset, double front_radius, double rear_offset, double rear_radius) 
-    : front_offset_(front_offset), front_radius_(front_radius), rear_offset_(rear_offset), rear_radius_(rear_radius) { }
+    : BaseRobotFootprintModel(FootprintType::TwoCircles), front_offset_(front_offset), front_radius_(front_radius), rear_offset_(rear_offset), rear_radius_(rear_radius) { }
   
   /**
    * @brief Virtual destructor.
@@ -349,10 +460,24 @@ public:
     * @return Euclidean distance to the robot
     */
   virtual double calculateDistance(const PoseSE2& current_pose, const Obstacle* obstacle) const
+  {
+    return calculateDistanceTo(current_pose, *obstacle);
+  }
+
+  /**
+    * @brief Calculate the distance between the robot and an obstacle of a known type (non-virtual, see calculateRobotObstacleDistance())
+    * @param current_pose Current robot pose
+    * @param obstacle obstacle
+    * @param witness unused (only polygonal footprints use the witness)
+    * @tparam ObstacleT built-in obstacle type (or Obstacle for virtual dispatch)
+    * @return Euclidean distance to the robot
+    */
+  template <typename ObstacleT>
+  double calculateDistanceTo(const PoseSE2& current_pose, const ObstacleT& obstacle, ConvexDistanceWitness* witness = NULL) const
   {
     Eigen::Vector2d dir = current_pose.orientationUnitVec();
-    double dist_front = obstacle->getMinimumDistance(current_pose.position() + front_offset_*dir) - front_radius_;
-    double dist_rear = obstacle->getMinimumDistance(current_pose.position() - rear_offset_*dir) - rear_radius_;
+    double dist_front = ObstacleDistance<ObstacleT>::toPoint(obstacle, current_pose.position() + front_offset_*dir) - front_radius_;
+    double dist_rear = ObstacleDistance<ObstacleT>::toPoint(obstacle, current_pose.position() - rear_offset_*dir) - rear_radius_;
     return std::min(dist_front, dist_rear);
   }
 
@@ -421,6 +546,15 @@ public:
       return std::min(min_longitudinal, min_lateral);
   }
 
+  /**
+   * @brief Compute the circumscribed radius of the footprint model
+   * @return circumscribed radius
+   */
+  virtual double getCircumscribedRadius() const
+  {
+      return std::max(std::fabs(front_offset_) + front_radius_, std::fabs(rear_offset_) + rear_radius_);
+  }
+
 private:
     
   double front_offset_;
@@ -445,7 +579,7 @@ public:
     * @param line_start start coordinates (only x and y) of the line (w.r.t. robot center at (0,0))
     * @param line_end end coordinates (only x and y) of the line (w.r.t. robot center at (0,0))
     */
-  LineRobotFootprint(const geometry_msgs::Point& line_start, const geometry_msgs::Point& line_end)
+  LineRobotFootprint(const geometry_msgs::Point& line_start, const geometry_msgs::Point& line_end) : BaseRobotFootprintModel(FootprintType::Line)
   {
     setLine(line_start, line_end);
   }
@@ -455,7 +589,8 @@ public:
   * @param line_start start coordinates (only x and y) of the line (w.r.t. robot center at (0,0))
   * @param line_end end coordinates (only x and y) of the line (w.r.t. robot center at (0,0))
   */
-  LineRobotFootprint(const Eigen::Vector2d& line_start, const Eigen::Vector2d& line_end, const double min_obstacle_dist) : min_obstacle_dist_(min_obstacle_dist)
+  LineRobotFootprint(const Eigen::Vector2d& line_start, const Eigen::Vector2d& line_end, const double min_obstacle_dist)
+    : BaseRobotFootprintModel(FootprintType::Line), min_obstacle_dist_(min_obstacle_dist)
   {
     setLine(line_start, line_end);
   }
@@ -494,11 +629,25 @@ public:
     * @return Euclidean distance to the robot
     */
   virtual double calculateDistance(const PoseSE2& current_pose, const Obstacle* obstacle) const
+  {
+    return calculateDistanceTo(current_pose, *obstacle);
+  }
+
+  /**
+    * @brief Calculate the distance between the robot and an obstacle of a known type (non-virtual, see calculateRobotObstacleDistance())
+    * @param current_pose Current robot pose
+    * @param obstacle obstacle
+    * @param witness unused (only polygonal footprints use the witness)
+    * @tparam ObstacleT built-in obstacle type (or Obstacle for virtual dispatch)
+    * @return Euclidean distance to the robot
+    */
+  template <typename ObstacleT>
+  double calculateDistanceTo(const PoseSE2& current_pose, const ObstacleT& obstacle, ConvexDistanceWitness* witness = NULL) const
   {
     Eigen::Vector2d line_start_world;
     Eigen::Vector2d line_end_world;
     transformToWorld(current_pose, line_start_world, line_end_world);
-    return obstacle->getMinimumDistance(line_start_world, line_end_world);
+    return ObstacleDistance<ObstacleT>::toSegment(obstacle, line_start_world, line_end_world);
   }
 
   /**
@@ -599,6 +748,15 @@ public:
       return 0.0; // lateral distance = 0.0
   }
 
+  /**
+   * @brief Compute the circumscribed radius of the footprint model
+   * @return circumscribed radius
+   */
+  virtual double getCircumscribedRadius() const
+  {
+      return std::max(line_start_.norm(), line_end_.norm());
+  }
+
 private:
     
   /**
@@ -642,7 +800,7 @@ public:
     * @brief Default constructor of the abstract obstacle class
     * @param vertices footprint vertices (only x and y) around the robot center (0,0) (do not repeat the first and last vertex at the end)
     */
-  PolygonRobotFootprint(const Point2dContainer& vertices) : vertices_(vertices) { }
+  PolygonRobotFootprint(const Point2dContainer& vertices) : BaseRobotFootprintModel(FootprintType::Polygon), vertices_(vertices) {calcCircumscribedRadius(); convex_ = check_polygon_convexity_2d(vertices_);}
   
   /**
    * @brief Virtual destructor.
@@ -653,7 +811,12 @@ public:
    * @brief Set vertices of the contour/footprint
    * @param vertices footprint vertices (only x and y) around the robot center (0,0) (do not repeat the first and last vertex at the end)
    */
-  void setVertices(const Point2dContainer& vertices) {vertices_ = vertices;}
+  void setVertices(const Point2dContainer& vertices) {vertices_ = vertices; calcCircumscribedRadius(); convex_ = check_polygon_convexity_2d(vertices_);}
+
+  /**
+   * @brief Check whether the footprint is convex (determined in the constructor and setVertices())
+   */
+  bool isConvex() const {return convex_;}
   
   /**
     * @brief Calculate the distance between the robot and an obstacle
@@ -663,9 +826,37 @@ public:
     */
   virtual double calculateDistance(const PoseSE2& current_pose, const Obstacle* obstacle) const
   {
-    Point2dContainer polygon_world(vertices_.size());
+    return calculateDistance(current_pose, obstacle, NULL);
+  }
+
+  /**
+    * @brief Calculate the distance between the robot and an obstacle with an optional warm start
+    * @param current_pose Current robot pose
+    * @param obstacle Pointer to the obstacle
+    * @param[in,out] witness witness vertices of the previous query (only used if the footprint and the obstacle are convex)
+    * @return Euclidean distance to the robot
+    */
+  virtual double calculateDistance(const PoseSE2& current_pose, const Obstacle* obstacle, ConvexDistanceWitness* witness) const
+  {
+    return calculateDistanceTo(current_pose, *obstacle, witness);
+  }
+
+  /**
+    * @brief Calculate the distance between the robot and an obstacle of a known type (non-virtual, see calculateRobotObstacleDistance())
+    * @param current_pose Current robot pose
+    * @param obstacle obstacle
+    * @param witness witness vertices of the previous query (only used if the footprint and the obstacle are convex)
+    * @tparam ObstacleT built-in obstacle type (or Obstacle for virtual dispatch)
+    * @return Euclidean distance to the robot
+    */
+  template <typename ObstacleT>
+  double calculateDistanceTo(const PoseSE2& current_pose, const ObstacleT& obstacle, ConvexDistanceWitness* witness = NULL) const
+  {
+    PolygonSoA polygon_world;
     transformToWorld(current_pose, polygon_world);
-    return obstacle->getMinimumDistance(polygon_world);
+    if (convex_)
+      return ObstacleDistance<ObstacleT>::toConvexPolygon(obstacle, polygon_world, witness);
+    return ObstacleDistance<ObstacleT>::toPolygon(obstacle, polygon_world);
   }
 
   /**
@@ -747,6 +938,12 @@ public:
      return std::min(min_dist, std::min(vertex_dist, edge_dist));
   }
 
+  /**
+   * @brief Compute the circumscribed radius of the footprint model
+   * @return circumscribed radius
+   */
+  virtual double getCircumscribedRadius() const {return circumscribed_radius_;}
+
 private:
     
   /**
@@ -765,12 +962,98 @@ private:
     }
   }
 
+  /**
+    * @brief Transforms a polygon to the world frame (SoA layout for the batch distance kernels)
+    * @param current_pose Current robot pose
+    * @param[out] polygon_world polygon in the world frame
+    */
+  void transformToWorld(const PoseSE2& current_pose, PolygonSoA& polygon_world) const
+  {
+    double cos_th = std::cos(current_pose.theta());
+    double sin_th = std::sin(current_pose.theta());
+    polygon_world.resize((int)vertices_.size());
+    for (std::size_t i=0; i<vertices_.size(); ++i)
+    {
+      polygon_world.setVertex((int)i, current_pose.x() + cos_th * vertices_[i].x() - sin_th * vertices_[i].y(),
+                                      current_pose.y() + sin_th * vertices_[i].x() + cos_th * vertices_[i].y());
+    }
+  }
+
+  /**
+    * @brief Compute the circumscribed radius once the vertices changed (it is queried for each obstacle distance)
+    */
+  void calcCircumscribedRadius()
+  {
+    circumscribed_radius_ = 0.0;
+    for (const Eigen::Vector2d& vertex : vertices_)
+      circumscribed_radius_ = std::max(circumscribed_radius_, vertex.norm());
+  }
+
   Point2dContainer vertices_;
+  double circumscribed_radius_; //!< Cached circumscribed radius (see calcCircumscribedRadius())
+  bool convex_; //!< Store whether the footprint is convex (see check_polygon_convexity_2d())
   
 };
 
 
 
+inline FootprintType BaseRobotFootprintModel::getType() const
+{
+  // see Obstacle::getType()
+  static const std::type_info* const builtin_types[(int)FootprintType::Custom] = {
+    &typeid(PointRobotFootprint), &typeid(CircularRobotFootprint), &typeid(TwoCirclesRobotFootprint), &typeid(LineRobotFootprint), &typeid(PolygonRobotFootprint)
+  };
+  return type_ != FootprintType::Custom && &typeid(*this) == builtin_types[(int)type_] ? type_ : FootprintType::Custom;
+}
+
+
+//! Distance kernel of the dispatch table for one footprint model and one obstacle type
+template <typename FootprintT, typename ObstacleT>
+double robotObstacleDistanceKernel(const BaseRobotFootprintModel& robot_model, const PoseSE2& current_pose, const Obstacle* obstacle, ConvexDistanceWitness* witness)
+{
+  return static_cast<const FootprintT&>(robot_model).calculateDistanceTo(current_pose, static_cast<const ObstacleT&>(*obstacle), witness);
+}
+
+/**
+ * @brief Calculate the distance between the robot and an obstacle without virtual calls for built-in types
+ *
+ * BaseRobotFootprintModel::calculateDistance() and Obstacle::getMinimumDistance() are two virtual calls per query
+ * that prevent inlining in the innermost loops of the obstacle association and the obstacle edges.
+ * For the built-in footprint models and obstacles (see FootprintType and ObstacleType) this function looks up a kernel
+ * in which both are inlined. User-defined types (including subclasses of the built-in types) are handled via the virtual interface.
+ * @param robot_model robot footprint model
+ * @param current_pose Current robot pose
+ * @param obstacle Pointer to the obstacle
+ * @param[in,out] witness optional witness vertices of the previous query (see BaseRobotFootprintModel::calculateDistance())
+ * @return Euclidean distance to the robot
+ */
+inline double calculateRobotObstacleDistance(const BaseRobotFootprintModel& robot_model, const PoseSE2& current_pose, const Obstacle* obstacle,
+                                             ConvexDistanceWitness* witness = NULL)
+{
+  typedef double (*DistanceKernel)(const BaseRobotFootprintModel&, const PoseSE2&, const Obstacle*, ConvexDistanceWitness*);
+
+  #define TEB_OBSTACLE_DISTANCE_KERNELS(FootprintT) \
+    {&robotObstacleDistanceKernel<FootprintT, PointObstacle>, &robotObstacleDistanceKernel<FootprintT, CircularObstacle>, \
+     &robotObstacleDistanceKernel<FootprintT, LineObstacle>, &robotObstacleDistanceKernel<FootprintT, PillObstacle>, \
+     &robotObstacleDistanceKernel<FootprintT, PolygonObstacle>}
+
+  // rows and columns follow the order of FootprintType and ObstacleType
+  static const DistanceKernel kernels[(int)FootprintType::Custom][(int)ObstacleType::Custom] = {
+    TEB_OBSTACLE_DISTANCE_KERNELS(PointRobotFootprint),
+    TEB_OBSTACLE_DISTANCE_KERNELS(CircularRobotFootprint),
+    TEB_OBSTACLE_DISTANCE_KERNELS(TwoCirclesRobotFootprint),
+    TEB_OBSTACLE_DISTANCE_KERNELS(LineRobotFootprint),
+    TEB_OBSTACLE_DISTANCE_KERNELS(PolygonRobotFootprint)
+  };
+
+  #undef TEB_OBSTACLE_DISTANCE_KERNELS
+
+  const FootprintType footprint_type = robot_model.getType();
+  const ObstacleType obstacle_type = obstacle->getType();
+  if (footprint_type == FootprintType::Custom || obstacle_type == ObstacleType::Custom)
+    return robot_model.calculateDistance(current_pose, obstacle, witness);
+  return kernels[(int)footprint_type][(int)obstacle_type](robot_model, current_pose, obstacle, witness);
+}
 
 
 } // namespace teb_local_planner
@@ -87,6 +87,8 @@ public:
     double min_resolution_collision_check_angular; //! Min angular resolution used during the costmap collision check. If not respected, intermediate samples are added. [rad]
     int control_look_ahead_poses; //! Index of the pose used to extract the velocity command
     int prevent_look_ahead_poses_near_goal; //! Prevents control_look_ahead_poses to look within this many poses of the goal in order to prevent overshoot & oscillation when xy_goal_tolerance is very small
+    int warm_start_cache_size; //!< Number of recently optimized trajectories that are cached to seed a reinitialization (new goal or planner reset) [0: disabled]
+    double warm_start_cache_resolution; //!< Distance up to which the static obstacles along a cached trajectory must match the current ones for reusing it [m]
   } trajectory; //!< Trajectory related parameters
 
   //! Robot related parameters
@@ -127,10 +129,14 @@ public:
     bool include_dynamic_obstacles; //!< Specify whether the movement of dynamic obstacles should be predicted by a constant velocity model (this also effects homotopy class planning); If false, all obstacles are considered to be static.
     bool include_costmap_obstacles; //!< Specify whether the obstacles in the costmap should be taken into account directly
     double costmap_obstacles_behind_robot_dist; //!< Limit the occupied local costmap obstacles taken into account for planning behind the robot (specify distance in meters)
+    bool costmap_obstacles_roi; //!< If true, only the part of the local costmap around the current trajectories and the reference plan (inflated by obstacle_association_cutoff_factor*min_obstacle_dist plus the circumscribed radius of the footprint model) is scanned for obstacles
+    double costmap_obstacles_cluster_resolution; //!< If positive (and no costmap_converter plugin is loaded), occupied costmap cells are downsampled with this voxel size and clustered into point, line and polygon obstacles [m]
+    double costmap_obstacles_cluster_max_extent; //!< Maximum diameter of a single obstacle cluster (see costmap_obstacles_cluster_resolution) [m]
     int obstacle_poses_affected; //!< The obstacle position is attached to the closest pose on the trajectory to reduce computational effort, but take a number of neighbors into account as well
     bool legacy_obstacle_association; //!< If true, the old association strategy is used (for each obstacle, find the nearest TEB pose), otherwise the new one (for each teb pose, find only "relevant" obstacles).
     double obstacle_association_force_inclusion_factor; //!< The non-legacy obstacle association technique tries to connect only relevant obstacles with the discretized trajectory during optimization, all obstacles within a specifed distance are forced to be included (as a multiple of min_obstacle_dist), e.g. choose 2.0 in order to consider obstacles within a radius of 2.0*min_obstacle_dist.
     double obstacle_association_cutoff_factor; //!< See obstacle_association_force_inclusion_factor, but beyond a multiple of [value]*min_obstacle_dist all obstacles are ignored during optimization. obstacle_association_force_inclusion_factor is processed first.
+    double obstacle_association_cache_tolerance; //!< The non-legacy obstacle association of a pose is reused in the next outer iteration if the pose moved less than [value] meters and the association provably remains the same (0: always reassociate)
     std::string costmap_converter_plugin; //!< Define a plugin name of the costmap_converter package (costmap cells are converted to points/lines/polygons)
     bool costmap_converter_spin_thread; //!< If \c true, the costmap converter invokes its callback queue in a different thread
     int costmap_converter_rate; //!< The rate that defines how often the costmap_converter plugin processes the current costmap (the value should not be much higher than the costmap update rate)
@@ -172,6 +178,7 @@ public:
 
     double weight_adapt_factor; //!< Some special weights (currently 'weight_obstacle') are repeatedly scaled by this factor in each outer TEB iteration (weight_new = weight_old*factor); Increasing weights iteratively instead of setting a huge value a-priori leads to better numerical conditions of the underlying optimization problem.
     double obstacle_cost_exponent; //!< Exponent for nonlinear obstacle cost (cost = linear_cost * obstacle_cost_exponent). Set to 1 to disable nonlinear cost (default)
+    bool fuse_segment_edges; //!< Non-holonomic robots only: replace the velocity, kinematics and time optimal edges of each segment by a single fused edge with analytic Jacobian
   } optim; //!< Optimization related parameters
 
 
@@ -182,19 +189,25 @@ public:
     bool simple_exploration; //!< If true, distinctive trajectories are explored using a simple left-right approach (pass each obstacle on the left or right side) for path generation, otherwise sample possible roadmaps randomly in a specified region between start and goal.
     int max_number_classes; //!< Specify the maximum number of allowed alternative homotopy classes (limits computational effort)
     int max_number_plans_in_current_class; //!< Specify the maximum number of trajectories to try that are in the same homotopy class as the current trajectory (helps avoid local minima)
+    double duplicate_trajectory_distance; //!< Two trajectories of the same homotopy class are considered duplicates if the Fréchet distance of their fingerprints is below this value [m]. Duplicates of a kept trajectory are removed and switching between duplicates is not blocked by switching_blocking_period (0: disabled).
     double selection_cost_hysteresis; //!< Specify how much trajectory cost must a new candidate have w.r.t. a previously selected trajectory in order to be selected (selection if new_cost < old_cost*factor).
     double selection_prefer_initial_plan; //!< Specify a cost reduction in the interval (0,1) for the trajectory in the equivalence class of the initial plan.
     double selection_obst_cost_scale; //!< Extra scaling of obstacle cost terms just for selecting the 'best' candidate.
     double selection_viapoint_cost_scale; //!< Extra scaling of via-point cost terms just for selecting the 'best' candidate.
     bool selection_alternative_time_cost; //!< If true, time cost is replaced by the total transition time.
     double selection_dropping_probability; //!< At each planning cycle, TEBs other than the current 'best' one will be randomly dropped with this probability. Prevents becoming 'fixated' on sub-optimal alternative homotopies.
+    double selection_pruning_ratio; //!< The outer iterations are split into rounds of 1, 2, 4, ... iterations; after each round this fraction of the candidates with the highest cost is not optimized any further in the current cycle (successive halving). The current 'best' TEB and the one of the global plan always get all iterations (0: all candidates get all iterations).
     double switching_blocking_period; //!< Specify a time duration in seconds that needs to be expired before a switch to new equivalence class is allowed
 
     int roadmap_graph_no_samples; //! < Specify the number of samples generated for creating the roadmap graph, if simple_exploration is turend off.
     double roadmap_graph_area_width; //!< Random keypoints/waypoints are sampled in a rectangular region between start and goal. Specify the width of that region in meters.
     double roadmap_graph_area_length_scale; //!< The length of the rectangular region is determined by the distance between start and goal. This parameter further scales the distance such that the geometric center remains equal!
+    bool roadmap_graph_persistent; //!< Keep the roadmap samples (and their edge collision checks) across planning cycles and only replace samples that left the sampling area or are occupied
+    double roadmap_graph_boundary_bias; //!< Fraction of the new roadmap samples that are placed close to obstacle boundaries (Gaussian sampling), the others are distributed over the free space (0: free space only)
     double h_signature_prescaler; //!< Scale number of obstacle value in order to allow huge number of obstacles. Do not choose it extremly low, otherwise obstacles cannot be distinguished from each other (0.2<H<=1).
     double h_signature_threshold; //!< Two h-signatures are assumed to be equal, if both the difference of real parts and complex parts are below the specified threshold.
+    double h_signature_reuse_tolerance; //!< Reuse the equivalence class of a trajectory from a previous cycle if neither its poses [m] and time differences [s] nor the obstacles [m, m/s] changed by more than this tolerance (0: always recompute).
+    int h_signature_full_update_interval; //!< Update the h-signatures of existing trajectories incrementally (only segments and obstacles that moved by more than h_signature_reuse_tolerance) and recompute them from scratch every n-th cycle (0: always recompute). Not applied if dynamic obstacles are included.
 
     double obstacle_keypoint_offset; //!< If simple_exploration is turned on, this parameter determines the distance on the left and right side of the obstacle at which a new keypoint will be cretead (in addition to min_obstacle_dist).
     double obstacle_heading_threshold; //!< Specify the value of the normalized scalar product between obstacle heading and goal heading in order to take them (obstacles) into account for exploration [0,1]
@@ -264,6 +277,8 @@ public:
     trajectory.min_resolution_collision_check_angular = M_PI;
     trajectory.control_look_ahead_poses = 1;
     trajectory.prevent_look_ahead_poses_near_goal = 0;
+    trajectory.warm_start_cache_size = 0;
+    trajectory.warm_start_cache_resolution = 0.5;
 
     // Robot
 
@@ -297,10 +312,14 @@ public:
     obstacles.include_dynamic_obstacles = true;
     obstacles.include_costmap_obstacles = true;
     obstacles.costmap_obstacles_behind_robot_dist = 1.5;
+    obstacles.costmap_obstacles_roi = true;
+    obstacles.costmap_obstacles_cluster_resolution = 0;
+    obstacles.costmap_obstacles_cluster_max_extent = 1.0;
     obstacles.obstacle_poses_affected = 25;
     obstacles.legacy_obstacle_association = false;
     obstacles.obstacle_association_force_inclusion_factor = 1.5;
     obstacles.obstacle_association_cutoff_factor = 5;
+    obstacles.obstacle_association_cache_tolerance = 0.1;
     obstacles.costmap_converter_plugin = "";
     obstacles.costmap_converter_spin_thread = true;
     obstacles.costmap_converter_rate = 5;
@@ -336,6 +355,7 @@ public:
 
     optim.weight_adapt_factor = 2.0;
     optim.obstacle_cost_exponent = 1.0;
+    optim.fuse_segment_edges = false;
 
     // Homotopy Class Planner
 
@@ -343,20 +363,26 @@ public:
     hcp.enable_multithreading = true;
     hcp.simple_exploration = false;
     hcp.max_number_classes = 5;
+    hcp.duplicate_trajectory_distance = 0.1;
     hcp.selection_cost_hysteresis = 1.0;
     hcp.selection_prefer_initial_plan = 0.95;
     hcp.selection_obst_cost_scale = 100.0;
     hcp.selection_viapoint_cost_scale = 1.0;
     hcp.selection_alternative_time_cost = false;
     hcp.selection_dropping_probability = 0.0;
+    hcp.selection_pruning_ratio = 0.0;
 
     hcp.obstacle_keypoint_offset = 0.1;
     hcp.obstacle_heading_threshold = 0.45;
     hcp.roadmap_graph_no_samples = 15;
     hcp.roadmap_graph_area_width = 6; // [m]
     hcp.roadmap_graph_area_length_scale = 1.0;
+    hcp.roadmap_graph_persistent = true;
+    hcp.roadmap_graph_boundary_bias = 0.5;
     hcp.h_signature_prescaler = 1;
     hcp.h_signature_threshold = 0.1;
+    hcp.h_signature_reuse_tolerance = 0.01;
+    hcp.h_signature_full_update_interval = 10;
     hcp.switching_blocking_period = 0.0;
 
     hcp.viapoints_all_candidates = true;
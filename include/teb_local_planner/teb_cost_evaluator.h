@@ -0,0 +1,221 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Christoph Rösmann
+ *********************************************************************/
+
+
+#ifndef TEB_COST_EVALUATOR_H_
+#define TEB_COST_EVALUATOR_H_
+
+#include <teb_local_planner/teb_config.h>
+#include <teb_local_planner/misc.h>
+#include <teb_local_planner/obstacles.h>
+#include <teb_local_planner/timed_elastic_band.h>
+#include <teb_local_planner/robot_footprint_model.h>
+#include <teb_local_planner/obstacle_spatial_index.h>
+
+#include <geometry_msgs/Twist.h>
+
+#include <algorithm>
+
+namespace teb_local_planner
+{
+
+/**
+ * @brief Categories of the cost terms of the TEB optimization problem
+ *
+ * Each edge type added by TebOptimalPlanner::buildGraph belongs to exactly one category.
+ * The categories are used for the typed edge registries of the planner and for the cost breakdown.
+ */
+enum class CostTerm
+{
+  Obstacle = 0,          //!< EdgeObstacle, EdgeInflatedObstacle
+  DynamicObstacle,       //!< EdgeDynamicObstacle
+  ViaPoint,              //!< EdgeViaPoint
+  Velocity,              //!< EdgeVelocity, EdgeVelocityHolonomic
+  Acceleration,          //!< EdgeAcceleration* (including start and goal edges)
+  TimeOptimal,           //!< EdgeTimeOptimal (or the sum of all time differences if alternative_time_cost is enabled)
+  ShortestPath,          //!< EdgeShortestPath
+  Kinematics,            //!< EdgeKinematicsDiffDrive, EdgeKinematicsCarlike
+  PreferRotDir,          //!< EdgePreferRotDir
+  VelocityObstacleRatio  //!< EdgeVelocityObstacleRatio
+};
+
+//! Number of categories in CostTerm
+static const int NUM_COST_TERMS = 10;
+
+/**
+ * @brief Return a human readable name of a cost term (e.g. for logging)
+ * @param term cost term category
+ * @return name of the category, e.g. "obstacle"
+ */
+const char* costTermName(CostTerm term);
+
+/**
+ * @struct TebCostBreakdown
+ * @brief Cost of a trajectory split into the individual cost terms
+ *
+ * The values already contain the extra obstacle and via-point scaling passed to the cost computation.
+ */
+struct TebCostBreakdown
+{
+  double terms[NUM_COST_TERMS]; //!< Accumulated (scaled) cost per CostTerm
+  double total; //!< Sum of all terms
+
+  TebCostBreakdown() {clear();}
+
+  //! Reset all terms and the total cost to zero
+  void clear()
+  {
+    std::fill(terms, terms + NUM_COST_TERMS, 0.0);
+    total = 0;
+  }
+
+  //! Access the cost of a single category
+  double& operator[](CostTerm term) {return terms[static_cast<int>(term)];}
+
+  //! Access the cost of a single category (read-only)
+  double operator[](CostTerm term) const {return terms[static_cast<int>(term)];}
+};
+
+
+/**
+ * @brief Robustness of an obstacle association (see TebCostEvaluator::associateObstacles)
+ *
+ * The association of a pose remains identical as long as the robot-obstacle distances
+ * change by less than \c distance and the orientation by less than \c angle.
+ */
+struct ObstacleAssociationMargin
+{
+  double distance; //!< Minimum separation of all distances from the thresholds (resp. half the gap to the runner-up of each side)
+  double angle; //!< Minimum rotation that moves a candidate obstacle to the other side
+};
+
+
+/**
+ * @class TebCostEvaluator
+ * @brief Evaluate the cost of a trajectory without building a g2o hyper-graph
+ *
+ * The evaluator binds a single instance of every edge type to the vertices of the TimedElasticBand one after another
+ * and accumulates the weighted squared errors per CostTerm. The edges are neither allocated per pose nor
+ * added to an optimizer, hence the evaluation is considerably cheaper than buildGraph() followed by clearGraph().
+ * The edges and information matrices match TebOptimalPlanner::buildGraph with a weight multiplier of 1.
+ * @remarks Obstacles are always associated as in TebOptimalPlanner::AddEdgesObstacles (non-legacy association).
+ */
+class TebCostEvaluator
+{
+public:
+
+  /**
+   * @brief Construct the evaluator
+   * @param cfg Const reference to the TebConfig class for internal parameters
+   * @param robot_model Robot footprint model used for the obstacle distances
+   */
+  TebCostEvaluator(const TebConfig& cfg, const BaseRobotFootprintModel* robot_model);
+
+  /**
+   * @brief Assign the obstacles (static and dynamic) that should be considered
+   * @param obstacles Pointer to the obstacle container (might be NULL)
+   */
+  void setObstacles(const ObstContainer* obstacles) {obstacles_ = obstacles;}
+
+  /**
+   * @brief Assign the via-points that should be considered
+   * @param via_points Pointer to the via-point container (might be NULL)
+   */
+  void setViaPoints(const Point2dContainer* via_points) {via_points_ = via_points;}
+
+  /**
+   * @brief Set the initial velocity of the trajectory (NULL: not considered)
+   * @param vel_start Pointer to the start velocity, must be valid during evaluate()
+   */
+  void setVelocityStart(const geometry_msgs::Twist* vel_start) {vel_start_ = vel_start;}
+
+  /**
+   * @brief Set the final velocity of the trajectory (NULL: free goal velocity)
+   * @param vel_goal Pointer to the goal velocity, must be valid during evaluate()
+   */
+  void setVelocityGoal(const geometry_msgs::Twist* vel_goal) {vel_goal_ = vel_goal;}
+
+  /**
+   * @brief Set the preferred initial turning direction (see TebOptimalPlanner::setPreferredTurningDir)
+   * @param dir preferred turning direction
+   */
+  void setPreferredTurningDir(RotType dir) {prefer_rotdir_ = dir;}
+
+  /**
+   * @brief Compute the cost of a trajectory
+   * @param teb trajectory to evaluate (the vertices are only read, but bound to non-const edges)
+   * @param[out] breakdown cost per CostTerm
+   * @param obst_cost_scale Specify extra scaling for obstacle costs
+   * @param viapoint_cost_scale Specify extra scaling for via points
+   * @param alternative_time_cost Replace the cost for the time optimal objective by the actual transition time
+   * @return total cost (identical to \c breakdown.total)
+   */
+  double evaluate(TimedElasticBand& teb, TebCostBreakdown& breakdown, double obst_cost_scale=1.0,
+                  double viapoint_cost_scale=1.0, bool alternative_time_cost=false) const;
+
+  /**
+   * @brief Associate the relevant static obstacles with a single trajectory pose
+   *
+   * All obstacles closer than \c min_obstacle_dist*obstacle_association_force_inclusion_factor are added,
+   * in addition the closest obstacle on the left and on the right side within the cutoff distance.
+   * @param cfg Const reference to the TebConfig class for internal parameters
+   * @param robot_model Robot footprint model used for the distance computation
+   * @param pose trajectory pose
+   * @param obstacles obstacle container
+   * @param[out] relevant associated obstacles are appended to this container
+   * @param[out] margin if not NULL, the robustness of the association w.r.t. small pose changes is stored here
+   * @param index optional spatial index of \c obstacles (ignored if it does not cover the container) to visit nearby obstacles only
+   */
+  static void associateObstacles(const TebConfig& cfg, const BaseRobotFootprintModel& robot_model, const PoseSE2& pose,
+                                 const ObstContainer& obstacles, ObstContainer& relevant, ObstacleAssociationMargin* margin = NULL,
+                                 const ObstacleSpatialIndex* index = NULL);
+
+private:
+
+  const TebConfig* cfg_; //!< Config class that stores and manages all related parameters
+  const BaseRobotFootprintModel* robot_model_; //!< Robot model
+  const ObstContainer* obstacles_; //!< Obstacles that should be considered
+  const Point2dContainer* via_points_; //!< Via-points that should be considered
+  const geometry_msgs::Twist* vel_start_; //!< Initial velocity (NULL: not considered)
+  const geometry_msgs::Twist* vel_goal_; //!< Final velocity (NULL: free goal velocity)
+  RotType prefer_rotdir_; //!< Preferred initial turning direction
+};
+
+} // namespace teb_local_planner
+
+#endif /* TEB_COST_EVALUATOR_H_ */
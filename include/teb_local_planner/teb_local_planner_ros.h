@@ -54,6 +54,7 @@
 #include <teb_local_planner/homotopy_class_planner.h>
 #include <teb_local_planner/visualization.h>
 #include <teb_local_planner/recovery_behaviors.h>
+#include <teb_local_planner/obstacle_clustering.h>
 
 // message types
 #include <nav_msgs/Path.h>
@@ -227,13 +228,18 @@ protected:
 
   /**
     * @brief Update internal obstacle vector based on occupied costmap cells
-    * @remarks All occupied cells will be added as point obstacles.
+    * @remarks All occupied cells will be added as point obstacles, or clustered into point, line and polygon obstacles
+    *          if costmap_obstacles_cluster_resolution is positive (see clusterPointObstacles()).
     * @remarks All previous obstacles are cleared.
+    * @remarks If costmap_obstacles_roi is enabled, only cells within the bounding box of the current trajectories and
+    *          the reference plan (inflated by the obstacle association cutoff distance and the circumscribed radius of the
+    *          robot footprint model) are scanned.
+    * @param transformed_plan (local) portion of the global plan (which is already transformed to the planning frame)
     * @sa updateObstacleContainerWithCostmapConverter
     * @todo Include temporal coherence among obstacle msgs (id vector)
     * @todo Include properties for dynamic obstacles (e.g. using constant velocity model)
     */
-  void updateObstacleContainerWithCostmap();
+  void updateObstacleContainerWithCostmap(const std::vector<geometry_msgs::PoseStamped>& transformed_plan);
   
   /**
    * @brief Update internal obstacle vector based on polygons provided by a costmap_converter plugin
@@ -253,7 +259,8 @@ protected:
 
   /**
    * @brief Update internal via-point container based on the current reference plan
-   * @remarks All previous via-points will be cleared.
+   * @remarks Via-points of the previous call that are still located on the plan are kept (and snapped to the plan),
+   *          passed ones are removed and the remaining part of the plan is sampled w.r.t. \c min_separation.
    * @param transformed_plan (local) portion of the global plan (which is already transformed to the planning frame)
    * @param min_separation minimum separation between two consecutive via-points
    */
@@ -268,6 +275,14 @@ protected:
     * @param level Dynamic reconfigure level
     */
   void reconfigureCB(TebLocalPlannerReconfigureConfig& config, uint32_t level);
+
+  /**
+    * @brief Apply the most recent config received in reconfigureCB() (if any)
+    *
+    * The callback only publishes a snapshot of the new config, which is applied here by the planning thread
+    * in between two planning cycles. Hence, the config must not be locked during optimization.
+    */
+  void applyPendingReconfiguration();
   
   
    /**
@@ -402,6 +417,7 @@ private:
   // internal objects (memory management owned)
   PlannerInterfacePtr planner_; //!< Instance of the underlying optimal planner class
   ObstContainer obstacles_; //!< Obstacle vector that should be considered during local trajectory optimization
+  Point2dContainer costmap_obstacle_points_; //!< Occupied costmap cells collected for clustering (see costmap_obstacles_cluster_resolution)
   ViaPointContainer via_points_; //!< Container of via-points that should be considered during local trajectory optimization
   TebVisualizationPtr visualization_; //!< Instance of the visualization class (local/global plan, obstacles, ...)
   boost::shared_ptr<base_local_planner::CostmapModel> costmap_model_;  
@@ -417,12 +433,12 @@ private:
 
   boost::shared_ptr< dynamic_reconfigure::Server<TebLocalPlannerReconfigureConfig> > dynamic_recfg_; //!< Dynamic reconfigure server to allow config modifications at runtime
   ros::Subscriber custom_obst_sub_; //!< Subscriber for custom obstacles received via a ObstacleMsg.
-  boost::mutex custom_obst_mutex_; //!< Mutex that locks the obstacle array (multi-threaded)
-  costmap_converter::ObstacleArrayMsg custom_obstacle_msg_; //!< Copy of the most recent obstacle message
+  costmap_converter::ObstacleArrayMsg::ConstPtr custom_obstacle_msg_; //!< Most recent obstacle message (immutable snapshot, access with boost::atomic_load/atomic_store)
 
   ros::Subscriber via_points_sub_; //!< Subscriber for custom via-points received via a Path msg.
   bool custom_via_points_active_; //!< Keep track whether valid via-points have been received from via_points_sub_
-  boost::mutex via_point_mutex_; //!< Mutex that locks the via_points container (multi-threaded)
+  boost::shared_ptr<const ViaPointContainer> custom_via_points_; //!< Most recent custom via-points (immutable snapshot, access with boost::atomic_load/atomic_store)
+  boost::shared_ptr<const TebLocalPlannerReconfigureConfig> pending_reconfig_; //!< Config published by reconfigureCB() that is not yet applied (access with boost::atomic_exchange/atomic_store)
 
   PoseSE2 robot_pose_; //!< Store current robot pose
   PoseSE2 robot_goal_; //!< Store current robot goal
@@ -437,6 +453,7 @@ private:
   std::vector<geometry_msgs::Point> footprint_spec_; //!< Store the footprint of the robot 
   double robot_inscribed_radius_; //!< The radius of the inscribed circle of the robot (collision possible)
   double robot_circumscribed_radius; //!< The radius of the circumscribed circle of the robot
+  RobotFootprintModelPtr robot_model_; //!< Robot footprint model used for optimization (also passed to the planner)
   
   std::string global_frame_; //!< The frame in which the controller will run
   std::string robot_base_frame_; //!< Used as the base frame id of the robot
@@ -591,8 +591,23 @@ public:
    * @return Index to the closest pose in the pose sequence
    */
   int findClosestTrajectoryPose(const Obstacle& obstacle, double* distance = NULL) const;
-  
-  
+
+  /**
+   * @brief Associate an ordered sequence of reference points (e.g. via-points) with poses of the trajectory.
+   *
+   * In contrast to calling findClosestTrajectoryPose() for each point, this method does not search the whole trajectory
+   * for each point. \n
+   * The cumulative arc length of the reference points (starting at Pose(0)) is scaled to the length of the trajectory
+   * and serves as prior for the pose index. Starting from the prior, a local search moves the index in both directions
+   * as long as the euclidean distance decreases. The index of a point is never smaller than the index of the previous
+   * point plus \c min_idx_gap.
+   * @param ref_points ordered container of reference points (2D position vectors)
+   * @param[out] indices resulting pose index for each reference point (same size as \c ref_points, empty if the trajectory is empty)
+   * @param min_idx_gap minimum index difference between the poses associated with two subsequent reference points
+   */
+  void findClosestTrajectoryPoses(const Point2dContainer& ref_points, std::vector<int>& indices, int min_idx_gap = 0) const;
+
+
   /**
    * @brief Get the length of the internal pose sequence
    */
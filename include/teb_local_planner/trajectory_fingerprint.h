@@ -0,0 +1,179 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Christoph Rösmann
+ *********************************************************************/
+
+
+#ifndef TRAJECTORY_FINGERPRINT_H_
+#define TRAJECTORY_FINGERPRINT_H_
+
+#include <algorithm>
+#include <iterator>
+
+#include <Eigen/Core>
+
+namespace teb_local_planner
+{
+
+class TimedElasticBand;
+
+/**
+ * @class TrajectoryFingerprint
+ * @brief Compact geometric description of a trajectory for fast comparisons between candidates
+ *
+ * The positions of the trajectory are resampled equidistantly w.r.t. the arc length
+ * and stored as separate x and y arrays of fixed size (the time is ignored).
+ * Distances between two fingerprints are computed on these arrays only, independent of the number of poses.
+ */
+class TrajectoryFingerprint
+{
+public:
+
+  static const int NumSamples = 32; //!< Number of resampled positions
+
+  TrajectoryFingerprint() : length_(0), valid_(false) {}
+
+  /**
+   * @brief Compute the fingerprint of the poses of a trajectory
+   * @param teb trajectory
+   */
+  void compute(const TimedElasticBand& teb);
+
+  /**
+   * @brief Compute the fingerprint of a generic path
+   * @param path_start Iterator to the first element in the path
+   * @param path_end Iterator behind the last element in the path
+   * @param fun_position function accepting the dereference iterator type and that returns the position as Eigen::Vector2d
+   * @tparam BidirIter Bidirectional iterator type
+   * @tparam Fun function of the form Eigen::Vector2d (const T& point_type)
+   */
+  template<typename BidirIter, typename Fun>
+  void compute(BidirIter path_start, BidirIter path_end, Fun fun_position);
+
+  /**
+   * @brief Invalidate the fingerprint
+   */
+  void clear() {length_ = 0; valid_ = false;}
+
+  bool isValid() const {return valid_;} //!< \c true if the fingerprint has been computed from a non-empty path
+  double length() const {return length_;} //!< Arc length of the path [m]
+  const double* x() const {return x_;} //!< x-coordinates of the resampled positions
+  const double* y() const {return y_;} //!< y-coordinates of the resampled positions
+
+  /**
+   * @brief Root mean square distance between the corresponding resampled positions
+   * @param other fingerprint to compare with
+   * @return distance [m] (infinity if one of the fingerprints is invalid)
+   */
+  double distanceL2(const TrajectoryFingerprint& other) const;
+
+  /**
+   * @brief Discrete Fréchet distance between the resampled positions
+   *
+   * In contrast to distanceL2() the positions are not compared pairwise,
+   * hence paths that only differ in the distribution of the samples along the path are close.
+   * @param other fingerprint to compare with
+   * @return distance [m] (infinity if one of the fingerprints is invalid)
+   */
+  double distanceFrechet(const TrajectoryFingerprint& other) const;
+
+private:
+
+  double x_[NumSamples]; //!< x-coordinates of the resampled positions
+  double y_[NumSamples]; //!< y-coordinates of the resampled positions
+  double length_; //!< Arc length of the path
+  bool valid_;
+};
+
+
+template<typename BidirIter, typename Fun>
+void TrajectoryFingerprint::compute(BidirIter path_start, BidirIter path_end, Fun fun_position)
+{
+  clear();
+  if (path_start == path_end)
+    return;
+
+  Eigen::Vector2d prev = fun_position(*path_start);
+  for (BidirIter it = std::next(path_start); it != path_end; ++it)
+  {
+    Eigen::Vector2d current = fun_position(*it);
+    length_ += (current - prev).norm();
+    prev = current;
+  }
+
+  // walk along the segments (a, b), s_a denotes the arc length at a
+  const double step = length_ / (NumSamples - 1);
+  Eigen::Vector2d a = fun_position(*path_start);
+  Eigen::Vector2d b = a;
+  double s_a = 0;
+  double segment = 0;
+  BidirIter next = std::next(path_start);
+  if (next != path_end)
+  {
+    b = fun_position(*next);
+    segment = (b - a).norm();
+  }
+  for (int k = 0; k < NumSamples; ++k)
+  {
+    const double s = k == NumSamples-1 ? length_ : k * step;
+    while (next != path_end && s_a + segment < s)
+    {
+      s_a += segment;
+      a = b;
+      if (++next != path_end)
+      {
+        b = fun_position(*next);
+        segment = (b - a).norm();
+      }
+    }
+    if (next == path_end || segment <= 0)
+    {
+      x_[k] = a.x();
+      y_[k] = a.y();
+    }
+    else
+    {
+      const double t = std::min(std::max((s - s_a) / segment, 0.), 1.);
+      x_[k] = a.x() + t * (b.x() - a.x());
+      y_[k] = a.y() + t * (b.y() - a.y());
+    }
+  }
+  valid_ = true;
+}
+
+} // namespace teb_local_planner
+
+#endif /* TRAJECTORY_FINGERPRINT_H_ */
@@ -45,6 +45,8 @@
 #include <teb_local_planner/teb_config.h>
 #include <teb_local_planner/timed_elastic_band.h>
 #include <teb_local_planner/robot_footprint_model.h>
+#include <teb_local_planner/teb_cost_evaluator.h>
+#include <teb_local_planner/TrajectoryCostMsg.h>
 
 // ros stuff
 #include <ros/publisher.h>
@@ -161,10 +163,10 @@ public:
   void publishViaPoints(const std::vector< Eigen::Vector2d, Eigen::aligned_allocator<Eigen::Vector2d> >& via_points, const std::string& ns = "ViaPoints") const;
   
   /**
-   * @brief Publish a boost::adjacency_list (boost's graph datatype) via markers.
+   * @brief Publish a graph (boost graph interface, e.g. boost::adjacency_list or HcGraph) via markers.
    * @remarks Make sure that vertices of the graph contain a member \c pos as \c Eigen::Vector2d type
    *	      to query metric position values.
-   * @param graph Const reference to the boost::adjacency_list (graph)
+   * @param graph Const reference to the graph
    * @param ns_prefix Namespace prefix for the marker objects (the strings "Edges" and "Vertices" will be appended)
    * @tparam GraphType boost::graph object in which vertices has the field/member \c pos.
    */
@@ -227,8 +229,9 @@ public:
    * The feedback message also contains a list of active obstacles.
    * @param teb_planner the planning instance
    * @param obstacles Container of obstacles
+   * @param cost_breakdown cost of the trajectory (if NULL, the stored cost breakdown of \c teb_planner is published)
    */
-  void publishFeedbackMessage(const TebOptimalPlanner& teb_planner, const ObstContainer& obstacles);
+  void publishFeedbackMessage(const TebOptimalPlanner& teb_planner, const ObstContainer& obstacles, const TebCostBreakdown* cost_breakdown = NULL);
   
   //@}
 
@@ -241,6 +244,13 @@ public:
    * @return Color message
    */
   static std_msgs::ColorRGBA toColorMsg(double a, double r, double g, double b);
+
+  /**
+   * @brief Helper function to convert a cost breakdown into its message representation
+   * @param breakdown cost per cost term
+   * @param[out] cost_msg cost message
+   */
+  static void toCostMsg(const TebCostBreakdown& breakdown, TrajectoryCostMsg& cost_msg);
   
 protected:
   
@@ -68,30 +68,30 @@ void TebVisualization::publishGraph(const GraphType& graph, const std::string& n
   marker.action = visualization_msgs::Marker::ADD;
   
   GraphEdgeIterator it_edge, end_edges;
-  for (boost::tie(it_edge,end_edges) = boost::edges(graph); it_edge!=end_edges; ++it_edge)
+  for (boost::tie(it_edge,end_edges) = edges(graph); it_edge!=end_edges; ++it_edge)
   {
 #ifdef TRIANGLE
     geometry_msgs::Point point_start1;
-    point_start1.x = graph[boost::source(*it_edge,graph)].pos[0]+0.05;
-    point_start1.y = graph[boost::source(*it_edge,graph)].pos[1]-0.05;
+    point_start1.x = graph[source(*it_edge,graph)].pos[0]+0.05;
+    point_start1.y = graph[source(*it_edge,graph)].pos[1]-0.05;
     point_start1.z = 0;
     marker.points.push_back(point_start1);
     geometry_msgs::Point point_start2;
-    point_start2.x = graph[boost::source(*it_edge,graph)].pos[0]-0.05;
-    point_start2.y = graph[boost::source(*it_edge,graph)].pos[1]+0.05;
+    point_start2.x = graph[source(*it_edge,graph)].pos[0]-0.05;
+    point_start2.y = graph[source(*it_edge,graph)].pos[1]+0.05;
     point_start2.z = 0;
     marker.points.push_back(point_start2);
 
 #else
     geometry_msgs::Point point_start;
-    point_start.x = graph[boost::source(*it_edge,graph)].pos[0];
-    point_start.y = graph[boost::source(*it_edge,graph)].pos[1];
+    point_start.x = graph[source(*it_edge,graph)].pos[0];
+    point_start.y = graph[source(*it_edge,graph)].pos[1];
     point_start.z = 0;
     marker.points.push_back(point_start);
 #endif
     geometry_msgs::Point point_end;
-    point_end.x = graph[boost::target(*it_edge,graph)].pos[0];
-    point_end.y = graph[boost::target(*it_edge,graph)].pos[1];
+    point_end.x = graph[target(*it_edge,graph)].pos[0];
+    point_end.y = graph[target(*it_edge,graph)].pos[1];
     point_end.z = 0;
     marker.points.push_back(point_end);
     
@@ -132,7 +132,7 @@ void TebVisualization::publishGraph(const GraphType& graph, const std::string& n
   marker.action = visualization_msgs::Marker::ADD;
   
   GraphVertexIterator it_vert, end_vert;
-  for (boost::tie(it_vert,end_vert) = boost::vertices(graph); it_vert!=end_vert; ++it_vert)
+  for (boost::tie(it_vert,end_vert) = vertices(graph); it_vert!=end_vert; ++it_vert)
   {
     geometry_msgs::Point point;
     point.x = graph[*it_vert].pos[0];
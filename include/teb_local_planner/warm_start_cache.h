@@ -0,0 +1,155 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Christoph Rösmann
+ *********************************************************************/
+
+
+#ifndef WARM_START_CACHE_H_
+#define WARM_START_CACHE_H_
+
+#include <list>
+#include <vector>
+
+#include <teb_local_planner/pose_se2.h>
+#include <teb_local_planner/obstacles.h>
+#include <teb_local_planner/timed_elastic_band.h>
+
+namespace teb_local_planner
+{
+
+/**
+ * @class WarmStartCache
+ * @brief Small LRU cache of recently optimized trajectories used to seed a reinitialization
+ *
+ * If the goal is moved further than \c force_reinit_new_goal_dist or the planner is cleared after a failure,
+ * the trajectory would be reinitialized from a straight line (resp. the reference plan) and must re-converge from scratch.
+ * Instead, a cached solution that passes the new start and the new goal is pruned at both ends and attached to them.
+ * This covers the trajectory that has just been discarded (e.g. the goal moved back along the current path)
+ * as well as a goal that is visited again later. \n
+ * Trajectories are first remembered (cheap copy after each feasible trajectory) and only committed
+ * to the cache (including a coarse copy of the static obstacle layout) in case they are about to be discarded.
+ * A cached trajectory is only reused if the static obstacles along its path did not change (compared by distance,
+ * so that a moving costmap window does not invalidate the entry).
+ */
+class WarmStartCache
+{
+public:
+
+  /**
+   * @brief Construct an empty cache
+   */
+  WarmStartCache() : has_pending_(false) {}
+
+  /**
+   * @brief Remember the current trajectory as candidate for the next commit() (the previous candidate is overwritten)
+   * @param teb feasible trajectory
+   */
+  void remember(const TimedElasticBand& teb);
+
+  /**
+   * @brief Move the remembered trajectory into the cache (evicting the least recently used entry if required)
+   * @param obstacles current obstacle container (might be NULL)
+   * @param layout_corridor distance to the path within which static obstacles must match (see seed()) [m]
+   * @param layout_tolerance distance up to which static obstacles are considered as unchanged [m]
+   * @param capacity maximum number of cached trajectories
+   */
+  void commit(const ObstContainer* obstacles, double layout_corridor, double layout_tolerance, std::size_t capacity);
+
+  /**
+   * @brief Seed a trajectory from the cached solution with the closest goal
+   *
+   * Only entries that pass the new start and (afterwards) the new goal within \c max_goal_dist are considered.
+   * The pose matched with the goal must not deviate more than \c max_goal_angular from the goal orientation
+   * and the static obstacles within \c layout_corridor of the reused path segment must match the cached ones.
+   * The selected entry is pruned to the reused segment and becomes the most recently used one.
+   * @param start new start pose
+   * @param goal new goal pose
+   * @param obstacles current obstacle container (might be NULL)
+   * @param layout_corridor distance to the reused path segment within which static obstacles must match [m]
+   * @param layout_tolerance distance up to which static obstacles are considered as unchanged [m]
+   * @param max_goal_dist maximum translational separation between the cached path and the new start / goal
+   * @param max_goal_angular maximum angular separation between the matched pose and the new goal
+   * @param min_samples minimum number of samples of the seeded trajectory
+   * @param[out] teb trajectory to be initialized (only modified on success)
+   * @return \c true if the trajectory has been seeded, \c false otherwise
+   */
+  bool seed(const PoseSE2& start, const PoseSE2& goal, const ObstContainer* obstacles, double layout_corridor, double layout_tolerance,
+            double max_goal_dist, double max_goal_angular, int min_samples, TimedElasticBand& teb);
+
+  /**
+   * @brief Remove all cached trajectories
+   */
+  void clear() {entries_.clear(); has_pending_ = false;}
+
+  /**
+   * @brief Number of cached trajectories
+   */
+  std::size_t size() const {return entries_.size();}
+
+protected:
+
+  //! Compact copy of a feasible trajectory
+  struct Entry
+  {
+    std::vector< PoseSE2, Eigen::aligned_allocator<PoseSE2> > poses;
+    std::vector<double> timediffs;
+    Point2dContainer layout; //!< Static obstacle centroids thinned out to one per \c layout_tolerance grid cell
+  };
+
+  /**
+   * @brief Collect the centroids of all static obstacles, thinned out to one point per grid cell
+   * @param obstacles obstacle container (might be NULL)
+   * @param tolerance grid resolution [m]
+   * @param[out] layout thinned centroids
+   */
+  static void computeObstacleLayout(const ObstContainer* obstacles, double tolerance, Point2dContainer& layout);
+
+  /**
+   * @brief Check if two layouts agree in the vicinity of the path segment \c [begin, end] of the cached entry
+   *
+   * Each point of either layout that is closer than \c corridor to the path segment requires a counterpart
+   * in the other layout within the diagonal of a grid cell (of size \c tolerance).
+   */
+  static bool matchesLayout(const Entry& entry, int begin, int end, const Point2dContainer& layout, double corridor, double tolerance);
+
+  std::list<Entry> entries_; //!< Cached trajectories, most recently used first
+  Entry pending_; //!< Trajectory remembered by remember()
+  bool has_pending_; //!< \c true if pending_ contains a valid trajectory
+};
+
+} // namespace teb_local_planner
+
+#endif /* WARM_START_CACHE_H_ */
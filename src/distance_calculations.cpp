@@ -0,0 +1,717 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Christoph Rösmann
+ *********************************************************************/
+
+
+
+#include <teb_local_planner/distance_calculations.h>
+
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+  #include <immintrin.h>
+  #define TEB_DISTANCE_AVX2 // compiled with target attributes, selected at runtime
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+  #include <arm_neon.h>
+  #define TEB_DISTANCE_NEON // part of the ARMv8 base instruction set
+#endif
+
+namespace teb_local_planner
+{
+
+namespace
+{
+
+// Each kernel operates on the SoA arrays: edge i connects (x[i], y[i]) and (x[i+1], y[i+1]).
+
+//! Function table of one instruction set
+struct DistanceKernels
+{
+  //! Minimum squared distance between a point and the edges [0, num_edges)
+  double (*point_to_edges_sq)(double px, double py, const double* x, const double* y, int num_edges);
+  //! Minimum squared distance between the points [0, num_points) and the segment (a, b)
+  double (*points_to_segment_sq)(const double* x, const double* y, int num_points, double ax, double ay, double bx, double by);
+  //! Check whether the segment (a, b) intersects one of the edges [0, num_edges) (see check_line_segments_intersection_2d())
+  bool (*segment_intersects_edges)(double ax, double ay, double bx, double by, const double* x, const double* y, int num_edges);
+};
+
+
+/** @name Scalar kernels (also used for the remainder of the SIMD loops) */
+//@{
+
+inline double pointToSegmentSq(double px, double py, double sx, double sy, double ex, double ey)
+{
+  const double dx = ex - sx;
+  const double dy = ey - sy;
+  const double sq_norm = dx*dx + dy*dy;
+  double u = sq_norm > 0 ? ((px - sx)*dx + (py - sy)*dy) / sq_norm : 0;
+  u = std::min(std::max(u, 0.), 1.);
+  const double cx = px - (sx + u*dx);
+  const double cy = py - (sy + u*dy);
+  return cx*cx + cy*cy;
+}
+
+inline bool segmentsIntersect(double ax, double ay, double bx, double by, double sx, double sy, double ex, double ey)
+{
+  const double l1x = bx - ax, l1y = by - ay;
+  const double l2x = ex - sx, l2y = ey - sy;
+  const double denom = l1x * l2y - l2x * l1y;
+  const double auxx = ax - sx, auxy = ay - sy;
+  const double s_numer = l1x * auxy - l1y * auxx;
+  const double t_numer = l2x * auxy - l2y * auxx;
+  if (denom > 0)
+    return s_numer >= 0 && t_numer >= 0 && s_numer <= denom && t_numer <= denom;
+  if (denom < 0)
+    return s_numer < 0 && t_numer < 0 && s_numer > denom && t_numer > denom;
+  return false; // collinear
+}
+
+double pointToEdgesSqScalar(double px, double py, const double* x, const double* y, int num_edges)
+{
+  double min_sq = std::numeric_limits<double>::infinity();
+  for (int i = 0; i < num_edges; ++i)
+    min_sq = std::min(min_sq, pointToSegmentSq(px, py, x[i], y[i], x[i+1], y[i+1]));
+  return min_sq;
+}
+
+double pointsToSegmentSqScalar(const double* x, const double* y, int num_points, double ax, double ay, double bx, double by)
+{
+  double min_sq = std::numeric_limits<double>::infinity();
+  for (int i = 0; i < num_points; ++i)
+    min_sq = std::min(min_sq, pointToSegmentSq(x[i], y[i], ax, ay, bx, by));
+  return min_sq;
+}
+
+bool segmentIntersectsEdgesScalar(double ax, double ay, double bx, double by, const double* x, const double* y, int num_edges)
+{
+  for (int i = 0; i < num_edges; ++i)
+  {
+    if (segmentsIntersect(ax, ay, bx, by, x[i], y[i], x[i+1], y[i+1]))
+      return true;
+  }
+  return false;
+}
+
+const DistanceKernels scalar_kernels = {&pointToEdgesSqScalar, &pointsToSegmentSqScalar, &segmentIntersectsEdgesScalar};
+
+//@}
+
+
+#ifdef TEB_DISTANCE_AVX2
+
+/** @name AVX2 kernels (4 doubles per instruction) */
+//@{
+
+__attribute__((target("avx2")))
+inline __m256d pointToSegmentSqAVX2(__m256d px, __m256d py, __m256d sx, __m256d sy, __m256d ex, __m256d ey)
+{
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d one = _mm256_set1_pd(1.);
+  const __m256d dx = _mm256_sub_pd(ex, sx);
+  const __m256d dy = _mm256_sub_pd(ey, sy);
+  const __m256d sq_norm = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+  const __m256d numer = _mm256_add_pd(_mm256_mul_pd(_mm256_sub_pd(px, sx), dx), _mm256_mul_pd(_mm256_sub_pd(py, sy), dy));
+  __m256d u = _mm256_and_pd(_mm256_div_pd(numer, sq_norm), _mm256_cmp_pd(sq_norm, zero, _CMP_GT_OQ)); // degenerated edge: u = 0
+  u = _mm256_min_pd(_mm256_max_pd(u, zero), one);
+  const __m256d cx = _mm256_sub_pd(px, _mm256_add_pd(sx, _mm256_mul_pd(u, dx)));
+  const __m256d cy = _mm256_sub_pd(py, _mm256_add_pd(sy, _mm256_mul_pd(u, dy)));
+  return _mm256_add_pd(_mm256_mul_pd(cx, cx), _mm256_mul_pd(cy, cy));
+}
+
+__attribute__((target("avx2")))
+inline double horizontalMinAVX2(__m256d v)
+{
+  const __m128d low = _mm256_castpd256_pd128(v);
+  const __m128d high = _mm256_extractf128_pd(v, 1);
+  const __m128d min2 = _mm_min_pd(low, high);
+  return std::min(_mm_cvtsd_f64(min2), _mm_cvtsd_f64(_mm_unpackhi_pd(min2, min2)));
+}
+
+__attribute__((target("avx2")))
+double pointToEdgesSqAVX2(double px, double py, const double* x, const double* y, int num_edges)
+{
+  const __m256d vpx = _mm256_set1_pd(px);
+  const __m256d vpy = _mm256_set1_pd(py);
+  __m256d vmin = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+  int i = 0;
+  for (; i + 4 <= num_edges; i += 4)
+  {
+    const __m256d d = pointToSegmentSqAVX2(vpx, vpy, _mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i),
+                                           _mm256_loadu_pd(x + i + 1), _mm256_loadu_pd(y + i + 1));
+    vmin = _mm256_min_pd(vmin, d);
+  }
+  // clear the upper ymm halves before the (non-VEX) scalar remainder, otherwise each call suffers SSE/AVX transition penalties
+  const double min_sq = horizontalMinAVX2(vmin);
+  _mm256_zeroupper();
+  return std::min(min_sq, pointToEdgesSqScalar(px, py, x + i, y + i, num_edges - i));
+}
+
+__attribute__((target("avx2")))
+double pointsToSegmentSqAVX2(const double* x, const double* y, int num_points, double ax, double ay, double bx, double by)
+{
+  const __m256d vax = _mm256_set1_pd(ax);
+  const __m256d vay = _mm256_set1_pd(ay);
+  const __m256d vbx = _mm256_set1_pd(bx);
+  const __m256d vby = _mm256_set1_pd(by);
+  __m256d vmin = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+  int i = 0;
+  for (; i + 4 <= num_points; i += 4)
+    vmin = _mm256_min_pd(vmin, pointToSegmentSqAVX2(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), vax, vay, vbx, vby));
+  const double min_sq = horizontalMinAVX2(vmin);
+  _mm256_zeroupper(); // see pointToEdgesSqAVX2()
+  return std::min(min_sq, pointsToSegmentSqScalar(x + i, y + i, num_points - i, ax, ay, bx, by));
+}
+
+__attribute__((target("avx2")))
+bool segmentIntersectsEdgesAVX2(double ax, double ay, double bx, double by, const double* x, const double* y, int num_edges)
+{
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d vax = _mm256_set1_pd(ax);
+  const __m256d vay = _mm256_set1_pd(ay);
+  const __m256d l1x = _mm256_set1_pd(bx - ax);
+  const __m256d l1y = _mm256_set1_pd(by - ay);
+  int i = 0;
+  for (; i + 4 <= num_edges; i += 4)
+  {
+    const __m256d sx = _mm256_loadu_pd(x + i);
+    const __m256d sy = _mm256_loadu_pd(y + i);
+    const __m256d l2x = _mm256_sub_pd(_mm256_loadu_pd(x + i + 1), sx);
+    const __m256d l2y = _mm256_sub_pd(_mm256_loadu_pd(y + i + 1), sy);
+    const __m256d denom = _mm256_sub_pd(_mm256_mul_pd(l1x, l2y), _mm256_mul_pd(l2x, l1y));
+    const __m256d auxx = _mm256_sub_pd(vax, sx);
+    const __m256d auxy = _mm256_sub_pd(vay, sy);
+    const __m256d s_numer = _mm256_sub_pd(_mm256_mul_pd(l1x, auxy), _mm256_mul_pd(l1y, auxx));
+    const __m256d t_numer = _mm256_sub_pd(_mm256_mul_pd(l2x, auxy), _mm256_mul_pd(l2y, auxx));
+
+    // same conditions as segmentsIntersect() for positive and negative denominators
+    __m256d pos = _mm256_cmp_pd(denom, zero, _CMP_GT_OQ);
+    pos = _mm256_and_pd(pos, _mm256_cmp_pd(s_numer, zero, _CMP_GE_OQ));
+    pos = _mm256_and_pd(pos, _mm256_cmp_pd(t_numer, zero, _CMP_GE_OQ));
+    pos = _mm256_and_pd(pos, _mm256_cmp_pd(s_numer, denom, _CMP_LE_OQ));
+    pos = _mm256_and_pd(pos, _mm256_cmp_pd(t_numer, denom, _CMP_LE_OQ));
+    __m256d neg = _mm256_cmp_pd(denom, zero, _CMP_LT_OQ);
+    neg = _mm256_and_pd(neg, _mm256_cmp_pd(s_numer, zero, _CMP_LT_OQ));
+    neg = _mm256_and_pd(neg, _mm256_cmp_pd(t_numer, zero, _CMP_LT_OQ));
+    neg = _mm256_and_pd(neg, _mm256_cmp_pd(s_numer, denom, _CMP_GT_OQ));
+    neg = _mm256_and_pd(neg, _mm256_cmp_pd(t_numer, denom, _CMP_GT_OQ));
+    if (_mm256_movemask_pd(_mm256_or_pd(pos, neg)) != 0)
+    {
+      _mm256_zeroupper(); // on every exit path, see pointToEdgesSqAVX2()
+      return true;
+    }
+  }
+  _mm256_zeroupper(); // see pointToEdgesSqAVX2()
+  return segmentIntersectsEdgesScalar(ax, ay, bx, by, x + i, y + i, num_edges - i);
+}
+
+const DistanceKernels avx2_kernels = {&pointToEdgesSqAVX2, &pointsToSegmentSqAVX2, &segmentIntersectsEdgesAVX2};
+
+//@}
+
+#endif // TEB_DISTANCE_AVX2
+
+
+#ifdef TEB_DISTANCE_NEON
+
+/** @name NEON kernels (2 doubles per instruction) */
+//@{
+
+inline float64x2_t pointToSegmentSqNEON(float64x2_t px, float64x2_t py, float64x2_t sx, float64x2_t sy, float64x2_t ex, float64x2_t ey)
+{
+  const float64x2_t zero = vdupq_n_f64(0.);
+  const float64x2_t one = vdupq_n_f64(1.);
+  const float64x2_t dx = vsubq_f64(ex, sx);
+  const float64x2_t dy = vsubq_f64(ey, sy);
+  const float64x2_t sq_norm = vaddq_f64(vmulq_f64(dx, dx), vmulq_f64(dy, dy));
+  const float64x2_t numer = vaddq_f64(vmulq_f64(vsubq_f64(px, sx), dx), vmulq_f64(vsubq_f64(py, sy), dy));
+  float64x2_t u = vbslq_f64(vcgtq_f64(sq_norm, zero), vdivq_f64(numer, sq_norm), zero); // degenerated edge: u = 0
+  u = vminq_f64(vmaxq_f64(u, zero), one);
+  const float64x2_t cx = vsubq_f64(px, vaddq_f64(sx, vmulq_f64(u, dx)));
+  const float64x2_t cy = vsubq_f64(py, vaddq_f64(sy, vmulq_f64(u, dy)));
+  return vaddq_f64(vmulq_f64(cx, cx), vmulq_f64(cy, cy));
+}
+
+double pointToEdgesSqNEON(double px, double py, const double* x, const double* y, int num_edges)
+{
+  const float64x2_t vpx = vdupq_n_f64(px);
+  const float64x2_t vpy = vdupq_n_f64(py);
+  float64x2_t vmin = vdupq_n_f64(std::numeric_limits<double>::infinity());
+  int i = 0;
+  for (; i + 2 <= num_edges; i += 2)
+    vmin = vminq_f64(vmin, pointToSegmentSqNEON(vpx, vpy, vld1q_f64(x + i), vld1q_f64(y + i), vld1q_f64(x + i + 1), vld1q_f64(y + i + 1)));
+  return std::min(vminvq_f64(vmin), pointToEdgesSqScalar(px, py, x + i, y + i, num_edges - i));
+}
+
+double pointsToSegmentSqNEON(const double* x, const double* y, int num_points, double ax, double ay, double bx, double by)
+{
+  const float64x2_t vax = vdupq_n_f64(ax);
+  const float64x2_t vay = vdupq_n_f64(ay);
+  const float64x2_t vbx = vdupq_n_f64(bx);
+  const float64x2_t vby = vdupq_n_f64(by);
+  float64x2_t vmin = vdupq_n_f64(std::numeric_limits<double>::infinity());
+  int i = 0;
+  for (; i + 2 <= num_points; i += 2)
+    vmin = vminq_f64(vmin, pointToSegmentSqNEON(vld1q_f64(x + i), vld1q_f64(y + i), vax, vay, vbx, vby));
+  return std::min(vminvq_f64(vmin), pointsToSegmentSqScalar(x + i, y + i, num_points - i, ax, ay, bx, by));
+}
+
+bool segmentIntersectsEdgesNEON(double ax, double ay, double bx, double by, const double* x, const double* y, int num_edges)
+{
+  const float64x2_t zero = vdupq_n_f64(0.);
+  const float64x2_t vax = vdupq_n_f64(ax);
+  const float64x2_t vay = vdupq_n_f64(ay);
+  const float64x2_t l1x = vdupq_n_f64(bx - ax);
+  const float64x2_t l1y = vdupq_n_f64(by - ay);
+  int i = 0;
+  for (; i + 2 <= num_edges; i += 2)
+  {
+    const float64x2_t sx = vld1q_f64(x + i);
+    const float64x2_t sy = vld1q_f64(y + i);
+    const float64x2_t l2x = vsubq_f64(vld1q_f64(x + i + 1), sx);
+    const float64x2_t l2y = vsubq_f64(vld1q_f64(y + i + 1), sy);
+    const float64x2_t denom = vsubq_f64(vmulq_f64(l1x, l2y), vmulq_f64(l2x, l1y));
+    const float64x2_t auxx = vsubq_f64(vax, sx);
+    const float64x2_t auxy = vsubq_f64(vay, sy);
+    const float64x2_t s_numer = vsubq_f64(vmulq_f64(l1x, auxy), vmulq_f64(l1y, auxx));
+    const float64x2_t t_numer = vsubq_f64(vmulq_f64(l2x, auxy), vmulq_f64(l2y, auxx));
+
+    // same conditions as segmentsIntersect() for positive and negative denominators
+    uint64x2_t pos = vcgtq_f64(denom, zero);
+    pos = vandq_u64(pos, vcgeq_f64(s_numer, zero));
+    pos = vandq_u64(pos, vcgeq_f64(t_numer, zero));
+    pos = vandq_u64(pos, vcleq_f64(s_numer, denom));
+    pos = vandq_u64(pos, vcleq_f64(t_numer, denom));
+    uint64x2_t neg = vcltq_f64(denom, zero);
+    neg = vandq_u64(neg, vcltq_f64(s_numer, zero));
+    neg = vandq_u64(neg, vcltq_f64(t_numer, zero));
+    neg = vandq_u64(neg, vcgtq_f64(s_numer, denom));
+    neg = vandq_u64(neg, vcgtq_f64(t_numer, denom));
+    const uint64x2_t any = vorrq_u64(pos, neg);
+    if ((vgetq_lane_u64(any, 0) | vgetq_lane_u64(any, 1)) != 0)
+      return true;
+  }
+  return segmentIntersectsEdgesScalar(ax, ay, bx, by, x + i, y + i, num_edges - i);
+}
+
+const DistanceKernels neon_kernels = {&pointToEdgesSqNEON, &pointsToSegmentSqNEON, &segmentIntersectsEdgesNEON};
+
+//@}
+
+#endif // TEB_DISTANCE_NEON
+
+
+//! Kernels of an instruction set, NULL if not supported
+const DistanceKernels* kernelsFor(SimdInstructionSet instruction_set)
+{
+  switch (instruction_set)
+  {
+    case SimdInstructionSet::Scalar:
+      return &scalar_kernels;
+#ifdef TEB_DISTANCE_AVX2
+    case SimdInstructionSet::AVX2:
+      __builtin_cpu_init(); // required since the default selection is made during static initialization
+      return __builtin_cpu_supports("avx2") ? &avx2_kernels : NULL;
+#endif
+#ifdef TEB_DISTANCE_NEON
+    case SimdInstructionSet::NEON:
+      return &neon_kernels;
+#endif
+    default:
+      return NULL;
+  }
+}
+
+//! Best instruction set supported by the CPU
+SimdInstructionSet detectInstructionSet()
+{
+  if (kernelsFor(SimdInstructionSet::AVX2))
+    return SimdInstructionSet::AVX2;
+  if (kernelsFor(SimdInstructionSet::NEON))
+    return SimdInstructionSet::NEON;
+  return SimdInstructionSet::Scalar;
+}
+
+std::atomic<SimdInstructionSet> active_instruction_set(detectInstructionSet());
+
+inline const DistanceKernels& kernels()
+{
+  return *kernelsFor(active_instruction_set.load(std::memory_order_relaxed));
+}
+
+//! Crossing number test (see check_point_in_polygon_2d()), points and lines have no interior
+inline bool pointInPolygon(double px, double py, const PolygonSoA& polygon)
+{
+  bool inside = false;
+  if (polygon.num_vertices < 3)
+    return inside;
+  for (int i = 0; i < polygon.num_edges; ++i)
+  {
+    if ((polygon.y[i+1] > py) != (polygon.y[i] > py) &&
+        px < (polygon.x[i] - polygon.x[i+1]) * (py - polygon.y[i+1]) / (polygon.y[i] - polygon.y[i+1]) + polygon.x[i+1])
+      inside = !inside;
+  }
+  return inside;
+}
+
+} // anonymous namespace
+
+
+SimdInstructionSet getDistanceInstructionSet()
+{
+  return active_instruction_set.load();
+}
+
+bool setDistanceInstructionSet(SimdInstructionSet instruction_set)
+{
+  if (!kernelsFor(instruction_set))
+    return false;
+  active_instruction_set.store(instruction_set);
+  return true;
+}
+
+
+double distance_point_to_polygon_2d(const Eigen::Vector2d& point, const PolygonSoA& polygon)
+{
+  if (polygon.num_vertices == 0)
+    return HUGE_VAL;
+
+  // the polygon is a point
+  if (polygon.num_edges == 0)
+    return std::hypot(point.x() - polygon.x[0], point.y() - polygon.y[0]);
+
+  if (pointInPolygon(point.x(), point.y(), polygon))
+    return 0;
+
+  return std::sqrt(kernels().point_to_edges_sq(point.x(), point.y(), polygon.x.data(), polygon.y.data(), polygon.num_edges));
+}
+
+double distance_segment_to_polygon_2d(const Eigen::Vector2d& line_start, const Eigen::Vector2d& line_end, const PolygonSoA& polygon)
+{
+  if (polygon.num_vertices == 0)
+    return HUGE_VAL;
+
+  const DistanceKernels& k = kernels();
+  const double* x = polygon.x.data();
+  const double* y = polygon.y.data();
+
+  // the segment intersects an edge or lies inside of the polygon
+  if (k.segment_intersects_edges(line_start.x(), line_start.y(), line_end.x(), line_end.y(), x, y, polygon.num_edges)
+      || pointInPolygon(line_start.x(), line_start.y(), polygon))
+    return 0;
+
+  // end points of the segment to all edges and all vertices (end points of the edges) to the segment
+  double min_sq = k.points_to_segment_sq(x, y, polygon.num_vertices, line_start.x(), line_start.y(), line_end.x(), line_end.y());
+  min_sq = std::min(min_sq, k.point_to_edges_sq(line_start.x(), line_start.y(), x, y, polygon.num_edges));
+  min_sq = std::min(min_sq, k.point_to_edges_sq(line_end.x(), line_end.y(), x, y, polygon.num_edges));
+  return std::sqrt(min_sq);
+}
+
+double distance_polygon_to_polygon_2d(const PolygonSoA& polygon1, const PolygonSoA& polygon2)
+{
+  if (polygon1.num_vertices == 0 || polygon2.num_vertices == 0)
+    return HUGE_VAL;
+
+  // both polygons are points
+  if (polygon1.num_edges == 0 && polygon2.num_edges == 0)
+    return std::hypot(polygon1.x[0] - polygon2.x[0], polygon1.y[0] - polygon2.y[0]);
+
+  const DistanceKernels& k = kernels();
+
+  for (int i = 0; i < polygon1.num_edges; ++i)
+  {
+    if (k.segment_intersects_edges(polygon1.x[i], polygon1.y[i], polygon1.x[i+1], polygon1.y[i+1],
+                                   polygon2.x.data(), polygon2.y.data(), polygon2.num_edges))
+      return 0;
+  }
+
+  // no edges intersect: the polygons are either disjoint or one contains the other one
+  if (pointInPolygon(polygon1.x[0], polygon1.y[0], polygon2) || pointInPolygon(polygon2.x[0], polygon2.y[0], polygon1))
+    return 0;
+
+  double min_sq = std::numeric_limits<double>::infinity();
+  for (int i = 0; i < polygon1.num_vertices; ++i)
+    min_sq = std::min(min_sq, k.point_to_edges_sq(polygon1.x[i], polygon1.y[i], polygon2.x.data(), polygon2.y.data(), polygon2.num_edges));
+  for (int i = 0; i < polygon2.num_vertices; ++i)
+    min_sq = std::min(min_sq, k.point_to_edges_sq(polygon2.x[i], polygon2.y[i], polygon1.x.data(), polygon1.y.data(), polygon1.num_edges));
+  return std::sqrt(min_sq);
+}
+
+
+bool check_polygon_convexity_2d(const Point2dContainer& vertices)
+{
+  const int n = (int)vertices.size();
+  if (n <= 2)
+    return n == 1 || (n == 2 && vertices[0] != vertices[1]);
+
+  double orientation = 0;
+  double turning_angle = 0;
+  for (int i = 0; i < n; ++i)
+  {
+    const Eigen::Vector2d edge1 = vertices[(i+1) % n] - vertices[i];
+    const Eigen::Vector2d edge2 = vertices[(i+2) % n] - vertices[(i+1) % n];
+    if (edge1.squaredNorm() == 0)
+      return false; // repeated vertex
+
+    const double cross = edge1.x() * edge2.y() - edge1.y() * edge2.x();
+    if (cross != 0)
+    {
+      if (orientation * cross < 0)
+        return false;
+      orientation = cross;
+    }
+    turning_angle += std::atan2(cross, edge1.dot(edge2));
+  }
+  // spikes and self-intersecting polygons turn more than once
+  return orientation != 0 && std::abs(std::abs(turning_angle) - 2 * M_PI) < 1e-6;
+}
+
+
+namespace
+{
+
+/**
+ * Vertex of a convex polygon with the largest projection onto (dx, dy), found by hill climbing from \c start.
+ * Runs of collinear vertices are accepted by check_polygon_convexity_2d(). If such a run is perpendicular to (dx, dy),
+ * its vertices have the same projection, hence the climb walks across it instead of stopping in its middle
+ * (which might be on the opposite side of the polygon).
+ */
+int supportVertex(const PolygonSoA& polygon, double dx, double dy, int start)
+{
+  const int n = polygon.num_vertices;
+  int i = start >= 0 && start < n ? start : 0;
+  double max_proj = polygon.x[i] * dx + polygon.y[i] * dy;
+  // projections within the rounding error of max_proj are treated as equal
+  const double tol = 1e-12 * (std::fabs(dx) + std::fabs(dy)) * (1 + std::fabs(polygon.x[i]) + std::fabs(polygon.y[i]));
+  for (int step = 0; step < n; ++step)
+  {
+    int best = i;
+    double best_proj = max_proj;
+    for (int dir : {1, n - 1}) // next and previous vertex
+    {
+      int j = i;
+      double proj;
+      int walked = 0;
+      do
+      {
+        j = j + dir < n ? j + dir : j + dir - n;
+        proj = polygon.x[j] * dx + polygon.y[j] * dy;
+      } while (++walked < n - 1 && std::fabs(proj - max_proj) <= tol);
+      if (proj > best_proj + tol)
+      {
+        best = j;
+        best_proj = proj;
+      }
+    }
+    if (best == i)
+      break;
+    i = best;
+    max_proj = best_proj;
+  }
+  return i;
+}
+
+//! Vertex of the Minkowski difference polygon1 - polygon2
+struct SimplexVertex
+{
+  double x;
+  double y;
+  int vertex1; //!< Vertex index of the first polygon
+  int vertex2; //!< Vertex index of the second polygon
+};
+
+//! Closest point to the origin on the segment (a, b), returns the barycentric coordinate of b (clamped to [0,1])
+inline double closestOnSegment(const SimplexVertex& a, const SimplexVertex& b, double& vx, double& vy)
+{
+  const double abx = b.x - a.x;
+  const double aby = b.y - a.y;
+  const double sq_norm = abx * abx + aby * aby;
+  double t = sq_norm > 0 ? -(a.x * abx + a.y * aby) / sq_norm : 0;
+  t = std::min(std::max(t, 0.), 1.);
+  vx = a.x + t * abx;
+  vy = a.y + t * aby;
+  return t;
+}
+
+/**
+ * Compute the closest point v of the simplex to the origin and reduce the simplex to the vertices supporting v.
+ * Returns false if the origin is inside the simplex (triangle).
+ */
+bool reduceSimplex(SimplexVertex* simplex, int& size, double& vx, double& vy)
+{
+  if (size == 1)
+  {
+    vx = simplex[0].x;
+    vy = simplex[0].y;
+    return true;
+  }
+
+  if (size == 2)
+  {
+    const double t = closestOnSegment(simplex[0], simplex[1], vx, vy);
+    if (t <= 0)
+      size = 1;
+    else if (t >= 1)
+    {
+      simplex[0] = simplex[1];
+      size = 1;
+    }
+    return true;
+  }
+
+  // triangle: check whether the origin is enclosed
+  const SimplexVertex& a = simplex[0];
+  const SimplexVertex& b = simplex[1];
+  const SimplexVertex& c = simplex[2];
+  const double area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+  if (area != 0)
+  {
+    const double c0 = (b.x - a.x) * (-a.y) - (b.y - a.y) * (-a.x);
+    const double c1 = (c.x - b.x) * (-b.y) - (c.y - b.y) * (-b.x);
+    const double c2 = (a.x - c.x) * (-c.y) - (a.y - c.y) * (-c.x);
+    if ((c0 >= 0 && c1 >= 0 && c2 >= 0) || (c0 <= 0 && c1 <= 0 && c2 <= 0))
+      return false;
+  }
+
+  // otherwise the closest point is located on one of the edges
+  const int edges[3][2] = {{0, 1}, {1, 2}, {2, 0}};
+  double min_sq = std::numeric_limits<double>::infinity();
+  int best_edge = 0;
+  double best_t = 0;
+  for (int k = 0; k < 3; ++k)
+  {
+    double ex, ey;
+    const double t = closestOnSegment(simplex[edges[k][0]], simplex[edges[k][1]], ex, ey);
+    const double sq = ex * ex + ey * ey;
+    if (sq < min_sq)
+    {
+      min_sq = sq;
+      best_edge = k;
+      best_t = t;
+      vx = ex;
+      vy = ey;
+    }
+  }
+  const SimplexVertex first = simplex[edges[best_edge][0]];
+  const SimplexVertex second = simplex[edges[best_edge][1]];
+  if (best_t <= 0)
+  {
+    simplex[0] = first;
+    size = 1;
+  }
+  else if (best_t >= 1)
+  {
+    simplex[0] = second;
+    size = 1;
+  }
+  else
+  {
+    simplex[0] = first;
+    simplex[1] = second;
+    size = 2;
+  }
+  return true;
+}
+
+inline SimplexVertex minkowskiVertex(const PolygonSoA& polygon1, const PolygonSoA& polygon2, int vertex1, int vertex2)
+{
+  SimplexVertex w = {polygon1.x[vertex1] - polygon2.x[vertex2], polygon1.y[vertex1] - polygon2.y[vertex2], vertex1, vertex2};
+  return w;
+}
+
+} // anonymous namespace
+
+
+double distance_convex_polygon_to_polygon_2d(const PolygonSoA& polygon1, const PolygonSoA& polygon2, ConvexDistanceWitness* witness)
+{
+  if (polygon1.num_vertices == 0 || polygon2.num_vertices == 0)
+    return HUGE_VAL;
+
+  int vertex1 = witness && witness->vertex1 >= 0 && witness->vertex1 < polygon1.num_vertices ? witness->vertex1 : 0;
+  int vertex2 = witness && witness->vertex2 >= 0 && witness->vertex2 < polygon2.num_vertices ? witness->vertex2 : 0;
+
+  SimplexVertex simplex[3];
+  int size = 1;
+  simplex[0] = minkowskiVertex(polygon1, polygon2, vertex1, vertex2);
+  double vx = simplex[0].x;
+  double vy = simplex[0].y;
+
+  // GJK terminates after finitely many iterations for polygons; the limit only guards against numerical cycling
+  const int max_iterations = 2 * (polygon1.num_vertices + polygon2.num_vertices) + 4;
+  for (int iter = 0; iter < max_iterations; ++iter)
+  {
+    const double sq_norm = vx * vx + vy * vy;
+    if (sq_norm == 0)
+      break; // touching
+
+    // support point of the Minkowski difference in direction -v
+    vertex1 = supportVertex(polygon1, -vx, -vy, vertex1);
+    vertex2 = supportVertex(polygon2, vx, vy, vertex2);
+    const SimplexVertex w = minkowskiVertex(polygon1, polygon2, vertex1, vertex2);
+
+    bool known = false;
+    for (int k = 0; k < size; ++k)
+      known |= simplex[k].vertex1 == w.vertex1 && simplex[k].vertex2 == w.vertex2;
+
+    // no progress in direction -v: v is the closest point (up to a relative error of 1e-12)
+    if (known || sq_norm - (vx * w.x + vy * w.y) <= 1e-12 * sq_norm)
+    {
+      if (witness)
+      {
+        witness->vertex1 = simplex[0].vertex1;
+        witness->vertex2 = simplex[0].vertex2;
+      }
+      return std::sqrt(sq_norm);
+    }
+
+    simplex[size++] = w;
+    if (!reduceSimplex(simplex, size, vx, vy))
+      break; // origin enclosed: the polygons overlap
+  }
+
+  if (witness)
+  {
+    witness->vertex1 = vertex1;
+    witness->vertex2 = vertex2;
+  }
+  if (vx * vx + vy * vy == 0 || size == 3)
+    return 0;
+  return distance_polygon_to_polygon_2d(polygon1, polygon2); // did not converge (numerical issues)
+}
+
+} // namespace teb_local_planner
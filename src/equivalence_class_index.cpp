@@ -0,0 +1,121 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Christoph Rösmann
+ *********************************************************************/
+
+
+#include <teb_local_planner/equivalence_class_index.h>
+
+#include <algorithm>
+
+namespace teb_local_planner
+{
+
+void EquivalenceClassIndex::insert(const EquivalenceClassPtr& eq_class)
+{
+  buckets_.insert(std::make_pair(eq_class->hashKey(), eq_class));
+}
+
+void EquivalenceClassIndex::erase(const EquivalenceClassPtr& eq_class)
+{
+  std::pair<BucketMap::iterator, BucketMap::iterator> bucket = buckets_.equal_range(eq_class->hashKey());
+  for (BucketMap::iterator it = bucket.first; it != bucket.second; ++it)
+  {
+    if (it->second == eq_class)
+    {
+      buckets_.erase(it);
+      return;
+    }
+  }
+}
+
+bool EquivalenceClassIndex::contains(const EquivalenceClass& eq_class) const
+{
+  bool conclusive;
+  if (countInCandidates(eq_class, true, conclusive) > 0)
+    return true;
+  return !conclusive && countInOthers(eq_class, true) > 0;
+}
+
+int EquivalenceClassIndex::count(const EquivalenceClass& eq_class) const
+{
+  bool conclusive;
+  int count = countInCandidates(eq_class, false, conclusive);
+  if (!conclusive)
+    count += countInOthers(eq_class, false);
+  return count;
+}
+
+int EquivalenceClassIndex::countInCandidates(const EquivalenceClass& eq_class, bool stop_at_first, bool& conclusive) const
+{
+  conclusive = eq_class.candidateKeys(keys_);
+  std::sort(keys_.begin(), keys_.end());
+  keys_.erase(std::unique(keys_.begin(), keys_.end()), keys_.end()); // neighbouring cells might share a hash key
+
+  int count = 0;
+  for (std::size_t key : keys_)
+  {
+    std::pair<BucketMap::const_iterator, BucketMap::const_iterator> bucket = buckets_.equal_range(key);
+    for (BucketMap::const_iterator it = bucket.first; it != bucket.second; ++it)
+    {
+      if (!eq_class.isEqual(*it->second))
+        continue;
+      ++count;
+      if (stop_at_first)
+        return count;
+    }
+  }
+  return count;
+}
+
+int EquivalenceClassIndex::countInOthers(const EquivalenceClass& eq_class, bool stop_at_first) const
+{
+  // keys_ still contains the (sorted) candidate keys of eq_class
+  int count = 0;
+  for (BucketMap::const_iterator it = buckets_.begin(); it != buckets_.end(); ++it)
+  {
+    if (std::binary_search(keys_.begin(), keys_.end(), it->first))
+      continue;
+    if (!eq_class.isEqual(*it->second))
+      continue;
+    ++count;
+    if (stop_at_first)
+      return count;
+  }
+  return count;
+}
+
+} // namespace teb_local_planner
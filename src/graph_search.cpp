@@ -38,6 +38,14 @@
 
 #include <teb_local_planner/graph_search.h>
 #include <teb_local_planner/homotopy_class_planner.h>
+#include <teb_local_planner/h_signature.h>
+
+#include <boost/functional/hash.hpp>
+
+#include <queue>
+#include <algorithm>
+#include <iterator>
+#include <limits>
 
 namespace teb_local_planner
 {
@@ -54,7 +62,7 @@ void GraphSearchInterface::DepthFirst(HcGraph& g, std::vector<HcGraphVertexType>
 
   /// Examine adjacent nodes
   HcGraphAdjecencyIterator it, end;
-  for ( boost::tie(it,end) = boost::adjacent_vertices(back,g); it!=end; ++it)
+  for ( boost::tie(it,end) = adjacent_vertices(back,g); it!=end; ++it)
   {
     if ( std::find(visited.begin(), visited.end(), *it)!=visited.end() )
       continue; // already visited
@@ -73,7 +81,7 @@ void GraphSearchInterface::DepthFirst(HcGraph& g, std::vector<HcGraphVertexType>
   }
 
   /// Recursion for all adjacent vertices
-  for ( boost::tie(it,end) = boost::adjacent_vertices(back,g); it!=end; ++it)
+  for ( boost::tie(it,end) = adjacent_vertices(back,g); it!=end; ++it)
   {
     if ( std::find(visited.begin(), visited.end(), *it)!=visited.end() || *it == goal)
       continue; // already visited || goal reached
@@ -90,6 +98,117 @@ void GraphSearchInterface::DepthFirst(HcGraph& g, std::vector<HcGraphVertexType>
 
 
 
+void GraphSearchInterface::BestFirst(HcGraph& g, const HcGraphVertexType& start, const HcGraphVertexType& goal, double start_orientation,
+                                     double goal_orientation, const geometry_msgs::Twist* start_velocity, bool free_goal_vel)
+{
+  if ((int)hcp_->getTrajectoryContainer().size() >= cfg_->hcp.max_number_classes)
+    return; // We do not need to search for further possible alternative homotopy classes.
+
+  typedef std::complex<long double> cplx;
+
+  // the (2d) h-signature of a path is the sum of the contributions of its edges
+  HSignatureSegmentTerms& h_terms = search_h_terms_;
+  if (hcp_->obstacles())
+    h_terms.initialize(*cfg_, getCplxFromHcGraph(start, g), getCplxFromHcGraph(goal, g), *hcp_->obstacles());
+
+  // search buffers are members such that their capacity is reused in the next planning cycle
+  const std::size_t num_vertices = teb_local_planner::num_vertices(g);
+  const int max_classes = std::max(cfg_->hcp.max_number_classes, 1);
+  search_states_.clear();
+  search_queue_.clear();
+  search_expanded_h_.resize(num_vertices * max_classes); // h-signatures of the expanded states of each vertex
+  search_expanded_count_.assign(num_vertices, 0);
+  search_edge_h_.resize(num_edges(g)); // h-signature contribution of each edge (computed once)
+  search_edge_h_valid_.assign(num_vertices, 0);
+  std::greater<QueueEntry> queue_compare; // min-heap
+
+  search_states_.push_back(SearchState{start, -1, 0., cplx(0, 0)});
+  search_queue_.push_back(QueueEntry((g[goal].pos - g[start].pos).norm(), 0));
+
+  std::vector<HcGraphVertexType>& path = search_path_;
+  while (!search_queue_.empty())
+  {
+    const int idx = search_queue_.front().second;
+    std::pop_heap(search_queue_.begin(), search_queue_.end(), queue_compare);
+    search_queue_.pop_back();
+    const SearchState state = search_states_[idx];
+
+    if (state.vertex == goal) // goal reached
+    {
+      path.clear();
+      for (int i = idx; i >= 0; i = search_states_[i].parent)
+        path.push_back(search_states_[i].vertex);
+      std::reverse(path.begin(), path.end());
+
+      // The 2d h-signature of the path is known from the search. Otherwise addAndInitNewTeb() computes the class of the path
+      // (with a timing approximated based on max_vel_x). In both cases the class is checked before a TEB is set up.
+      EquivalenceClassPtr eq_class;
+      if (!cfg_->obstacles.include_dynamic_obstacles)
+        eq_class = EquivalenceClassPtr(new HSignature(*cfg_, state.h));
+      hcp_->addAndInitNewTeb(path.begin(), path.end(), boost::bind(getVector2dFromHcGraph, _1, boost::cref(g)),
+                             start_orientation, goal_orientation, start_velocity, free_goal_vel, eq_class);
+
+      if ((int)hcp_->getTrajectoryContainer().size() >= cfg_->hcp.max_number_classes)
+        return;
+      continue;
+    }
+
+    // a shorter path with a similar (2d) h-signature reached this vertex already.
+    // Each vertex is expanded at most once per class of the resulting trajectories.
+    cplx* expanded_h = &search_expanded_h_[state.vertex * max_classes];
+    int& num_expanded = search_expanded_count_[state.vertex];
+    if (num_expanded >= max_classes)
+      continue;
+    bool similar = false;
+    for (int i = 0; i < num_expanded; ++i)
+    {
+      if (HomotopyClassPlanner::isHSignatureSimilar(expanded_h[i], state.h, cfg_->hcp.h_signature_threshold))
+      {
+        similar = true;
+        break;
+      }
+    }
+    if (similar)
+      continue;
+    expanded_h[num_expanded++] = state.h;
+
+    /// Examine adjacent nodes
+    cplx* vertex_edge_h = &search_edge_h_[g.firstOutEdge(state.vertex)];
+    const bool compute_edge_h = !search_edge_h_valid_[state.vertex];
+    search_edge_h_valid_[state.vertex] = 1;
+    std::size_t k = 0;
+    HcGraphAdjecencyIterator it, end;
+    for ( boost::tie(it,end) = adjacent_vertices(state.vertex,g); it!=end; ++it, ++k)
+    {
+      if (compute_edge_h)
+        vertex_edge_h[k] = h_terms.segment(getCplxFromHcGraph(state.vertex, g), getCplxFromHcGraph(*it, g));
+
+      const double length = state.length + (g[*it].pos - g[state.vertex].pos).norm();
+      search_states_.push_back(SearchState{*it, idx, length, state.h + vertex_edge_h[k]});
+      search_queue_.push_back(QueueEntry(length + (g[goal].pos - g[*it].pos).norm(), (int)search_states_.size() - 1));
+      std::push_heap(search_queue_.begin(), search_queue_.end(), queue_compare);
+    }
+  }
+}
+
+
+const ObstacleSpatialIndex& GraphSearchInterface::obstacleIndex()
+{
+  if (hcp_->obstacleIndex().covers(*hcp_->obstacles()))
+    return hcp_->obstacleIndex();
+  local_obstacle_index_.build(*hcp_->obstacles());
+  return local_obstacle_index_;
+}
+
+
+bool GraphSearchInterface::checkEdgeCollision(const ObstacleSpatialIndex& index, const Eigen::Vector2d& start, const Eigen::Vector2d& end, double min_dist) const
+{
+  // broadphase: only obstacles whose bounding circle is close to the edge (terminates at the first collision)
+  const ObstContainer& obstacles = *hcp_->obstacles();
+  return index.anyAlongSegment(start, end, min_dist, [&](int idx) {return obstacles[idx]->checkLineIntersection(start, end, min_dist);});
+}
+
+
 void lrKeyPointGraph::createGraph(const PoseSE2& start, const PoseSE2& goal, double dist_to_obst, double obstacle_heading_threshold, const geometry_msgs::Twist* start_velocity, bool free_goal_vel)
 {
   // Clear existing graph and paths
@@ -115,7 +234,7 @@ void lrKeyPointGraph::createGraph(const PoseSE2& start, const PoseSE2& goal, dou
   normal = normal*dist_to_obst; // scale with obstacle_distance;
 
   // Insert Vertices
-  HcGraphVertexType start_vtx = boost::add_vertex(graph_); // start vertex
+  HcGraphVertexType start_vtx = add_vertex(graph_); // start vertex
   graph_[start_vtx].pos = start.position();
   diff.normalize();
 
@@ -134,9 +253,9 @@ void lrKeyPointGraph::createGraph(const PoseSE2& start, const PoseSE2& goal, dou
         continue;
 
       // Add Keypoints
-      HcGraphVertexType u = boost::add_vertex(graph_);
+      HcGraphVertexType u = add_vertex(graph_);
       graph_[u].pos = (*it_obst)->getCentroid() + normal;
-      HcGraphVertexType v = boost::add_vertex(graph_);
+      HcGraphVertexType v = add_vertex(graph_);
       graph_[v].pos = (*it_obst)->getCentroid() - normal;
 
       // store nearest obstacle
@@ -149,14 +268,15 @@ void lrKeyPointGraph::createGraph(const PoseSE2& start, const PoseSE2& goal, dou
     }
   }
 
-  HcGraphVertexType goal_vtx = boost::add_vertex(graph_); // goal vertex
+  HcGraphVertexType goal_vtx = add_vertex(graph_); // goal vertex
   graph_[goal_vtx].pos = goal.position();
 
   // Insert Edges
+  const ObstacleSpatialIndex* obst_index = hcp_->obstacles()!=NULL ? &obstacleIndex() : NULL;
   HcGraphVertexIterator it_i, end_i, it_j, end_j;
-  for (boost::tie(it_i,end_i) = boost::vertices(graph_); it_i!=end_i-1; ++it_i) // ignore goal in this loop
+  for (boost::tie(it_i,end_i) = vertices(graph_); it_i!=end_i-1; ++it_i) // ignore goal in this loop
   {
-    for (boost::tie(it_j,end_j) = boost::vertices(graph_); it_j!=end_j; ++it_j) // check all forward connections
+    for (boost::tie(it_j,end_j) = vertices(graph_); it_j!=end_j; ++it_j) // check all forward connections
     {
       if (it_i==it_j)
         continue;
@@ -188,31 +308,17 @@ void lrKeyPointGraph::createGraph(const PoseSE2& start, const PoseSE2& goal, dou
 
       // Collision Check
 
-      if (hcp_->obstacles()!=NULL)
-      {
-        bool collision = false;
-        for (ObstContainer::const_iterator it_obst = hcp_->obstacles()->begin(); it_obst != hcp_->obstacles()->end(); ++it_obst)
-        {
-          if ( (*it_obst)->checkLineIntersection(graph_[*it_i].pos,graph_[*it_j].pos, 0.5*dist_to_obst) )
-          {
-            collision = true;
-            break;
-          }
-        }
-        if (collision)
-          continue;
-      }
+      if (obst_index && checkEdgeCollision(*obst_index, graph_[*it_i].pos, graph_[*it_j].pos, 0.5*dist_to_obst))
+        continue;
 
       // Create Edge
-      boost::add_edge(*it_i,*it_j,graph_);
+      add_edge(*it_i,*it_j,graph_);
     }
   }
 
 
-  // Find all paths between start and goal!
-  std::vector<HcGraphVertexType> visited;
-  visited.push_back(start_vtx);
-  DepthFirst(graph_,visited,goal_vtx, start.theta(), goal.theta(), start_velocity, free_goal_vel);
+  // Find the shortest paths in distinct homotopy classes
+  BestFirst(graph_, start_vtx, goal_vtx, start.theta(), goal.theta(), start_velocity, free_goal_vel);
 }
 
 
@@ -245,9 +351,6 @@ void ProbRoadmapGraph::createGraph(const PoseSE2& start, const PoseSE2& goal, do
 
   double area_width = cfg_->hcp.roadmap_graph_area_width;
 
-  boost::random::uniform_real_distribution<double> distribution_x(0, start_goal_dist * cfg_->hcp.roadmap_graph_area_length_scale);
-  boost::random::uniform_real_distribution<double> distribution_y(0, area_width);
-
   double phi = atan2(diff.coeffRef(1),diff.coeffRef(0)); // rotate area by this angle
   Eigen::Rotation2D<double> rot_phi(phi);
 
@@ -257,52 +360,33 @@ void ProbRoadmapGraph::createGraph(const PoseSE2& start, const PoseSE2& goal, do
   else
     area_origin = start.position() - 0.5*area_width*normal; // bottom left corner of the origin
 
+  const ObstacleSpatialIndex& obst_index = obstacleIndex();
+
+  // Keep the samples of the previous cycles that are still valid and top up the roadmap
+  updateSamples(obst_index, area_origin, rot_phi, start_goal_dist * cfg_->hcp.roadmap_graph_area_length_scale, area_width, dist_to_obst);
+
   // Insert Vertices
-  HcGraphVertexType start_vtx = boost::add_vertex(graph_); // start vertex
+  HcGraphVertexType start_vtx = add_vertex(graph_); // start vertex
   graph_[start_vtx].pos = start.position();
   diff.normalize(); // normalize in place
 
-
-  // Start sampling
-  for (int i=0; i < cfg_->hcp.roadmap_graph_no_samples; ++i)
+  for (const Eigen::Vector2d& sample : samples_)
   {
-    Eigen::Vector2d sample;
-//     bool coll_free;
-//     do // sample as long as a collision free sample is found
-//     {
-      // Sample coordinates
-      sample = area_origin + rot_phi*Eigen::Vector2d(distribution_x(rnd_generator_), distribution_y(rnd_generator_));
-
-      // Test for collision
-      // we do not care for collision checking here to improve efficiency, since we perform resampling repeatedly.
-      // occupied vertices are ignored in the edge insertion state since they always violate the edge-obstacle collision check.
-//       coll_free = true;
-//       for (ObstContainer::const_iterator it_obst = obstacles_->begin(); it_obst != obstacles_->end(); ++it_obst)
-//       {
-//         if ( (*it_obst)->checkCollision(sample, dist_to_obst)) // TODO really keep dist_to_obst here?
-//         {
-//           coll_free = false;
-//           break;
-//         }
-//       }
-//
-//     } while (!coll_free && ros::ok());
-
-    // Add new vertex
-    HcGraphVertexType v = boost::add_vertex(graph_);
+    HcGraphVertexType v = add_vertex(graph_);
     graph_[v].pos = sample;
   }
 
   // Now add goal vertex
-  HcGraphVertexType goal_vtx = boost::add_vertex(graph_); // goal vertex
+  HcGraphVertexType goal_vtx = add_vertex(graph_); // goal vertex
   graph_[goal_vtx].pos = goal.position();
 
 
   // Insert Edges
+  const int num_samples = (int)samples_.size();
   HcGraphVertexIterator it_i, end_i, it_j, end_j;
-  for (boost::tie(it_i,end_i) = boost::vertices(graph_); it_i!=boost::prior(end_i); ++it_i) // ignore goal in this loop
+  for (boost::tie(it_i,end_i) = vertices(graph_); it_i!=boost::prior(end_i); ++it_i) // ignore goal in this loop
   {
-    for (boost::tie(it_j,end_j) = boost::vertices(graph_); it_j!=end_j; ++it_j) // check all forward connections
+    for (boost::tie(it_j,end_j) = vertices(graph_); it_j!=end_j; ++it_j) // check all forward connections
     {
       if (it_i==it_j) // same vertex found
         continue;
@@ -315,28 +399,255 @@ void ProbRoadmapGraph::createGraph(const PoseSE2& start, const PoseSE2& goal, do
           continue; // diff is already normalized
 
 
-      // Collision Check
-      bool collision = false;
-      for (ObstContainer::const_iterator it_obst = hcp_->obstacles()->begin(); it_obst != hcp_->obstacles()->end(); ++it_obst)
+      // Collision Check (the result for edges between two samples is cached, vertex i+1 corresponds to sample i)
+      bool collision;
+      if (*it_i != start_vtx && *it_j != start_vtx && *it_j != goal_vtx)
       {
-        if ( (*it_obst)->checkLineIntersection(graph_[*it_i].pos,graph_[*it_j].pos, dist_to_obst) )
+        signed char& state = sample_edges_[(*it_i-1) * num_samples + (*it_j-1)];
+        if (state < 0)
         {
-          collision = true;
-          break;
+          state = checkEdgeCollision(obst_index, graph_[*it_i].pos, graph_[*it_j].pos, dist_to_obst) ? 1 : 0;
+          sample_edges_[(*it_j-1) * num_samples + (*it_i-1)] = state; // symmetric
         }
+        collision = state > 0;
       }
+      else
+        collision = checkEdgeCollision(obst_index, graph_[*it_i].pos, graph_[*it_j].pos, dist_to_obst);
       if (collision)
         continue;
 
       // Create Edge
-      boost::add_edge(*it_i,*it_j,graph_);
+      add_edge(*it_i,*it_j,graph_);
+    }
+  }
+
+  /// Find the shortest paths in distinct homotopy classes
+  BestFirst(graph_, start_vtx, goal_vtx, start.theta(), goal.theta(), start_velocity, free_goal_vel);
+}
+
+
+ProbRoadmapGraph::ObstacleSnapshot ProbRoadmapGraph::snapshotObstacle(const Obstacle& obstacle)
+{
+  ObstacleSnapshot snapshot = {obstacle.getCentroid().x(), obstacle.getCentroid().y(), obstacle.getBoundingRadius(), 0};
+  // points and circles are determined by their bounding circle
+  switch (obstacle.getType())
+  {
+    case ObstacleType::Line:
+    {
+      const LineObstacle& line = static_cast<const LineObstacle&>(obstacle);
+      boost::hash_range(snapshot.shape, line.start().data(), line.start().data() + 2);
+      boost::hash_range(snapshot.shape, line.end().data(), line.end().data() + 2);
+      break;
+    }
+    case ObstacleType::Pill:
+    {
+      const PillObstacle& pill = static_cast<const PillObstacle&>(obstacle);
+      boost::hash_range(snapshot.shape, pill.start().data(), pill.start().data() + 2);
+      boost::hash_range(snapshot.shape, pill.end().data(), pill.end().data() + 2);
+      break;
     }
+    case ObstacleType::Polygon:
+    {
+      for (const Eigen::Vector2d& vertex : static_cast<const PolygonObstacle&>(obstacle).vertices())
+        boost::hash_range(snapshot.shape, vertex.data(), vertex.data() + 2);
+      break;
+    }
+    default:
+      break;
+  }
+  return snapshot;
+}
+
+
+void ProbRoadmapGraph::updateSamples(const ObstacleSpatialIndex& obst_index, const Eigen::Vector2d& area_origin, const Eigen::Rotation2D<double>& area_rotation,
+                                     double area_length, double area_width, double dist_to_obst)
+{
+  const ObstContainer& obstacles = *hcp_->obstacles();
+
+  // snapshot of the obstacles (bounding circle and shape) to detect changes since the previous cycle
+  // (all buffers are members to reuse their capacity)
+  std::vector<ObstacleSnapshot>& snapshot = snapshot_buffer_;
+  std::vector<ObstacleSnapshot>& custom = custom_buffer_;
+  std::vector<ObstacleSnapshot>& changed = changed_obstacles_; // added, removed, moved or reshaped obstacles
+  snapshot.clear();
+  custom.clear();
+  bool unbounded = false;
+  for (const ObstaclePtr& obst : obstacles)
+  {
+    if (!std::isfinite(obst->getBoundingRadius()))
+      unbounded = true; // affects every edge
+    else if (obst->getType() == ObstacleType::Custom)
+      custom.push_back(snapshotObstacle(*obst)); // unknown shape, the edges close to it are always checked again
+    else
+      snapshot.push_back(snapshotObstacle(*obst));
+  }
+  std::sort(snapshot.begin(), snapshot.end());
+  changed.assign(custom_snapshot_.begin(), custom_snapshot_.end());
+  changed.insert(changed.end(), custom.begin(), custom.end());
+  custom_snapshot_.swap(custom);
+  std::set_symmetric_difference(snapshot.begin(), snapshot.end(), obstacle_snapshot_.begin(), obstacle_snapshot_.end(),
+                                std::back_inserter(changed));
+  obstacle_snapshot_.swap(snapshot);
+
+  if (!cfg_->hcp.roadmap_graph_persistent)
+    samples_.clear();
+  const int num_old = (int)samples_.size();
+  const bool reset_edges = dist_to_obst != sample_edges_dist_ || unbounded || 2 * changed.size() > obstacles.size();
+  sample_edges_dist_ = dist_to_obst;
+
+  // coarse occupancy map of the current area, it avoids most of the exact checks of the samples
+  buildOccupancyMap(area_origin, area_rotation, area_length, area_width, dist_to_obst);
+
+  // keep samples inside of the current area that are not occupied
+  const Eigen::Rotation2D<double> to_area = area_rotation.inverse();
+  std::vector<int>& kept = kept_samples_;
+  std::vector<int>& candidates = index_candidates_;
+  kept.clear();
+  for (int i = 0; i < num_old && (int)kept.size() < cfg_->hcp.roadmap_graph_no_samples; ++i)
+  {
+    const Eigen::Vector2d local = to_area * (samples_[i] - area_origin);
+    if (local.x() < 0 || local.x() > area_length || local.y() < 0 || local.y() > area_width)
+      continue;
+    if (isSampleOccupied(obst_index, samples_[i], local, dist_to_obst, candidates))
+      continue;
+    kept.push_back(i);
+  }
+
+  // compact the cached edge checks and invalidate those close to changed obstacles
+  const int num_kept = (int)kept.size();
+  std::vector<signed char>& edges = sample_edges_buffer_;
+  edges.assign(num_kept * num_kept, -1);
+  for (int a = 0; a < num_kept && !reset_edges; ++a)
+  {
+    for (int b = a + 1; b < num_kept; ++b)
+    {
+      signed char state = sample_edges_[kept[a] * num_old + kept[b]];
+      if (state < 0)
+        continue;
+      for (const ObstacleSnapshot& obst : changed)
+      {
+        if (distance_point_to_segment_2d(Eigen::Vector2d(obst.x, obst.y), samples_[kept[a]], samples_[kept[b]]) <= obst.radius + dist_to_obst)
+        {
+          state = -1;
+          break;
+        }
+      }
+      edges[a * num_kept + b] = edges[b * num_kept + a] = state;
+    }
+  }
+  for (int a = 0; a < num_kept; ++a)
+    samples_[a] = samples_[kept[a]];
+  samples_.resize(num_kept);
+
+  // top up with new samples (occupied samples are rejected, since they violate all edge collision checks).
+  // The candidates follow a Halton sequence, which covers the area more evenly than independent random samples.
+  // Paths of distinct homotopy classes pass close to the obstacles, hence a fraction of the samples is placed
+  // close to obstacle boundaries: a Halton point and a random neighbour are drawn and the free one is kept if the other one is occupied.
+  const double boundary_bias = obstacles.empty() ? 0. : cfg_->hcp.roadmap_graph_boundary_bias;
+  boost::random::uniform_real_distribution<double> uniform(0, 1);
+  boost::random::normal_distribution<double> neighbour(0, std::max(dist_to_obst, occupancy_cell_size_));
+  const int max_attempts = 10 * cfg_->hcp.roadmap_graph_no_samples;
+  for (int attempt = 0; (int)samples_.size() < cfg_->hcp.roadmap_graph_no_samples && attempt < 2 * max_attempts; ++attempt)
+  {
+    ++halton_index_;
+    Eigen::Vector2d local(halton(halton_index_, 2) * area_length, halton(halton_index_, 3) * area_width);
+    Eigen::Vector2d sample = area_origin + area_rotation * local;
+    const bool occupied = isSampleOccupied(obst_index, sample, local, dist_to_obst, candidates);
+
+    // boundary samples are only tried in the first half of the attempts, afterwards the free space is filled up
+    if (attempt < max_attempts && boundary_bias > 0 && uniform(rnd_generator_) < boundary_bias)
+    {
+      const Eigen::Vector2d other_local = local + Eigen::Vector2d(neighbour(rnd_generator_), neighbour(rnd_generator_));
+      if (other_local.x() < 0 || other_local.x() > area_length || other_local.y() < 0 || other_local.y() > area_width)
+        continue;
+      const Eigen::Vector2d other = area_origin + area_rotation * other_local;
+      if (occupied == isSampleOccupied(obst_index, other, other_local, dist_to_obst, candidates))
+        continue; // both free or both occupied
+      if (occupied)
+        sample = other;
+    }
+    else if (occupied)
+      continue;
+
+    samples_.push_back(sample);
+  }
+
+  const int num_samples = (int)samples_.size();
+  sample_edges_.assign(num_samples * num_samples, -1);
+  for (int a = 0; a < num_kept; ++a)
+    std::copy(edges.begin() + a * num_kept, edges.begin() + (a+1) * num_kept, sample_edges_.begin() + a * num_samples);
+}
+
+
+void ProbRoadmapGraph::buildOccupancyMap(const Eigen::Vector2d& area_origin, const Eigen::Rotation2D<double>& area_rotation,
+                                         double area_length, double area_width, double dist_to_obst)
+{
+  // square cells, about 32 along the width (and not more than 256 along the length)
+  occupancy_cell_size_ = std::max(std::max(area_width / 32., area_length / 256.), 1e-3);
+  occupancy_rows_ = std::max((int)std::ceil(area_width / occupancy_cell_size_), 1);
+  occupancy_cols_ = std::max((int)std::ceil(area_length / occupancy_cell_size_), 1);
+  occupancy_map_.assign(occupancy_rows_ * occupancy_cols_, 0);
+  occupancy_unbounded_ = false;
+
+  const Eigen::Rotation2D<double> to_area = area_rotation.inverse();
+  for (const ObstaclePtr& obst : *hcp_->obstacles())
+  {
+    const double radius = obst->getBoundingRadius() + dist_to_obst;
+    if (!std::isfinite(radius))
+    {
+      occupancy_unbounded_ = true;
+      return;
+    }
+    // mark the cells covered by the bounding box of the inflated bounding circle
+    const Eigen::Vector2d center = to_area * (obst->getCentroid() - area_origin);
+    const int col_min = std::max((int)std::floor((center.x() - radius) / occupancy_cell_size_), 0);
+    const int col_max = std::min((int)std::floor((center.x() + radius) / occupancy_cell_size_), occupancy_cols_ - 1);
+    const int row_min = std::max((int)std::floor((center.y() - radius) / occupancy_cell_size_), 0);
+    const int row_max = std::min((int)std::floor((center.y() + radius) / occupancy_cell_size_), occupancy_rows_ - 1);
+    for (int row = row_min; row <= row_max; ++row)
+      std::fill(occupancy_map_.begin() + row * occupancy_cols_ + col_min, occupancy_map_.begin() + row * occupancy_cols_ + col_max + 1, 1);
+  }
+}
+
+
+bool ProbRoadmapGraph::isSampleOccupied(const ObstacleSpatialIndex& obst_index, const Eigen::Vector2d& point, const Eigen::Vector2d& local,
+                                        double dist_to_obst, std::vector<int>& candidates) const
+{
+  if (!occupancy_unbounded_)
+  {
+    const int col = (int)std::floor(local.x() / occupancy_cell_size_);
+    const int row = (int)std::floor(local.y() / occupancy_cell_size_);
+    if (col >= 0 && col < occupancy_cols_ && row >= 0 && row < occupancy_rows_ && !occupancy_map_[row * occupancy_cols_ + col])
+      return false;
+  }
+  return isOccupied(obst_index, point, dist_to_obst, candidates);
+}
+
+
+double ProbRoadmapGraph::halton(unsigned int index, unsigned int base)
+{
+  double value = 0;
+  double factor = 1. / base;
+  while (index > 0)
+  {
+    value += factor * (index % base);
+    index /= base;
+    factor /= base;
   }
+  return value;
+}
+
 
-  /// Find all paths between start and goal!
-  std::vector<HcGraphVertexType> visited;
-  visited.push_back(start_vtx);
-  DepthFirst(graph_,visited,goal_vtx, start.theta(), goal.theta(), start_velocity, free_goal_vel);
+bool ProbRoadmapGraph::isOccupied(const ObstacleSpatialIndex& obst_index, const Eigen::Vector2d& point, double dist_to_obst, std::vector<int>& candidates) const
+{
+  const ObstContainer& obstacles = *hcp_->obstacles();
+  obst_index.queryCircle(point, dist_to_obst, candidates);
+  for (int idx : candidates)
+  {
+    if (obstacles[idx]->checkCollision(point, dist_to_obst))
+      return true;
+  }
+  return false;
 }
 
 } // end namespace
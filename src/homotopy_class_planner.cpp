@@ -116,6 +116,12 @@ bool HomotopyClassPlanner::plan(const PoseSE2& start, const PoseSE2& goal, const
 {
   ROS_ASSERT_MSG(initialized_, "Call initialize() first.");
 
+  // Broadphase shared by the roadmap collision checks and the obstacle association of all candidates
+  if (obstacles_)
+    obstacle_index_.build(*obstacles_);
+  else
+    obstacle_index_.clear();
+
   // Update old TEBs with new start, goal and velocity
   updateAllTEBs(&start, &goal, start_vel);
 
@@ -185,13 +191,8 @@ void HomotopyClassPlanner::visualize()
 
 bool HomotopyClassPlanner::hasEquivalenceClass(const EquivalenceClassPtr& eq_class) const
 {
-  // iterate existing h-signatures and check if there is an existing H-Signature similar the candidate
-  for (const std::pair<EquivalenceClassPtr, bool>& eqrel : equivalence_classes_)
-  {
-     if (eq_class->isEqual(*eqrel.first))
-        return true; // Found! Homotopy class already exists, therefore nothing added
-  }
-  return false;
+  // look up the buckets of the index that might contain a similar H-Signature
+  return equivalence_class_index_.contains(*eq_class);
 }
 
 bool HomotopyClassPlanner::addEquivalenceClassIfNew(const EquivalenceClassPtr& eq_class, bool lock)
@@ -205,6 +206,20 @@ bool HomotopyClassPlanner::addEquivalenceClassIfNew(const EquivalenceClassPtr& e
     return false;
   }
 
+  if (!isNewEquivalenceClass(eq_class))
+    return false;
+
+  // Homotopy class not found -> Add to class-list, return that the h-signature is new
+  equivalence_classes_.push_back(std::make_pair(eq_class,lock));
+  equivalence_class_index_.insert(eq_class);
+  return true;
+}
+
+bool HomotopyClassPlanner::isNewEquivalenceClass(const EquivalenceClassPtr& eq_class) const
+{
+  if (!eq_class || !eq_class->isValid())
+    return false;
+
   if (hasEquivalenceClass(eq_class))
   {
     // Allow up to configured number of Tebs that are in the same homotopy
@@ -212,9 +227,6 @@ bool HomotopyClassPlanner::addEquivalenceClassIfNew(const EquivalenceClassPtr& e
     if (!isInBestTebClass(eq_class) || numTebsInBestTebClass() >= cfg_->hcp.max_number_plans_in_current_class)
       return false;
   }
-
-  // Homotopy class not found -> Add to class-list, return that the h-signature is new
-  equivalence_classes_.push_back(std::make_pair(eq_class,lock));
   return true;
 }
 
@@ -223,6 +235,11 @@ void HomotopyClassPlanner::renewAndAnalyzeOldTebs(bool delete_detours)
 {
   // clear old h-signatures (since they could be changed due to new obstacle positions.
   equivalence_classes_.clear();
+  equivalence_class_index_.clear();
+
+  // the classes of trajectories that did not change since the previous cycle are reused
+  const bool obstacles_unchanged = updateObstacleSnapshot();
+  teb_eq_class_cache_next_.clear();
 
   // Adding the equivalence class of the latest best_teb_ first
   TebOptPlannerContainer::iterator it_best_teb = best_teb_ ? std::find(tebs_.begin(), tebs_.end(), best_teb_) : tebs_.end();
@@ -230,9 +247,7 @@ void HomotopyClassPlanner::renewAndAnalyzeOldTebs(bool delete_detours)
   if (has_best_teb)
   {
     std::iter_swap(tebs_.begin(), it_best_teb);  // Putting the last best teb at the beginning of the container
-    best_teb_eq_class_ = calculateEquivalenceClass(best_teb_->teb().poses().begin(),
-      best_teb_->teb().poses().end(), getCplxFromVertexPosePtr , obstacles_,
-      best_teb_->teb().timediffs().begin(), best_teb_->teb().timediffs().end());
+    best_teb_eq_class_ = calculateEquivalenceClassOfTeb(best_teb_, obstacles_unchanged);
     addEquivalenceClassIfNew(best_teb_eq_class_);
   }
   // Collect h-signatures for all existing TEBs and store them together with the corresponding iterator / pointer:
@@ -244,8 +259,24 @@ void HomotopyClassPlanner::renewAndAnalyzeOldTebs(bool delete_detours)
   while(it_teb != tebs_.end())
   {
     // calculate equivalence class for the current candidate
-    EquivalenceClassPtr equivalence_class = calculateEquivalenceClass(it_teb->get()->teb().poses().begin(), it_teb->get()->teb().poses().end(), getCplxFromVertexPosePtr , obstacles_,
-                                                                      it_teb->get()->teb().timediffs().begin(), it_teb->get()->teb().timediffs().end());
+    EquivalenceClassPtr equivalence_class = calculateEquivalenceClassOfTeb(*it_teb, obstacles_unchanged);
+
+    // further trajectories in a known class (see isNewEquivalenceClass()) are only kept if they differ from the ones already kept
+    bool duplicate = false;
+    if (cfg_->hcp.duplicate_trajectory_distance > 0 && hasEquivalenceClass(equivalence_class))
+    {
+      for (TebOptPlannerContainer::iterator it_kept = tebs_.begin(); it_kept != it_teb && !duplicate; ++it_kept)
+      {
+        EquivalenceClassCache::const_iterator kept_class = teb_eq_class_cache_next_.find(it_kept->get());
+        duplicate = kept_class != teb_eq_class_cache_next_.end() && isDuplicateTrajectory(**it_teb, equivalence_class, **it_kept, kept_class->second.eq_class);
+      }
+    }
+    if (duplicate)
+    {
+      ROS_DEBUG("HomotopyClassPlanner: Removing a teb that is a duplicate of another one in the same equivalence class");
+      it_teb = eraseTeb(it_teb);
+      continue;
+    }
 
 //     teb_candidates.push_back(std::make_pair(it_teb,H));
 
@@ -254,12 +285,14 @@ void HomotopyClassPlanner::renewAndAnalyzeOldTebs(bool delete_detours)
     bool new_flag = addEquivalenceClassIfNew(equivalence_class);
     if (!new_flag)
     {
-      it_teb = tebs_.erase(it_teb);
+      it_teb = eraseTeb(it_teb);
       continue;
     }
 
     ++it_teb;
   }
+  teb_eq_class_cache_.swap(teb_eq_class_cache_next_); // the classes of this cycle are the reference of the next one (removed trajectories are erased in eraseTeb())
+
   if(delete_detours)
     deletePlansDetouringBackwards(cfg_->hcp.detours_orientation_tolerance, cfg_->hcp.length_start_orientation_vector);
 
@@ -364,19 +397,111 @@ void HomotopyClassPlanner::exploreEquivalenceClassesAndInitTebs(const PoseSE2& s
 }
 
 
+EquivalenceClassPtr HomotopyClassPlanner::calculateEquivalenceClassOfTeb(const TebOptimalPlannerPtr& teb, bool obstacles_unchanged)
+{
+  const double tolerance = cfg_->hcp.h_signature_reuse_tolerance;
+  TimedElasticBand& band = teb->teb();
+  CachedEquivalenceClass& entry = teb_eq_class_cache_next_[teb.get()];
+
+  EquivalenceClassCache::iterator cached = teb_eq_class_cache_.find(teb.get());
+  if (tolerance > 0 && obstacles_unchanged && cached != teb_eq_class_cache_.end() && cached->second.poses.size() == 3 * (std::size_t)band.sizePoses())
+  {
+    const std::vector<double>& poses = cached->second.poses;
+    bool unchanged = true;
+    for (int i = 0; i < band.sizePoses() && unchanged; ++i)
+    {
+      const double dt = i < band.sizeTimeDiffs() ? band.TimeDiff(i) : 0.;
+      unchanged = std::abs(poses[3*i] - band.Pose(i).x()) <= tolerance && std::abs(poses[3*i+1] - band.Pose(i).y()) <= tolerance
+                  && std::abs(poses[3*i+2] - dt) <= tolerance;
+    }
+    if (unchanged)
+    {
+      entry = cached->second; // keep the poses of the cached class as reference, such that small changes do not accumulate
+      return entry.eq_class;
+    }
+  }
+
+  if (cfg_->hcp.h_signature_full_update_interval > 0 && !cfg_->obstacles.include_dynamic_obstacles && obstacles_)
+  {
+    // the 3d h-signature depends on the absolute time of each pose, which changes whenever the trajectory is pruned
+    if (cached != teb_eq_class_cache_.end())
+      std::swap(entry.h_signature, cached->second.h_signature);
+    entry.eq_class = EquivalenceClassPtr(new HSignature(*cfg_, entry.h_signature.update(*cfg_, band.poses().begin(), band.poses().end(),
+                                         getCplxFromVertexPosePtr, *obstacles_, tolerance, cfg_->hcp.h_signature_full_update_interval)));
+  }
+  else
+    entry.eq_class = calculateEquivalenceClass(band.poses().begin(), band.poses().end(), getCplxFromVertexPosePtr, obstacles_,
+                                               band.timediffs().begin(), band.timediffs().end());
+  entry.poses.resize(3 * band.sizePoses());
+  for (int i = 0; i < band.sizePoses(); ++i)
+  {
+    entry.poses[3*i] = band.Pose(i).x();
+    entry.poses[3*i+1] = band.Pose(i).y();
+    entry.poses[3*i+2] = i < band.sizeTimeDiffs() ? band.TimeDiff(i) : 0.;
+  }
+  return entry.eq_class;
+}
+
+
+bool HomotopyClassPlanner::isDuplicateTrajectory(const TebOptimalPlanner& teb1, const EquivalenceClassPtr& class1,
+                                                 const TebOptimalPlanner& teb2, const EquivalenceClassPtr& class2) const
+{
+  const double threshold = cfg_->hcp.duplicate_trajectory_distance;
+  if (!(threshold > 0) || !class1 || !class2 || !class1->isEqual(*class2))
+    return false;
+  return teb1.getTrajectoryFingerprint().distanceFrechet(teb2.getTrajectoryFingerprint()) < threshold;
+}
+
+
+bool HomotopyClassPlanner::updateObstacleSnapshot()
+{
+  const double tolerance = cfg_->hcp.h_signature_reuse_tolerance;
+  const std::size_t num_obstacles = obstacles_ ? obstacles_->size() : 0;
+  bool unchanged = obstacle_snapshot_.size() == 4 * num_obstacles;
+  for (std::size_t i = 0; i < num_obstacles && unchanged; ++i)
+  {
+    const Obstacle& obst = *obstacles_->at(i);
+    unchanged = (obst.getCentroid() - Eigen::Vector2d(obstacle_snapshot_[4*i], obstacle_snapshot_[4*i+1])).cwiseAbs().maxCoeff() <= tolerance
+                && (obst.getCentroidVelocity() - Eigen::Vector2d(obstacle_snapshot_[4*i+2], obstacle_snapshot_[4*i+3])).cwiseAbs().maxCoeff() <= tolerance;
+  }
+  if (unchanged)
+    return true;
+
+  obstacle_snapshot_.resize(4 * num_obstacles);
+  for (std::size_t i = 0; i < num_obstacles; ++i)
+  {
+    const Obstacle& obst = *obstacles_->at(i);
+    obstacle_snapshot_[4*i] = obst.getCentroid().x();
+    obstacle_snapshot_[4*i+1] = obst.getCentroid().y();
+    obstacle_snapshot_[4*i+2] = obst.getCentroidVelocity().x();
+    obstacle_snapshot_[4*i+3] = obst.getCentroidVelocity().y();
+  }
+  return false;
+}
+
+
 TebOptimalPlannerPtr HomotopyClassPlanner::addAndInitNewTeb(const PoseSE2& start, const PoseSE2& goal, const geometry_msgs::Twist* start_velocity, bool free_goal_vel)
 {
   if(tebs_.size() >= cfg_->hcp.max_number_classes)
     return TebOptimalPlannerPtr();
-  TebOptimalPlannerPtr candidate =  TebOptimalPlannerPtr( new TebOptimalPlanner(*cfg_, obstacles_, robot_model_, visualization_));
+
+  // check the equivalence class of the straight line before a planner is set up for it
+  const PoseSE2 straight_line[2] = {start, goal};
+  EquivalenceClassPtr H = calculateEquivalenceClass(straight_line, straight_line + 2, getCplxFromPoseSE2, obstacles_);
+  if (!isNewEquivalenceClass(H))
+    return TebOptimalPlannerPtr();
+
+  TebOptimalPlannerPtr candidate = acquireTebPlanner();
 
   candidate->teb().initTrajectoryToGoal(start, goal, 0, cfg_->robot.max_vel_x, cfg_->trajectory.min_samples, cfg_->trajectory.allow_init_with_backwards_motion);
 
   if (start_velocity)
     candidate->setVelocityStart(*start_velocity);
 
-  EquivalenceClassPtr H = calculateEquivalenceClass(candidate->teb().poses().begin(), candidate->teb().poses().end(), getCplxFromVertexPosePtr, obstacles_,
-                                                    candidate->teb().timediffs().begin(), candidate->teb().timediffs().end());
+  // the 3d h-signature depends on the timing of the trajectory
+  if (cfg_->obstacles.include_dynamic_obstacles)
+    H = calculateEquivalenceClass(candidate->teb().poses().begin(), candidate->teb().poses().end(), getCplxFromVertexPosePtr, obstacles_,
+                                  candidate->teb().timediffs().begin(), candidate->teb().timediffs().end());
 
   if (free_goal_vel)
     candidate->setVelocityGoalFree(); 
@@ -388,6 +513,7 @@ TebOptimalPlannerPtr HomotopyClassPlanner::addAndInitNewTeb(const PoseSE2& start
   }
 
   // If the candidate constitutes no new equivalence class, return a null pointer
+  releaseTebPlanner(candidate);
   return TebOptimalPlannerPtr();
 }
 
@@ -402,13 +528,7 @@ bool HomotopyClassPlanner::isInBestTebClass(const EquivalenceClassPtr& eq_class)
 
 int HomotopyClassPlanner::numTebsInClass(const EquivalenceClassPtr& eq_class) const
 {
-  int count = 0;
-  for (const std::pair<EquivalenceClassPtr, bool>& eqrel : equivalence_classes_)
-  {
-    if (eq_class->isEqual(*eqrel.first))
-      ++count;
-  }
-  return count;
+  return equivalence_class_index_.count(*eq_class);
 }
 
 int HomotopyClassPlanner::numTebsInBestTebClass() const
@@ -423,7 +543,7 @@ TebOptimalPlannerPtr HomotopyClassPlanner::addAndInitNewTeb(const std::vector<ge
 {
   if(tebs_.size() >= cfg_->hcp.max_number_classes)
     return TebOptimalPlannerPtr();
-  TebOptimalPlannerPtr candidate = TebOptimalPlannerPtr( new TebOptimalPlanner(*cfg_, obstacles_, robot_model_, visualization_));
+  TebOptimalPlannerPtr candidate = acquireTebPlanner();
 
   candidate->teb().initTrajectoryToGoal(initial_plan, cfg_->robot.max_vel_x, cfg_->robot.max_vel_theta,
     cfg_->trajectory.global_plan_overwrite_orientation, cfg_->trajectory.min_samples, cfg_->trajectory.allow_init_with_backwards_motion);
@@ -445,6 +565,7 @@ TebOptimalPlannerPtr HomotopyClassPlanner::addAndInitNewTeb(const std::vector<ge
   }
 
   // If the candidate constitutes no new equivalence class, return a null pointer
+  releaseTebPlanner(candidate);
   return TebOptimalPlannerPtr();
 }
 
@@ -457,10 +578,16 @@ void HomotopyClassPlanner::updateAllTEBs(const PoseSE2* start, const PoseSE2* go
         || fabs(g2o::normalize_theta(goal->theta() - tebs_.front()->teb().BackPose().theta())) >= cfg_->trajectory.force_reinit_new_goal_angular))
   {
       ROS_DEBUG("New goal: distance to existing goal is higher than the specified threshold. Reinitalizing trajectories.");
-      tebs_.clear();
+      commitBestTebToWarmStartCache();
+      clearTebs();
       equivalence_classes_.clear();
+      equivalence_class_index_.clear();
   }
 
+  // seed the first candidate from a cached solution instead of exploring from scratch only
+  if (tebs_.empty())
+    addTebFromWarmStartCache(*start, *goal);
+
   // hot-start from previous solutions
   for (TebOptPlannerContainer::iterator it_teb = tebs_.begin(); it_teb != tebs_.end(); ++it_teb)
   {
@@ -471,10 +598,118 @@ void HomotopyClassPlanner::updateAllTEBs(const PoseSE2* start, const PoseSE2* go
 }
 
 
+void HomotopyClassPlanner::commitBestTebToWarmStartCache()
+{
+  if (!cfg_ || cfg_->trajectory.warm_start_cache_size <= 0)
+    return;
+  warm_start_cache_.commit(obstacles_, cfg_->obstacles.min_obstacle_dist*cfg_->obstacles.obstacle_association_force_inclusion_factor,
+                           cfg_->trajectory.warm_start_cache_resolution, cfg_->trajectory.warm_start_cache_size);
+}
+
+bool HomotopyClassPlanner::addTebFromWarmStartCache(const PoseSE2& start, const PoseSE2& goal)
+{
+  if (cfg_->trajectory.warm_start_cache_size <= 0 || warm_start_cache_.size() == 0)
+    return false;
+
+  TebOptimalPlannerPtr candidate = acquireTebPlanner();
+  if (!warm_start_cache_.seed(start, goal, obstacles_, cfg_->obstacles.min_obstacle_dist*cfg_->obstacles.obstacle_association_force_inclusion_factor,
+                              cfg_->trajectory.warm_start_cache_resolution, cfg_->trajectory.force_reinit_new_goal_dist,
+                              cfg_->trajectory.force_reinit_new_goal_angular, cfg_->trajectory.min_samples, candidate->teb()))
+  {
+    releaseTebPlanner(candidate);
+    return false;
+  }
+
+  ROS_DEBUG("HomotopyClassPlanner: trajectory initialized from a cached solution (warm-start cache).");
+  tebs_.push_back(candidate);
+  return true;
+}
+
+
 void HomotopyClassPlanner::optimizeAllTEBs(int iter_innerloop, int iter_outerloop)
 {
+  // the index is only read during the optimization, hence it can be shared among the threads
+  optimization_candidates_.clear();
+  for (TebOptPlannerContainer::iterator it_teb = tebs_.begin(); it_teb != tebs_.end(); ++it_teb)
+  {
+    it_teb->get()->setObstacleIndex(&obstacle_index_);
+    optimization_candidates_.push_back(it_teb->get());
+  }
+
+  const double pruning_ratio = cfg_->hcp.selection_pruning_ratio;
+  if (!(pruning_ratio > 0) || optimization_candidates_.size() < 2)
+  {
+    optimizeCandidates(iter_innerloop, iter_outerloop, 0);
+    return;
+  }
+
+  // successive halving: all candidates get a cheap first round, only the cheapest ones are optimized further
+  // with rounds of 1, 2, 4, ... outer iterations. The pruned candidates are optimized again in the next cycle.
+  // Within a round all candidates have performed the same number of outer iterations, hence their costs are comparable.
+  const TebOptimalPlanner* protected_tebs[2] = {best_teb_.get(), initial_plan_teb_.get()};
+  auto isProtected = [&protected_tebs](const TebOptimalPlanner* teb) {return teb == protected_tebs[0] || teb == protected_tebs[1];};
+  auto rankingCost = [](const TebOptimalPlanner* teb) {
+    const double cost = teb->getCurrentCost();
+    return std::isfinite(cost) ? cost : std::numeric_limits<double>::max();
+  };
+
+  int iterations_done = 0;
+  bool pruned = false;
+  for (int round_iterations = 1; iterations_done < iter_outerloop; round_iterations *= 2)
+  {
+    const int iterations = std::min(round_iterations, iter_outerloop - iterations_done);
+    optimizeCandidates(iter_innerloop, iterations, iterations_done);
+    iterations_done += iterations;
+    if (iterations_done >= iter_outerloop)
+      break;
+
+    // failed optimizations are not continued
+    std::size_t num_succeeded = 0;
+    for (std::size_t i = 0; i < optimization_candidates_.size(); ++i)
+    {
+      if (optimization_succeeded_[i])
+        optimization_candidates_[num_succeeded++] = optimization_candidates_[i];
+    }
+    optimization_candidates_.resize(num_succeeded);
+
+    // protected candidates first, the others by ascending cost
+    std::stable_sort(optimization_candidates_.begin(), optimization_candidates_.end(),
+                     [&](const TebOptimalPlanner* a, const TebOptimalPlanner* b) {
+                       const bool a_protected = isProtected(a);
+                       const bool b_protected = isProtected(b);
+                       if (a_protected != b_protected)
+                         return a_protected;
+                       return rankingCost(a) < rankingCost(b);
+                     });
+    std::size_t num_protected = 0;
+    while (num_protected < optimization_candidates_.size() && isProtected(optimization_candidates_[num_protected]))
+      ++num_protected;
+    std::size_t num_pruned = std::min((std::size_t)std::floor(pruning_ratio * optimization_candidates_.size()),
+                                      optimization_candidates_.size() - num_protected);
+    if (num_pruned >= optimization_candidates_.size())
+      num_pruned = optimization_candidates_.size() - 1; // keep at least one candidate
+    optimization_candidates_.resize(optimization_candidates_.size() - num_pruned);
+    pruned = pruned || num_pruned > 0;
+    if (optimization_candidates_.empty())
+      break;
+  }
+
+  // The cost computed by optimizeTEB() refers to the graph of the last outer iteration, whose obstacle weights grow with
+  // each iteration (optim.weight_adapt_factor). After pruning the candidates have performed different numbers of iterations,
+  // hence all costs are evaluated again with the unscaled weights before selectBestTeb() compares them.
+  if (pruned)
+  {
+    for (TebOptPlannerContainer::iterator it_teb = tebs_.begin(); it_teb != tebs_.end(); ++it_teb)
+      it_teb->get()->computeCurrentCost(cfg_->hcp.selection_obst_cost_scale, cfg_->hcp.selection_viapoint_cost_scale, cfg_->hcp.selection_alternative_time_cost);
+  }
+}
+
+void HomotopyClassPlanner::optimizeCandidates(int iter_innerloop, int iter_outerloop, int first_outerloop_iteration)
+{
+  optimization_succeeded_.assign(optimization_candidates_.size(), 0);
+
   // optimize TEBs in parallel since they are independend of each other
-  if (cfg_->hcp.enable_multithreading)
+  if (cfg_->hcp.enable_multithreading && optimization_candidates_.size() > 1)
   {
     // Must prevent .join_all() from throwing exception if interruption was
     // requested, as this can lead to multiple threads operating on the same
@@ -482,20 +717,23 @@ void HomotopyClassPlanner::optimizeAllTEBs(int iter_innerloop, int iter_outerloo
     boost::this_thread::disable_interruption di;
 
     boost::thread_group teb_threads;
-    for (TebOptPlannerContainer::iterator it_teb = tebs_.begin(); it_teb != tebs_.end(); ++it_teb)
+    for (std::size_t i = 0; i < optimization_candidates_.size(); ++i)
     {
-      teb_threads.create_thread( boost::bind(&TebOptimalPlanner::optimizeTEB, it_teb->get(), iter_innerloop, iter_outerloop,
-                                             true, cfg_->hcp.selection_obst_cost_scale, cfg_->hcp.selection_viapoint_cost_scale,
-                                             cfg_->hcp.selection_alternative_time_cost) );
+      teb_threads.create_thread( [this, i, iter_innerloop, iter_outerloop, first_outerloop_iteration]() {
+        optimization_succeeded_[i] = optimization_candidates_[i]->optimizeTEB(iter_innerloop, iter_outerloop, true, cfg_->hcp.selection_obst_cost_scale,
+                                                                              cfg_->hcp.selection_viapoint_cost_scale, cfg_->hcp.selection_alternative_time_cost,
+                                                                              first_outerloop_iteration);
+      } );
     }
     teb_threads.join_all();
   }
   else
   {
-    for (TebOptPlannerContainer::iterator it_teb = tebs_.begin(); it_teb != tebs_.end(); ++it_teb)
+    for (std::size_t i = 0; i < optimization_candidates_.size(); ++i)
     {
-      it_teb->get()->optimizeTEB(iter_innerloop,iter_outerloop, true, cfg_->hcp.selection_obst_cost_scale,
-                                 cfg_->hcp.selection_viapoint_cost_scale, cfg_->hcp.selection_alternative_time_cost); // compute cost as well inside optimizeTEB (last argument = true)
+      optimization_succeeded_[i] = optimization_candidates_[i]->optimizeTEB(iter_innerloop, iter_outerloop, true, cfg_->hcp.selection_obst_cost_scale,
+                                                                            cfg_->hcp.selection_viapoint_cost_scale, cfg_->hcp.selection_alternative_time_cost,
+                                                                            first_outerloop_iteration); // compute cost as well inside optimizeTEB (last argument = true)
     }
   }
 }
@@ -558,7 +796,8 @@ void HomotopyClassPlanner::randomlyDropTebs()
     if (it_teb->get() != best_teb_.get()  // Always preserve the "best" teb
         && (random_() <= cfg_->hcp.selection_dropping_probability * random_.max()))
     {
-      it_teb = tebs_.erase(it_teb);
+      it_teb = eraseTeb(it_teb);
+      equivalence_class_index_.erase(it_eqrel->first);
       it_eqrel = equivalence_classes_.erase(it_eqrel);
     }
     else
@@ -653,8 +892,9 @@ TebOptimalPlannerPtr HomotopyClassPlanner::selectBestTeb()
 //       }
 //   }
 
-    // check if we are allowed to change
-    if (last_best_teb_ && best_teb_ != last_best_teb_)
+    // check if we are allowed to change (switching to a duplicate of the last best teb does not change the equivalence class)
+    if (last_best_teb_ && best_teb_ != last_best_teb_ && !isDuplicateTrajectory(*best_teb_, equivalenceClassOfTeb(best_teb_),
+                                                                                 *last_best_teb_, equivalenceClassOfTeb(last_best_teb_)))
     {
       ros::Time now = ros::Time::now();
       if ((now-last_eq_class_switching_time_).toSec() > cfg_->hcp.switching_blocking_period)
@@ -674,6 +914,19 @@ TebOptimalPlannerPtr HomotopyClassPlanner::selectBestTeb()
     return best_teb_;
 }
 
+EquivalenceClassPtr HomotopyClassPlanner::equivalenceClassOfTeb(const TebOptimalPlannerPtr& teb) const
+{
+  if (equivalence_classes_.size() != tebs_.size())
+    return EquivalenceClassPtr(); // the classes of some trajectories are not known yet
+
+  for (std::size_t i = 0; i < tebs_.size(); ++i)
+  {
+    if (tebs_[i] == teb)
+      return equivalence_classes_[i].first;
+  }
+  return EquivalenceClassPtr();
+}
+
 int HomotopyClassPlanner::bestTebIdx() const
 {
   if (tebs_.size() == 1)
@@ -710,6 +963,8 @@ bool HomotopyClassPlanner::isTrajectoryFeasible(base_local_planner::CostmapModel
       if(last_best_teb_ && (last_best_teb_ == best)) // Same plan as before.
         return feasible;                             // Not failing could result in oscillations between trajectories.
     }
+    else if (cfg_->trajectory.warm_start_cache_size > 0)
+      warm_start_cache_.remember(best->teb());
   }
   return feasible;
 }
@@ -736,7 +991,8 @@ TebOptPlannerContainer::iterator HomotopyClassPlanner::removeTeb(TebOptimalPlann
   {
     if(*it == teb)
     {
-      return_iterator = tebs_.erase(it);
+      return_iterator = eraseTeb(it);
+      equivalence_class_index_.erase(it_eq_classes->first);
       equivalence_classes_.erase(it_eq_classes);
       break;
     }
@@ -745,6 +1001,51 @@ TebOptPlannerContainer::iterator HomotopyClassPlanner::removeTeb(TebOptimalPlann
   return return_iterator;
 }
 
+TebOptimalPlannerPtr HomotopyClassPlanner::acquireTebPlanner()
+{
+  if (teb_pool_.empty())
+    return TebOptimalPlannerPtr( new TebOptimalPlanner(*cfg_, obstacles_, robot_model_, visualization_));
+
+  // reuse the g2o optimizer of a removed trajectory
+  TebOptimalPlannerPtr planner = teb_pool_.back();
+  teb_pool_.pop_back();
+  planner->reinitialize(*cfg_, obstacles_, robot_model_, visualization_);
+  return planner;
+}
+
+void HomotopyClassPlanner::releaseTebPlanner(const TebOptimalPlannerPtr& teb)
+{
+  // the planner must not be referenced anywhere else (e.g. best_teb_, initial_plan_teb_)
+  if (teb && teb.unique() && (int)teb_pool_.size() < cfg_->hcp.max_number_classes)
+    teb_pool_.push_back(teb);
+}
+
+TebOptPlannerContainer::iterator HomotopyClassPlanner::eraseTeb(TebOptPlannerContainer::iterator it)
+{
+  // the planner is recycled, hence its cached class must not be found again under the same address
+  teb_eq_class_cache_.erase(it->get());
+  teb_eq_class_cache_next_.erase(it->get());
+  TebOptimalPlannerPtr teb;
+  teb.swap(*it);
+  it = tebs_.erase(it);
+  releaseTebPlanner(teb);
+  return it;
+}
+
+void HomotopyClassPlanner::clearTebs()
+{
+  teb_eq_class_cache_.clear();
+  teb_eq_class_cache_next_.clear();
+  TebOptPlannerContainer tebs;
+  tebs.swap(tebs_);
+  for (TebOptimalPlannerPtr& teb : tebs)
+  {
+    TebOptimalPlannerPtr released;
+    released.swap(teb);
+    releaseTebPlanner(released);
+  }
+}
+
 void HomotopyClassPlanner::setPreferredTurningDir(RotType dir)
 {
   // set preferred turning dir for all TEBs
@@ -763,6 +1064,29 @@ bool HomotopyClassPlanner::hasDiverged() const
   return best_teb_->hasDiverged();
 }
 
+bool HomotopyClassPlanner::getTrajectoryBoundingBox(Eigen::Vector2d& min_corner, Eigen::Vector2d& max_corner) const
+{
+  bool valid = false;
+  Eigen::Vector2d teb_min, teb_max;
+  for (TebOptPlannerContainer::const_iterator it_teb = tebs_.begin(); it_teb != tebs_.end(); ++it_teb)
+  {
+    if (!(*it_teb)->getTrajectoryBoundingBox(teb_min, teb_max))
+      continue;
+    if (valid)
+    {
+      min_corner = min_corner.cwiseMin(teb_min);
+      max_corner = max_corner.cwiseMax(teb_max);
+    }
+    else
+    {
+      min_corner = teb_min;
+      max_corner = teb_max;
+      valid = true;
+    }
+  }
+  return valid;
+}
+
 void HomotopyClassPlanner::computeCurrentCost(std::vector<double>& cost, double obst_cost_scale, double viapoint_cost_scale, bool alternative_time_cost)
 {
   for (TebOptPlannerContainer::iterator it_teb = tebs_.begin(); it_teb != tebs_.end(); ++it_teb)
@@ -0,0 +1,129 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Christoph Rösmann
+ *********************************************************************/
+
+
+
+#include <teb_local_planner/obstacle_association_cache.h>
+
+#include <cmath>
+#include <algorithm>
+
+namespace teb_local_planner
+{
+
+void ObstacleAssociationCache::beginPass(const ObstContainer& obstacles, const ObstacleSpatialIndex* index)
+{
+  // the margins refer to a specific obstacle set
+  if (&obstacles != obstacles_ || obstacles.size() != num_obstacles_)
+  {
+    entries_.clear();
+    obstacles_ = &obstacles;
+    num_obstacles_ = obstacles.size();
+  }
+  next_entries_.clear();
+  search_start_ = 0;
+  index_ = index;
+}
+
+
+bool ObstacleAssociationCache::associate(const TebConfig& cfg, const BaseRobotFootprintModel& robot_model, const PoseSE2& pose,
+                                         double arc_length, ObstContainer& relevant)
+{
+  const double tolerance = cfg.obstacles.obstacle_association_cache_tolerance;
+  if (tolerance > 0 && !entries_.empty())
+  {
+    // monotonic sweep: entries_[search_start_] is the last entry with an arc-length below the current one
+    while (search_start_ + 1 < entries_.size() && entries_[search_start_ + 1].arc_length <= arc_length)
+      ++search_start_;
+
+    // try the neighbor with the closest arc-length first
+    std::size_t candidates[2] = {search_start_, std::min(search_start_ + 1, entries_.size() - 1)};
+    if (std::fabs(entries_[candidates[1]].arc_length - arc_length) < std::fabs(entries_[candidates[0]].arc_length - arc_length))
+      std::swap(candidates[0], candidates[1]);
+
+    const double circumscribed_radius = robot_model.getCircumscribedRadius();
+    for (std::size_t idx : candidates)
+    {
+      const Entry& entry = entries_[idx];
+      if (!isValid(entry, pose, tolerance, circumscribed_radius))
+        continue;
+
+      relevant.insert(relevant.end(), entry.obstacles.begin(), entry.obstacles.end());
+      next_entries_.push_back(entry); // keep the pose and margin of the original association
+      next_entries_.back().arc_length = arc_length;
+      ++hits_;
+      return true;
+    }
+  }
+
+  // full association
+  next_entries_.push_back(Entry());
+  Entry& entry = next_entries_.back();
+  entry.arc_length = arc_length;
+  entry.pose = pose;
+  const std::size_t first_new = relevant.size();
+  TebCostEvaluator::associateObstacles(cfg, robot_model, pose, *obstacles_, relevant, &entry.margin, index_);
+  entry.obstacles.assign(relevant.begin() + first_new, relevant.end());
+  ++misses_;
+  return false;
+}
+
+
+void ObstacleAssociationCache::endPass()
+{
+  entries_.swap(next_entries_);
+  next_entries_.clear();
+}
+
+
+bool ObstacleAssociationCache::isValid(const Entry& entry, const PoseSE2& pose, double tolerance, double circumscribed_radius) const
+{
+  const double translation = (pose.position() - entry.pose.position()).norm();
+  if (translation > tolerance)
+    return false;
+
+  const double rotation = std::fabs(g2o::normalize_theta(pose.theta() - entry.pose.theta()));
+  if (rotation >= entry.margin.angle)
+    return false;
+
+  // no point of the footprint moves further than the translation plus the chord of the rotation
+  const double displacement = translation + 2.0 * circumscribed_radius * std::sin(0.5 * rotation);
+  return displacement < entry.margin.distance;
+}
+
+} // namespace teb_local_planner
@@ -0,0 +1,200 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Christoph Rösmann
+ *********************************************************************/
+
+
+#include <teb_local_planner/obstacle_clustering.h>
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+namespace teb_local_planner
+{
+
+namespace
+{
+
+  //! Occupied voxel: accumulated position of all points inside
+  struct Voxel
+  {
+    long ix;
+    long iy;
+    Eigen::Vector2d sum;
+    int count;
+    int first_point; //!< index of the first point inside (further points are linked by next_point)
+    Eigen::Vector2d centroid() const {return sum / count;}
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+
+  inline long long voxelKey(long ix, long iy)
+  {
+    return (static_cast<long long>(ix) << 32) ^ static_cast<long long>(static_cast<unsigned int>(iy));
+  }
+
+  inline double cross(const Eigen::Vector2d& o, const Eigen::Vector2d& a, const Eigen::Vector2d& b)
+  {
+    return (a.x() - o.x()) * (b.y() - o.y()) - (a.y() - o.y()) * (b.x() - o.x());
+  }
+
+  /**
+   * Convex hull (Andrew's monotone chain), collinear and duplicate points are removed.
+   * A set of collinear points results in its two extreme points.
+   */
+  void convexHull(Point2dContainer& points, Point2dContainer& hull)
+  {
+    hull.clear();
+    std::sort(points.begin(), points.end(), [](const Eigen::Vector2d& a, const Eigen::Vector2d& b)
+              {return a.x() < b.x() || (a.x() == b.x() && a.y() < b.y());});
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+    if (points.size() < 3)
+    {
+      hull = points;
+      return;
+    }
+
+    hull.resize(2 * points.size());
+    std::size_t k = 0;
+    for (std::size_t i = 0; i < points.size(); ++i) // lower hull
+    {
+      while (k >= 2 && cross(hull[k-2], hull[k-1], points[i]) <= 0)
+        --k;
+      hull[k++] = points[i];
+    }
+    for (std::size_t i = points.size() - 1, t = k + 1; i > 0; --i) // upper hull
+    {
+      while (k >= t && cross(hull[k-2], hull[k-1], points[i-1]) <= 0)
+        --k;
+      hull[k++] = points[i-1];
+    }
+    hull.resize(k - 1); // the last point equals the first one
+  }
+
+} // anonymous namespace
+
+
+std::size_t clusterPointObstacles(const Point2dContainer& points, double resolution, double max_extent, ObstContainer& obstacles)
+{
+  if (points.empty() || resolution <= 0)
+    return 0;
+
+  // 1. voxel downsampling (voxels are stored in the order of the first occurrence, hence the result is deterministic)
+  std::vector< Voxel, Eigen::aligned_allocator<Voxel> > voxels;
+  std::vector<int> next_point(points.size(), -1);
+  std::unordered_map<long long, int> voxel_lookup;
+  voxel_lookup.reserve(points.size());
+  for (std::size_t i = 0; i < points.size(); ++i)
+  {
+    const Eigen::Vector2d& point = points[i];
+    long ix = (long) std::floor(point.x() / resolution);
+    long iy = (long) std::floor(point.y() / resolution);
+    std::pair<std::unordered_map<long long, int>::iterator, bool> inserted = voxel_lookup.insert(std::make_pair(voxelKey(ix, iy), (int) voxels.size()));
+    if (inserted.second)
+    {
+      Voxel voxel;
+      voxel.ix = ix;
+      voxel.iy = iy;
+      voxel.sum = point;
+      voxel.count = 1;
+      voxel.first_point = (int) i;
+      voxels.push_back(voxel);
+    }
+    else
+    {
+      Voxel& voxel = voxels[inserted.first->second];
+      voxel.sum += point;
+      ++voxel.count;
+      next_point[i] = voxel.first_point;
+      voxel.first_point = (int) i;
+    }
+  }
+
+  // 2. connected components with bounded extent and 3. conversion to obstacles
+  const double max_radius_sq = 0.25 * max_extent * max_extent;
+  std::vector<bool> assigned(voxels.size(), false);
+  std::vector<int> queue;
+  Point2dContainer members;
+  Point2dContainer hull;
+  std::size_t num_added = 0;
+
+  for (std::size_t seed = 0; seed < voxels.size(); ++seed)
+  {
+    if (assigned[seed])
+      continue;
+
+    const Eigen::Vector2d seed_centroid = voxels[seed].centroid();
+    assigned[seed] = true;
+    queue.assign(1, (int) seed);
+    members.clear();
+
+    for (std::size_t head = 0; head < queue.size(); ++head)
+    {
+      // the hull is built from the points themselves (the voxel centroids would shrink the obstacle)
+      const Voxel& voxel = voxels[queue[head]];
+      for (int point = voxel.first_point; point >= 0; point = next_point[point])
+        members.push_back(points[point]);
+
+      for (long dx = -1; dx <= 1; ++dx)
+      {
+        for (long dy = -1; dy <= 1; ++dy)
+        {
+          std::unordered_map<long long, int>::const_iterator neighbor = voxel_lookup.find(voxelKey(voxel.ix + dx, voxel.iy + dy));
+          if (neighbor == voxel_lookup.end() || assigned[neighbor->second])
+            continue;
+          if ((voxels[neighbor->second].centroid() - seed_centroid).squaredNorm() > max_radius_sq)
+            continue; // keep it for another cluster
+          assigned[neighbor->second] = true;
+          queue.push_back(neighbor->second);
+        }
+      }
+    }
+
+    convexHull(members, hull);
+    if (hull.size() == 1)
+      obstacles.push_back(ObstaclePtr(new PointObstacle(hull.front())));
+    else if (hull.size() == 2)
+      obstacles.push_back(ObstaclePtr(new LineObstacle(hull.front(), hull.back())));
+    else
+      obstacles.push_back(ObstaclePtr(new PolygonObstacle(hull)));
+    ++num_added;
+  }
+
+  return num_added;
+}
+
+} // namespace teb_local_planner
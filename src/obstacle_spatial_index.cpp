@@ -0,0 +1,253 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Christoph Rösmann
+ *********************************************************************/
+
+
+#include <teb_local_planner/obstacle_spatial_index.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace teb_local_planner
+{
+
+namespace
+{
+  // obstacles that would be stored in more cells are tested individually
+  const int kMaxCellsPerObstacle = 64;
+}
+
+
+void ObstacleSpatialIndex::clear()
+{
+  obstacles_ = NULL;
+  num_obstacles_ = 0;
+  centers_.clear();
+  radii_.clear();
+  cols_ = rows_ = 0;
+  cell_begin_.clear();
+  cell_items_.clear();
+  large_.clear();
+  unbounded_.clear();
+}
+
+
+void ObstacleSpatialIndex::build(const ObstContainer& obstacles, double cell_size)
+{
+  clear();
+  obstacles_ = &obstacles;
+  num_obstacles_ = obstacles.size();
+  centers_.resize(num_obstacles_);
+  radii_.resize(num_obstacles_);
+
+  // bounding box of all bounded obstacles
+  Eigen::Vector2d min_corner = Eigen::Vector2d::Constant(std::numeric_limits<double>::infinity());
+  Eigen::Vector2d max_corner = -min_corner;
+  int num_bounded = 0;
+  for (std::size_t i = 0; i < num_obstacles_; ++i)
+  {
+    // the centroid of obstacles without a bounding circle is not required
+    radii_[i] = obstacles[i]->getBoundingRadius();
+    centers_[i] = std::isfinite(radii_[i]) ? obstacles[i]->getCentroid() : Eigen::Vector2d::Zero();
+    if (!std::isfinite(radii_[i]) || !centers_[i].allFinite())
+    {
+      radii_[i] = std::numeric_limits<double>::infinity();
+      unbounded_.push_back((int)i);
+      continue;
+    }
+    min_corner = min_corner.cwiseMin(centers_[i] - Eigen::Vector2d::Constant(radii_[i]));
+    max_corner = max_corner.cwiseMax(centers_[i] + Eigen::Vector2d::Constant(radii_[i]));
+    ++num_bounded;
+  }
+  if (num_bounded == 0)
+    return;
+
+  // about two obstacles per cell, but not more cells than four times the number of obstacles
+  const Eigen::Vector2d extent = (max_corner - min_corner).cwiseMax(1e-3);
+  cell_size_ = cell_size > 0 ? cell_size : std::sqrt(2.0 * extent.x() * extent.y() / num_bounded);
+  cell_size_ = std::max(cell_size_, std::sqrt(extent.x() * extent.y() / (4.0 * num_bounded)));
+  origin_ = min_corner;
+  cols_ = (int)(extent.x() / cell_size_) + 1;
+  rows_ = (int)(extent.y() / cell_size_) + 1;
+
+  // count and fill the cells (compressed row storage)
+  std::vector<int> cell_count(cols_ * rows_ + 1, 0);
+  std::vector<int> in_cells;
+  for (std::size_t i = 0; i < num_obstacles_; ++i)
+  {
+    if (!std::isfinite(radii_[i]))
+      continue;
+    const int c0 = cellCoord(centers_[i].x() - radii_[i], origin_.x());
+    const int c1 = std::min(cellCoord(centers_[i].x() + radii_[i], origin_.x()), cols_ - 1);
+    const int r0 = cellCoord(centers_[i].y() - radii_[i], origin_.y());
+    const int r1 = std::min(cellCoord(centers_[i].y() + radii_[i], origin_.y()), rows_ - 1);
+    if ((c1 - c0 + 1) * (r1 - r0 + 1) > kMaxCellsPerObstacle)
+    {
+      large_.push_back((int)i);
+      continue;
+    }
+    in_cells.push_back((int)i);
+    for (int c = std::max(c0, 0); c <= c1; ++c)
+      for (int r = std::max(r0, 0); r <= r1; ++r)
+        ++cell_count[c * rows_ + r + 1];
+  }
+  for (std::size_t k = 1; k < cell_count.size(); ++k)
+    cell_count[k] += cell_count[k-1];
+  cell_begin_ = cell_count;
+  cell_items_.resize(cell_begin_.back());
+  for (int i : in_cells)
+  {
+    const int c0 = std::max(cellCoord(centers_[i].x() - radii_[i], origin_.x()), 0);
+    const int c1 = std::min(cellCoord(centers_[i].x() + radii_[i], origin_.x()), cols_ - 1);
+    const int r0 = std::max(cellCoord(centers_[i].y() - radii_[i], origin_.y()), 0);
+    const int r1 = std::min(cellCoord(centers_[i].y() + radii_[i], origin_.y()), rows_ - 1);
+    for (int c = c0; c <= c1; ++c)
+      for (int r = r0; r <= r1; ++r)
+        cell_items_[cell_count[c * rows_ + r]++] = i;
+  }
+}
+
+
+void ObstacleSpatialIndex::appendColumn(int col, int row_begin, int row_end, std::vector<int>& candidates) const
+{
+  row_begin = std::max(row_begin, 0);
+  row_end = std::min(row_end, rows_ - 1);
+  if (col < 0 || col >= cols_ || row_begin > row_end)
+    return;
+  // cells of a column are stored consecutively
+  candidates.insert(candidates.end(), cell_items_.begin() + cell_begin_[col * rows_ + row_begin],
+                    cell_items_.begin() + cell_begin_[col * rows_ + row_end + 1]);
+}
+
+
+void ObstacleSpatialIndex::finalizeCandidates(std::vector<int>& candidates, const Eigen::Vector2d& line_start,
+                                              const Eigen::Vector2d& line_end, double dist) const
+{
+  // obstacles are stored in several cells
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+  // exact test of the bounding circles (a circle query is a degenerated segment)
+  std::size_t num_kept = 0;
+  for (int i : candidates)
+  {
+    if (isNear(i, line_start, line_end, dist))
+      candidates[num_kept++] = i;
+  }
+  candidates.resize(num_kept);
+  for (int i : large_)
+  {
+    if (isNear(i, line_start, line_end, dist))
+      candidates.push_back(i);
+  }
+  candidates.insert(candidates.end(), unbounded_.begin(), unbounded_.end());
+
+  if (!large_.empty() || !unbounded_.empty())
+    std::sort(candidates.begin(), candidates.end());
+}
+
+
+void ObstacleSpatialIndex::segmentColumns(const Eigen::Vector2d& line_start, const Eigen::Vector2d& line_end, double dist,
+                                          int& col_begin, int& col_end) const
+{
+  col_begin = std::max(cellCoord(std::min(line_start.x(), line_end.x()) - dist, origin_.x()), 0);
+  col_end = std::min(cellCoord(std::max(line_start.x(), line_end.x()) + dist, origin_.x()), cols_ - 1);
+}
+
+
+bool ObstacleSpatialIndex::segmentRows(const Eigen::Vector2d& line_start, const Eigen::Vector2d& line_end, double dist,
+                                       int col, int& row_begin, int& row_end) const
+{
+  const Eigen::Vector2d dir = line_end - line_start;
+  double y_min = std::min(line_start.y(), line_end.y());
+  double y_max = std::max(line_start.y(), line_end.y());
+  if (dir.x() != 0)
+  {
+    // part of the segment whose dist-neighborhood overlaps the column
+    const double x0 = origin_.x() + col * cell_size_ - dist;
+    const double x1 = x0 + cell_size_ + 2 * dist;
+    double t0 = (x0 - line_start.x()) / dir.x();
+    double t1 = (x1 - line_start.x()) / dir.x();
+    if (t0 > t1)
+      std::swap(t0, t1);
+    t0 = std::max(t0, 0.);
+    t1 = std::min(t1, 1.);
+    if (t0 > t1)
+      return false;
+    y_min = std::min(line_start.y() + t0 * dir.y(), line_start.y() + t1 * dir.y());
+    y_max = std::max(line_start.y() + t0 * dir.y(), line_start.y() + t1 * dir.y());
+  }
+  row_begin = std::max(cellCoord(y_min - dist, origin_.y()), 0);
+  row_end = std::min(cellCoord(y_max + dist, origin_.y()), rows_ - 1);
+  return row_begin <= row_end;
+}
+
+
+void ObstacleSpatialIndex::querySegment(const Eigen::Vector2d& line_start, const Eigen::Vector2d& line_end, double dist,
+                                        std::vector<int>& candidates) const
+{
+  candidates.clear();
+  if (cols_ > 0)
+  {
+    // walk along the columns covered by the segment inflated by dist and collect the rows covered within each column
+    int c0, c1, r0, r1;
+    segmentColumns(line_start, line_end, dist, c0, c1);
+    for (int c = c0; c <= c1; ++c)
+    {
+      if (segmentRows(line_start, line_end, dist, c, r0, r1))
+        appendColumn(c, r0, r1, candidates);
+    }
+  }
+  finalizeCandidates(candidates, line_start, line_end, dist);
+}
+
+
+void ObstacleSpatialIndex::queryCircle(const Eigen::Vector2d& center, double radius, std::vector<int>& candidates) const
+{
+  candidates.clear();
+  if (cols_ > 0)
+  {
+    const int c0 = std::max(cellCoord(center.x() - radius, origin_.x()), 0);
+    const int c1 = std::min(cellCoord(center.x() + radius, origin_.x()), cols_ - 1);
+    for (int c = c0; c <= c1; ++c)
+      appendColumn(c, cellCoord(center.y() - radius, origin_.y()), cellCoord(center.y() + radius, origin_.y()), candidates);
+  }
+  finalizeCandidates(candidates, center, center, radius);
+}
+
+} // namespace teb_local_planner
@@ -41,6 +41,9 @@
 #include <ros/assert.h>
 // #include <teb_local_planner/misc.h>
 
+#include <algorithm>
+#include <limits>
+
 namespace teb_local_planner
 {
 
@@ -127,6 +130,20 @@ void PolygonObstacle::calcCentroid()
 }
 
 
+void PolygonObstacle::calcBoundingRadius()
+{
+  // 以质心为圆心包含所有顶点的圆，用于距离计算之前的快速剔除
+  if (!centroid_.allFinite())
+  {
+    bounding_radius_ = std::numeric_limits<double>::infinity(); // no culling
+    return;
+  }
+  bounding_radius_ = 0;
+  for (const Eigen::Vector2d& vertex : vertices_)
+    bounding_radius_ = std::max(bounding_radius_, (vertex - centroid_).norm());
+}
+
+
 
 Eigen::Vector2d PolygonObstacle::getClosestPoint(const Eigen::Vector2d& position) const
 {
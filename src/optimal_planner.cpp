@@ -49,6 +49,7 @@
 #include <teb_local_planner/g2o_types/edge_dynamic_obstacle.h>
 #include <teb_local_planner/g2o_types/edge_via_point.h>
 #include <teb_local_planner/g2o_types/edge_prefer_rotdir.h>
+#include <teb_local_planner/g2o_types/edge_segment_kinematics.h>
 
 #include <memory>
 #include <limits>
@@ -59,12 +60,13 @@ namespace teb_local_planner
 
 // ============== Implementation ===================
 
-TebOptimalPlanner::TebOptimalPlanner() : cfg_(NULL), obstacles_(NULL), via_points_(NULL), cost_(HUGE_VAL), prefer_rotdir_(RotType::none),
+TebOptimalPlanner::TebOptimalPlanner() : cfg_(NULL), obstacles_(NULL), via_points_(NULL), obstacle_index_(NULL), cost_(HUGE_VAL), prefer_rotdir_(RotType::none),
                                          robot_model_(new PointRobotFootprint()), initialized_(false), optimized_(false)
 {
 }
 
 TebOptimalPlanner::TebOptimalPlanner(const TebConfig& cfg, ObstContainer* obstacles, RobotFootprintModelPtr robot_model, TebVisualizationPtr visual, const ViaPointContainer* via_points)
+  : obstacle_index_(NULL)
 {
   initialize(cfg, obstacles, robot_model, visual, via_points);
 }
@@ -89,6 +91,35 @@ void TebOptimalPlanner::initialize(const TebConfig& cfg, ObstContainer* obstacle
   // 初始化优化器 (设置求解器和block ordering)
   optimizer_ = initOptimizer();
 
+  initializeParameters(cfg, obstacles, robot_model, visual, via_points);
+}
+
+
+void TebOptimalPlanner::reinitialize(const TebConfig& cfg, ObstContainer* obstacles, RobotFootprintModelPtr robot_model, TebVisualizationPtr visual, const ViaPointContainer* via_points)
+{
+  if (!optimizer_)
+  {
+    initialize(cfg, obstacles, robot_model, visual, via_points);
+    return;
+  }
+
+  // 保留优化器，只清除上一条轨迹相关的状态
+  clearGraph();
+  teb_.clearTimedElasticBand();
+  warm_start_cache_.clear();
+  obstacle_association_cache_.clear();
+  obstacles_per_vertex_.clear();
+  cost_breakdown_.clear();
+  fingerprint_.clear();
+  obstacle_index_ = NULL;
+  optimized_ = false;
+
+  initializeParameters(cfg, obstacles, robot_model, visual, via_points);
+}
+
+
+void TebOptimalPlanner::initializeParameters(const TebConfig& cfg, ObstContainer* obstacles, RobotFootprintModelPtr robot_model, TebVisualizationPtr visual, const ViaPointContainer* via_points)
+{
   cfg_ = &cfg;
   obstacles_ = obstacles;
   robot_model_ = robot_model;
@@ -126,7 +157,12 @@ void TebOptimalPlanner::visualize()
     visualization_->publishRobotFootprintModel(teb_.Pose(0), *robot_model_);
 
   if (cfg_->trajectory.publish_feedback)
-    visualization_->publishFeedbackMessage(*this, *obstacles_);
+  {
+    // evaluated separately, since the stored cost must remain the one of the last optimizeTEB() call
+    TebCostBreakdown cost_breakdown;
+    evaluateCostBreakdown(cost_breakdown);
+    visualization_->publishFeedbackMessage(*this, *obstacles_, &cost_breakdown);
+  }
 
 }
 
@@ -157,6 +193,7 @@ void TebOptimalPlanner::registerG2OTypes()
   factory->registerType("EDGE_DYNAMIC_OBSTACLE", new g2o::HyperGraphElementCreator<EdgeDynamicObstacle>);
   factory->registerType("EDGE_VIA_POINT", new g2o::HyperGraphElementCreator<EdgeViaPoint>);
   factory->registerType("EDGE_PREFER_ROTDIR", new g2o::HyperGraphElementCreator<EdgePreferRotDir>);
+  factory->registerType("EDGE_SEGMENT_KINEMATICS", new g2o::HyperGraphElementCreator<EdgeSegmentKinematics>);
   return;
 }
 
@@ -188,7 +225,8 @@ boost::shared_ptr<g2o::SparseOptimizer> TebOptimalPlanner::initOptimizer()
 // 用到的超图构建(hyper-graph)，也就是将机器人位姿和时间差描述为顶点(vertex)（优化的对象），
 // 目标函数以及约束函数被看做边(edges)，超图中每个约束都为一条edge，并且每条edge允许连接的vertex数目是不受限。
 bool TebOptimalPlanner::optimizeTEB(int iterations_innerloop, int iterations_outerloop, bool compute_cost_afterwards,
-                                    double obst_cost_scale, double viapoint_cost_scale, bool alternative_time_cost)
+                                    double obst_cost_scale, double viapoint_cost_scale, bool alternative_time_cost,
+                                    int first_outerloop_iteration)
 {
   if (cfg_->optim.optimization_activate==false)
     return false;
@@ -196,7 +234,7 @@ bool TebOptimalPlanner::optimizeTEB(int iterations_innerloop, int iterations_out
   bool success = false;
   optimized_ = false;
 
-  double weight_multiplier = 1.0;
+  double weight_multiplier = std::pow(cfg_->optim.weight_adapt_factor, first_outerloop_iteration);
 
   // TODO(roesmann): we introduced the non-fast mode with the support of dynamic obstacles
   //                (which leads to better results in terms of x-y-t homotopy planning).
@@ -204,6 +242,10 @@ bool TebOptimalPlanner::optimizeTEB(int iterations_innerloop, int iterations_out
   //                 the legacy fast mode as default until we finish our tests.
   bool fast_mode = !cfg_->obstacles.include_dynamic_obstacles;
 
+  // obstacles, robot model and parameters might have changed since the last call (unless it is continued within the same cycle)
+  if (first_outerloop_iteration == 0)
+    obstacle_association_cache_.clear();
+
   for(int i=0; i<iterations_outerloop; ++i)
   {
     if (cfg_->trajectory.teb_autosize)
@@ -229,7 +271,10 @@ bool TebOptimalPlanner::optimizeTEB(int iterations_innerloop, int iterations_out
     optimized_ = true;
     // step xx   compute_cost_afterwards 默认是false
     if (compute_cost_afterwards && i==iterations_outerloop-1) // compute cost vec only in the last iteration
+    {
       computeCurrentCost(obst_cost_scale, viapoint_cost_scale, alternative_time_cost);
+      fingerprint_.compute(teb_);
+    }
 
     clearGraph();
 
@@ -257,17 +302,18 @@ void TebOptimalPlanner::setVelocityGoal(const geometry_msgs::Twist& vel_goal)
 bool TebOptimalPlanner::plan(const std::vector<geometry_msgs::PoseStamped>& initial_plan, const geometry_msgs::Twist* start_vel, bool free_goal_vel)
 {
   ROS_ASSERT_MSG(initialized_, "Call initialize() first.");
+  PoseSE2 start_(initial_plan.front().pose);
+  PoseSE2 goal_(initial_plan.back().pose);
   if (!teb_.isInit())
   {
     // 這邊會在 teb 裡面去把 initial_plan 做插值，然後添加進 Vertex. Vertex 有分是否固定，不過他們都沒有被設定成固定。
     // 這部份應該是為 g2o 的準備。
-    teb_.initTrajectoryToGoal(initial_plan, cfg_->robot.max_vel_x, cfg_->robot.max_vel_theta, cfg_->trajectory.global_plan_overwrite_orientation,
-      cfg_->trajectory.min_samples, cfg_->trajectory.allow_init_with_backwards_motion);
+    if (!initTrajectoryFromWarmStartCache(start_, goal_))
+      teb_.initTrajectoryToGoal(initial_plan, cfg_->robot.max_vel_x, cfg_->robot.max_vel_theta, cfg_->trajectory.global_plan_overwrite_orientation,
+        cfg_->trajectory.min_samples, cfg_->trajectory.allow_init_with_backwards_motion);
   }
   else // 热启动
   {
-    PoseSE2 start_(initial_plan.front().pose);
-    PoseSE2 goal_(initial_plan.back().pose);
     if (teb_.sizePoses()>0
         && (goal_.position() - teb_.BackPose().position()).norm() < cfg_->trajectory.force_reinit_new_goal_dist
         && fabs(g2o::normalize_theta(goal_.theta() - teb_.BackPose().theta())) < cfg_->trajectory.force_reinit_new_goal_angular) // actual warm start!
@@ -275,9 +321,11 @@ bool TebOptimalPlanner::plan(const std::vector<geometry_msgs::PoseStamped>& init
     else // 目标点太远，重新初始化
     {
       ROS_DEBUG("New goal: distance to existing goal is higher than the specified threshold. Reinitalizing trajectories.");
+      commitToWarmStartCache();
       teb_.clearTimedElasticBand();
-      teb_.initTrajectoryToGoal(initial_plan, cfg_->robot.max_vel_x, cfg_->robot.max_vel_theta, cfg_->trajectory.global_plan_overwrite_orientation,
-        cfg_->trajectory.min_samples, cfg_->trajectory.allow_init_with_backwards_motion);
+      if (!initTrajectoryFromWarmStartCache(start_, goal_))
+        teb_.initTrajectoryToGoal(initial_plan, cfg_->robot.max_vel_x, cfg_->robot.max_vel_theta, cfg_->trajectory.global_plan_overwrite_orientation,
+          cfg_->trajectory.min_samples, cfg_->trajectory.allow_init_with_backwards_motion);
     }
   }
 
@@ -309,7 +357,8 @@ bool TebOptimalPlanner::plan(const PoseSE2& start, const PoseSE2& goal, const ge
   if (!teb_.isInit())
   {
     // 初始化轨迹
-    teb_.initTrajectoryToGoal(start, goal, 0, cfg_->robot.max_vel_x, cfg_->trajectory.min_samples, cfg_->trajectory.allow_init_with_backwards_motion); // 0 intermediate samples, but dt=1 -> autoResize will add more samples before calling first optimization
+    if (!initTrajectoryFromWarmStartCache(start, goal))
+      teb_.initTrajectoryToGoal(start, goal, 0, cfg_->robot.max_vel_x, cfg_->trajectory.min_samples, cfg_->trajectory.allow_init_with_backwards_motion); // 0 intermediate samples, but dt=1 -> autoResize will add more samples before calling first optimization
   }
   else // 热启动
   {
@@ -320,8 +369,10 @@ bool TebOptimalPlanner::plan(const PoseSE2& start, const PoseSE2& goal, const ge
     else // 目标点太远，重新初始化
     {
       ROS_DEBUG("New goal: distance to existing goal is higher than the specified threshold. Reinitalizing trajectories.");
+      commitToWarmStartCache();
       teb_.clearTimedElasticBand();
-      teb_.initTrajectoryToGoal(start, goal, 0, cfg_->robot.max_vel_x, cfg_->trajectory.min_samples, cfg_->trajectory.allow_init_with_backwards_motion);
+      if (!initTrajectoryFromWarmStartCache(start, goal))
+        teb_.initTrajectoryToGoal(start, goal, 0, cfg_->robot.max_vel_x, cfg_->trajectory.min_samples, cfg_->trajectory.allow_init_with_backwards_motion);
     }
   }
   if (start_vel)
@@ -336,6 +387,29 @@ bool TebOptimalPlanner::plan(const PoseSE2& start, const PoseSE2& goal, const ge
 }
 
 
+void TebOptimalPlanner::commitToWarmStartCache()
+{
+  if (!cfg_ || cfg_->trajectory.warm_start_cache_size <= 0)
+    return;
+  warm_start_cache_.commit(obstacles_, cfg_->obstacles.min_obstacle_dist*cfg_->obstacles.obstacle_association_force_inclusion_factor,
+                           cfg_->trajectory.warm_start_cache_resolution, cfg_->trajectory.warm_start_cache_size);
+}
+
+bool TebOptimalPlanner::initTrajectoryFromWarmStartCache(const PoseSE2& start, const PoseSE2& goal)
+{
+  if (cfg_->trajectory.warm_start_cache_size <= 0 || warm_start_cache_.size() == 0)
+    return false;
+
+  if (!warm_start_cache_.seed(start, goal, obstacles_, cfg_->obstacles.min_obstacle_dist*cfg_->obstacles.obstacle_association_force_inclusion_factor,
+                              cfg_->trajectory.warm_start_cache_resolution, cfg_->trajectory.force_reinit_new_goal_dist,
+                              cfg_->trajectory.force_reinit_new_goal_angular, cfg_->trajectory.min_samples, teb_))
+    return false;
+
+  ROS_DEBUG("TebOptimalPlanner: trajectory initialized from a cached solution (warm-start cache).");
+  return true;
+}
+
+
 bool TebOptimalPlanner::buildGraph(double weight_multiplier)
 {
   if (!optimizer_->edges().empty() || !optimizer_->vertices().empty())
@@ -360,18 +434,28 @@ bool TebOptimalPlanner::buildGraph(double weight_multiplier)
 
   AddEdgesViaPoints();  // 通过点约束
 
-  AddEdgesVelocity();  // 速度约束
+  // 非完整约束机器人可以把每段的速度、运动学与时间约束合并成一条边
+  const bool fuse_segments = cfg_->optim.fuse_segment_edges && cfg_->robot.max_vel_y == 0;
+
+  if (fuse_segments)
+    AddEdgesSegmentKinematics();  // 合并的速度、运动学与时间约束
+  else
+    AddEdgesVelocity();  // 速度约束
 
   AddEdgesAcceleration();  // 加速度约束
 
-  AddEdgesTimeOptimal();  // 时间约束
+  if (!fuse_segments)
+    AddEdgesTimeOptimal();  // 时间约束
 
   AddEdgesShortestPath();  // 最短路径约束
 
-  if (cfg_->robot.min_turning_radius == 0 || cfg_->optim.weight_kinematics_turning_radius == 0)
-    AddEdgesKinematicsDiffDrive(); // 差速机器人运动学约束
-  else
-    AddEdgesKinematicsCarlike(); // 类汽车机器人运动学约束，该类型受旋转半径的约束
+  if (!fuse_segments)
+  {
+    if (cfg_->robot.min_turning_radius == 0 || cfg_->optim.weight_kinematics_turning_radius == 0)
+      AddEdgesKinematicsDiffDrive(); // 差速机器人运动学约束
+    else
+      AddEdgesKinematicsCarlike(); // 类汽车机器人运动学约束，该类型受旋转半径的约束
+  }
 
   AddEdgesPreferRotDir();  // 朝向约束
 
@@ -430,6 +514,9 @@ void TebOptimalPlanner::clearGraph()
     optimizer_->vertices().clear();  // 这样清理是有必要的，如果直接用optimizer->clear会删除指针对象（TEB的状态也也就没有了）
     optimizer_->clear();
   }
+  for (int i = 0; i < NUM_COST_TERMS; ++i)
+    edge_registry_[i].clear();
+  segment_kinematics_edges_.clear();
 }
 
 
@@ -488,7 +575,7 @@ void TebOptimalPlanner::AddEdgesObstacles(double weight_multiplier)
       dist_bandpt_obst->setVertex(0,teb_.PoseVertex(index));
       dist_bandpt_obst->setInformation(information_inflated);
       dist_bandpt_obst->setParameters(*cfg_, robot_model_.get(), obstacle);
-      optimizer_->addEdge(dist_bandpt_obst);
+      addEdge(CostTerm::Obstacle, dist_bandpt_obst);
     }
     else
     {
@@ -496,64 +583,23 @@ void TebOptimalPlanner::AddEdgesObstacles(double weight_multiplier)
       dist_bandpt_obst->setVertex(0,teb_.PoseVertex(index));
       dist_bandpt_obst->setInformation(information);
       dist_bandpt_obst->setParameters(*cfg_, robot_model_.get(), obstacle);
-      optimizer_->addEdge(dist_bandpt_obst);
+      addEdge(CostTerm::Obstacle, dist_bandpt_obst);
     };
   };
 
   // 迭代所有的teb点，如果不创建EdgeVelocityObstacleRatio的边，跳过第一个和最后的点
   const int first_vertex = cfg_->optim.weight_velocity_obstacle_ratio == 0 ? 1 : 0;
+  double arc_length = 0; // 位姿在轨迹上的弧长位置，作为关联缓存的键
+
+  obstacle_association_cache_.beginPass(*obstacles_, obstacle_index_);
   for (int i = first_vertex; i < teb_.sizePoses() - 1; ++i)
   {
-      double left_min_dist = std::numeric_limits<double>::max();
-      double right_min_dist = std::numeric_limits<double>::max();
-      ObstaclePtr left_obstacle;
-      ObstaclePtr right_obstacle;
-
-      const Eigen::Vector2d pose_orient = teb_.Pose(i).orientationUnitVec();
-
-      // 迭代障碍物
-      for (const ObstaclePtr& obst : *obstacles_)
-      {
-        // 动态障碍物会被分别处理
-        if(cfg_->obstacles.include_dynamic_obstacles && obst->isDynamic())
-          continue;
+      if (i > 0)
+        arc_length += (teb_.Pose(i).position() - teb_.Pose(i-1).position()).norm();
 
-          // 计算到机器人模型的距离
-          double dist = robot_model_->calculateDistance(teb_.Pose(i), obst.get());
-
-          // 如果离的很近了就必须考虑障碍物了
-        if (dist < cfg_->obstacles.min_obstacle_dist*cfg_->obstacles.obstacle_association_force_inclusion_factor)
-          {
-              iter_obstacle->push_back(obst);
-              continue;
-          }
-          // cut-off distance
-          if (dist > cfg_->obstacles.min_obstacle_dist*cfg_->obstacles.obstacle_association_cutoff_factor)
-            continue;
-
-          // determine side (left or right) and assign obstacle if closer than the previous one
-          if (cross2d(pose_orient, obst->getCentroid()) > 0) // left
-          {
-              if (dist < left_min_dist)
-              {
-                  left_min_dist = dist;
-                  left_obstacle = obst;
-              }
-          }
-          else
-          {
-              if (dist < right_min_dist)
-              {
-                  right_min_dist = dist;
-                  right_obstacle = obst;
-              }
-          }
-      }
-
-      if (left_obstacle)
-        iter_obstacle->push_back(left_obstacle);
-      if (right_obstacle)
-        iter_obstacle->push_back(right_obstacle);
+      // 关联距离很近的障碍物，以及左右两侧各一个最近的障碍物 (与 TebCostEvaluator 共用)
+      // 位姿只移动了一点时沿用上一次外层迭代的关联结果
+      obstacle_association_cache_.associate(*cfg_, *robot_model_, teb_.Pose(i), arc_length, *iter_obstacle);
 
       // continue here to ignore obstacles for the first pose, but use them later to create the EdgeVelocityObstacleRatio edges
       if (i == 0)
@@ -567,6 +613,10 @@ void TebOptimalPlanner::AddEdgesObstacles(double weight_multiplier)
         create_edge(i, obst.get()); // 上面的lambda表达式
       ++iter_obstacle;
   }
+  obstacle_association_cache_.endPass();
+
+  ROS_DEBUG_COND(cfg_->optim.optimization_verbose, "Obstacle association: %u reused, %u recomputed (total).",
+                 obstacle_association_cache_.hits(), obstacle_association_cache_.misses());
 }
 
 
@@ -608,7 +658,7 @@ void TebOptimalPlanner::AddEdgesObstaclesLegacy(double weight_multiplier)
         dist_bandpt_obst->setVertex(0,teb_.PoseVertex(index));
         dist_bandpt_obst->setInformation(information_inflated);
         dist_bandpt_obst->setParameters(*cfg_, robot_model_.get(), obst->get());
-        optimizer_->addEdge(dist_bandpt_obst);
+        addEdge(CostTerm::Obstacle, dist_bandpt_obst);
     }
     else
     {
@@ -616,7 +666,7 @@ void TebOptimalPlanner::AddEdgesObstaclesLegacy(double weight_multiplier)
         dist_bandpt_obst->setVertex(0,teb_.PoseVertex(index));
         dist_bandpt_obst->setInformation(information);
         dist_bandpt_obst->setParameters(*cfg_, robot_model_.get(), obst->get());
-        optimizer_->addEdge(dist_bandpt_obst);
+        addEdge(CostTerm::Obstacle, dist_bandpt_obst);
     }
 
     for (int neighbourIdx=0; neighbourIdx < floor(cfg_->obstacles.obstacle_poses_affected/2); neighbourIdx++)
@@ -629,7 +679,7 @@ void TebOptimalPlanner::AddEdgesObstaclesLegacy(double weight_multiplier)
                 dist_bandpt_obst_n_r->setVertex(0,teb_.PoseVertex(index+neighbourIdx));
                 dist_bandpt_obst_n_r->setInformation(information_inflated);
                 dist_bandpt_obst_n_r->setParameters(*cfg_, robot_model_.get(), obst->get());
-                optimizer_->addEdge(dist_bandpt_obst_n_r);
+                addEdge(CostTerm::Obstacle, dist_bandpt_obst_n_r);
             }
             else
             {
@@ -637,7 +687,7 @@ void TebOptimalPlanner::AddEdgesObstaclesLegacy(double weight_multiplier)
                 dist_bandpt_obst_n_r->setVertex(0,teb_.PoseVertex(index+neighbourIdx));
                 dist_bandpt_obst_n_r->setInformation(information);
                 dist_bandpt_obst_n_r->setParameters(*cfg_, robot_model_.get(), obst->get());
-                optimizer_->addEdge(dist_bandpt_obst_n_r);
+                addEdge(CostTerm::Obstacle, dist_bandpt_obst_n_r);
             }
       }
       if ( index - neighbourIdx >= 0) // needs to be casted to int to allow negative values
@@ -648,7 +698,7 @@ void TebOptimalPlanner::AddEdgesObstaclesLegacy(double weight_multiplier)
                 dist_bandpt_obst_n_l->setVertex(0,teb_.PoseVertex(index-neighbourIdx));
                 dist_bandpt_obst_n_l->setInformation(information_inflated);
                 dist_bandpt_obst_n_l->setParameters(*cfg_, robot_model_.get(), obst->get());
-                optimizer_->addEdge(dist_bandpt_obst_n_l);
+                addEdge(CostTerm::Obstacle, dist_bandpt_obst_n_l);
             }
             else
             {
@@ -656,7 +706,7 @@ void TebOptimalPlanner::AddEdgesObstaclesLegacy(double weight_multiplier)
                 dist_bandpt_obst_n_l->setVertex(0,teb_.PoseVertex(index-neighbourIdx));
                 dist_bandpt_obst_n_l->setInformation(information);
                 dist_bandpt_obst_n_l->setParameters(*cfg_, robot_model_.get(), obst->get());
-                optimizer_->addEdge(dist_bandpt_obst_n_l);
+                addEdge(CostTerm::Obstacle, dist_bandpt_obst_n_l);
             }
       }
     }
@@ -688,7 +738,7 @@ void TebOptimalPlanner::AddEdgesDynamicObstacles(double weight_multiplier)
       dynobst_edge->setVertex(0,teb_.PoseVertex(i));
       dynobst_edge->setInformation(information);
       dynobst_edge->setParameters(*cfg_, robot_model_.get(), obst->get());
-      optimizer_->addEdge(dynobst_edge);
+      addEdge(CostTerm::DynamicObstacle, dynobst_edge);
       time += teb_.TimeDiff(i); // we do not need to check the time diff bounds, since we iterate to "< sizePoses()-1".
     }
   }
@@ -699,19 +749,21 @@ void TebOptimalPlanner::AddEdgesViaPoints()
   if (cfg_->optim.weight_viapoint==0 || via_points_==NULL || via_points_->empty() )
     return; // if weight equals zero skip adding edges!
 
-  int start_pose_idx = 0;
-
   int n = teb_.sizePoses();
   if (n<3) // we do not have any degrees of freedom for reaching via-points
     return;
 
-  for (ViaPointContainer::const_iterator vp_it = via_points_->begin(); vp_it != via_points_->end(); ++vp_it)
+  // ordered via-points: associate all of them with a single monotonic sweep along the trajectory (O(poses + via-points))
+  std::vector<int> ordered_indices;
+  if (cfg_->trajectory.via_points_ordered)
+    teb_.findClosestTrajectoryPoses(*via_points_, ordered_indices, 2); // skip a point to have a DOF inbetween for further via-points
+
+  for (std::size_t vp_idx = 0; vp_idx < via_points_->size(); ++vp_idx)
   {
+    const Eigen::Vector2d& via_point = (*via_points_)[vp_idx];
 
     // 找trajectory裡面，離viapoint最近的點 index
-    int index = teb_.findClosestTrajectoryPose(*vp_it, NULL, start_pose_idx);
-    if (cfg_->trajectory.via_points_ordered)
-      start_pose_idx = index+2; // skip a point to have a DOF inbetween for further via-points
+    int index = cfg_->trajectory.via_points_ordered ? ordered_indices[vp_idx] : teb_.findClosestTrajectoryPose(via_point);
 
     // check if point conicides with goal or is located behind it
     if ( index > n-2 )
@@ -737,10 +789,10 @@ void TebOptimalPlanner::AddEdgesViaPoints()
     // teb_.PoseVertex(index) 代表的是 pose_vec 的 index 元素，就是前面步驟一直在 addPose 的那部份其中元素。
     edge_viapoint->setVertex(0,teb_.PoseVertex(index));
     edge_viapoint->setInformation(information);
-    // setParameters 裡面會把 vp_it 這個指標的指向點（via point) 設定為一元邊的 _measurement
+    // setParameters 裡面會把 via_point 這個指標的指向點（via point) 設定為一元邊的 _measurement
     // 優化的時候，就是拿 trajectory 的 index 點和這個 _measurement 來計算誤差。
-    edge_viapoint->setParameters(*cfg_, &(*vp_it));
-    optimizer_->addEdge(edge_viapoint);
+    edge_viapoint->setParameters(*cfg_, &via_point);
+    addEdge(CostTerm::ViaPoint, edge_viapoint);
   }
 }
 
@@ -766,7 +818,7 @@ void TebOptimalPlanner::AddEdgesVelocity()
       velocity_edge->setVertex(2,teb_.TimeDiffVertex(i));
       velocity_edge->setInformation(information);
       velocity_edge->setTebConfig(*cfg_);
-      optimizer_->addEdge(velocity_edge);
+      addEdge(CostTerm::Velocity, velocity_edge);
     }
   }
   else // holonomic-robot
@@ -789,7 +841,7 @@ void TebOptimalPlanner::AddEdgesVelocity()
       velocity_edge->setVertex(2,teb_.TimeDiffVertex(i));
       velocity_edge->setInformation(information);
       velocity_edge->setTebConfig(*cfg_);
-      optimizer_->addEdge(velocity_edge);
+      addEdge(CostTerm::Velocity, velocity_edge);
     }
 
   }
@@ -819,7 +871,7 @@ void TebOptimalPlanner::AddEdgesAcceleration()
       acceleration_edge->setInitialVelocity(vel_start_.second);
       acceleration_edge->setInformation(information);
       acceleration_edge->setTebConfig(*cfg_);
-      optimizer_->addEdge(acceleration_edge);
+      addEdge(CostTerm::Acceleration, acceleration_edge);
     }
 
     // now add the usual acceleration edge for each tuple of three teb poses
@@ -833,7 +885,7 @@ void TebOptimalPlanner::AddEdgesAcceleration()
       acceleration_edge->setVertex(4,teb_.TimeDiffVertex(i+1));
       acceleration_edge->setInformation(information);
       acceleration_edge->setTebConfig(*cfg_);
-      optimizer_->addEdge(acceleration_edge);
+      addEdge(CostTerm::Acceleration, acceleration_edge);
     }
 
     // check if a goal velocity should be taken into accound
@@ -846,7 +898,7 @@ void TebOptimalPlanner::AddEdgesAcceleration()
       acceleration_edge->setGoalVelocity(vel_goal_.second);
       acceleration_edge->setInformation(information);
       acceleration_edge->setTebConfig(*cfg_);
-      optimizer_->addEdge(acceleration_edge);
+      addEdge(CostTerm::Acceleration, acceleration_edge);
     }
   }
   else // holonomic robot
@@ -867,7 +919,7 @@ void TebOptimalPlanner::AddEdgesAcceleration()
       acceleration_edge->setInitialVelocity(vel_start_.second);
       acceleration_edge->setInformation(information);
       acceleration_edge->setTebConfig(*cfg_);
-      optimizer_->addEdge(acceleration_edge);
+      addEdge(CostTerm::Acceleration, acceleration_edge);
     }
 
     // now add the usual acceleration edge for each tuple of three teb poses
@@ -881,7 +933,7 @@ void TebOptimalPlanner::AddEdgesAcceleration()
       acceleration_edge->setVertex(4,teb_.TimeDiffVertex(i+1));
       acceleration_edge->setInformation(information);
       acceleration_edge->setTebConfig(*cfg_);
-      optimizer_->addEdge(acceleration_edge);
+      addEdge(CostTerm::Acceleration, acceleration_edge);
     }
 
     // check if a goal velocity should be taken into accound
@@ -894,7 +946,7 @@ void TebOptimalPlanner::AddEdgesAcceleration()
       acceleration_edge->setGoalVelocity(vel_goal_.second);
       acceleration_edge->setInformation(information);
       acceleration_edge->setTebConfig(*cfg_);
-      optimizer_->addEdge(acceleration_edge);
+      addEdge(CostTerm::Acceleration, acceleration_edge);
     }
   }
 }
@@ -915,7 +967,7 @@ void TebOptimalPlanner::AddEdgesTimeOptimal()
     timeoptimal_edge->setVertex(0,teb_.TimeDiffVertex(i));
     timeoptimal_edge->setInformation(information);
     timeoptimal_edge->setTebConfig(*cfg_);
-    optimizer_->addEdge(timeoptimal_edge);
+    addEdge(CostTerm::TimeOptimal, timeoptimal_edge);
   }
 }
 
@@ -934,7 +986,7 @@ void TebOptimalPlanner::AddEdgesShortestPath()
     shortest_path_edge->setVertex(1,teb_.PoseVertex(i+1));
     shortest_path_edge->setInformation(information);
     shortest_path_edge->setTebConfig(*cfg_);
-    optimizer_->addEdge(shortest_path_edge);
+    addEdge(CostTerm::ShortestPath, shortest_path_edge);
   }
 }
 
@@ -958,7 +1010,7 @@ void TebOptimalPlanner::AddEdgesKinematicsDiffDrive()
     kinematics_edge->setVertex(1,teb_.PoseVertex(i+1));
     kinematics_edge->setInformation(information_kinematics);
     kinematics_edge->setTebConfig(*cfg_);
-    optimizer_->addEdge(kinematics_edge);
+    addEdge(CostTerm::Kinematics, kinematics_edge);
   }
 }
 
@@ -980,7 +1032,7 @@ void TebOptimalPlanner::AddEdgesKinematicsCarlike()
     kinematics_edge->setVertex(1,teb_.PoseVertex(i+1));
     kinematics_edge->setInformation(information_kinematics);
     kinematics_edge->setTebConfig(*cfg_);
-    optimizer_->addEdge(kinematics_edge);
+    addEdge(CostTerm::Kinematics, kinematics_edge);
   }
 }
 
@@ -1019,7 +1071,7 @@ void TebOptimalPlanner::AddEdgesPreferRotDir()
     else if (prefer_rotdir_ == RotType::right)
         rotdir_edge->preferRight();
 
-    optimizer_->addEdge(rotdir_edge);
+    addEdge(CostTerm::PreferRotDir, rotdir_edge);
   }
 }
 
@@ -1042,11 +1094,53 @@ void TebOptimalPlanner::AddEdgesVelocityObstacleRatio()
       edge->setVertex(2,teb_.TimeDiffVertex(index));
       edge->setInformation(information);
       edge->setParameters(*cfg_, robot_model_.get(), obstacle.get());
-      optimizer_->addEdge(edge);
+      addEdge(CostTerm::VelocityObstacleRatio, edge);
     }
   }
 }
 
+void TebOptimalPlanner::AddEdgesSegmentKinematics()
+{
+  const bool carlike = cfg_->robot.min_turning_radius != 0 && cfg_->optim.weight_kinematics_turning_radius != 0;
+
+  // 对角线上是各个分量原本的权重
+  Eigen::Matrix<double,5,5> information;
+  information.fill(0);
+  information(EdgeSegmentKinematics::VelocityX, EdgeSegmentKinematics::VelocityX) = cfg_->optim.weight_max_vel_x;
+  information(EdgeSegmentKinematics::VelocityTheta, EdgeSegmentKinematics::VelocityTheta) = cfg_->optim.weight_max_vel_theta;
+  information(EdgeSegmentKinematics::NonHolonomic, EdgeSegmentKinematics::NonHolonomic) = cfg_->optim.weight_kinematics_nh;
+  information(EdgeSegmentKinematics::DriveDirOrTurningRadius, EdgeSegmentKinematics::DriveDirOrTurningRadius) =
+    carlike ? cfg_->optim.weight_kinematics_turning_radius : cfg_->optim.weight_kinematics_forward_drive;
+  information(EdgeSegmentKinematics::TimeOptimal, EdgeSegmentKinematics::TimeOptimal) = cfg_->optim.weight_optimaltime;
+
+  segment_kinematics_edges_.reserve(teb_.sizeTimeDiffs());
+  for (int i=0; i < teb_.sizePoses() - 1; ++i)
+  {
+    EdgeSegmentKinematics* segment_edge = new EdgeSegmentKinematics;
+    segment_edge->setVertex(0,teb_.PoseVertex(i));
+    segment_edge->setVertex(1,teb_.PoseVertex(i+1));
+    segment_edge->setVertex(2,teb_.TimeDiffVertex(i));
+    segment_edge->setInformation(information);
+    segment_edge->setTebConfig(*cfg_);
+    optimizer_->addEdge(segment_edge);
+    segment_kinematics_edges_.push_back(segment_edge); // 代价分属多个类别，单独登记
+  }
+}
+
+bool TebOptimalPlanner::getTrajectoryBoundingBox(Eigen::Vector2d& min_corner, Eigen::Vector2d& max_corner) const
+{
+  if (teb_.sizePoses() == 0)
+    return false;
+
+  min_corner = max_corner = teb_.Pose(0).position();
+  for (int i = 1; i < teb_.sizePoses(); ++i)
+  {
+    min_corner = min_corner.cwiseMin(teb_.Pose(i).position());
+    max_corner = max_corner.cwiseMax(teb_.Pose(i).position());
+  }
+  return true;
+}
+
 bool TebOptimalPlanner::hasDiverged() const
 {
   // 如果发散性检测是false，返回false
@@ -1068,55 +1162,61 @@ bool TebOptimalPlanner::hasDiverged() const
 void TebOptimalPlanner::computeCurrentCost(double obst_cost_scale, double viapoint_cost_scale, bool alternative_time_cost)
 {
   // check if graph is empty/exist  -> important if function is called between buildGraph and optimizeGraph/clearGraph
-  bool graph_exist_flag(false);
   if (optimizer_->edges().empty() && optimizer_->vertices().empty())
   {
-    // here the graph is build again, for time efficiency make sure to call this function
-    // between buildGraph and Optimize (deleted), but it depends on the application
-    buildGraph();
-    optimizer_->initializeOptimization();
-  }
-  else
-  {
-    graph_exist_flag = true;
+    // 图已经清除了: 直接在 teb_ 上计算代价，不需要重新建图
+    cost_ = evaluateCostBreakdown(cost_breakdown_, obst_cost_scale, viapoint_cost_scale, alternative_time_cost);
+    return;
   }
 
-  optimizer_->computeInitialGuess();
+  cost_breakdown_.clear();
 
-  cost_ = 0;
-
-  if (alternative_time_cost) // true 代表cost累加方式为  \f$ \sum_i \Delta T_i \f$
+  // 按代价类别累加 chi2，边在 buildGraph 时已经登记好，不需要再逐一 dynamic_cast
+  for (int term = 0; term < NUM_COST_TERMS; ++term)
   {
-    cost_ += teb_.getSumOfAllTimeDiffs();
-    // TEST we use SumOfAllTimeDiffs() here, because edge cost depends on number of samples, which is not always the same for similar TEBs,
-    // since we are using an AutoResize Function with hysteresis.
+    double scale = 1.0;
+    if (term == static_cast<int>(CostTerm::Obstacle) || term == static_cast<int>(CostTerm::DynamicObstacle))
+      scale = obst_cost_scale;
+    else if (term == static_cast<int>(CostTerm::ViaPoint))
+      scale = viapoint_cost_scale;
+    else if (term == static_cast<int>(CostTerm::TimeOptimal) && alternative_time_cost)
+    {
+      // true 代表cost累加方式为  \f$ \sum_i \Delta T_i \f$, time optimal 边的代价被忽略
+      // TEST we use SumOfAllTimeDiffs() here, because edge cost depends on number of samples, which is not always the same for similar TEBs,
+      // since we are using an AutoResize Function with hysteresis.
+      cost_breakdown_.terms[term] = teb_.getSumOfAllTimeDiffs();
+      continue;
+    }
+
+    double sum = 0;
+    for (const g2o::OptimizableGraph::Edge* edge : edge_registry_[term])
+      sum += edge->chi2();
+    cost_breakdown_.terms[term] = scale * sum;
   }
 
-  // 现在开始累加所有的代价。因为没有存储边的指针，所有要检查每个边是不是nullptr
-  for (std::vector<g2o::OptimizableGraph::Edge*>::const_iterator it = optimizer_->activeEdges().begin(); it!= optimizer_->activeEdges().end(); it++)
+  // 合并的边按分量拆分到对应的代价类别
+  for (const EdgeSegmentKinematics* edge : segment_kinematics_edges_)
   {
-    double cur_cost = (*it)->chi2();
-
-    if (dynamic_cast<EdgeObstacle*>(*it) != nullptr
-        || dynamic_cast<EdgeInflatedObstacle*>(*it) != nullptr
-        || dynamic_cast<EdgeDynamicObstacle*>(*it) != nullptr)
-    {
-      cur_cost *= obst_cost_scale;
-    }
-    else if (dynamic_cast<EdgeViaPoint*>(*it) != nullptr)
-    {
-      cur_cost *= viapoint_cost_scale;
-    }
-    else if (dynamic_cast<EdgeTimeOptimal*>(*it) != nullptr && alternative_time_cost)
-    {
-      continue; // 如果alternative_time_cost是true, 该循环的代价被忽略
-    }
-    cost_ += cur_cost;
+    cost_breakdown_[CostTerm::Velocity] += edge->componentChi2(EdgeSegmentKinematics::VelocityX) + edge->componentChi2(EdgeSegmentKinematics::VelocityTheta);
+    cost_breakdown_[CostTerm::Kinematics] += edge->componentChi2(EdgeSegmentKinematics::NonHolonomic) + edge->componentChi2(EdgeSegmentKinematics::DriveDirOrTurningRadius);
+    if (!alternative_time_cost)
+      cost_breakdown_[CostTerm::TimeOptimal] += edge->componentChi2(EdgeSegmentKinematics::TimeOptimal);
   }
 
-  // 删除临时创建的图
-  if (!graph_exist_flag)
-    clearGraph();
+  for (int term = 0; term < NUM_COST_TERMS; ++term)
+    cost_breakdown_.total += cost_breakdown_.terms[term];
+  cost_ = cost_breakdown_.total;
+}
+
+double TebOptimalPlanner::evaluateCostBreakdown(TebCostBreakdown& breakdown, double obst_cost_scale, double viapoint_cost_scale, bool alternative_time_cost)
+{
+  TebCostEvaluator evaluator(*cfg_, robot_model_.get());
+  evaluator.setObstacles(obstacles_);
+  evaluator.setViaPoints(via_points_);
+  evaluator.setVelocityStart(vel_start_.first ? &vel_start_.second : NULL);
+  evaluator.setVelocityGoal(vel_goal_.first ? &vel_goal_.second : NULL);
+  evaluator.setPreferredTurningDir(prefer_rotdir_);
+  return evaluator.evaluate(teb_, breakdown, obst_cost_scale, viapoint_cost_scale, alternative_time_cost);
 }
 
 
@@ -1320,6 +1420,10 @@ bool TebOptimalPlanner::isTrajectoryFeasible(base_local_planner::CostmapModel* c
       }
     }
   }
+
+  // only feasible trajectories are worth to seed a later reinitialization
+  if (cfg_->trajectory.warm_start_cache_size > 0)
+    warm_start_cache_.remember(teb_);
   return true;
 }
 
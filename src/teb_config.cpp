@@ -87,6 +87,9 @@ void TebConfig::loadRosParamFromNodeHandle(const ros::NodeHandle& nh)
   nh.param("control_look_ahead_poses", trajectory.control_look_ahead_poses, trajectory.control_look_ahead_poses);
   // 防止观察点太远
   nh.param("prevent_look_ahead_poses_near_goal", trajectory.prevent_look_ahead_poses_near_goal, trajectory.prevent_look_ahead_poses_near_goal);
+  // 重新初始化時，用快取的軌跡當初始值 (0: 不使用)，以及障礙物分佈 hash 的網格解析度
+  nh.param("warm_start_cache_size", trajectory.warm_start_cache_size, trajectory.warm_start_cache_size);
+  nh.param("warm_start_cache_resolution", trajectory.warm_start_cache_resolution, trajectory.warm_start_cache_resolution);
 
   // <--------------------------------------   Robot 机器人相关参数
   // 最大前向线速度
@@ -142,6 +145,11 @@ void TebConfig::loadRosParamFromNodeHandle(const ros::NodeHandle& nh)
   nh.param("include_costmap_obstacles", obstacles.include_costmap_obstacles, obstacles.include_costmap_obstacles);
   // 限制机器人后面被考虑障碍物的距离
   nh.param("costmap_obstacles_behind_robot_dist", obstacles.costmap_obstacles_behind_robot_dist, obstacles.costmap_obstacles_behind_robot_dist);
+  // 只掃描軌跡和路徑附近 (加上 cutoff 距離) 的代價地圖區域
+  nh.param("costmap_obstacles_roi", obstacles.costmap_obstacles_roi, obstacles.costmap_obstacles_roi);
+  // 把代价地图的障碍物格子降采样并聚类成点、线、多边形障碍物 (0: 不聚类，每个格子都是一个点障碍物)
+  nh.param("costmap_obstacles_cluster_resolution", obstacles.costmap_obstacles_cluster_resolution, obstacles.costmap_obstacles_cluster_resolution);
+  nh.param("costmap_obstacles_cluster_max_extent", obstacles.costmap_obstacles_cluster_max_extent, obstacles.costmap_obstacles_cluster_max_extent);
   //
   nh.param("obstacle_poses_affected", obstacles.obstacle_poses_affected, obstacles.obstacle_poses_affected);
   // true，对于每个障碍物找到最近的TEB位姿。false,只找相关的障碍物
@@ -150,6 +158,8 @@ void TebConfig::loadRosParamFromNodeHandle(const ros::NodeHandle& nh)
   nh.param("obstacle_association_force_inclusion_factor", obstacles.obstacle_association_force_inclusion_factor, obstacles.obstacle_association_force_inclusion_factor);
   // [value]*min_obstacle_dist以外的障碍物都会在优化时被忽略，该参数会被优先处理
   nh.param("obstacle_association_cutoff_factor", obstacles.obstacle_association_cutoff_factor, obstacles.obstacle_association_cutoff_factor);
+  // 位姿在外层迭代间移动小于该值时，沿用上一次的障碍物关联结果 (0: 每次都重新关联)
+  nh.param("obstacle_association_cache_tolerance", obstacles.obstacle_association_cache_tolerance, obstacles.obstacle_association_cache_tolerance);
   // 代价地图转换器的名字
   nh.param("costmap_converter_plugin", obstacles.costmap_converter_plugin, obstacles.costmap_converter_plugin);
   // true,代价地图转换器在另外的线程唤醒回调队列
@@ -212,6 +222,8 @@ void TebConfig::loadRosParamFromNodeHandle(const ros::NodeHandle& nh)
   nh.param("weight_adapt_factor", optim.weight_adapt_factor, optim.weight_adapt_factor);
   // 非线性障碍物代价的指数(cost = linear_cost * obstacle_cost_exponent)
   nh.param("obstacle_cost_exponent", optim.obstacle_cost_exponent, optim.obstacle_cost_exponent);
+  // 把每段的速度、运动学与时间约束合并成一条边 (只适用于非完整约束机器人)
+  nh.param("fuse_segment_edges", optim.fuse_segment_edges, optim.fuse_segment_edges);
 
   // <----------------------------------------  Homotopy Class Planner
   // 是否开启同伦
@@ -224,6 +236,8 @@ void TebConfig::loadRosParamFromNodeHandle(const ros::NodeHandle& nh)
   nh.param("max_number_classes", hcp.max_number_classes, hcp.max_number_classes);
   // 相同同伦内的最大轨迹数，帮助避免局部最小
   nh.param("max_number_plans_in_current_class", hcp.max_number_plans_in_current_class, hcp.max_number_plans_in_current_class);
+  // 同一同伦类中形状几乎相同的轨迹的距离阈值 (0: 不检查)
+  nh.param("duplicate_trajectory_distance", hcp.duplicate_trajectory_distance, hcp.duplicate_trajectory_distance);
   // 障碍物代价的尺度因子，为了找到最好的候选路径
   nh.param("selection_obst_cost_scale", hcp.selection_obst_cost_scale, hcp.selection_obst_cost_scale);
   // 选择（0，1）中的值，减小代价
@@ -236,6 +250,8 @@ void TebConfig::loadRosParamFromNodeHandle(const ros::NodeHandle& nh)
   nh.param("selection_alternative_time_cost", hcp.selection_alternative_time_cost, hcp.selection_alternative_time_cost);
   // 在每个规划循环中，TEBs被抛弃的概率
   nh.param("selection_dropping_probability", hcp.selection_dropping_probability, hcp.selection_dropping_probability);
+  // 每轮外层迭代后停止优化的代价最高的候选轨迹的比例 (0: 所有候选轨迹都进行全部迭代)
+  nh.param("selection_pruning_ratio", hcp.selection_pruning_ratio, hcp.selection_pruning_ratio);
   // 切换到新的同等类上的等待时间
   nh.param("switching_blocking_period", hcp.switching_blocking_period, hcp.switching_blocking_period);
   // roadmap的样本产生数
@@ -244,9 +260,17 @@ void TebConfig::loadRosParamFromNodeHandle(const ros::NodeHandle& nh)
   nh.param("roadmap_graph_area_width", hcp.roadmap_graph_area_width, hcp.roadmap_graph_area_width);
   // 长方形区域的的长由起终点距离决定，该参数为了几何中心保持不变
   nh.param("roadmap_graph_area_length_scale", hcp.roadmap_graph_area_length_scale, hcp.roadmap_graph_area_length_scale);
+  // 在规划周期之间保留路线图的采样点（只重新检查变化的障碍物附近的边）
+  nh.param("roadmap_graph_persistent", hcp.roadmap_graph_persistent, hcp.roadmap_graph_persistent);
+  // 在障碍物边界附近生成的路线图采样点的比例 (0: 只在自由空间中均匀采样)
+  nh.param("roadmap_graph_boundary_bias", hcp.roadmap_graph_boundary_bias, hcp.roadmap_graph_boundary_bias);
   // 改变障碍物值的数量
   nh.param("h_signature_prescaler", hcp.h_signature_prescaler, hcp.h_signature_prescaler);
   nh.param("h_signature_threshold", hcp.h_signature_threshold, hcp.h_signature_threshold);
+  // 轨迹与障碍物变化小于该容差时沿用上一周期的同伦类 (0: 每个周期重新计算)
+  nh.param("h_signature_reuse_tolerance", hcp.h_signature_reuse_tolerance, hcp.h_signature_reuse_tolerance);
+  // 增量更新已有轨迹的H签名，每隔n个周期完整重新计算一次 (0: 每个周期完整计算)
+  nh.param("h_signature_full_update_interval", hcp.h_signature_full_update_interval, hcp.h_signature_full_update_interval);
   nh.param("obstacle_keypoint_offset", hcp.obstacle_keypoint_offset, hcp.obstacle_keypoint_offset);
   nh.param("obstacle_heading_threshold", hcp.obstacle_heading_threshold, hcp.obstacle_heading_threshold);
   nh.param("viapoints_all_candidates", hcp.viapoints_all_candidates, hcp.viapoints_all_candidates);
@@ -298,6 +322,8 @@ void TebConfig::reconfigure(TebLocalPlannerReconfigureConfig& cfg)
   trajectory.publish_feedback = cfg.publish_feedback;
   trajectory.control_look_ahead_poses = cfg.control_look_ahead_poses;
   trajectory.prevent_look_ahead_poses_near_goal = cfg.prevent_look_ahead_poses_near_goal;
+  trajectory.warm_start_cache_size = cfg.warm_start_cache_size;
+  trajectory.warm_start_cache_resolution = cfg.warm_start_cache_resolution;
 
   // Robot
   robot.max_vel_x = cfg.max_vel_x;
@@ -328,7 +354,11 @@ void TebConfig::reconfigure(TebLocalPlannerReconfigureConfig& cfg)
   obstacles.legacy_obstacle_association = cfg.legacy_obstacle_association;
   obstacles.obstacle_association_force_inclusion_factor = cfg.obstacle_association_force_inclusion_factor;
   obstacles.obstacle_association_cutoff_factor = cfg.obstacle_association_cutoff_factor;
+  obstacles.obstacle_association_cache_tolerance = cfg.obstacle_association_cache_tolerance;
   obstacles.costmap_obstacles_behind_robot_dist = cfg.costmap_obstacles_behind_robot_dist;
+  obstacles.costmap_obstacles_roi = cfg.costmap_obstacles_roi;
+  obstacles.costmap_obstacles_cluster_resolution = cfg.costmap_obstacles_cluster_resolution;
+  obstacles.costmap_obstacles_cluster_max_extent = cfg.costmap_obstacles_cluster_max_extent;
   obstacles.obstacle_poses_affected = cfg.obstacle_poses_affected;
   obstacles.obstacle_proximity_ratio_max_vel = cfg.obstacle_proximity_ratio_max_vel;
   obstacles.obstacle_proximity_lower_bound = cfg.obstacle_proximity_lower_bound;
@@ -359,25 +389,32 @@ void TebConfig::reconfigure(TebLocalPlannerReconfigureConfig& cfg)
   optim.weight_viapoint = cfg.weight_viapoint;
   optim.weight_adapt_factor = cfg.weight_adapt_factor;
   optim.obstacle_cost_exponent = cfg.obstacle_cost_exponent;
+  optim.fuse_segment_edges = cfg.fuse_segment_edges;
 
   // Homotopy Class Planner
   hcp.enable_multithreading = cfg.enable_multithreading;
   hcp.max_number_classes = cfg.max_number_classes;
   hcp.max_number_plans_in_current_class = cfg.max_number_plans_in_current_class;
+  hcp.duplicate_trajectory_distance = cfg.duplicate_trajectory_distance;
   hcp.selection_cost_hysteresis = cfg.selection_cost_hysteresis;
   hcp.selection_prefer_initial_plan = cfg.selection_prefer_initial_plan;
   hcp.selection_obst_cost_scale = cfg.selection_obst_cost_scale;
   hcp.selection_viapoint_cost_scale = cfg.selection_viapoint_cost_scale;
   hcp.selection_alternative_time_cost = cfg.selection_alternative_time_cost;
   hcp.selection_dropping_probability = cfg.selection_dropping_probability;
+  hcp.selection_pruning_ratio = cfg.selection_pruning_ratio;
   hcp.switching_blocking_period = cfg.switching_blocking_period;
 
   hcp.obstacle_heading_threshold = cfg.obstacle_heading_threshold;
   hcp.roadmap_graph_no_samples = cfg.roadmap_graph_no_samples;
   hcp.roadmap_graph_area_width = cfg.roadmap_graph_area_width;
   hcp.roadmap_graph_area_length_scale = cfg.roadmap_graph_area_length_scale;
+  hcp.roadmap_graph_persistent = cfg.roadmap_graph_persistent;
+  hcp.roadmap_graph_boundary_bias = cfg.roadmap_graph_boundary_bias;
   hcp.h_signature_prescaler = cfg.h_signature_prescaler;
   hcp.h_signature_threshold = cfg.h_signature_threshold;
+  hcp.h_signature_reuse_tolerance = cfg.h_signature_reuse_tolerance;
+  hcp.h_signature_full_update_interval = cfg.h_signature_full_update_interval;
   hcp.viapoints_all_candidates = cfg.viapoints_all_candidates;
   hcp.visualize_hc_graph = cfg.visualize_hc_graph;
   hcp.visualize_with_time_as_z_axis_scale = cfg.visualize_with_time_as_z_axis_scale;
@@ -427,6 +464,10 @@ void TebConfig::checkParameters() const
   if (obstacles.costmap_obstacles_behind_robot_dist < 0)
     ROS_WARN("TebLocalPlannerROS() Param Warning: parameter 'costmap_obstacles_behind_robot_dist' should be positive or zero.");
 
+  // costmap obstacle clustering
+  if (obstacles.costmap_obstacles_cluster_resolution > 0 && obstacles.costmap_obstacles_cluster_max_extent < obstacles.costmap_obstacles_cluster_resolution)
+    ROS_WARN("TebLocalPlannerROS() Param Warning: parameter 'costmap_obstacles_cluster_max_extent' should be larger than 'costmap_obstacles_cluster_resolution', otherwise each voxel becomes its own obstacle.");
+
   // hcp: obstacle heading threshold
   if (hcp.obstacle_keypoint_offset>=1 || hcp.obstacle_keypoint_offset<=0)
     ROS_WARN("TebLocalPlannerROS() Param Warning: parameter obstacle_heading_threshold must be in the interval ]0,1[. 0=0deg opening angle, 1=90deg opening angle.");
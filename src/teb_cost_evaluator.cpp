@@ -0,0 +1,578 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Christoph Rösmann
+ *********************************************************************/
+
+
+#include <teb_local_planner/teb_cost_evaluator.h>
+
+// g2o custom edges and vertices for the TEB planner
+#include <teb_local_planner/g2o_types/edge_velocity.h>
+#include <teb_local_planner/g2o_types/edge_velocity_obstacle_ratio.h>
+#include <teb_local_planner/g2o_types/edge_acceleration.h>
+#include <teb_local_planner/g2o_types/edge_kinematics.h>
+#include <teb_local_planner/g2o_types/edge_time_optimal.h>
+#include <teb_local_planner/g2o_types/edge_shortest_path.h>
+#include <teb_local_planner/g2o_types/edge_obstacle.h>
+#include <teb_local_planner/g2o_types/edge_dynamic_obstacle.h>
+#include <teb_local_planner/g2o_types/edge_via_point.h>
+#include <teb_local_planner/g2o_types/edge_prefer_rotdir.h>
+
+#include <limits>
+
+namespace teb_local_planner
+{
+
+namespace
+{
+
+// 計算一條邊目前的代價 (weighted squared error)，邊不需要加進 optimizer
+template <typename EdgeT>
+inline double edgeCost(EdgeT& edge)
+{
+  edge.computeError();
+  return edge.chi2();
+}
+
+} // anonymous namespace
+
+
+const char* costTermName(CostTerm term)
+{
+  switch (term)
+  {
+    case CostTerm::Obstacle: return "obstacle";
+    case CostTerm::DynamicObstacle: return "dynamic_obstacle";
+    case CostTerm::ViaPoint: return "via_point";
+    case CostTerm::Velocity: return "velocity";
+    case CostTerm::Acceleration: return "acceleration";
+    case CostTerm::TimeOptimal: return "time_optimal";
+    case CostTerm::ShortestPath: return "shortest_path";
+    case CostTerm::Kinematics: return "kinematics";
+    case CostTerm::PreferRotDir: return "prefer_rotdir";
+    case CostTerm::VelocityObstacleRatio: return "velocity_obstacle_ratio";
+  }
+  return "unknown";
+}
+
+
+TebCostEvaluator::TebCostEvaluator(const TebConfig& cfg, const BaseRobotFootprintModel* robot_model)
+  : cfg_(&cfg), robot_model_(robot_model), obstacles_(NULL), via_points_(NULL), vel_start_(NULL), vel_goal_(NULL),
+    prefer_rotdir_(RotType::none)
+{
+}
+
+
+void TebCostEvaluator::associateObstacles(const TebConfig& cfg, const BaseRobotFootprintModel& robot_model, const PoseSE2& pose,
+                                          const ObstContainer& obstacles, ObstContainer& relevant, ObstacleAssociationMargin* margin,
+                                          const ObstacleSpatialIndex* index)
+{
+  double left_min_dist = std::numeric_limits<double>::max();
+  double right_min_dist = std::numeric_limits<double>::max();
+  double left_second_dist = std::numeric_limits<double>::max();
+  double right_second_dist = std::numeric_limits<double>::max();
+  ObstaclePtr left_obstacle;
+  ObstaclePtr right_obstacle;
+
+  const double force_inclusion_dist = cfg.obstacles.min_obstacle_dist*cfg.obstacles.obstacle_association_force_inclusion_factor;
+  const double cutoff_dist = cfg.obstacles.min_obstacle_dist*cfg.obstacles.obstacle_association_cutoff_factor;
+  // beyond both thresholds an obstacle is never associated
+  const double cull_dist = std::max(force_inclusion_dist, cutoff_dist);
+  double dist_margin = std::numeric_limits<double>::max();
+  double angle_margin = std::numeric_limits<double>::max();
+
+  const Eigen::Vector2d pose_orient = pose.orientationUnitVec();
+
+  // 只访问空间索引中附近的障碍物
+  std::vector<int> candidates;
+  const bool use_index = index && index->covers(obstacles);
+  if (use_index)
+  {
+    // the distance bound of the obstacles outside of the query circle exceeds the cull distance by at least query_margin
+    const double query_margin = cull_dist + cfg.obstacles.obstacle_association_cache_tolerance;
+    index->queryCircle(pose.position(), robot_model.getCircumscribedRadius() + cull_dist + query_margin, candidates);
+    dist_margin = query_margin;
+  }
+  const std::size_t num_obstacles = use_index ? candidates.size() : obstacles.size();
+
+  // 迭代障碍物
+  for (std::size_t k = 0; k < num_obstacles; ++k)
+  {
+    const ObstaclePtr& obst = obstacles[use_index ? candidates[k] : k];
+
+    // 动态障碍物会被分别处理
+    if (cfg.obstacles.include_dynamic_obstacles && obst->isDynamic())
+      continue;
+
+    // 包围圆已经超出截断距离时不需要计算精确距离
+    if (robot_model.isBeyondDistance(pose, obst.get(), cull_dist))
+    {
+      if (margin) // the distance bound of the circles is a lower bound of the exact distance
+        dist_margin = std::min(dist_margin, (pose.position() - obst->getCentroid()).norm() - robot_model.getCircumscribedRadius()
+                                            - obst->getBoundingRadius() - cull_dist);
+      continue;
+    }
+
+    // 计算到机器人模型的距离
+    double dist = calculateRobotObstacleDistance(robot_model, pose, obst.get());
+
+    // 与两个阈值的距离决定了关联结果对位姿变化的鲁棒性
+    if (margin)
+      dist_margin = std::min(dist_margin, std::min(std::fabs(dist - force_inclusion_dist), std::fabs(dist - cutoff_dist)));
+
+    // 如果离的很近了就必须考虑障碍物了
+    if (dist < force_inclusion_dist)
+    {
+      relevant.push_back(obst);
+      continue;
+    }
+    // cut-off distance
+    if (dist > cutoff_dist)
+      continue;
+
+    // the side only depends on the orientation, it changes if the pose is rotated beyond the direction of the centroid
+    if (margin)
+    {
+      const Eigen::Vector2d& centroid = obst->getCentroid();
+      const double angle = std::fabs(g2o::normalize_theta(pose.theta() - std::atan2(centroid.y(), centroid.x())));
+      angle_margin = std::min(angle_margin, std::min(angle, M_PI - angle));
+    }
+
+    // determine side (left or right) and assign obstacle if closer than the previous one
+    if (cross2d(pose_orient, obst->getCentroid()) > 0) // left
+    {
+      if (dist < left_min_dist)
+      {
+        left_second_dist = left_min_dist;
+        left_min_dist = dist;
+        left_obstacle = obst;
+      }
+      else
+        left_second_dist = std::min(left_second_dist, dist);
+    }
+    else
+    {
+      if (dist < right_min_dist)
+      {
+        right_second_dist = right_min_dist;
+        right_min_dist = dist;
+        right_obstacle = obst;
+      }
+      else
+        right_second_dist = std::min(right_second_dist, dist);
+    }
+  }
+
+  if (left_obstacle)
+    relevant.push_back(left_obstacle);
+  if (right_obstacle)
+    relevant.push_back(right_obstacle);
+
+  if (margin)
+  {
+    // the closest obstacle of a side remains the same as long as the distances change by less than half the gap to the runner-up
+    if (left_obstacle && left_second_dist != std::numeric_limits<double>::max())
+      dist_margin = std::min(dist_margin, 0.5 * (left_second_dist - left_min_dist));
+    if (right_obstacle && right_second_dist != std::numeric_limits<double>::max())
+      dist_margin = std::min(dist_margin, 0.5 * (right_second_dist - right_min_dist));
+    margin->distance = dist_margin;
+    margin->angle = angle_margin;
+  }
+}
+
+
+double TebCostEvaluator::evaluate(TimedElasticBand& teb, TebCostBreakdown& breakdown, double obst_cost_scale,
+                                  double viapoint_cost_scale, bool alternative_time_cost) const
+{
+  breakdown.clear();
+
+  const int n = teb.sizePoses();
+  if (n < 2 || teb.sizeTimeDiffs() < n - 1)
+    return 0;
+
+  const bool holonomic = cfg_->robot.max_vel_y != 0;
+
+  // obstacles (and the velocity obstacle ratio, which shares the association)
+  if (obstacles_ != NULL && robot_model_ != NULL && cfg_->optim.weight_obstacle != 0)
+  {
+    const bool inflated = cfg_->obstacles.inflation_dist > cfg_->obstacles.min_obstacle_dist;
+    const bool velocity_obstacle_ratio = cfg_->optim.weight_velocity_obstacle_ratio > 0;
+
+    EdgeObstacle edge_obst;
+    Eigen::Matrix<double,1,1> information;
+    information.fill(cfg_->optim.weight_obstacle);
+    edge_obst.setInformation(information);
+
+    EdgeInflatedObstacle edge_inflated_obst;
+    Eigen::Matrix<double,2,2> information_inflated;
+    information_inflated(0,0) = cfg_->optim.weight_obstacle;
+    information_inflated(1,1) = cfg_->optim.weight_inflation;
+    information_inflated(0,1) = information_inflated(1,0) = 0;
+    edge_inflated_obst.setInformation(information_inflated);
+
+    EdgeVelocityObstacleRatio edge_ratio;
+    Eigen::Matrix<double,2,2> information_ratio;
+    information_ratio(0,0) = information_ratio(1,1) = cfg_->optim.weight_velocity_obstacle_ratio;
+    information_ratio(0,1) = information_ratio(1,0) = 0;
+    edge_ratio.setInformation(information_ratio);
+
+    ObstContainer relevant;
+    relevant.reserve(obstacles_->size());
+
+    const int first_vertex = velocity_obstacle_ratio ? 0 : 1;
+    for (int i = first_vertex; i < n - 1; ++i)
+    {
+      relevant.clear();
+      associateObstacles(*cfg_, *robot_model_, teb.Pose(i), *obstacles_, relevant);
+
+      for (const ObstaclePtr& obst : relevant)
+      {
+        if (i > 0)
+        {
+          if (inflated)
+          {
+            edge_inflated_obst.setVertex(0, teb.PoseVertex(i));
+            edge_inflated_obst.setParameters(*cfg_, robot_model_, obst.get());
+            breakdown[CostTerm::Obstacle] += obst_cost_scale * edgeCost(edge_inflated_obst);
+          }
+          else
+          {
+            edge_obst.setVertex(0, teb.PoseVertex(i));
+            edge_obst.setParameters(*cfg_, robot_model_, obst.get());
+            breakdown[CostTerm::Obstacle] += obst_cost_scale * edgeCost(edge_obst);
+          }
+        }
+
+        if (velocity_obstacle_ratio)
+        {
+          edge_ratio.setVertex(0, teb.PoseVertex(i));
+          edge_ratio.setVertex(1, teb.PoseVertex(i+1));
+          edge_ratio.setVertex(2, teb.TimeDiffVertex(i));
+          edge_ratio.setParameters(*cfg_, robot_model_, obst.get());
+          breakdown[CostTerm::VelocityObstacleRatio] += edgeCost(edge_ratio);
+        }
+      }
+    }
+  }
+
+  // dynamic obstacles
+  if (obstacles_ != NULL && robot_model_ != NULL && cfg_->obstacles.include_dynamic_obstacles && cfg_->optim.weight_obstacle != 0)
+  {
+    EdgeDynamicObstacle edge;
+    Eigen::Matrix<double,2,2> information;
+    information(0,0) = cfg_->optim.weight_dynamic_obstacle;
+    information(1,1) = cfg_->optim.weight_dynamic_obstacle_inflation;
+    information(0,1) = information(1,0) = 0;
+    edge.setInformation(information);
+
+    for (const ObstaclePtr& obst : *obstacles_)
+    {
+      if (!obst->isDynamic())
+        continue;
+
+      edge.setParameters(*cfg_, robot_model_, obst.get());
+      double time = teb.TimeDiff(0);
+      for (int i=1; i < n - 1; ++i)
+      {
+        edge.setVertex(0, teb.PoseVertex(i));
+        edge.setTime(time);
+        breakdown[CostTerm::DynamicObstacle] += obst_cost_scale * edgeCost(edge);
+        time += teb.TimeDiff(i);
+      }
+    }
+  }
+
+  // via-points (same association as TebOptimalPlanner::AddEdgesViaPoints)
+  if (via_points_ != NULL && !via_points_->empty() && cfg_->optim.weight_viapoint != 0 && n >= 3)
+  {
+    EdgeViaPoint edge;
+    Eigen::Matrix<double,1,1> information;
+    information.fill(cfg_->optim.weight_viapoint);
+    edge.setInformation(information);
+
+    std::vector<int> ordered_indices;
+    if (cfg_->trajectory.via_points_ordered)
+      teb.findClosestTrajectoryPoses(*via_points_, ordered_indices, 2);
+
+    for (std::size_t vp_idx = 0; vp_idx < via_points_->size(); ++vp_idx)
+    {
+      const Eigen::Vector2d& via_point = (*via_points_)[vp_idx];
+      int index = cfg_->trajectory.via_points_ordered ? ordered_indices[vp_idx] : teb.findClosestTrajectoryPose(via_point);
+      if (index > n-2)
+        index = n-2;
+      if (index < 1)
+      {
+        if (!cfg_->trajectory.via_points_ordered)
+          continue;
+        index = 1;
+      }
+      edge.setVertex(0, teb.PoseVertex(index));
+      edge.setParameters(*cfg_, &via_point);
+      breakdown[CostTerm::ViaPoint] += viapoint_cost_scale * edgeCost(edge);
+    }
+  }
+
+  // velocity
+  if (!holonomic)
+  {
+    if (cfg_->optim.weight_max_vel_x != 0 || cfg_->optim.weight_max_vel_theta != 0)
+    {
+      EdgeVelocity edge;
+      Eigen::Matrix<double,2,2> information;
+      information.fill(0);
+      information(0,0) = cfg_->optim.weight_max_vel_x;
+      information(1,1) = cfg_->optim.weight_max_vel_theta;
+      edge.setInformation(information);
+      edge.setTebConfig(*cfg_);
+      for (int i=0; i < n - 1; ++i)
+      {
+        edge.setVertex(0, teb.PoseVertex(i));
+        edge.setVertex(1, teb.PoseVertex(i+1));
+        edge.setVertex(2, teb.TimeDiffVertex(i));
+        breakdown[CostTerm::Velocity] += edgeCost(edge);
+      }
+    }
+  }
+  else if (cfg_->optim.weight_max_vel_x != 0 || cfg_->optim.weight_max_vel_y != 0 || cfg_->optim.weight_max_vel_theta != 0)
+  {
+    EdgeVelocityHolonomic edge;
+    Eigen::Matrix<double,3,3> information;
+    information.fill(0);
+    information(0,0) = cfg_->optim.weight_max_vel_x;
+    information(1,1) = cfg_->optim.weight_max_vel_y;
+    information(2,2) = cfg_->optim.weight_max_vel_theta;
+    edge.setInformation(information);
+    edge.setTebConfig(*cfg_);
+    for (int i=0; i < n - 1; ++i)
+    {
+      edge.setVertex(0, teb.PoseVertex(i));
+      edge.setVertex(1, teb.PoseVertex(i+1));
+      edge.setVertex(2, teb.TimeDiffVertex(i));
+      breakdown[CostTerm::Velocity] += edgeCost(edge);
+    }
+  }
+
+  // acceleration
+  if (cfg_->optim.weight_acc_lim_x != 0 || cfg_->optim.weight_acc_lim_theta != 0)
+  {
+    if (cfg_->robot.max_vel_y == 0 || cfg_->robot.acc_lim_y == 0) // non-holonomic robot
+    {
+      Eigen::Matrix<double,2,2> information;
+      information.fill(0);
+      information(0,0) = cfg_->optim.weight_acc_lim_x;
+      information(1,1) = cfg_->optim.weight_acc_lim_theta;
+
+      if (vel_start_)
+      {
+        EdgeAccelerationStart edge;
+        edge.setVertex(0, teb.PoseVertex(0));
+        edge.setVertex(1, teb.PoseVertex(1));
+        edge.setVertex(2, teb.TimeDiffVertex(0));
+        edge.setInitialVelocity(*vel_start_);
+        edge.setInformation(information);
+        edge.setTebConfig(*cfg_);
+        breakdown[CostTerm::Acceleration] += edgeCost(edge);
+      }
+
+      EdgeAcceleration edge;
+      edge.setInformation(information);
+      edge.setTebConfig(*cfg_);
+      for (int i=0; i < n - 2; ++i)
+      {
+        edge.setVertex(0, teb.PoseVertex(i));
+        edge.setVertex(1, teb.PoseVertex(i+1));
+        edge.setVertex(2, teb.PoseVertex(i+2));
+        edge.setVertex(3, teb.TimeDiffVertex(i));
+        edge.setVertex(4, teb.TimeDiffVertex(i+1));
+        breakdown[CostTerm::Acceleration] += edgeCost(edge);
+      }
+
+      if (vel_goal_)
+      {
+        EdgeAccelerationGoal edge_goal;
+        edge_goal.setVertex(0, teb.PoseVertex(n-2));
+        edge_goal.setVertex(1, teb.PoseVertex(n-1));
+        edge_goal.setVertex(2, teb.TimeDiffVertex(teb.sizeTimeDiffs()-1));
+        edge_goal.setGoalVelocity(*vel_goal_);
+        edge_goal.setInformation(information);
+        edge_goal.setTebConfig(*cfg_);
+        breakdown[CostTerm::Acceleration] += edgeCost(edge_goal);
+      }
+    }
+    else // holonomic robot
+    {
+      Eigen::Matrix<double,3,3> information;
+      information.fill(0);
+      information(0,0) = cfg_->optim.weight_acc_lim_x;
+      information(1,1) = cfg_->optim.weight_acc_lim_y;
+      information(2,2) = cfg_->optim.weight_acc_lim_theta;
+
+      if (vel_start_)
+      {
+        EdgeAccelerationHolonomicStart edge;
+        edge.setVertex(0, teb.PoseVertex(0));
+        edge.setVertex(1, teb.PoseVertex(1));
+        edge.setVertex(2, teb.TimeDiffVertex(0));
+        edge.setInitialVelocity(*vel_start_);
+        edge.setInformation(information);
+        edge.setTebConfig(*cfg_);
+        breakdown[CostTerm::Acceleration] += edgeCost(edge);
+      }
+
+      EdgeAccelerationHolonomic edge;
+      edge.setInformation(information);
+      edge.setTebConfig(*cfg_);
+      for (int i=0; i < n - 2; ++i)
+      {
+        edge.setVertex(0, teb.PoseVertex(i));
+        edge.setVertex(1, teb.PoseVertex(i+1));
+        edge.setVertex(2, teb.PoseVertex(i+2));
+        edge.setVertex(3, teb.TimeDiffVertex(i));
+        edge.setVertex(4, teb.TimeDiffVertex(i+1));
+        breakdown[CostTerm::Acceleration] += edgeCost(edge);
+      }
+
+      if (vel_goal_)
+      {
+        EdgeAccelerationHolonomicGoal edge_goal;
+        edge_goal.setVertex(0, teb.PoseVertex(n-2));
+        edge_goal.setVertex(1, teb.PoseVertex(n-1));
+        edge_goal.setVertex(2, teb.TimeDiffVertex(teb.sizeTimeDiffs()-1));
+        edge_goal.setGoalVelocity(*vel_goal_);
+        edge_goal.setInformation(information);
+        edge_goal.setTebConfig(*cfg_);
+        breakdown[CostTerm::Acceleration] += edgeCost(edge_goal);
+      }
+    }
+  }
+
+  // time optimality
+  if (alternative_time_cost)
+  {
+    breakdown[CostTerm::TimeOptimal] = teb.getSumOfAllTimeDiffs();
+  }
+  else if (cfg_->optim.weight_optimaltime != 0)
+  {
+    EdgeTimeOptimal edge;
+    Eigen::Matrix<double,1,1> information;
+    information.fill(cfg_->optim.weight_optimaltime);
+    edge.setInformation(information);
+    edge.setTebConfig(*cfg_);
+    for (int i=0; i < teb.sizeTimeDiffs(); ++i)
+    {
+      edge.setVertex(0, teb.TimeDiffVertex(i));
+      breakdown[CostTerm::TimeOptimal] += edgeCost(edge);
+    }
+  }
+
+  // shortest path
+  if (cfg_->optim.weight_shortest_path != 0)
+  {
+    EdgeShortestPath edge;
+    Eigen::Matrix<double,1,1> information;
+    information.fill(cfg_->optim.weight_shortest_path);
+    edge.setInformation(information);
+    edge.setTebConfig(*cfg_);
+    for (int i=0; i < n - 1; ++i)
+    {
+      edge.setVertex(0, teb.PoseVertex(i));
+      edge.setVertex(1, teb.PoseVertex(i+1));
+      breakdown[CostTerm::ShortestPath] += edgeCost(edge);
+    }
+  }
+
+  // kinematics
+  if (cfg_->robot.min_turning_radius == 0 || cfg_->optim.weight_kinematics_turning_radius == 0)
+  {
+    if (cfg_->optim.weight_kinematics_nh != 0 || cfg_->optim.weight_kinematics_forward_drive != 0)
+    {
+      EdgeKinematicsDiffDrive edge;
+      Eigen::Matrix<double,2,2> information;
+      information.fill(0.0);
+      information(0, 0) = cfg_->optim.weight_kinematics_nh;
+      information(1, 1) = cfg_->optim.weight_kinematics_forward_drive;
+      edge.setInformation(information);
+      edge.setTebConfig(*cfg_);
+      for (int i=0; i < n - 1; ++i)
+      {
+        edge.setVertex(0, teb.PoseVertex(i));
+        edge.setVertex(1, teb.PoseVertex(i+1));
+        breakdown[CostTerm::Kinematics] += edgeCost(edge);
+      }
+    }
+  }
+  else if (cfg_->optim.weight_kinematics_nh != 0 || cfg_->optim.weight_kinematics_turning_radius != 0)
+  {
+    EdgeKinematicsCarlike edge;
+    Eigen::Matrix<double,2,2> information;
+    information.fill(0.0);
+    information(0, 0) = cfg_->optim.weight_kinematics_nh;
+    information(1, 1) = cfg_->optim.weight_kinematics_turning_radius;
+    edge.setInformation(information);
+    edge.setTebConfig(*cfg_);
+    for (int i=0; i < n - 1; ++i)
+    {
+      edge.setVertex(0, teb.PoseVertex(i));
+      edge.setVertex(1, teb.PoseVertex(i+1));
+      breakdown[CostTerm::Kinematics] += edgeCost(edge);
+    }
+  }
+
+  // preferred turning direction
+  if ((prefer_rotdir_ == RotType::left || prefer_rotdir_ == RotType::right) && cfg_->optim.weight_prefer_rotdir != 0)
+  {
+    EdgePreferRotDir edge;
+    Eigen::Matrix<double,1,1> information;
+    information.fill(cfg_->optim.weight_prefer_rotdir);
+    edge.setInformation(information);
+    if (prefer_rotdir_ == RotType::left)
+      edge.preferLeft();
+    else
+      edge.preferRight();
+    for (int i=0; i < n - 1 && i < 3; ++i)
+    {
+      edge.setVertex(0, teb.PoseVertex(i));
+      edge.setVertex(1, teb.PoseVertex(i+1));
+      breakdown[CostTerm::PreferRotDir] += edgeCost(edge);
+    }
+  }
+
+  for (int i = 0; i < NUM_COST_TERMS; ++i)
+    breakdown.total += breakdown.terms[i];
+  return breakdown.total;
+}
+
+} // namespace teb_local_planner
@@ -42,6 +42,7 @@
 #include <tf2_geometry_msgs/tf2_geometry_msgs.h>
 
 #include <boost/algorithm/string.hpp>
+#include <cstring>
 
 // MBF return codes
 #include <mbf_msgs/ExePathResult.h>
@@ -80,11 +81,23 @@ TebLocalPlannerROS::~TebLocalPlannerROS()
 
 void TebLocalPlannerROS::reconfigureCB(TebLocalPlannerReconfigureConfig& config, uint32_t level)
 {
+  // 只發佈新設定的快照，真正套用是在下一個規劃週期開始時 (不會被正在進行的優化卡住)
+  boost::atomic_store(&pending_reconfig_, boost::shared_ptr<const TebLocalPlannerReconfigureConfig>(boost::make_shared<TebLocalPlannerReconfigureConfig>(config)));
+}
+
+void TebLocalPlannerROS::applyPendingReconfiguration()
+{
+  boost::shared_ptr<const TebLocalPlannerReconfigureConfig> reconfig =
+    boost::atomic_exchange(&pending_reconfig_, boost::shared_ptr<const TebLocalPlannerReconfigureConfig>());
+  if (!reconfig)
+    return;
+
+  TebLocalPlannerReconfigureConfig config = *reconfig;
   cfg_.reconfigure(config);
   ros::NodeHandle nh("~/" + name_);
   // 创建机器人的footprint（轮廓）模型，用于优化
-  RobotFootprintModelPtr robot_model = getRobotFootprintFromParamServer(nh, cfg_);
-  planner_->updateRobotModel(robot_model);
+  robot_model_ = getRobotFootprintFromParamServer(nh, cfg_);
+  planner_->updateRobotModel(robot_model_);
 }
 
 void TebLocalPlannerROS::initialize(std::string name, tf2_ros::Buffer* tf, costmap_2d::Costmap2DROS* costmap_ros)
@@ -106,17 +119,17 @@ void TebLocalPlannerROS::initialize(std::string name, tf2_ros::Buffer* tf, costm
     visualization_ = TebVisualizationPtr(new TebVisualization(nh, cfg_));
 
     // 创建机器人的footprint（轮廓）模型，用于优化
-    RobotFootprintModelPtr robot_model = getRobotFootprintFromParamServer(nh, cfg_);
+    robot_model_ = getRobotFootprintFromParamServer(nh, cfg_);
 
     // 创建局部规划器实例
     if (cfg_.hcp.enable_homotopy_class_planning)
     {
-      planner_ = PlannerInterfacePtr(new HomotopyClassPlanner(cfg_, &obstacles_, robot_model, visualization_, &via_points_));
+      planner_ = PlannerInterfacePtr(new HomotopyClassPlanner(cfg_, &obstacles_, robot_model_, visualization_, &via_points_));
       ROS_INFO("Parallel planning in distinctive topologies enabled.");
     }
     else
     {
-      planner_ = PlannerInterfacePtr(new TebOptimalPlanner(cfg_, &obstacles_, robot_model, visualization_, &via_points_));
+      planner_ = PlannerInterfacePtr(new TebOptimalPlanner(cfg_, &obstacles_, robot_model_, visualization_, &via_points_));
       ROS_INFO("Parallel planning in distinctive topologies disabled.");
     }
 
@@ -167,10 +180,11 @@ void TebLocalPlannerROS::initialize(std::string name, tf2_ros::Buffer* tf, costm
     dynamic_recfg_ = boost::make_shared< dynamic_reconfigure::Server<TebLocalPlannerReconfigureConfig> >(nh);
     dynamic_reconfigure::Server<TebLocalPlannerReconfigureConfig>::CallbackType cb = boost::bind(&TebLocalPlannerROS::reconfigureCB, this, _1, _2);
     dynamic_recfg_->setCallback(cb);
+    applyPendingReconfiguration(); // setCallback() publishes the initial config
 
     // 校验用于优化footprint和代价的footprint
     // 這邊其實就在比較機器人footprint的距離值和costmap距離值的判斷
-    validateFootprints(robot_model->getInscribedRadius(), robot_inscribed_radius_, cfg_.obstacles.min_obstacle_dist);
+    validateFootprints(robot_model_->getInscribedRadius(), robot_inscribed_radius_, cfg_.obstacles.min_obstacle_dist);
 
     // 设置自定义障碍物的回调函数
     custom_obst_sub_ = nh.subscribe("obstacles", 1, &TebLocalPlannerROS::customObstacleCB, this);
@@ -250,6 +264,9 @@ uint32_t TebLocalPlannerROS::computeVelocityCommands(const geometry_msgs::PoseSt
   cmd_vel.twist.linear.x = cmd_vel.twist.linear.y = cmd_vel.twist.angular.z = 0;
   goal_reached_ = false;
 
+  // 套用 dynamic_reconfigure 送來的新設定 (只在兩次規劃之間更新 cfg_)
+  applyPendingReconfiguration();
+
   // 获得机器人位姿
   geometry_msgs::PoseStamped robot_pose;
   costmap_ros_->getRobotPose(robot_pose);
@@ -280,7 +297,11 @@ uint32_t TebLocalPlannerROS::computeVelocityCommands(const geometry_msgs::PoseSt
   }
 
   // 更新via-points容器
-  if (!custom_via_points_active_)
+  boost::shared_ptr<const ViaPointContainer> custom_via_points = boost::atomic_load(&custom_via_points_);
+  custom_via_points_active_ = custom_via_points && !custom_via_points->empty();
+  if (custom_via_points_active_)
+    via_points_ = *custom_via_points;
+  else
     // 這邊會根據 transformed_plan 以及設置的距離，來決定 via_points_ 的內容
     updateViaPointsContainer(transformed_plan, cfg_.trajectory.global_plan_viapoint_sep);
 
@@ -349,14 +370,13 @@ uint32_t TebLocalPlannerROS::computeVelocityCommands(const geometry_msgs::PoseSt
   if (costmap_converter_)
     updateObstacleContainerWithCostmapConverter();
   else
-    updateObstacleContainerWithCostmap();
+    updateObstacleContainerWithCostmap(transformed_plan);
 
   // 也考虑自定义障碍物，必须在其他的更新后在被调用，因为该容器没有被清理
   updateObstacleContainerWithCustomObstacles();
 
 
-  // 加锁，在接下来的优化过程中不允许配置被修改
-  boost::mutex::scoped_lock cfg_lock(cfg_.configMutex());
+  // 不需要对配置加锁: 新的配置只会在下一个周期开始时被套用 (applyPendingReconfiguration)
 
   // 准备工作做了这么久，现在开始真正的局部轨迹规划 ╮(╯▽╰)╭
 //   bool success = planner_->plan(robot_pose_, robot_goal_, robot_vel_, cfg_.goal_tolerance.free_goal_vel); // straight line init
@@ -477,31 +497,93 @@ bool TebLocalPlannerROS::isGoalReached()
 
 
 
-void TebLocalPlannerROS::updateObstacleContainerWithCostmap()
+void TebLocalPlannerROS::updateObstacleContainerWithCostmap(const std::vector<geometry_msgs::PoseStamped>& transformed_plan)
 {
   // 加进代价地图障碍物
   if (cfg_.obstacles.include_costmap_obstacles)
   {
     Eigen::Vector2d robot_orient = robot_pose_.orientationUnitVec();
 
-    for (unsigned int i=0; i<costmap_->getSizeInCellsX()-1; ++i)
+    // region of interest (in cells), the last row and column are excluded as before
+    int size_x = (int) costmap_->getSizeInCellsX();
+    int size_y = (int) costmap_->getSizeInCellsY();
+    int min_mx = 0, min_my = 0;
+    int max_mx = size_x - 2, max_my = size_y - 2;
+
+    // 只掃描目前軌跡與參考路徑的 bounding box (再加上 cutoff 距離)，更遠的障礙物在優化時本來就會被忽略
+    // (the legacy association attaches every obstacle to its closest pose, so it still requires the full map)
+    if (cfg_.obstacles.costmap_obstacles_roi && !cfg_.obstacles.legacy_obstacle_association)
     {
-      for (unsigned int j=0; j<costmap_->getSizeInCellsY()-1; ++j)
+      Eigen::Vector2d roi_min = robot_pose_.position();
+      Eigen::Vector2d roi_max = robot_pose_.position();
+      for (const geometry_msgs::PoseStamped& pose : transformed_plan)
       {
-        if (costmap_->getCost(i,j) == costmap_2d::LETHAL_OBSTACLE)
-        {
-          Eigen::Vector2d obs;
-          costmap_->mapToWorld(i,j,obs.coeffRef(0), obs.coeffRef(1));
+        Eigen::Vector2d position(pose.pose.position.x, pose.pose.position.y);
+        roi_min = roi_min.cwiseMin(position);
+        roi_max = roi_max.cwiseMax(position);
+      }
+      Eigen::Vector2d teb_min, teb_max;
+      if (planner_->getTrajectoryBoundingBox(teb_min, teb_max))
+      {
+        roi_min = roi_min.cwiseMin(teb_min);
+        roi_max = roi_max.cwiseMax(teb_max);
+      }
+
+      // the association cutoff is measured from the footprint, not from the robot center
+      double margin = cfg_.obstacles.obstacle_association_cutoff_factor * cfg_.obstacles.min_obstacle_dist
+                      + robot_model_->getCircumscribedRadius();
+      if (cfg_.hcp.enable_homotopy_class_planning)
+        margin += 0.5 * cfg_.hcp.roadmap_graph_area_width; // alternative candidates are explored around the start-goal line
+      roi_min.array() -= margin;
+      roi_max.array() += margin;
+
+      costmap_->worldToMapEnforceBounds(roi_min.x(), roi_min.y(), min_mx, min_my);
+      costmap_->worldToMapEnforceBounds(roi_max.x(), roi_max.y(), max_mx, max_my);
+      max_mx = std::min(max_mx, size_x - 2);
+      max_my = std::min(max_my, size_y - 2);
+    }
+
+    // 如果有設定聚類，先收集所有障礙物格子，最後再一起轉換
+    bool cluster = cfg_.obstacles.costmap_obstacles_cluster_resolution > 0;
+    costmap_obstacle_points_.clear();
+
+    // 直接用指標逐列存取 char map (row-major)，memchr 會快速跳過沒有障礙物的區段
+    const unsigned char* charmap = costmap_->getCharMap();
+    double resolution = costmap_->getResolution();
+    double origin_x = costmap_->getOriginX();
+    double origin_y = costmap_->getOriginY();
 
-          // 检查该障碍物是否需要被考虑，比如机器人后面太远的障碍物就不考虑了
-          Eigen::Vector2d obs_dir = obs-robot_pose_.position();
-          if ( obs_dir.dot(robot_orient) < 0 && obs_dir.norm() > cfg_.obstacles.costmap_obstacles_behind_robot_dist  )
-            continue;
+    for (int j = min_my; j <= max_my; ++j)
+    {
+      const unsigned char* row = charmap + (std::size_t) j * size_x;
+      const unsigned char* cell = row + min_mx;
+      const unsigned char* row_end = row + max_mx + 1;
+      while (cell < row_end && (cell = static_cast<const unsigned char*>(std::memchr(cell, costmap_2d::LETHAL_OBSTACLE, row_end - cell))) != NULL)
+      {
+        int i = (int) (cell - row);
+        ++cell;
+
+        Eigen::Vector2d obs(origin_x + (i + 0.5) * resolution, origin_y + (j + 0.5) * resolution); // same as mapToWorld()
 
+        // 检查该障碍物是否需要被考虑，比如机器人后面太远的障碍物就不考虑了
+        Eigen::Vector2d obs_dir = obs-robot_pose_.position();
+        if ( obs_dir.dot(robot_orient) < 0 && obs_dir.norm() > cfg_.obstacles.costmap_obstacles_behind_robot_dist  )
+          continue;
+
+        if (cluster)
+          costmap_obstacle_points_.push_back(obs);
+        else
           obstacles_.push_back(ObstaclePtr(new PointObstacle(obs)));
-        }
       }
     }
+
+    if (cluster && !costmap_obstacle_points_.empty())
+    {
+      std::size_t num_clusters = clusterPointObstacles(costmap_obstacle_points_, cfg_.obstacles.costmap_obstacles_cluster_resolution,
+                                                       cfg_.obstacles.costmap_obstacles_cluster_max_extent, obstacles_);
+      ROS_DEBUG_THROTTLE(5.0, "TebLocalPlannerROS: %zu occupied costmap cells clustered into %zu obstacles (reduction factor %.1f).",
+                         costmap_obstacle_points_.size(), num_clusters, (double) costmap_obstacle_points_.size() / (double) num_clusters);
+    }
   }
 }
 
@@ -553,18 +635,18 @@ void TebLocalPlannerROS::updateObstacleContainerWithCostmapConverter()
 
 void TebLocalPlannerROS::updateObstacleContainerWithCustomObstacles()
 {
-  // 加入通过消息获得的自定义障碍物
-  boost::mutex::scoped_lock l(custom_obst_mutex_);
+  // 加入通过消息获得的自定义障碍物 (取得目前的快照，不需要加锁)
+  costmap_converter::ObstacleArrayMsg::ConstPtr custom_obstacle_msg = boost::atomic_load(&custom_obstacle_msg_);
 
-  if (!custom_obstacle_msg_.obstacles.empty())
+  if (custom_obstacle_msg && !custom_obstacle_msg->obstacles.empty())
   {
     // 用global_frame_设置障碍物的坐标系，而不是随便一个坐标系
     Eigen::Affine3d obstacle_to_map_eig;
     try
     {
       geometry_msgs::TransformStamped obstacle_to_map =  tf_->lookupTransform(global_frame_, ros::Time(0),
-                                                                              custom_obstacle_msg_.header.frame_id, ros::Time(0),
-                                                                              custom_obstacle_msg_.header.frame_id, ros::Duration(cfg_.robot.transform_tolerance));
+                                                                              custom_obstacle_msg->header.frame_id, ros::Time(0),
+                                                                              custom_obstacle_msg->header.frame_id, ros::Duration(cfg_.robot.transform_tolerance));
       obstacle_to_map_eig = tf2::transformToEigen(obstacle_to_map);
     }
     catch (tf::TransformException ex)
@@ -573,34 +655,34 @@ void TebLocalPlannerROS::updateObstacleContainerWithCustomObstacles()
       obstacle_to_map_eig.setIdentity();
     }
 
-    for (size_t i=0; i<custom_obstacle_msg_.obstacles.size(); ++i)
+    for (size_t i=0; i<custom_obstacle_msg->obstacles.size(); ++i)
     {
-      if (custom_obstacle_msg_.obstacles.at(i).polygon.points.size() == 1 && custom_obstacle_msg_.obstacles.at(i).radius > 0 ) // circle
+      if (custom_obstacle_msg->obstacles.at(i).polygon.points.size() == 1 && custom_obstacle_msg->obstacles.at(i).radius > 0 ) // circle
       {
-        Eigen::Vector3d pos( custom_obstacle_msg_.obstacles.at(i).polygon.points.front().x,
-                             custom_obstacle_msg_.obstacles.at(i).polygon.points.front().y,
-                             custom_obstacle_msg_.obstacles.at(i).polygon.points.front().z );
-        obstacles_.push_back(ObstaclePtr(new CircularObstacle( (obstacle_to_map_eig * pos).head(2), custom_obstacle_msg_.obstacles.at(i).radius)));
+        Eigen::Vector3d pos( custom_obstacle_msg->obstacles.at(i).polygon.points.front().x,
+                             custom_obstacle_msg->obstacles.at(i).polygon.points.front().y,
+                             custom_obstacle_msg->obstacles.at(i).polygon.points.front().z );
+        obstacles_.push_back(ObstaclePtr(new CircularObstacle( (obstacle_to_map_eig * pos).head(2), custom_obstacle_msg->obstacles.at(i).radius)));
       }
-      else if (custom_obstacle_msg_.obstacles.at(i).polygon.points.size() == 1 ) // point
+      else if (custom_obstacle_msg->obstacles.at(i).polygon.points.size() == 1 ) // point
       {
-        Eigen::Vector3d pos( custom_obstacle_msg_.obstacles.at(i).polygon.points.front().x,
-                             custom_obstacle_msg_.obstacles.at(i).polygon.points.front().y,
-                             custom_obstacle_msg_.obstacles.at(i).polygon.points.front().z );
+        Eigen::Vector3d pos( custom_obstacle_msg->obstacles.at(i).polygon.points.front().x,
+                             custom_obstacle_msg->obstacles.at(i).polygon.points.front().y,
+                             custom_obstacle_msg->obstacles.at(i).polygon.points.front().z );
         obstacles_.push_back(ObstaclePtr(new PointObstacle( (obstacle_to_map_eig * pos).head(2) )));
       }
-      else if (custom_obstacle_msg_.obstacles.at(i).polygon.points.size() == 2 ) // line
+      else if (custom_obstacle_msg->obstacles.at(i).polygon.points.size() == 2 ) // line
       {
-        Eigen::Vector3d line_start( custom_obstacle_msg_.obstacles.at(i).polygon.points.front().x,
-                                    custom_obstacle_msg_.obstacles.at(i).polygon.points.front().y,
-                                    custom_obstacle_msg_.obstacles.at(i).polygon.points.front().z );
-        Eigen::Vector3d line_end( custom_obstacle_msg_.obstacles.at(i).polygon.points.back().x,
-                                  custom_obstacle_msg_.obstacles.at(i).polygon.points.back().y,
-                                  custom_obstacle_msg_.obstacles.at(i).polygon.points.back().z );
+        Eigen::Vector3d line_start( custom_obstacle_msg->obstacles.at(i).polygon.points.front().x,
+                                    custom_obstacle_msg->obstacles.at(i).polygon.points.front().y,
+                                    custom_obstacle_msg->obstacles.at(i).polygon.points.front().z );
+        Eigen::Vector3d line_end( custom_obstacle_msg->obstacles.at(i).polygon.points.back().x,
+                                  custom_obstacle_msg->obstacles.at(i).polygon.points.back().y,
+                                  custom_obstacle_msg->obstacles.at(i).polygon.points.back().z );
         obstacles_.push_back(ObstaclePtr(new LineObstacle( (obstacle_to_map_eig * line_start).head(2),
                                                            (obstacle_to_map_eig * line_end).head(2) )));
       }
-      else if (custom_obstacle_msg_.obstacles.at(i).polygon.points.empty())
+      else if (custom_obstacle_msg->obstacles.at(i).polygon.points.empty())
       {
         ROS_WARN("Invalid custom obstacle received. List of polygon vertices is empty. Skipping...");
         continue;
@@ -608,11 +690,11 @@ void TebLocalPlannerROS::updateObstacleContainerWithCustomObstacles()
       else // 多边形
       {
         PolygonObstacle* polyobst = new PolygonObstacle;
-        for (size_t j=0; j<custom_obstacle_msg_.obstacles.at(i).polygon.points.size(); ++j)
+        for (size_t j=0; j<custom_obstacle_msg->obstacles.at(i).polygon.points.size(); ++j)
         {
-          Eigen::Vector3d pos( custom_obstacle_msg_.obstacles.at(i).polygon.points[j].x,
-                               custom_obstacle_msg_.obstacles.at(i).polygon.points[j].y,
-                               custom_obstacle_msg_.obstacles.at(i).polygon.points[j].z );
+          Eigen::Vector3d pos( custom_obstacle_msg->obstacles.at(i).polygon.points[j].x,
+                               custom_obstacle_msg->obstacles.at(i).polygon.points[j].y,
+                               custom_obstacle_msg->obstacles.at(i).polygon.points[j].z );
           polyobst->pushBackVertex( (obstacle_to_map_eig * pos).head(2) );
         }
         polyobst->finalizePolygon();
@@ -621,27 +703,70 @@ void TebLocalPlannerROS::updateObstacleContainerWithCustomObstacles()
 
       // 如果障碍物在移动，设置速度
       if(!obstacles_.empty())
-        obstacles_.back()->setCentroidVelocity(custom_obstacle_msg_.obstacles[i].velocities, custom_obstacle_msg_.obstacles[i].orientation);
+        obstacles_.back()->setCentroidVelocity(custom_obstacle_msg->obstacles[i].velocities, custom_obstacle_msg->obstacles[i].orientation);
     }
   }
 }
 
 void TebLocalPlannerROS::updateViaPointsContainer(const std::vector<geometry_msgs::PoseStamped>& transformed_plan, double min_separation)
 {
-  via_points_.clear();
-
-  if (min_separation<=0)
+  if (min_separation<=0 || transformed_plan.empty())
+  {
+    via_points_.clear();
     return;
+  }
+
+  auto plan_point = [&transformed_plan](std::size_t i)
+  {
+    return Eigen::Vector2d( transformed_plan[i].pose.position.x, transformed_plan[i].pose.position.y );
+  };
+
+  // 保留上一個週期的 via-points: 用 two-pointer 同時走訪 plan 與既有的 via-points (O(plan + via-points))，
+  // 還落在 plan 上的 via-point 會保留下來 (座標更新成對應的 plan 點)，已經走過的則丟掉
+  const Eigen::Vector2d plan_start = plan_point(0);
+  const double match_dist_sq = 0.25 * min_separation * min_separation;
+  const double max_search_arc = 3.0 * min_separation;
+
+  std::size_t vp_idx = 0;
+  while (vp_idx < via_points_.size() && (via_points_[vp_idx] - plan_start).norm() < min_separation)
+    ++vp_idx; // via-point is already passed
 
   std::size_t prev_idx = 0;
-  for (std::size_t i=1; i < transformed_plan.size(); ++i) // skip first one, since we do not need any point before the first min_separation [m]
+  std::size_t num_kept = 0;
+  for (; vp_idx < via_points_.size(); ++vp_idx)
+  {
+    const Eigen::Vector2d via_point = via_points_[vp_idx];
+    std::size_t i = prev_idx + 1;
+    double arc = 0;
+    bool found = false;
+    for (; i < transformed_plan.size() && arc <= max_search_arc; ++i)
+    {
+      arc += (plan_point(i) - plan_point(i-1)).norm();
+      if ((plan_point(i) - via_point).squaredNorm() <= match_dist_sq)
+      {
+        // snap to the closest plan point
+        while (i+1 < transformed_plan.size() && (plan_point(i+1) - via_point).squaredNorm() < (plan_point(i) - via_point).squaredNorm())
+          ++i;
+        found = true;
+        break;
+      }
+    }
+    if (!found)
+      break; // the plan has changed from here on, so sample new via-points
+
+    via_points_[num_kept++] = plan_point(i);
+    prev_idx = i;
+  }
+  via_points_.resize(num_kept);
+
+  for (std::size_t i=prev_idx+1; i < transformed_plan.size(); ++i) // skip first one, since we do not need any point before the first min_separation [m]
   {
     // check separation to the previous via-point inserted
     if (distance_points2d( transformed_plan[prev_idx].pose.position, transformed_plan[i].pose.position ) < min_separation)
       continue;
 
     // add via-point
-    via_points_.push_back( Eigen::Vector2d( transformed_plan[i].pose.position.x, transformed_plan[i].pose.position.y ) );
+    via_points_.push_back( plan_point(i) );
     prev_idx = i;
   }
 
@@ -1014,8 +1139,8 @@ void TebLocalPlannerROS::configureBackupModes(std::vector<geometry_msgs::PoseSta
 
 void TebLocalPlannerROS::customObstacleCB(const costmap_converter::ObstacleArrayMsg::ConstPtr& obst_msg)
 {
-  boost::mutex::scoped_lock l(custom_obst_mutex_);
-  custom_obstacle_msg_ = *obst_msg;
+  // 訊息本身是不可變的，直接發佈指標 (不複製也不上鎖)
+  boost::atomic_store(&custom_obstacle_msg_, obst_msg);
 }
 
 void TebLocalPlannerROS::customViaPointsCB(const nav_msgs::Path::ConstPtr& via_points_msg)
@@ -1025,17 +1150,18 @@ void TebLocalPlannerROS::customViaPointsCB(const nav_msgs::Path::ConstPtr& via_p
   {
     ROS_WARN("Via-points are already obtained from the global plan (global_plan_viapoint_sep>0)."
              "Ignoring custom via-points.");
-    custom_via_points_active_ = false;
+    boost::atomic_store(&custom_via_points_, boost::shared_ptr<const ViaPointContainer>());
     return;
   }
 
-  boost::mutex::scoped_lock l(via_point_mutex_);
-  via_points_.clear();
+  // build a new container and publish it as a whole, the planner keeps reading the previous one in the meantime
+  boost::shared_ptr<ViaPointContainer> via_points = boost::make_shared<ViaPointContainer>();
+  via_points->reserve(via_points_msg->poses.size());
   for (const geometry_msgs::PoseStamped& pose : via_points_msg->poses)
   {
-    via_points_.emplace_back(pose.pose.position.x, pose.pose.position.y);
+    via_points->emplace_back(pose.pose.position.x, pose.pose.position.y);
   }
-  custom_via_points_active_ = !via_points_.empty();
+  boost::atomic_store(&custom_via_points_, boost::shared_ptr<const ViaPointContainer>(via_points));
 }
 
 RobotFootprintModelPtr TebLocalPlannerROS::getRobotFootprintFromParamServer(const ros::NodeHandle& nh, const TebConfig& config)
@@ -38,6 +38,7 @@
 
 #include <teb_local_planner/timed_elastic_band.h>
 
+#include <algorithm>
 #include <limits>
 
 namespace teb_local_planner
@@ -557,6 +558,48 @@ int TimedElasticBand::findClosestTrajectoryPose(const Obstacle& obstacle, double
   return findClosestTrajectoryPose(obstacle.getCentroid(), distance);
 }
 
+
+void TimedElasticBand::findClosestTrajectoryPoses(const Point2dContainer& ref_points, std::vector<int>& indices, int min_idx_gap) const
+{
+  indices.clear();
+  int n = sizePoses();
+  if (n == 0 || ref_points.empty())
+    return;
+  indices.resize(ref_points.size());
+
+  // 兩條曲線的總弧長，用來把 via-point 的弧長換算到 trajectory 上
+  double teb_length = getAccumulatedDistance();
+  double ref_length = (ref_points.front() - Pose(0).position()).norm();
+  for (std::size_t j = 1; j < ref_points.size(); ++j)
+    ref_length += (ref_points[j] - ref_points[j-1]).norm();
+  double scale = ref_length > 1e-6 ? teb_length / ref_length : 0.0;
+
+  std::vector<double> s_teb(n); // arc length of the trajectory up to each pose
+  s_teb[0] = 0.0;
+  for (int i = 1; i < n; ++i)
+    s_teb[i] = s_teb[i-1] + (Pose(i).position() - Pose(i-1).position()).norm();
+
+  double s_ref = 0.0; // arc length of the reference sequence up to point j
+  for (std::size_t j = 0; j < ref_points.size(); ++j)
+  {
+    s_ref += (ref_points[j] - (j == 0 ? Pose(0).position() : ref_points[j-1])).norm();
+    double s_target = s_ref * scale;
+
+    int lower_idx = j == 0 ? 0 : std::min(indices[j-1] + min_idx_gap, n-1);
+
+    // the arc-length prior is only the start of a local search in both directions,
+    // since both curves may differ in shape (e.g. detours around obstacles or a pruned trajectory start)
+    int i = std::lower_bound(s_teb.begin() + lower_idx, s_teb.end(), s_target) - s_teb.begin();
+    i = std::min(i, n-1);
+    double dist_sq = (ref_points[j] - Pose(i).position()).squaredNorm();
+    while (i > lower_idx && (ref_points[j] - Pose(i-1).position()).squaredNorm() < dist_sq)
+      dist_sq = (ref_points[j] - Pose(--i).position()).squaredNorm();
+    while (i < n-1 && (ref_points[j] - Pose(i+1).position()).squaredNorm() < dist_sq)
+      dist_sq = (ref_points[j] - Pose(++i).position()).squaredNorm();
+    indices[j] = i;
+  }
+}
+
 /**
  * @brief  根据参考分辨率，通过添加或减少(pose,dt)改变轨迹尺寸.
  *
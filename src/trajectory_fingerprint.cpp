@@ -0,0 +1,107 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Christoph Rösmann
+ *********************************************************************/
+
+
+
+#include <teb_local_planner/trajectory_fingerprint.h>
+#include <teb_local_planner/timed_elastic_band.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace teb_local_planner
+{
+
+void TrajectoryFingerprint::compute(const TimedElasticBand& teb)
+{
+  compute(teb.poses().begin(), teb.poses().end(), [](const VertexPose* pose) -> const Eigen::Vector2d& {return pose->position();});
+}
+
+double TrajectoryFingerprint::distanceL2(const TrajectoryFingerprint& other) const
+{
+  if (!valid_ || !other.valid_)
+    return std::numeric_limits<double>::infinity();
+
+  double sum = 0;
+  for (int k = 0; k < NumSamples; ++k)
+  {
+    const double dx = x_[k] - other.x_[k];
+    const double dy = y_[k] - other.y_[k];
+    sum += dx*dx + dy*dy;
+  }
+  return std::sqrt(sum / NumSamples);
+}
+
+double TrajectoryFingerprint::distanceFrechet(const TrajectoryFingerprint& other) const
+{
+  if (!valid_ || !other.valid_)
+    return std::numeric_limits<double>::infinity();
+
+  // dynamic programming over the coupling table (squared distances), only the previous row is kept
+  double prev_row[NumSamples];
+  double row[NumSamples];
+  double dist[NumSamples];
+  for (int i = 0; i < NumSamples; ++i)
+  {
+    // distances of sample i to all samples of the other fingerprint (independent of each other)
+    for (int j = 0; j < NumSamples; ++j)
+    {
+      const double dx = x_[i] - other.x_[j];
+      const double dy = y_[i] - other.y_[j];
+      dist[j] = dx*dx + dy*dy;
+    }
+
+    if (i == 0)
+    {
+      row[0] = dist[0];
+      for (int j = 1; j < NumSamples; ++j)
+        row[j] = std::max(dist[j], row[j-1]);
+    }
+    else
+    {
+      row[0] = std::max(dist[0], prev_row[0]);
+      for (int j = 1; j < NumSamples; ++j)
+        row[j] = std::max(dist[j], std::min(std::min(prev_row[j], prev_row[j-1]), row[j-1]));
+    }
+    std::copy(row, row + NumSamples, prev_row);
+  }
+  return std::sqrt(row[NumSamples-1]);
+}
+
+} // namespace teb_local_planner
@@ -428,6 +428,7 @@ void TebVisualization::publishFeedbackMessage(const std::vector< boost::shared_p
   
   
   msg.trajectories.resize(teb_planners.size());
+  msg.costs.resize(teb_planners.size());
   
   // Iterate through teb pose sequence
   std::size_t idx_traj = 0;
@@ -435,6 +436,7 @@ void TebVisualization::publishFeedbackMessage(const std::vector< boost::shared_p
   {   
     msg.trajectories[idx_traj].header = msg.header;
     it_teb->get()->getFullTrajectory(msg.trajectories[idx_traj].trajectory);
+    toCostMsg(it_teb->get()->getCurrentCostBreakdown(), msg.costs[idx_traj]);
   }
   
   // add obstacles
@@ -460,7 +462,7 @@ void TebVisualization::publishFeedbackMessage(const std::vector< boost::shared_p
   feedback_pub_.publish(msg);
 }
 
-void TebVisualization::publishFeedbackMessage(const TebOptimalPlanner& teb_planner, const ObstContainer& obstacles)
+void TebVisualization::publishFeedbackMessage(const TebOptimalPlanner& teb_planner, const ObstContainer& obstacles, const TebCostBreakdown* cost_breakdown)
 {
   FeedbackMsg msg;
   msg.header.stamp = ros::Time::now();
@@ -470,6 +472,9 @@ void TebVisualization::publishFeedbackMessage(const TebOptimalPlanner& teb_plann
   msg.trajectories.resize(1);
   msg.trajectories.front().header = msg.header;
   teb_planner.getFullTrajectory(msg.trajectories.front().trajectory);
+
+  msg.costs.resize(1);
+  toCostMsg(cost_breakdown ? *cost_breakdown : teb_planner.getCurrentCostBreakdown(), msg.costs.front());
  
   // add obstacles
   msg.obstacles_msg.obstacles.resize(obstacles.size());
@@ -494,6 +499,21 @@ void TebVisualization::publishFeedbackMessage(const TebOptimalPlanner& teb_plann
   feedback_pub_.publish(msg);
 }
 
+void TebVisualization::toCostMsg(const TebCostBreakdown& breakdown, TrajectoryCostMsg& cost_msg)
+{
+  cost_msg.total = breakdown.total;
+  cost_msg.obstacle = breakdown[CostTerm::Obstacle];
+  cost_msg.dynamic_obstacle = breakdown[CostTerm::DynamicObstacle];
+  cost_msg.via_point = breakdown[CostTerm::ViaPoint];
+  cost_msg.velocity = breakdown[CostTerm::Velocity];
+  cost_msg.acceleration = breakdown[CostTerm::Acceleration];
+  cost_msg.time_optimal = breakdown[CostTerm::TimeOptimal];
+  cost_msg.shortest_path = breakdown[CostTerm::ShortestPath];
+  cost_msg.kinematics = breakdown[CostTerm::Kinematics];
+  cost_msg.prefer_rotdir = breakdown[CostTerm::PreferRotDir];
+  cost_msg.velocity_obstacle_ratio = breakdown[CostTerm::VelocityObstacleRatio];
+}
+
 std_msgs::ColorRGBA TebVisualization::toColorMsg(double a, double r, double g, double b)
 {
   std_msgs::ColorRGBA color;
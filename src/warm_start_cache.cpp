@@ -0,0 +1,246 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Christoph Rösmann
+ *********************************************************************/
+
+
+#include <teb_local_planner/warm_start_cache.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace teb_local_planner
+{
+
+namespace
+{
+
+//! Check if \c point is closer than \c dist to the path segment [begin, end] of \c poses
+template <typename PoseContainer>
+inline bool isNearPath(const PoseContainer& poses, int begin, int end, const Eigen::Vector2d& point, double dist)
+{
+  if (begin == end)
+    return (poses[begin].position() - point).norm() < dist;
+  for (int i = begin; i < end; ++i)
+  {
+    if (distance_point_to_segment_2d(point, poses[i].position(), poses[i+1].position()) < dist)
+      return true;
+  }
+  return false;
+}
+
+//! Check if \c layout contains a point closer than \c dist to \c point
+inline bool hasCounterpart(const Point2dContainer& layout, const Eigen::Vector2d& point, double dist)
+{
+  for (std::size_t i = 0; i < layout.size(); ++i)
+  {
+    if ((layout[i] - point).squaredNorm() < dist*dist)
+      return true;
+  }
+  return false;
+}
+
+} // anonymous namespace
+
+
+void WarmStartCache::remember(const TimedElasticBand& teb)
+{
+  has_pending_ = teb.sizePoses() >= 2 && teb.sizeTimeDiffs() == teb.sizePoses()-1;
+  if (!has_pending_)
+    return;
+
+  // 重複使用 pending_ 的記憶體，每個週期只做一次複製
+  pending_.poses.resize(teb.sizePoses());
+  for (int i = 0; i < teb.sizePoses(); ++i)
+    pending_.poses[i] = teb.Pose(i);
+  pending_.timediffs.resize(teb.sizeTimeDiffs());
+  for (int i = 0; i < teb.sizeTimeDiffs(); ++i)
+    pending_.timediffs[i] = teb.TimeDiff(i);
+}
+
+
+void WarmStartCache::commit(const ObstContainer* obstacles, double layout_corridor, double layout_tolerance, std::size_t capacity)
+{
+  if (!has_pending_ || capacity == 0)
+    return;
+  has_pending_ = false;
+  computeObstacleLayout(obstacles, layout_tolerance, pending_.layout);
+
+  // replace an existing entry with (almost) the same goal in the same layout
+  for (std::list<Entry>::iterator it = entries_.begin(); it != entries_.end(); ++it)
+  {
+    if ((it->poses.back().position() - pending_.poses.back().position()).norm() < 0.1
+        && matchesLayout(*it, 0, (int)it->poses.size()-1, pending_.layout, layout_corridor, layout_tolerance))
+    {
+      entries_.erase(it);
+      break;
+    }
+  }
+
+  entries_.push_front(Entry());
+  std::swap(entries_.front(), pending_);
+
+  while (entries_.size() > capacity)
+    entries_.pop_back();
+}
+
+
+bool WarmStartCache::seed(const PoseSE2& start, const PoseSE2& goal, const ObstContainer* obstacles, double layout_corridor, double layout_tolerance,
+                          double max_goal_dist, double max_goal_angular, int min_samples, TimedElasticBand& teb)
+{
+  std::list<Entry>::iterator best = entries_.end();
+  int best_start_idx = 0;
+  int best_goal_idx = 0;
+  double best_goal_dist = std::numeric_limits<double>::max();
+
+  Point2dContainer layout;
+  bool layout_computed = false;
+
+  for (std::list<Entry>::iterator it = entries_.begin(); it != entries_.end(); ++it)
+  {
+    int n = (int)it->poses.size();
+
+    // the cached path must pass the new start ...
+    int start_idx = 0;
+    double min_dist_sq = std::numeric_limits<double>::max();
+    for (int i = 0; i < n; ++i)
+    {
+      double dist_sq = (it->poses[i].position() - start.position()).squaredNorm();
+      if (dist_sq < min_dist_sq)
+      {
+        min_dist_sq = dist_sq;
+        start_idx = i;
+      }
+    }
+    if (min_dist_sq >= max_goal_dist*max_goal_dist)
+      continue;
+
+    // ... and the new goal afterwards (not necessarily at its end)
+    int goal_idx = n-1;
+    min_dist_sq = std::numeric_limits<double>::max();
+    for (int i = start_idx+1; i < n; ++i)
+    {
+      double dist_sq = (it->poses[i].position() - goal.position()).squaredNorm();
+      if (dist_sq < min_dist_sq)
+      {
+        min_dist_sq = dist_sq;
+        goal_idx = i;
+      }
+    }
+    double goal_dist = std::sqrt(min_dist_sq);
+    if (goal_dist >= max_goal_dist || goal_dist >= best_goal_dist || goal_idx - start_idx + 1 < std::max(min_samples, 2)
+        || std::abs(g2o::normalize_theta(it->poses[goal_idx].theta() - goal.theta())) >= max_goal_angular)
+      continue;
+
+    // the static obstacles along the reused segment must not have changed
+    if (!layout_computed)
+    {
+      computeObstacleLayout(obstacles, layout_tolerance, layout);
+      layout_computed = true;
+    }
+    if (!matchesLayout(*it, start_idx, goal_idx, layout, layout_corridor, layout_tolerance))
+      continue;
+
+    best = it;
+    best_start_idx = start_idx;
+    best_goal_idx = goal_idx;
+    best_goal_dist = goal_dist;
+  }
+
+  if (best == entries_.end())
+    return false;
+
+  // the selected entry becomes the most recently used one
+  entries_.splice(entries_.begin(), entries_, best);
+  const Entry& entry = entries_.front();
+
+  teb.clearTimedElasticBand();
+  teb.addPose(start);
+  teb.setPoseVertexFixed(0,true);
+  for (int i = best_start_idx+1; i < best_goal_idx; ++i)
+    teb.addPoseAndTimeDiff(entry.poses[i], entry.timediffs[i-1]);
+  teb.addPoseAndTimeDiff(goal, entry.timediffs[best_goal_idx-1]);
+  teb.setPoseVertexFixed(teb.sizePoses()-1,true);
+  return true;
+}
+
+
+void WarmStartCache::computeObstacleLayout(const ObstContainer* obstacles, double tolerance, Point2dContainer& layout)
+{
+  layout.clear();
+  if (!obstacles || tolerance <= 0)
+    return;
+
+  std::vector< std::pair< std::pair<long, long>, int > > cells;
+  cells.reserve(obstacles->size());
+  for (int i = 0; i < (int)obstacles->size(); ++i)
+  {
+    if ((*obstacles)[i]->isDynamic())
+      continue;
+    const Eigen::Vector2d& centroid = (*obstacles)[i]->getCentroid();
+    cells.push_back(std::make_pair(std::make_pair((long)std::floor(centroid.x() / tolerance), (long)std::floor(centroid.y() / tolerance)), i));
+  }
+
+  // keep one centroid per cell in order to bound the size of dense point obstacle sets
+  std::sort(cells.begin(), cells.end());
+  for (std::size_t i = 0; i < cells.size(); ++i)
+  {
+    if (i == 0 || cells[i].first != cells[i-1].first)
+      layout.push_back((*obstacles)[cells[i].second]->getCentroid());
+  }
+}
+
+
+bool WarmStartCache::matchesLayout(const Entry& entry, int begin, int end, const Point2dContainer& layout, double corridor, double tolerance)
+{
+  // both layouts are thinned out independently, hence the representatives of a cell might differ by the cell diagonal
+  double match_dist = std::sqrt(2.) * tolerance;
+  for (std::size_t i = 0; i < layout.size(); ++i)
+  {
+    if (isNearPath(entry.poses, begin, end, layout[i], corridor) && !hasCounterpart(entry.layout, layout[i], match_dist))
+      return false;
+  }
+  for (std::size_t i = 0; i < entry.layout.size(); ++i)
+  {
+    if (isNearPath(entry.poses, begin, end, entry.layout[i], corridor) && !hasCounterpart(layout, entry.layout[i], match_dist))
+      return false;
+  }
+  return true;
+}
+
+} // namespace teb_local_planner
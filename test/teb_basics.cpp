@@ -1,6 +1,13 @@
 #include <gtest/gtest.h>
 
 #include <teb_local_planner/timed_elastic_band.h>
+#include <teb_local_planner/teb_cost_evaluator.h>
+#include <teb_local_planner/obstacle_association_cache.h>
+#include <teb_local_planner/obstacle_spatial_index.h>
+#include <teb_local_planner/obstacle_clustering.h>
+#include <teb_local_planner/warm_start_cache.h>
+
+#include <random>
 
 TEST(TEBBasic, autoResizeLargeValueAtEnd)
 {
@@ -66,6 +73,414 @@ TEST(TEBBasic, autoResize)
   }
 }
 
+TEST(TEBBasic, findClosestTrajectoryPoses)
+{
+  double dt = 0.1;
+  teb_local_planner::TimedElasticBand teb;
+
+  teb.addPose(teb_local_planner::PoseSE2(0., 0., 0.));
+  for (int i = 1; i < 10; ++i) {
+    teb.addPoseAndTimeDiff(teb_local_planner::PoseSE2(i * 1., 0., 0.), dt);
+  }
+
+  // ordered reference points slightly offset from the trajectory
+  teb_local_planner::Point2dContainer ref_points;
+  for (int i = 1; i < 10; i += 2) {
+    ref_points.push_back(Eigen::Vector2d(i * 1. + 0.1, 0.3));
+  }
+
+  // the monotonic sweep must agree with the exhaustive search
+  std::vector<int> indices;
+  teb.findClosestTrajectoryPoses(ref_points, indices);
+  ASSERT_EQ(indices.size(), ref_points.size());
+  for (std::size_t j = 0; j < ref_points.size(); ++j) {
+    ASSERT_EQ(indices[j], teb.findClosestTrajectoryPose(ref_points[j])) << "wrong association: " << j;
+  }
+
+  // enforce a minimum index gap between subsequent points
+  teb.findClosestTrajectoryPoses(ref_points, indices, 3);
+  for (std::size_t j = 1; j < indices.size(); ++j) {
+    ASSERT_LE(std::min(indices[j-1] + 3, teb.sizePoses()-1), indices[j]) << "index gap violated: " << j;
+  }
+
+  // trajectory with a detour, so that the arc-length prior overshoots the closest poses
+  teb.clearTimedElasticBand();
+  teb.addPose(teb_local_planner::PoseSE2(0., 0., 0.));
+  const double detour[][2] = {{1, 0}, {2, 0}, {2, 1}, {2, 2}, {2, 3}, {2, 4}, {3, 4}, {4, 4},
+                              {4, 3}, {4, 2}, {4, 1}, {4, 0}, {5, 0}, {6, 0}};
+  for (const auto& position : detour) {
+    teb.addPoseAndTimeDiff(teb_local_planner::PoseSE2(position[0], position[1], 0.), dt);
+  }
+  ref_points.clear();
+  ref_points.push_back(Eigen::Vector2d(1., 0.1));
+  ref_points.push_back(Eigen::Vector2d(5., 0.1));
+  ref_points.push_back(Eigen::Vector2d(6., 0.1));
+  teb.findClosestTrajectoryPoses(ref_points, indices, 2);
+  ASSERT_EQ(indices.size(), ref_points.size());
+  for (std::size_t j = 0; j < ref_points.size(); ++j) {
+    ASSERT_EQ(indices[j], teb.findClosestTrajectoryPose(ref_points[j])) << "wrong association with detour: " << j;
+  }
+}
+
+TEST(TEBBasic, costEvaluator)
+{
+  double dt = 0.5;
+  teb_local_planner::TebConfig cfg;
+  teb_local_planner::PointRobotFootprint robot_model;
+  teb_local_planner::TimedElasticBand teb;
+
+  // straight line with a feasible velocity
+  teb.addPose(teb_local_planner::PoseSE2(0., 0., 0.));
+  for (int i = 1; i < 10; ++i) {
+    teb.addPoseAndTimeDiff(teb_local_planner::PoseSE2(i * 0.1, 0., 0.), dt);
+  }
+
+  teb_local_planner::ObstContainer obstacles;
+  obstacles.push_back(teb_local_planner::ObstaclePtr(new teb_local_planner::PointObstacle(0.5, 0.1)));
+
+  teb_local_planner::TebCostEvaluator evaluator(cfg, &robot_model);
+  evaluator.setObstacles(&obstacles);
+
+  teb_local_planner::TebCostBreakdown breakdown;
+  double cost = evaluator.evaluate(teb, breakdown);
+  ASSERT_DOUBLE_EQ(cost, breakdown.total);
+  ASSERT_NEAR(breakdown[teb_local_planner::CostTerm::TimeOptimal], cfg.optim.weight_optimaltime * 9 * dt * dt, 1e-9);
+  ASSERT_NEAR(breakdown[teb_local_planner::CostTerm::Velocity], 0., 1e-9);
+  ASSERT_GT(breakdown[teb_local_planner::CostTerm::Obstacle], 0.);
+
+  double sum = 0;
+  for (int i = 0; i < teb_local_planner::NUM_COST_TERMS; ++i)
+    sum += breakdown.terms[i];
+  ASSERT_NEAR(sum, breakdown.total, 1e-9);
+
+  // extra obstacle scaling and alternative time cost
+  teb_local_planner::TebCostBreakdown scaled;
+  evaluator.evaluate(teb, scaled, 2.0, 1.0, true);
+  ASSERT_NEAR(scaled[teb_local_planner::CostTerm::Obstacle], 2.0 * breakdown[teb_local_planner::CostTerm::Obstacle], 1e-9);
+  ASSERT_NEAR(scaled[teb_local_planner::CostTerm::TimeOptimal], teb.getSumOfAllTimeDiffs(), 1e-9);
+}
+
+TEST(TEBBasic, obstacleAssociationCache)
+{
+  teb_local_planner::TebConfig cfg;
+  teb_local_planner::PolygonRobotFootprint robot_model({Eigen::Vector2d(0.3, 0.2), Eigen::Vector2d(-0.3, 0.2),
+                                                        Eigen::Vector2d(-0.3, -0.2), Eigen::Vector2d(0.3, -0.2)});
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<double> coord(-1., 6.);
+  std::normal_distribution<double> noise(0., 0.01);
+
+  teb_local_planner::ObstContainer obstacles;
+  for (int i = 0; i < 50; ++i)
+    obstacles.push_back(teb_local_planner::ObstaclePtr(new teb_local_planner::PointObstacle(coord(rng), coord(rng))));
+
+  std::vector<teb_local_planner::PoseSE2> poses;
+  for (int i = 0; i < 30; ++i)
+    poses.push_back(teb_local_planner::PoseSE2(i * 0.2, 0.5 * std::sin(0.3 * i), 0.1 * i));
+
+  teb_local_planner::ObstacleAssociationCache cache;
+  for (int pass = 0; pass < 10; ++pass)
+  {
+    cache.beginPass(obstacles);
+    double arc_length = 0;
+    for (std::size_t i = 0; i < poses.size(); ++i)
+    {
+      if (i > 0)
+        arc_length += (poses[i].position() - poses[i-1].position()).norm();
+
+      // reused associations must be identical to a full association
+      teb_local_planner::ObstContainer cached, full;
+      cache.associate(cfg, robot_model, poses[i], arc_length, cached);
+      teb_local_planner::TebCostEvaluator::associateObstacles(cfg, robot_model, poses[i], obstacles, full);
+      ASSERT_EQ(cached.size(), full.size()) << "pass " << pass << ", pose " << i;
+      for (std::size_t j = 0; j < full.size(); ++j)
+        ASSERT_EQ(cached[j], full[j]) << "pass " << pass << ", pose " << i;
+
+      // small motion as between two outer iterations
+      poses[i] = teb_local_planner::PoseSE2(poses[i].x() + noise(rng), poses[i].y() + noise(rng), poses[i].theta() + noise(rng));
+    }
+    cache.endPass();
+  }
+  ASSERT_GT(cache.hits(), 0u);
+  ASSERT_EQ(cache.hits() + cache.misses(), 10 * poses.size());
+
+  // a modified obstacle set invalidates the cache
+  unsigned int misses = cache.misses();
+  obstacles.pop_back();
+  cache.beginPass(obstacles);
+  teb_local_planner::ObstContainer relevant;
+  cache.associate(cfg, robot_model, poses.front(), 0., relevant);
+  ASSERT_EQ(cache.misses(), misses + 1);
+}
+
+namespace
+{
+  // user footprint model that only implements the pure virtual methods
+  class UnknownExtentRobotFootprint : public teb_local_planner::BaseRobotFootprintModel
+  {
+  public:
+    virtual double calculateDistance(const teb_local_planner::PoseSE2& current_pose, const teb_local_planner::Obstacle* obstacle) const
+    {
+      return obstacle->getMinimumDistance(current_pose.position());
+    }
+    virtual double estimateSpatioTemporalDistance(const teb_local_planner::PoseSE2& current_pose, const teb_local_planner::Obstacle* obstacle, double t) const
+    {
+      return obstacle->getMinimumSpatioTemporalDistance(current_pose.position(), t);
+    }
+    virtual double getInscribedRadius() {return 0.0;}
+  };
+}
+
+TEST(TEBBasic, obstacleBoundingCircles)
+{
+  teb_local_planner::Point2dContainer footprint = {Eigen::Vector2d(0.4, 0.2), Eigen::Vector2d(-0.2, 0.3),
+                                                   Eigen::Vector2d(-0.3, -0.2), Eigen::Vector2d(0.3, -0.3)};
+  std::vector<teb_local_planner::RobotFootprintModelPtr> robot_models;
+  robot_models.push_back(teb_local_planner::RobotFootprintModelPtr(new teb_local_planner::PointRobotFootprint()));
+  robot_models.push_back(teb_local_planner::RobotFootprintModelPtr(new teb_local_planner::CircularRobotFootprint(0.3)));
+  robot_models.push_back(teb_local_planner::RobotFootprintModelPtr(new teb_local_planner::TwoCirclesRobotFootprint(0.3, 0.2, 0.2, 0.25)));
+  robot_models.push_back(teb_local_planner::RobotFootprintModelPtr(new teb_local_planner::LineRobotFootprint(Eigen::Vector2d(0.4, 0.), Eigen::Vector2d(-0.2, 0.), 0.)));
+  robot_models.push_back(teb_local_planner::RobotFootprintModelPtr(new teb_local_planner::PolygonRobotFootprint(footprint)));
+
+  teb_local_planner::ObstContainer obstacles;
+  obstacles.push_back(teb_local_planner::ObstaclePtr(new teb_local_planner::PointObstacle(1., 0.5)));
+  obstacles.push_back(teb_local_planner::ObstaclePtr(new teb_local_planner::CircularObstacle(-1., 0.5, 0.4)));
+  obstacles.push_back(teb_local_planner::ObstaclePtr(new teb_local_planner::LineObstacle(0.5, -1., 1.5, -0.5)));
+  obstacles.push_back(teb_local_planner::ObstaclePtr(new teb_local_planner::PillObstacle(-0.5, -1., -1.5, -0.5, 0.2)));
+  obstacles.push_back(teb_local_planner::ObstaclePtr(new teb_local_planner::PolygonObstacle(
+    {Eigen::Vector2d(0., 1.), Eigen::Vector2d(0.6, 1.2), Eigen::Vector2d(0.3, 1.8), Eigen::Vector2d(-0.4, 1.5)})));
+
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<double> coord(-3., 3.);
+  std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+  std::uniform_real_distribution<double> threshold(0., 2.);
+
+  int culled = 0;
+  for (int i = 0; i < 2000; ++i)
+  {
+    teb_local_planner::PoseSE2 pose(coord(rng), coord(rng), angle(rng));
+    const double dist = threshold(rng);
+    for (const teb_local_planner::RobotFootprintModelPtr& robot_model : robot_models)
+    {
+      for (const teb_local_planner::ObstaclePtr& obstacle : obstacles)
+      {
+        // the culling must be conservative
+        if (robot_model->isBeyondDistance(pose, obstacle.get(), dist))
+        {
+          ASSERT_GT(robot_model->calculateDistance(pose, obstacle.get()), dist);
+          ++culled;
+        }
+      }
+    }
+  }
+  ASSERT_GT(culled, 0);
+
+  // footprint models that do not provide a circumscribed radius are never culled
+  teb_local_planner::CircularObstacle far_obstacle(100., 100., 0.1);
+  ASSERT_FALSE(UnknownExtentRobotFootprint().isBeyondDistance(teb_local_planner::PoseSE2(0., 0., 0.), &far_obstacle, 0.5));
+}
+
+namespace
+{
+  // obstacle type that does not provide a bounding circle
+  class UnboundedObstacle : public teb_local_planner::CircularObstacle
+  {
+  public:
+    UnboundedObstacle(double x, double y, double radius) : teb_local_planner::CircularObstacle(x, y, radius) {}
+    virtual double getBoundingRadius() const {return std::numeric_limits<double>::infinity();}
+  };
+
+  teb_local_planner::ObstContainer randomObstacles(int number, double extent, std::mt19937& rng)
+  {
+    std::uniform_real_distribution<double> coord(0., extent);
+    std::uniform_real_distribution<double> size(0.05, 0.5);
+    std::uniform_int_distribution<int> type(0, 4);
+    teb_local_planner::ObstContainer obstacles;
+    for (int i = 0; i < number; ++i)
+    {
+      const Eigen::Vector2d pos(coord(rng), coord(rng));
+      const Eigen::Vector2d offset(size(rng), size(rng));
+      switch (type(rng))
+      {
+        case 0:
+          obstacles.push_back(teb_local_planner::ObstaclePtr(new teb_local_planner::PointObstacle(pos)));
+          break;
+        case 1:
+          obstacles.push_back(teb_local_planner::ObstaclePtr(new teb_local_planner::CircularObstacle(pos, size(rng))));
+          break;
+        case 2:
+          obstacles.push_back(teb_local_planner::ObstaclePtr(new teb_local_planner::LineObstacle(pos, pos + offset)));
+          break;
+        case 3:
+          obstacles.push_back(teb_local_planner::ObstaclePtr(new teb_local_planner::PillObstacle(pos, pos + offset, 0.5 * size(rng))));
+          break;
+        default:
+          obstacles.push_back(teb_local_planner::ObstaclePtr(new teb_local_planner::PolygonObstacle(
+            {pos, pos + Eigen::Vector2d(offset.x(), 0.), pos + offset, pos + Eigen::Vector2d(0., offset.y())})));
+      }
+    }
+    return obstacles;
+  }
+}
+
+TEST(TEBBasic, obstacleSpatialIndex)
+{
+  std::mt19937 rng(42);
+  teb_local_planner::ObstContainer obstacles = randomObstacles(300, 20., rng);
+  // large and unbounded obstacles
+  obstacles.push_back(teb_local_planner::ObstaclePtr(new teb_local_planner::LineObstacle(-5., 3., 25., 4.)));
+  obstacles.push_back(teb_local_planner::ObstaclePtr(new UnboundedObstacle(3., 3., 0.5)));
+
+  teb_local_planner::ObstacleSpatialIndex index;
+  ASSERT_FALSE(index.covers(obstacles));
+  index.build(obstacles);
+  ASSERT_TRUE(index.covers(obstacles));
+
+  std::uniform_real_distribution<double> coord(-2., 22.);
+  std::uniform_real_distribution<double> dist(0., 1.5);
+  std::vector<int> candidates;
+  for (int i = 0; i < 2000; ++i)
+  {
+    const Eigen::Vector2d start(coord(rng), coord(rng));
+    const Eigen::Vector2d end = i % 10 == 0 ? Eigen::Vector2d(start.x(), coord(rng)) : Eigen::Vector2d(coord(rng), coord(rng));
+    const double min_dist = dist(rng);
+
+    // all colliding obstacles are candidates and the candidates are sorted
+    index.querySegment(start, end, min_dist, candidates);
+    ASSERT_TRUE(std::is_sorted(candidates.begin(), candidates.end()));
+    ASSERT_TRUE(std::binary_search(candidates.begin(), candidates.end(), (int)obstacles.size() - 1));
+    bool collision = false;
+    for (std::size_t k = 0; k < obstacles.size(); ++k)
+    {
+      if (obstacles[k]->checkLineIntersection(start, end, min_dist))
+      {
+        ASSERT_TRUE(std::binary_search(candidates.begin(), candidates.end(), (int)k)) << "segment query " << i << ", obstacle " << k;
+        collision = true;
+      }
+    }
+    ASSERT_EQ(index.anyAlongSegment(start, end, min_dist, [&](int k) {return obstacles[k]->checkLineIntersection(start, end, min_dist);}),
+              collision) << "segment query " << i;
+
+    index.queryCircle(start, min_dist, candidates);
+    ASSERT_TRUE(std::is_sorted(candidates.begin(), candidates.end()));
+    for (std::size_t k = 0; k + 1 < obstacles.size(); ++k)
+    {
+      if (obstacles[k]->getMinimumDistance(start) <= min_dist)
+        ASSERT_TRUE(std::binary_search(candidates.begin(), candidates.end(), (int)k)) << "circle query " << i << ", obstacle " << k;
+    }
+  }
+
+  // the association using the index is identical to the full association
+  teb_local_planner::TebConfig cfg;
+  teb_local_planner::CircularRobotFootprint robot_model(0.3);
+  for (int i = 0; i < 200; ++i)
+  {
+    teb_local_planner::PoseSE2 pose(coord(rng), coord(rng), 0.);
+    teb_local_planner::ObstContainer indexed, full;
+    teb_local_planner::TebCostEvaluator::associateObstacles(cfg, robot_model, pose, obstacles, indexed, NULL, &index);
+    teb_local_planner::TebCostEvaluator::associateObstacles(cfg, robot_model, pose, obstacles, full);
+    ASSERT_EQ(indexed.size(), full.size());
+    for (std::size_t j = 0; j < full.size(); ++j)
+      ASSERT_EQ(indexed[j], full[j]);
+  }
+
+  // a modified container is not covered anymore
+  obstacles.pop_back();
+  ASSERT_FALSE(index.covers(obstacles));
+}
+
+TEST(TEBBasic, warmStartCache)
+{
+  teb_local_planner::TimedElasticBand teb;
+  teb.addPose(teb_local_planner::PoseSE2(0., 0., 0.));
+  for (int i = 1; i <= 25; ++i)
+    teb.addPoseAndTimeDiff(teb_local_planner::PoseSE2(i * 0.2, 0., 0.), 0.1);
+
+  teb_local_planner::ObstContainer obstacles;
+  obstacles.push_back(teb_local_planner::ObstaclePtr(new teb_local_planner::PointObstacle(2.5, 0.6)));
+  obstacles.push_back(teb_local_planner::ObstaclePtr(new teb_local_planner::PointObstacle(-3., 4.)));
+
+  const double corridor = 0.75;
+  const double tolerance = 0.5;
+  const double max_goal_dist = 1.;
+  const double max_goal_angular = M_PI/2;
+  teb_local_planner::WarmStartCache cache;
+  cache.commit(&obstacles, corridor, tolerance, 3);
+  ASSERT_EQ(cache.size(), 0u); // nothing remembered yet
+  cache.remember(teb);
+  cache.commit(&obstacles, corridor, tolerance, 3);
+  ASSERT_EQ(cache.size(), 1u);
+
+  // the goal moved back along the cached path beyond the reinitialization threshold
+  teb_local_planner::PoseSE2 start(0.5, 0.05, 0.);
+  teb_local_planner::PoseSE2 goal(3., 0.05, 0.);
+  ASSERT_GE((goal.position() - teb.BackPose().position()).norm(), max_goal_dist);
+  teb_local_planner::TimedElasticBand seeded;
+  ASSERT_TRUE(cache.seed(start, goal, &obstacles, corridor, tolerance, max_goal_dist, max_goal_angular, 3, seeded));
+  ASSERT_EQ(seeded.sizePoses(), 14);
+  ASSERT_TRUE(seeded.Pose(0).position() == start.position());
+  ASSERT_TRUE(seeded.BackPose().position() == goal.position());
+  ASSERT_NEAR(seeded.getSumOfAllTimeDiffs(), 1.3, 1e-9);
+
+  // obstacles far away from the path enter and leave the costmap window
+  teb_local_planner::ObstContainer shifted;
+  shifted.push_back(teb_local_planner::ObstaclePtr(new teb_local_planner::PointObstacle(2.6, 0.65)));
+  shifted.push_back(teb_local_planner::ObstaclePtr(new teb_local_planner::PointObstacle(8., -4.)));
+  ASSERT_TRUE(cache.seed(start, goal, &shifted, corridor, tolerance, max_goal_dist, max_goal_angular, 3, seeded));
+
+  // a new obstacle on the path
+  shifted.push_back(teb_local_planner::ObstaclePtr(new teb_local_planner::PointObstacle(1.5, 0.1)));
+  ASSERT_FALSE(cache.seed(start, goal, &shifted, corridor, tolerance, max_goal_dist, max_goal_angular, 3, seeded));
+
+  // a vanished obstacle next to the path
+  teb_local_planner::ObstContainer vanished(obstacles.begin()+1, obstacles.end());
+  ASSERT_FALSE(cache.seed(start, goal, &vanished, corridor, tolerance, max_goal_dist, max_goal_angular, 3, seeded));
+
+  // goals off the cached path or with a different orientation
+  ASSERT_FALSE(cache.seed(start, teb_local_planner::PoseSE2(3., 2., 0.), &obstacles, corridor, tolerance, max_goal_dist, max_goal_angular, 3, seeded));
+  ASSERT_FALSE(cache.seed(start, teb_local_planner::PoseSE2(3., 0., M_PI), &obstacles, corridor, tolerance, max_goal_dist, max_goal_angular, 3, seeded));
+  ASSERT_EQ(seeded.sizePoses(), 14); // unmodified on failure
+}
+
+TEST(TEBBasic, obstacleClustering)
+{
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<double> coord(-3., 3.);
+  std::normal_distribution<double> blob(0., 0.15);
+
+  // occupied cells of walls, blobs and scattered points
+  const double cell = 0.05;
+  teb_local_planner::Point2dContainer points;
+  for (int i = 0; i < 80; ++i)
+    points.push_back(Eigen::Vector2d(-2. + i * cell, 1.5));
+  for (int i = 0; i < 40; ++i)
+    points.push_back(Eigen::Vector2d(1., -2. + i * cell));
+  for (int b = 0; b < 5; ++b)
+  {
+    Eigen::Vector2d center(coord(rng), coord(rng));
+    for (int i = 0; i < 60; ++i)
+      points.push_back(center + Eigen::Vector2d(blob(rng), blob(rng)));
+  }
+  for (int i = 0; i < 50; ++i)
+    points.push_back(Eigen::Vector2d(coord(rng), coord(rng)));
+  for (Eigen::Vector2d& point : points) // snap to the cell centers as for costmap cells
+    point = (point / cell).array().floor().matrix() * cell + Eigen::Vector2d::Constant(0.5 * cell);
+
+  teb_local_planner::ObstContainer obstacles;
+  obstacles.push_back(teb_local_planner::ObstaclePtr(new teb_local_planner::PointObstacle(10., 10.))); // existing obstacles are kept
+  std::size_t num_clusters = teb_local_planner::clusterPointObstacles(points, 0.2, 1., obstacles);
+  ASSERT_EQ(obstacles.size(), num_clusters + 1);
+  ASSERT_LT(num_clusters, points.size() / 4);
+
+  // every point lies inside or on the obstacle of its cluster
+  for (std::size_t i = 0; i < points.size(); ++i)
+  {
+    bool covered = false;
+    for (std::size_t j = 1; j < obstacles.size() && !covered; ++j)
+      covered = obstacles[j]->checkCollision(points[i], 1e-9);
+    ASSERT_TRUE(covered) << "point " << i << " (" << points[i].transpose() << ")";
+  }
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
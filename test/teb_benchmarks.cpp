@@ -0,0 +1,414 @@
+// Micro benchmarks of the planner internals.
+// They are not registered as tests. Build and run them explicitly, e.g.
+//   catkin_make teb_benchmarks && rosrun teb_local_planner teb_benchmarks --gtest_filter=TEBBenchmark.*
+// The measured ratios are printed and recorded as properties of the gtest xml output (--gtest_output=xml).
+
+#include <gtest/gtest.h>
+
+#include <boost/make_shared.hpp>
+
+#include <g2o/core/jacobian_workspace.h>
+
+#include <teb_local_planner/teb_config.h>
+#include <teb_local_planner/distance_calculations.h>
+#include <teb_local_planner/obstacles.h>
+#include <teb_local_planner/obstacle_spatial_index.h>
+#include <teb_local_planner/robot_footprint_model.h>
+#include <teb_local_planner/g2o_types/edge_acceleration.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace teb_local_planner;
+
+// random star-shaped polygon (as in teb_distance_kernels.cpp)
+Point2dContainer randomPolygon(std::mt19937& rng, int num_vertices, const Eigen::Vector2d& center, double max_radius)
+{
+  std::uniform_real_distribution<double> radius(0.1 * max_radius, max_radius);
+  Point2dContainer vertices(num_vertices);
+  for (int i = 0; i < num_vertices; ++i)
+  {
+    double angle = 2 * M_PI * i / num_vertices;
+    double r = radius(rng);
+    vertices[i] = center + r * Eigen::Vector2d(std::cos(angle), std::sin(angle));
+  }
+  return vertices;
+}
+
+// random convex polygon (as in teb_distance_kernels.cpp)
+Point2dContainer randomConvexPolygon(std::mt19937& rng, int num_vertices, const Eigen::Vector2d& center, double max_radius)
+{
+  std::uniform_real_distribution<double> unit(0, 1);
+  std::vector<double> angles(num_vertices);
+  for (double& angle : angles)
+    angle = 2 * M_PI * unit(rng);
+  std::sort(angles.begin(), angles.end());
+  const double a = max_radius * (0.2 + 0.8 * unit(rng));
+  const double b = max_radius * (0.2 + 0.8 * unit(rng));
+  const double rotation = 2 * M_PI * unit(rng);
+  Point2dContainer vertices(num_vertices);
+  for (int i = 0; i < num_vertices; ++i)
+    vertices[i] = center + Eigen::Rotation2Dd(rotation) * Eigen::Vector2d(a * std::cos(angles[i]), b * std::sin(angles[i]));
+  return vertices;
+}
+
+// all instruction sets supported by this build and cpu
+std::vector<SimdInstructionSet> supportedInstructionSets()
+{
+  std::vector<SimdInstructionSet> instruction_sets;
+  SimdInstructionSet previous = getDistanceInstructionSet();
+  for (SimdInstructionSet instruction_set : {SimdInstructionSet::Scalar, SimdInstructionSet::AVX2, SimdInstructionSet::NEON})
+  {
+    if (setDistanceInstructionSet(instruction_set))
+      instruction_sets.push_back(instruction_set);
+  }
+  setDistanceInstructionSet(previous);
+  return instruction_sets;
+}
+
+enum class LinearizationMode { Analytic, AutoDiff, Numeric };
+
+// linearize all edges repeatedly, either analytically, by automatic differentiation or with the numeric differentiation of g2o
+template <typename EdgeT>
+double linearizationTime(std::vector<EdgeT*>& edges, g2o::JacobianWorkspace& workspace, LinearizationMode mode, int repetitions)
+{
+  typedef g2o::BaseMultiEdge<EdgeT::Dimension, typename EdgeT::Measurement> NumericBase;
+  for (EdgeT* edge : edges)
+    static_cast<g2o::OptimizableGraph::Edge*>(edge)->linearizeOplus(workspace); // map the jacobians into the workspace
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int rep = 0; rep < repetitions; ++rep)
+  {
+    for (EdgeT* edge : edges)
+    {
+      edge->computeError(); // as done by the optimizer before each linearization
+      switch (mode)
+      {
+        case LinearizationMode::Analytic: edge->linearizeOplus(); break;
+        case LinearizationMode::AutoDiff: edge->linearizeOplusAutoDiff(); break;
+        case LinearizationMode::Numeric: edge->NumericBase::linearizeOplus(); break;
+      }
+    }
+  }
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// linearization of the acceleration edges only, the effect on a complete optimizeTEB() call is smaller
+// since the sparse solver and the remaining edges are not affected
+TEST(TEBBenchmark, HolonomicAccelerationLinearization)
+{
+  TebConfig cfg;
+  cfg.robot.max_vel_y = 0.3;
+  cfg.robot.acc_lim_y = 0.3;
+
+  // 60 poses of a holonomic trajectory with strafing and rotation
+  const int num_poses = 60;
+  std::vector<VertexPose, Eigen::aligned_allocator<VertexPose> > poses(num_poses);
+  std::vector<VertexTimeDiff> time_diffs(num_poses - 1);
+  for (int i = 0; i < num_poses; ++i)
+    poses[i].setEstimate(PoseSE2(0.1*i, 0.3*std::sin(0.2*i), 0.05*i));
+  for (VertexTimeDiff& time_diff : time_diffs)
+    time_diff.setEstimate(0.2);
+
+  std::vector<EdgeAccelerationHolonomic*> edges;
+  for (int i = 0; i < num_poses - 2; ++i)
+  {
+    EdgeAccelerationHolonomic* edge = new EdgeAccelerationHolonomic;
+    edge->setTebConfig(cfg);
+    edge->setInformation(Eigen::Matrix3d::Identity());
+    edge->setVertex(0, &poses[i]);
+    edge->setVertex(1, &poses[i+1]);
+    edge->setVertex(2, &poses[i+2]);
+    edge->setVertex(3, &time_diffs[i]);
+    edge->setVertex(4, &time_diffs[i+1]);
+    edges.push_back(edge);
+  }
+
+  g2o::JacobianWorkspace workspace;
+  workspace.updateSize(edges.front());
+  workspace.allocate();
+
+  // fastest of several interleaved batches, such that the ratio is robust against other load on the machine
+  const int repetitions = 200;
+  const int batches = 7;
+  double time_analytic = std::numeric_limits<double>::max();
+  double time_autodiff = std::numeric_limits<double>::max();
+  double time_numeric = std::numeric_limits<double>::max();
+  for (int batch = 0; batch < batches; ++batch)
+  {
+    time_analytic = std::min(time_analytic, linearizationTime(edges, workspace, LinearizationMode::Analytic, repetitions));
+    time_autodiff = std::min(time_autodiff, linearizationTime(edges, workspace, LinearizationMode::AutoDiff, repetitions));
+    time_numeric = std::min(time_numeric, linearizationTime(edges, workspace, LinearizationMode::Numeric, repetitions));
+  }
+  std::cout << "holonomic acceleration edges (" << num_poses << " poses, " << repetitions << " linearizations, best of " << batches << "): analytic "
+            << time_analytic << " ms, autodiff " << time_autodiff << " ms, numeric " << time_numeric << " ms, speedup "
+            << time_numeric / time_analytic << " (analytic) " << time_numeric / time_autodiff << " (autodiff)" << std::endl;
+  RecordProperty("speedup_percent", static_cast<int>(100 * time_numeric / time_analytic));
+  RecordProperty("autodiff_speedup_percent", static_cast<int>(100 * time_numeric / time_autodiff));
+
+  for (EdgeAccelerationHolonomic* edge : edges)
+    delete edge;
+}
+
+TEST(TEBBenchmark, PolygonDistanceKernels)
+{
+  const int repetitions = 20000;
+  std::mt19937 rng(23);
+
+  std::vector<SimdInstructionSet> instruction_sets = supportedInstructionSets();
+  const char* names[] = {"scalar", "avx2", "neon"};
+  SimdInstructionSet previous = getDistanceInstructionSet();
+
+  for (int num_vertices : {4, 8, 16, 64})
+  {
+    Point2dContainer polygon = randomPolygon(rng, num_vertices, Eigen::Vector2d::Zero(), 1.);
+    Point2dContainer robot = randomPolygon(rng, 6, Eigen::Vector2d(2.5, 0.3), 0.5);
+    PolygonSoA polygon_soa(polygon);
+    PolygonSoA robot_soa(robot);
+
+    // reference: edge-by-edge implementation on the point container
+    double dist_aos = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repetitions; ++i)
+      dist_aos += distance_polygon_to_polygon_2d(robot, polygon);
+    double time_aos = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << num_vertices << " vertices (" << repetitions << " polygon distances): point container " << time_aos << " ms";
+
+    for (SimdInstructionSet instruction_set : instruction_sets)
+    {
+      setDistanceInstructionSet(instruction_set);
+      double dist_soa = 0;
+      start = std::chrono::steady_clock::now();
+      for (int i = 0; i < repetitions; ++i)
+        dist_soa += distance_polygon_to_polygon_2d(robot_soa, polygon_soa);
+      double time_soa = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      EXPECT_NEAR(dist_soa, dist_aos, 1e-9 * repetitions); // keeps the loop from being optimized away
+
+      const char* name = names[static_cast<int>(instruction_set)];
+      std::cout << ", " << name << " " << time_soa << " ms";
+      RecordProperty(std::string(name) + "_speedup_percent_" + std::to_string(num_vertices), static_cast<int>(100 * time_aos / time_soa));
+    }
+    std::cout << std::endl;
+  }
+  setDistanceInstructionSet(previous);
+}
+
+TEST(TEBBenchmark, ConvexFootprintWarmStart)
+{
+  const int repetitions = 20000;
+  std::mt19937 rng(31);
+  Point2dContainer footprint = randomConvexPolygon(rng, 8, Eigen::Vector2d::Zero(), 0.5);
+  PolygonRobotFootprint robot(footprint);
+  ASSERT_TRUE(robot.isConvex());
+
+  for (int num_vertices : {8, 64})
+  {
+    PolygonObstacle obstacle(randomConvexPolygon(rng, num_vertices, Eigen::Vector2d(2, 0.5), 1.));
+    ASSERT_TRUE(obstacle.isConvex());
+
+    // robot moving along a path next to the obstacle (as during the optimization)
+    std::vector<PoseSE2> poses;
+    for (int i = 0; i < 100; ++i)
+      poses.push_back(PoseSE2(-1 + 0.04 * i, -1.2 + 0.01 * i, 0.02 * i));
+
+    double dist_cold = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repetitions; ++i)
+      dist_cold += robot.calculateDistance(poses[i % poses.size()], &obstacle);
+    double time_cold = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    ConvexDistanceWitness witness;
+    double dist_warm = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repetitions; ++i)
+      dist_warm += robot.calculateDistance(poses[i % poses.size()], &obstacle, &witness);
+    double time_warm = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // reference: all vertex-edge pairs
+    PolygonSoA obstacle_soa(obstacle.vertices());
+    double dist_pairs = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repetitions; ++i)
+    {
+      const PoseSE2& pose = poses[i % poses.size()];
+      Point2dContainer footprint_world(footprint.size());
+      for (std::size_t j = 0; j < footprint.size(); ++j)
+        footprint_world[j] = pose.position() + Eigen::Rotation2Dd(pose.theta()) * footprint[j];
+      dist_pairs += distance_polygon_to_polygon_2d(PolygonSoA(footprint_world), obstacle_soa);
+    }
+    double time_pairs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    EXPECT_NEAR(dist_cold, dist_pairs, 1e-9 * repetitions); // keeps the loops from being optimized away
+    EXPECT_NEAR(dist_warm, dist_pairs, 1e-9 * repetitions);
+    std::cout << "convex footprint (8 vertices) to convex obstacle (" << num_vertices << " vertices, " << repetitions
+              << " distances): vertex-edge pairs " << time_pairs << " ms, gjk " << time_cold << " ms, gjk warm started " << time_warm << " ms" << std::endl;
+    RecordProperty("gjk_warm_speedup_percent_" + std::to_string(num_vertices), static_cast<int>(100 * time_pairs / time_warm));
+  }
+}
+
+TEST(TEBBenchmark, ObstacleFootprintDispatch)
+{
+  std::mt19937 rng(37);
+  std::uniform_real_distribution<double> coord(-2, 2);
+  std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+
+  std::vector<RobotFootprintModelPtr> robot_models;
+  robot_models.push_back(boost::make_shared<PointRobotFootprint>());
+  robot_models.push_back(boost::make_shared<CircularRobotFootprint>(0.3));
+  robot_models.push_back(boost::make_shared<TwoCirclesRobotFootprint>(0.3, 0.2, 0.2, 0.25));
+  robot_models.push_back(boost::make_shared<LineRobotFootprint>(Eigen::Vector2d(-0.3, 0), Eigen::Vector2d(0.4, 0), 0.1));
+
+  // point and line obstacles are the common case
+  std::vector<ObstaclePtr> obstacles;
+  obstacles.push_back(ObstaclePtr(new PointObstacle(0.7, -0.2)));
+  obstacles.push_back(ObstaclePtr(new CircularObstacle(-0.4, 0.6, 0.2)));
+  obstacles.push_back(ObstaclePtr(new LineObstacle(0.3, 0.9, -0.8, 0.1)));
+
+  // timing of the dispatch table compared to the virtual interface
+  const int repetitions = 200000;
+  std::vector<PoseSE2> poses;
+  for (int i = 0; i < 64; ++i)
+    poses.push_back(PoseSE2(coord(rng), coord(rng), angle(rng)));
+  for (std::size_t model = 0; model < robot_models.size(); ++model)
+  {
+    const BaseRobotFootprintModel& robot_model = *robot_models[model];
+    double dist_virtual = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repetitions; ++i)
+      dist_virtual += robot_model.calculateDistance(poses[i % poses.size()], obstacles[i % obstacles.size()].get());
+    double time_virtual = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    double dist_dispatch = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repetitions; ++i)
+      dist_dispatch += calculateRobotObstacleDistance(robot_model, poses[i % poses.size()], obstacles[i % obstacles.size()].get());
+    double time_dispatch = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    EXPECT_NEAR(dist_dispatch, dist_virtual, 1e-9 * repetitions); // keeps the loops from being optimized away
+    std::cout << "footprint type " << model << " (" << repetitions << " distances to point/circle/line obstacles): virtual "
+              << time_virtual << " ms, dispatch table " << time_dispatch << " ms" << std::endl;
+    RecordProperty("dispatch_speedup_percent_" + std::to_string(model), static_cast<int>(100 * time_virtual / time_dispatch));
+  }
+}
+
+// random point, circular, line, pill and polygon obstacles (as in teb_basics.cpp)
+ObstContainer randomObstacles(int number, double extent, std::mt19937& rng)
+{
+  std::uniform_real_distribution<double> coord(0., extent);
+  std::uniform_real_distribution<double> size(0.05, 0.5);
+  std::uniform_int_distribution<int> type(0, 4);
+  ObstContainer obstacles;
+  for (int i = 0; i < number; ++i)
+  {
+    const Eigen::Vector2d pos(coord(rng), coord(rng));
+    const Eigen::Vector2d offset(size(rng), size(rng));
+    switch (type(rng))
+    {
+      case 0:
+        obstacles.push_back(ObstaclePtr(new PointObstacle(pos)));
+        break;
+      case 1:
+        obstacles.push_back(ObstaclePtr(new CircularObstacle(pos, size(rng))));
+        break;
+      case 2:
+        obstacles.push_back(ObstaclePtr(new LineObstacle(pos, pos + offset)));
+        break;
+      case 3:
+        obstacles.push_back(ObstaclePtr(new PillObstacle(pos, pos + offset, 0.5 * size(rng))));
+        break;
+      default:
+        obstacles.push_back(ObstaclePtr(new PolygonObstacle(
+          {pos, pos + Eigen::Vector2d(offset.x(), 0.), pos + offset, pos + Eigen::Vector2d(0., offset.y())})));
+    }
+  }
+  return obstacles;
+}
+
+TEST(TEBBenchmark, ObstacleSpatialIndex)
+{
+  // edge collision checks of a roadmap as in ProbRoadmapGraph::createGraph() (start, goal and 15 samples, all forward edges)
+  // within a 20m x 20m local costmap. The roadmap is sampled in the free corridor between start and goal, hence most edges are
+  // collision free and require a test against all obstacles without a broadphase.
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<double> sample_x(0., 20.);
+  std::uniform_real_distribution<double> sample_y(8.5, 11.5);
+  std::vector<Eigen::Vector2d, Eigen::aligned_allocator<Eigen::Vector2d> > vertices;
+  vertices.push_back(Eigen::Vector2d(0., 10.));
+  for (int i = 0; i < 15; ++i)
+    vertices.push_back(Eigen::Vector2d(sample_x(rng), sample_y(rng)));
+  vertices.push_back(Eigen::Vector2d(20., 10.));
+  const double dist_to_obst = 0.5;
+
+  for (int num_obstacles : {100, 1000, 5000})
+  {
+    // obstacles outside of the corridor and a few inside
+    ObstContainer obstacles;
+    while ((int)obstacles.size() < num_obstacles)
+    {
+      ObstContainer obstacle = randomObstacles(1, 20., rng);
+      const double y = obstacle.front()->getCentroid().y();
+      if (y < 7.5 || y > 12.5 || std::uniform_real_distribution<double>(0., 1.)(rng) < 0.01)
+        obstacles.push_back(obstacle.front());
+    }
+    const int repetitions = 200000 / num_obstacles + 1;
+
+    int free_brute_force = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < repetitions; ++rep)
+    {
+      free_brute_force = 0;
+      for (std::size_t i = 0; i + 1 < vertices.size(); ++i)
+      {
+        for (std::size_t j = i + 1; j < vertices.size(); ++j)
+        {
+          bool collision = false;
+          for (const ObstaclePtr& obstacle : obstacles)
+          {
+            if (obstacle->checkLineIntersection(vertices[i], vertices[j], dist_to_obst))
+            {
+              collision = true;
+              break;
+            }
+          }
+          free_brute_force += !collision;
+        }
+      }
+    }
+    double time_brute_force = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / repetitions;
+
+    int free_indexed = 0;
+    ObstacleSpatialIndex index;
+    start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < repetitions; ++rep)
+    {
+      index.build(obstacles); // included since it is rebuilt in each planning cycle
+      free_indexed = 0;
+      for (std::size_t i = 0; i + 1 < vertices.size(); ++i)
+      {
+        for (std::size_t j = i + 1; j < vertices.size(); ++j)
+        {
+          const Eigen::Vector2d& a = vertices[i];
+          const Eigen::Vector2d& b = vertices[j];
+          free_indexed += !index.anyAlongSegment(a, b, dist_to_obst, [&](int k) {return obstacles[k]->checkLineIntersection(a, b, dist_to_obst);});
+        }
+      }
+    }
+    double time_indexed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / repetitions;
+
+    ASSERT_EQ(free_indexed, free_brute_force); // keeps the loops from being optimized away
+    std::cout << num_obstacles << " obstacles (" << vertices.size() * (vertices.size() - 1) / 2 << " roadmap edges, " << free_indexed
+              << " collision free): brute force " << time_brute_force << " ms, spatial index " << time_indexed << " ms (incl. build)" << std::endl;
+    RecordProperty("edge_check_speedup_percent_" + std::to_string(num_obstacles), static_cast<int>(100 * time_brute_force / time_indexed));
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
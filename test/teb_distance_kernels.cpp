@@ -0,0 +1,479 @@
+#include <gtest/gtest.h>
+
+#include <boost/make_shared.hpp>
+
+#include <teb_local_planner/distance_calculations.h>
+#include <teb_local_planner/obstacles.h>
+#include <teb_local_planner/robot_footprint_model.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace teb_local_planner;
+
+// random star-shaped polygon (not necessarily convex) with the given number of vertices
+Point2dContainer randomPolygon(std::mt19937& rng, int num_vertices, const Eigen::Vector2d& center, double max_radius)
+{
+  std::uniform_real_distribution<double> radius(0.1 * max_radius, max_radius);
+  Point2dContainer vertices(num_vertices);
+  for (int i = 0; i < num_vertices; ++i)
+  {
+    double angle = 2 * M_PI * i / num_vertices;
+    double r = radius(rng);
+    vertices[i] = center + r * Eigen::Vector2d(std::cos(angle), std::sin(angle));
+  }
+  return vertices;
+}
+
+// all instruction sets supported by this build and cpu
+std::vector<SimdInstructionSet> supportedInstructionSets()
+{
+  std::vector<SimdInstructionSet> instruction_sets;
+  SimdInstructionSet previous = getDistanceInstructionSet();
+  for (SimdInstructionSet instruction_set : {SimdInstructionSet::Scalar, SimdInstructionSet::AVX2, SimdInstructionSet::NEON})
+  {
+    if (setDistanceInstructionSet(instruction_set))
+      instruction_sets.push_back(instruction_set);
+  }
+  setDistanceInstructionSet(previous);
+  return instruction_sets;
+}
+
+TEST(TEBDistanceKernels, PolygonSoALayout)
+{
+  Point2dContainer vertices;
+  vertices.push_back(Eigen::Vector2d(0, 0));
+  EXPECT_EQ(PolygonSoA(vertices).num_edges, 0);
+  vertices.push_back(Eigen::Vector2d(1, 0));
+  EXPECT_EQ(PolygonSoA(vertices).num_edges, 1);
+  vertices.push_back(Eigen::Vector2d(1, 1));
+  PolygonSoA triangle(vertices);
+  EXPECT_EQ(triangle.num_vertices, 3);
+  EXPECT_EQ(triangle.num_edges, 3);
+  ASSERT_EQ(triangle.x.size(), 4u);
+  EXPECT_EQ(triangle.x[3], triangle.x[0]);
+  EXPECT_EQ(triangle.y[3], triangle.y[0]);
+
+  triangle.setVertex(0, -1, -2);
+  EXPECT_EQ(triangle.x[3], -1);
+  EXPECT_EQ(triangle.y[3], -2);
+}
+
+TEST(TEBDistanceKernels, MatchScalarImplementation)
+{
+  std::mt19937 rng(17);
+  std::uniform_real_distribution<double> coord(-3, 3);
+  std::uniform_int_distribution<int> no_vertices(1, 19);
+
+  SimdInstructionSet previous = getDistanceInstructionSet();
+  for (SimdInstructionSet instruction_set : supportedInstructionSets())
+  {
+    ASSERT_TRUE(setDistanceInstructionSet(instruction_set));
+    for (int sample = 0; sample < 2000; ++sample)
+    {
+      Point2dContainer polygon1 = randomPolygon(rng, no_vertices(rng), Eigen::Vector2d(coord(rng), coord(rng)), 1.5);
+      Point2dContainer polygon2 = randomPolygon(rng, no_vertices(rng), Eigen::Vector2d(coord(rng), coord(rng)), 1.5);
+      PolygonSoA soa1(polygon1);
+      PolygonSoA soa2(polygon2);
+      Eigen::Vector2d a(coord(rng), coord(rng));
+      Eigen::Vector2d b(coord(rng), coord(rng));
+
+      EXPECT_NEAR(distance_point_to_polygon_2d(a, soa1), distance_point_to_polygon_2d(a, polygon1), 1e-9);
+      EXPECT_NEAR(distance_segment_to_polygon_2d(a, b, soa1), distance_segment_to_polygon_2d(a, b, polygon1), 1e-9);
+      EXPECT_NEAR(distance_polygon_to_polygon_2d(soa1, soa2), distance_polygon_to_polygon_2d(polygon1, polygon2), 1e-9);
+    }
+  }
+  setDistanceInstructionSet(previous);
+}
+
+TEST(TEBDistanceKernels, PolygonFootprintDistance)
+{
+  std::mt19937 rng(4);
+  std::uniform_real_distribution<double> coord(-2, 2);
+  std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+
+  Point2dContainer footprint = randomPolygon(rng, 6, Eigen::Vector2d::Zero(), 0.5);
+  PolygonRobotFootprint robot(footprint);
+
+  std::vector<ObstaclePtr> obstacles;
+  obstacles.push_back(ObstaclePtr(new PointObstacle(0.7, -0.2)));
+  obstacles.push_back(ObstaclePtr(new CircularObstacle(-0.4, 0.6, 0.2)));
+  obstacles.push_back(ObstaclePtr(new LineObstacle(0.3, 0.9, -0.8, 0.1)));
+  obstacles.push_back(ObstaclePtr(new PillObstacle(-0.9, -0.5, 0.2, -1.1, 0.15)));
+  PolygonObstacle* polygon = new PolygonObstacle(randomPolygon(rng, 9, Eigen::Vector2d(0.5, 0.5), 0.4));
+  obstacles.push_back(ObstaclePtr(polygon));
+
+  for (int sample = 0; sample < 500; ++sample)
+  {
+    PoseSE2 pose(coord(rng), coord(rng), angle(rng));
+
+    // reference: footprint in the world frame as point container
+    Point2dContainer footprint_world(footprint.size());
+    for (std::size_t i = 0; i < footprint.size(); ++i)
+      footprint_world[i] = pose.position() + Eigen::Rotation2Dd(pose.theta()) * footprint[i];
+
+    for (const ObstaclePtr& obstacle : obstacles)
+      EXPECT_NEAR(robot.calculateDistance(pose, obstacle.get()), obstacle->getMinimumDistance(footprint_world), 1e-9);
+  }
+}
+
+// random convex polygon: vertices on an ellipse at sorted random angles
+Point2dContainer randomConvexPolygon(std::mt19937& rng, int num_vertices, const Eigen::Vector2d& center, double max_radius)
+{
+  std::uniform_real_distribution<double> unit(0, 1);
+  std::vector<double> angles(num_vertices);
+  for (double& angle : angles)
+    angle = 2 * M_PI * unit(rng);
+  std::sort(angles.begin(), angles.end());
+  const double a = max_radius * (0.2 + 0.8 * unit(rng));
+  const double b = max_radius * (0.2 + 0.8 * unit(rng));
+  const double rotation = 2 * M_PI * unit(rng);
+  Point2dContainer vertices(num_vertices);
+  for (int i = 0; i < num_vertices; ++i)
+    vertices[i] = center + Eigen::Rotation2Dd(rotation) * Eigen::Vector2d(a * std::cos(angles[i]), b * std::sin(angles[i]));
+  return vertices;
+}
+
+TEST(TEBDistanceKernels, PolygonConvexity)
+{
+  Point2dContainer square;
+  square.push_back(Eigen::Vector2d(0, 0));
+  square.push_back(Eigen::Vector2d(1, 0));
+  square.push_back(Eigen::Vector2d(1, 1));
+  square.push_back(Eigen::Vector2d(0, 1));
+  EXPECT_TRUE(check_polygon_convexity_2d(square));
+
+  Point2dContainer clockwise(square.rbegin(), square.rend());
+  EXPECT_TRUE(check_polygon_convexity_2d(clockwise));
+
+  Point2dContainer collinear = square;
+  collinear.insert(collinear.begin() + 1, Eigen::Vector2d(0.5, 0));
+  EXPECT_TRUE(check_polygon_convexity_2d(collinear));
+
+  Point2dContainer concave = square;
+  concave.insert(concave.begin() + 1, Eigen::Vector2d(0.5, 0.5));
+  EXPECT_FALSE(check_polygon_convexity_2d(concave));
+
+  Point2dContainer bowtie = square;
+  std::swap(bowtie[2], bowtie[3]);
+  EXPECT_FALSE(check_polygon_convexity_2d(bowtie));
+
+  Point2dContainer repeated = square;
+  repeated.insert(repeated.begin() + 1, square[1]);
+  EXPECT_FALSE(check_polygon_convexity_2d(repeated));
+
+  EXPECT_TRUE(check_polygon_convexity_2d(Point2dContainer(1, Eigen::Vector2d(1, 2))));
+  EXPECT_FALSE(check_polygon_convexity_2d(Point2dContainer(2, Eigen::Vector2d(1, 2))));
+
+  PolygonObstacle obstacle(square);
+  EXPECT_TRUE(obstacle.isConvex());
+  EXPECT_FALSE(PolygonObstacle(concave).isConvex());
+  EXPECT_TRUE(PolygonRobotFootprint(square).isConvex());
+  EXPECT_FALSE(PolygonRobotFootprint(concave).isConvex());
+}
+
+TEST(TEBDistanceKernels, ConvexPolygonDistance)
+{
+  std::mt19937 rng(29);
+  std::uniform_real_distribution<double> coord(-2, 2);
+  std::uniform_int_distribution<int> no_vertices(1, 24);
+
+  for (int sample = 0; sample < 5000; ++sample)
+  {
+    Point2dContainer polygon1 = randomConvexPolygon(rng, no_vertices(rng), Eigen::Vector2d(coord(rng), coord(rng)), 1.);
+    Point2dContainer polygon2 = randomConvexPolygon(rng, no_vertices(rng), Eigen::Vector2d(coord(rng), coord(rng)), 1.);
+    if (!check_polygon_convexity_2d(polygon1) || !check_polygon_convexity_2d(polygon2))
+      continue; // e.g. repeated angles
+
+    PolygonSoA soa1(polygon1);
+    PolygonSoA soa2(polygon2);
+    double expected = distance_polygon_to_polygon_2d(polygon1, polygon2);
+
+    EXPECT_NEAR(distance_convex_polygon_to_polygon_2d(soa1, soa2), expected, 1e-9);
+
+    // warm start from the witness of a slightly different configuration
+    ConvexDistanceWitness witness;
+    distance_convex_polygon_to_polygon_2d(soa1, soa2, &witness);
+    EXPECT_GE(witness.vertex1, 0);
+    EXPECT_GE(witness.vertex2, 0);
+    for (int i = 0; i < soa1.num_vertices; ++i)
+      soa1.setVertex(i, soa1.x[i] + 0.01, soa1.y[i] - 0.02);
+    Point2dContainer shifted = polygon1;
+    for (Eigen::Vector2d& vertex : shifted)
+      vertex += Eigen::Vector2d(0.01, -0.02);
+    expected = distance_polygon_to_polygon_2d(shifted, polygon2);
+    EXPECT_NEAR(distance_convex_polygon_to_polygon_2d(soa1, soa2, &witness), expected, 1e-9);
+
+    // invalid witnesses (e.g. the obstacle changed) are ignored
+    ConvexDistanceWitness invalid;
+    invalid.vertex1 = 100;
+    invalid.vertex2 = -5;
+    EXPECT_NEAR(distance_convex_polygon_to_polygon_2d(soa1, soa2, &invalid), expected, 1e-9);
+  }
+}
+
+TEST(TEBDistanceKernels, CollinearConvexPolygonDistance)
+{
+  // unit square with an additional vertex in the middle of the bottom edge (accepted as convex)
+  Point2dContainer square;
+  square.push_back(Eigen::Vector2d(0, 0));
+  square.push_back(Eigen::Vector2d(0.5, 0));
+  square.push_back(Eigen::Vector2d(1, 0));
+  square.push_back(Eigen::Vector2d(1, 1));
+  square.push_back(Eigen::Vector2d(0, 1));
+  Point2dContainer triangle;
+  triangle.push_back(Eigen::Vector2d(0.5, 2));
+  triangle.push_back(Eigen::Vector2d(0.7, 3));
+  triangle.push_back(Eigen::Vector2d(0.3, 3));
+  ASSERT_TRUE(check_polygon_convexity_2d(square));
+  PolygonSoA square_soa(square);
+  PolygonSoA triangle_soa(triangle);
+
+  // warm starts on the collinear run must not stop the support search in its middle
+  for (int vertex1 = 0; vertex1 < square_soa.num_vertices; ++vertex1)
+  {
+    for (int vertex2 = 0; vertex2 < triangle_soa.num_vertices; ++vertex2)
+    {
+      ConvexDistanceWitness witness;
+      witness.vertex1 = vertex1;
+      witness.vertex2 = vertex2;
+      EXPECT_NEAR(distance_convex_polygon_to_polygon_2d(square_soa, triangle_soa, &witness), 1., 1e-9) << vertex1 << ", " << vertex2;
+      witness.vertex1 = vertex2;
+      witness.vertex2 = vertex1;
+      EXPECT_NEAR(distance_convex_polygon_to_polygon_2d(triangle_soa, square_soa, &witness), 1., 1e-9) << vertex2 << ", " << vertex1;
+    }
+  }
+
+  // random convex polygons with collinear vertices inserted on their edges and random warm starts
+  std::mt19937 rng(37);
+  std::uniform_real_distribution<double> coord(-2, 2);
+  std::uniform_int_distribution<int> no_vertices(3, 12);
+  for (int sample = 0; sample < 2000; ++sample)
+  {
+    Point2dContainer polygons[2];
+    for (Point2dContainer& polygon : polygons)
+    {
+      Point2dContainer convex = randomConvexPolygon(rng, no_vertices(rng), Eigen::Vector2d(coord(rng), coord(rng)), 1.);
+      for (std::size_t i = 0; i < convex.size(); ++i)
+      {
+        polygon.push_back(convex[i]);
+        if (i % 2 == 0)
+          polygon.push_back(0.5 * (convex[i] + convex[(i + 1) % convex.size()]));
+      }
+    }
+    if (!check_polygon_convexity_2d(polygons[0]) || !check_polygon_convexity_2d(polygons[1]))
+      continue; // e.g. repeated angles
+
+    PolygonSoA soa1(polygons[0]);
+    PolygonSoA soa2(polygons[1]);
+    const double expected = distance_polygon_to_polygon_2d(polygons[0], polygons[1]);
+    ConvexDistanceWitness witness;
+    witness.vertex1 = std::uniform_int_distribution<int>(0, soa1.num_vertices - 1)(rng);
+    witness.vertex2 = std::uniform_int_distribution<int>(0, soa2.num_vertices - 1)(rng);
+    EXPECT_NEAR(distance_convex_polygon_to_polygon_2d(soa1, soa2, &witness), expected, 1e-9);
+  }
+}
+
+TEST(TEBDistanceKernels, ContainedPolygonDistance)
+{
+  // small square inside a large one: no edges intersect, but the polygons overlap
+  Point2dContainer outer, inner;
+  outer.push_back(Eigen::Vector2d(-1, -1));
+  outer.push_back(Eigen::Vector2d(1, -1));
+  outer.push_back(Eigen::Vector2d(1, 1));
+  outer.push_back(Eigen::Vector2d(-1, 1));
+  for (const Eigen::Vector2d& vertex : outer)
+    inner.push_back(0.1 * vertex + Eigen::Vector2d(0.3, 0.2));
+  PolygonSoA outer_soa(outer);
+  PolygonSoA inner_soa(inner);
+
+  EXPECT_EQ(distance_polygon_to_polygon_2d(outer, inner), 0);
+  EXPECT_EQ(distance_polygon_to_polygon_2d(inner, outer), 0);
+  EXPECT_EQ(distance_polygon_to_polygon_2d(outer_soa, inner_soa), 0);
+  EXPECT_EQ(distance_polygon_to_polygon_2d(inner_soa, outer_soa), 0);
+  EXPECT_EQ(distance_convex_polygon_to_polygon_2d(outer_soa, inner_soa), 0);
+  EXPECT_EQ(distance_convex_polygon_to_polygon_2d(inner_soa, outer_soa), 0);
+
+  // a point inside a polygon is a degenerated polygon that is contained as well
+  Point2dContainer point(1, Eigen::Vector2d(0.5, -0.5));
+  EXPECT_EQ(distance_polygon_to_polygon_2d(point, outer), 0);
+  EXPECT_EQ(distance_polygon_to_polygon_2d(PolygonSoA(point), outer_soa), 0);
+  EXPECT_EQ(distance_point_to_polygon_2d(point.front(), outer), 0);
+  EXPECT_EQ(distance_point_to_polygon_2d(point.front(), outer_soa), 0);
+  EXPECT_EQ(distance_segment_to_polygon_2d(inner[0], inner[2], outer), 0);
+  EXPECT_EQ(distance_segment_to_polygon_2d(inner[0], inner[2], outer_soa), 0);
+
+  // convex and non-convex footprints agree for a polygon obstacle inside the footprint
+  Point2dContainer concave = outer;
+  concave.insert(concave.begin() + 1, Eigen::Vector2d(0, -0.5));
+  PolygonRobotFootprint convex_robot(outer);
+  PolygonRobotFootprint concave_robot(concave);
+  ASSERT_TRUE(convex_robot.isConvex());
+  ASSERT_FALSE(concave_robot.isConvex());
+
+  PolygonObstacle obstacle(inner);
+  PoseSE2 pose(0.1, -0.1, 0.05);
+  EXPECT_EQ(convex_robot.calculateDistance(pose, &obstacle), 0);
+  EXPECT_EQ(concave_robot.calculateDistance(pose, &obstacle), 0);
+
+  // point and line obstacles inside the footprint are treated like 1- and 2-vertex polygons
+  PointObstacle point_obstacle(0.3, 0.2);
+  LineObstacle line_obstacle(0.2, 0.1, 0.4, 0.3);
+  EXPECT_EQ(concave_robot.calculateDistance(pose, &point_obstacle), 0);
+  EXPECT_EQ(concave_robot.calculateDistance(pose, &line_obstacle), 0);
+}
+
+TEST(TEBDistanceKernels, ConvexFootprintWarmStart)
+{
+  std::mt19937 rng(31);
+  Point2dContainer footprint = randomConvexPolygon(rng, 8, Eigen::Vector2d::Zero(), 0.5);
+  PolygonRobotFootprint robot(footprint);
+  ASSERT_TRUE(robot.isConvex());
+
+  for (int num_vertices : {8, 64})
+  {
+    PolygonObstacle obstacle(randomConvexPolygon(rng, num_vertices, Eigen::Vector2d(2, 0.5), 1.));
+    ASSERT_TRUE(obstacle.isConvex());
+    PolygonSoA obstacle_soa(obstacle.vertices());
+
+    // robot moving along a path next to the obstacle (as during the optimization), reference: all vertex-edge pairs
+    ConvexDistanceWitness witness;
+    for (int i = 0; i < 100; ++i)
+    {
+      PoseSE2 pose(-1 + 0.04 * i, -1.2 + 0.01 * i, 0.02 * i);
+      Point2dContainer footprint_world(footprint.size());
+      for (std::size_t j = 0; j < footprint.size(); ++j)
+        footprint_world[j] = pose.position() + Eigen::Rotation2Dd(pose.theta()) * footprint[j];
+      const double expected = distance_polygon_to_polygon_2d(PolygonSoA(footprint_world), obstacle_soa);
+
+      EXPECT_NEAR(robot.calculateDistance(pose, &obstacle), expected, 1e-9);
+      EXPECT_NEAR(robot.calculateDistance(pose, &obstacle, &witness), expected, 1e-9);
+    }
+  }
+}
+
+// user-defined footprint model (handled by the virtual interface)
+class EllipseRobotFootprint : public BaseRobotFootprintModel
+{
+public:
+  EllipseRobotFootprint(double a, double b) : a_(a), b_(b) {}
+
+  virtual double calculateDistance(const PoseSE2& current_pose, const Obstacle* obstacle) const
+  {
+    Point2dContainer polygon(16);
+    for (int i = 0; i < 16; ++i)
+      polygon[i] = current_pose.position() + Eigen::Rotation2Dd(current_pose.theta()) * Eigen::Vector2d(a_ * std::cos(i * M_PI / 8), b_ * std::sin(i * M_PI / 8));
+    return obstacle->getMinimumDistance(polygon);
+  }
+
+  virtual double estimateSpatioTemporalDistance(const PoseSE2& current_pose, const Obstacle* obstacle, double t) const
+  {
+    return calculateDistance(current_pose, obstacle);
+  }
+
+  virtual double getInscribedRadius() {return std::min(a_, b_);}
+  virtual double getCircumscribedRadius() const {return std::max(a_, b_);}
+
+private:
+  double a_;
+  double b_;
+};
+
+// subclasses of built-in types that override the distance functions (must not be dispatched to the built-in kernels)
+class InflatedCircularObstacle : public CircularObstacle
+{
+public:
+  InflatedCircularObstacle(double x, double y, double radius, double inflation) : CircularObstacle(x, y, radius), inflation_(inflation) {}
+
+  using CircularObstacle::getMinimumDistance;
+  virtual double getMinimumDistance(const Eigen::Vector2d& position) const
+  {
+    return CircularObstacle::getMinimumDistance(position) - inflation_;
+  }
+
+private:
+  double inflation_;
+};
+
+class PaddedCircularRobotFootprint : public CircularRobotFootprint
+{
+public:
+  PaddedCircularRobotFootprint(double radius, double padding) : CircularRobotFootprint(radius), padding_(padding) {}
+
+  using CircularRobotFootprint::calculateDistance;
+  virtual double calculateDistance(const PoseSE2& current_pose, const Obstacle* obstacle) const
+  {
+    return CircularRobotFootprint::calculateDistance(current_pose, obstacle) - padding_;
+  }
+
+private:
+  double padding_;
+};
+
+TEST(TEBDistanceKernels, DerivedTypeDispatch)
+{
+  PointRobotFootprint point_robot;
+  PaddedCircularRobotFootprint padded_robot(0.3, 0.05);
+  CircularObstacle obstacle(1., 0.5, 0.2);
+  InflatedCircularObstacle inflated_obstacle(1., 0.5, 0.2, 0.1);
+  EXPECT_EQ(padded_robot.getType(), FootprintType::Custom);
+  EXPECT_EQ(inflated_obstacle.getType(), ObstacleType::Custom);
+  EXPECT_EQ(obstacle.getType(), ObstacleType::Circular);
+
+  PoseSE2 pose(0.1, -0.2, 0.3);
+  const double dist = point_robot.calculateDistance(pose, &obstacle);
+  EXPECT_NEAR(calculateRobotObstacleDistance(point_robot, pose, &inflated_obstacle), dist - 0.1, 1e-12);
+  EXPECT_NEAR(calculateRobotObstacleDistance(padded_robot, pose, &obstacle), dist - 0.3 - 0.05, 1e-12);
+  EXPECT_NEAR(calculateRobotObstacleDistance(padded_robot, pose, &inflated_obstacle), dist - 0.3 - 0.05 - 0.1, 1e-12);
+}
+
+TEST(TEBDistanceKernels, ObstacleFootprintDispatch)
+{
+  std::mt19937 rng(37);
+  std::uniform_real_distribution<double> coord(-2, 2);
+  std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+
+  std::vector<RobotFootprintModelPtr> robot_models;
+  robot_models.push_back(boost::make_shared<PointRobotFootprint>());
+  robot_models.push_back(boost::make_shared<CircularRobotFootprint>(0.3));
+  robot_models.push_back(boost::make_shared<TwoCirclesRobotFootprint>(0.3, 0.2, 0.2, 0.25));
+  robot_models.push_back(boost::make_shared<LineRobotFootprint>(Eigen::Vector2d(-0.3, 0), Eigen::Vector2d(0.4, 0), 0.1));
+  robot_models.push_back(boost::make_shared<PolygonRobotFootprint>(randomConvexPolygon(rng, 6, Eigen::Vector2d::Zero(), 0.5)));
+  robot_models.push_back(boost::make_shared<PolygonRobotFootprint>(randomPolygon(rng, 7, Eigen::Vector2d::Zero(), 0.5)));
+  robot_models.push_back(boost::make_shared<EllipseRobotFootprint>(0.4, 0.2));
+  EXPECT_EQ(robot_models[2]->getType(), FootprintType::TwoCircles);
+  EXPECT_EQ(robot_models.back()->getType(), FootprintType::Custom);
+
+  std::vector<ObstaclePtr> obstacles;
+  obstacles.push_back(ObstaclePtr(new PointObstacle(0.7, -0.2)));
+  obstacles.push_back(ObstaclePtr(new CircularObstacle(-0.4, 0.6, 0.2)));
+  obstacles.push_back(ObstaclePtr(new LineObstacle(0.3, 0.9, -0.8, 0.1)));
+  obstacles.push_back(ObstaclePtr(new PillObstacle(-0.9, -0.5, 0.2, -1.1, 0.15)));
+  obstacles.push_back(ObstaclePtr(new PolygonObstacle(randomConvexPolygon(rng, 9, Eigen::Vector2d(0.5, 0.5), 0.4))));
+  obstacles.push_back(ObstaclePtr(new PolygonObstacle(randomPolygon(rng, 9, Eigen::Vector2d(-0.5, 0.5), 0.4))));
+  EXPECT_EQ(obstacles[3]->getType(), ObstacleType::Pill);
+  EXPECT_EQ(obstacles[4]->getType(), ObstacleType::Polygon);
+
+  for (int sample = 0; sample < 200; ++sample)
+  {
+    PoseSE2 pose(coord(rng), coord(rng), angle(rng));
+    for (const RobotFootprintModelPtr& robot_model : robot_models)
+    {
+      for (const ObstaclePtr& obstacle : obstacles)
+      {
+        ConvexDistanceWitness witness;
+        const double expected = robot_model->calculateDistance(pose, obstacle.get());
+        EXPECT_NEAR(calculateRobotObstacleDistance(*robot_model, pose, obstacle.get()), expected, 1e-12);
+        EXPECT_NEAR(calculateRobotObstacleDistance(*robot_model, pose, obstacle.get(), &witness), expected, 1e-12);
+      }
+    }
+  }
+
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
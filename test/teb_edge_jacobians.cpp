@@ -0,0 +1,321 @@
+#include <gtest/gtest.h>
+
+#include <g2o/core/jacobian_workspace.h>
+
+#include <teb_local_planner/teb_config.h>
+#include <teb_local_planner/obstacles.h>
+#include <teb_local_planner/robot_footprint_model.h>
+#include <teb_local_planner/g2o_types/edge_velocity.h>
+#include <teb_local_planner/g2o_types/edge_velocity_obstacle_ratio.h>
+#include <teb_local_planner/g2o_types/edge_segment_kinematics.h>
+#include <teb_local_planner/g2o_types/edge_acceleration.h>
+#include <teb_local_planner/g2o_types/edge_kinematics.h>
+#include <teb_local_planner/g2o_types/edge_via_point.h>
+#include <teb_local_planner/g2o_types/edge_prefer_rotdir.h>
+
+#include <algorithm>
+#include <random>
+#include <type_traits>
+
+using namespace teb_local_planner;
+
+// map the jacobians of an edge into the workspace and compute them with the edge's linearizeOplus()
+template <typename EdgeT>
+void linearize(EdgeT& edge, g2o::JacobianWorkspace& workspace, std::false_type /*autodiff*/)
+{
+  // the workspace overload is hidden by the linearizeOplus() of the derived edge
+  static_cast<g2o::OptimizableGraph::Edge&>(edge).linearizeOplus(workspace);
+}
+
+// map the jacobians of an edge into the workspace and compute them by automatic differentiation
+template <typename EdgeT>
+void linearize(EdgeT& edge, g2o::JacobianWorkspace& workspace, std::true_type /*autodiff*/)
+{
+  static_cast<g2o::OptimizableGraph::Edge&>(edge).linearizeOplus(workspace);
+  edge.linearizeOplusAutoDiff();
+}
+
+// compare the jacobian of an edge (analytic or autodiff) with central differences of its computeError()
+template <bool AutoDiff = false, typename EdgeT>
+void checkJacobian(EdgeT& edge, double tolerance = 1e-4)
+{
+  g2o::JacobianWorkspace workspace;
+  workspace.updateSize(&edge);
+  workspace.allocate();
+  linearize(edge, workspace, std::integral_constant<bool, AutoDiff>());
+
+  const double h = 1e-6;
+  for (std::size_t i = 0; i < edge.vertices().size(); ++i)
+  {
+    g2o::OptimizableGraph::Vertex* vertex = static_cast<g2o::OptimizableGraph::Vertex*>(edge.vertex(i));
+    Eigen::Map<Eigen::MatrixXd> jacobian(workspace.workspaceForVertex(i), edge.dimension(), vertex->dimension());
+
+    for (int k = 0; k < vertex->dimension(); ++k)
+    {
+      double delta[3] = {0, 0, 0};
+
+      delta[k] = h;
+      vertex->push();
+      vertex->oplus(delta);
+      edge.computeError();
+      Eigen::VectorXd error_plus = edge.error();
+      vertex->pop();
+
+      delta[k] = -h;
+      vertex->push();
+      vertex->oplus(delta);
+      edge.computeError();
+      Eigen::VectorXd error_minus = edge.error();
+      vertex->pop();
+
+      Eigen::VectorXd numeric = (error_plus - error_minus) / (2*h);
+      for (int row = 0; row < edge.dimension(); ++row) {
+        ASSERT_NEAR(jacobian(row, k), numeric[row], tolerance * std::max(1.0, std::fabs(numeric[row])))
+          << "vertex " << i << ", component " << k << ", row " << row;
+      }
+    }
+  }
+}
+
+class EdgeJacobianTest : public ::testing::Test
+{
+protected:
+  typedef std::vector<VertexPose, Eigen::aligned_allocator<VertexPose> > PoseVertexContainer;
+  typedef std::vector<VertexTimeDiff> TimeDiffVertexContainer;
+
+  void SetUp() override
+  {
+    cfg.robot.max_vel_y = 0.3;
+    cfg.robot.acc_lim_y = 0.3;
+    boundary_vel.linear.x = 0.2;
+    boundary_vel.linear.y = -0.1;
+    boundary_vel.angular.z = 0.3;
+    cfg.obstacles.obstacle_proximity_lower_bound = 0.1;
+    cfg.obstacles.obstacle_proximity_upper_bound = 2.0;
+    cfg.obstacles.obstacle_proximity_ratio_max_vel = 1.0;
+  }
+
+  // random chain of poses and time differences with velocities inside and outside of the bounds
+  void randomChain(PoseVertexContainer& poses, TimeDiffVertexContainer& time_diffs)
+  {
+    std::uniform_real_distribution<double> pos(-2., 2.);
+    std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+    std::uniform_real_distribution<double> step(-0.4, 0.4);
+    std::uniform_real_distribution<double> turn(-1.5, 1.5);
+    std::uniform_real_distribution<double> dt(0.1, 1.0);
+
+    poses.front().setEstimate(PoseSE2(pos(rng), pos(rng), angle(rng)));
+    for (std::size_t i = 1; i < poses.size(); ++i)
+    {
+      const VertexPose& prev = poses[i-1];
+      poses[i].setEstimate(PoseSE2(prev.x() + step(rng), prev.y() + step(rng), g2o::normalize_theta(prev.theta() + turn(rng))));
+    }
+    for (VertexTimeDiff& time_diff : time_diffs)
+      time_diff.setEstimate(dt(rng));
+  }
+
+  // connect the edge to num_poses poses followed by num_time_diffs time differences and check random configurations
+  template <bool AutoDiff = false, typename EdgeT>
+  void checkRandomChains(EdgeT& edge, int num_poses, int num_time_diffs, int samples = 500)
+  {
+    PoseVertexContainer poses(num_poses);
+    TimeDiffVertexContainer time_diffs(num_time_diffs);
+    for (int i = 0; i < num_poses; ++i)
+      edge.setVertex(i, &poses[i]);
+    for (int i = 0; i < num_time_diffs; ++i)
+      edge.setVertex(num_poses + i, &time_diffs[i]);
+
+    for (int i = 0; i < samples; ++i)
+    {
+      randomChain(poses, time_diffs);
+      checkJacobian<AutoDiff>(edge);
+      if (HasFatalFailure())
+        return;
+    }
+  }
+
+  // two poses and the time difference in between
+  template <bool AutoDiff = false, typename EdgeT>
+  void checkRandomSegments(EdgeT& edge, int samples = 500)
+  {
+    checkRandomChains<AutoDiff>(edge, 2, 1, samples);
+  }
+
+  TebConfig cfg;
+  geometry_msgs::Twist boundary_vel; //!< start / goal velocity of the acceleration edges
+  std::mt19937 rng{42};
+};
+
+TEST_F(EdgeJacobianTest, EdgeVelocity)
+{
+  EdgeVelocity edge;
+  edge.setTebConfig(cfg);
+  edge.setInformation(Eigen::Matrix2d::Identity());
+  checkRandomSegments(edge);
+
+  cfg.trajectory.exact_arc_length = true;
+  checkRandomSegments(edge);
+}
+
+TEST_F(EdgeJacobianTest, EdgeVelocityHolonomic)
+{
+  EdgeVelocityHolonomic edge;
+  edge.setTebConfig(cfg);
+  edge.setInformation(Eigen::Matrix3d::Identity());
+  checkRandomSegments(edge);
+}
+
+TEST_F(EdgeJacobianTest, EdgeVelocityObstacleRatio)
+{
+  PointRobotFootprint robot_model;
+  PointObstacle obstacle(0.3, -0.2);
+
+  EdgeVelocityObstacleRatio edge;
+  edge.setParameters(cfg, &robot_model, &obstacle);
+  edge.setInformation(Eigen::Matrix2d::Identity());
+  checkRandomSegments(edge);
+
+  cfg.trajectory.exact_arc_length = true;
+  checkRandomSegments(edge);
+}
+
+TEST_F(EdgeJacobianTest, EdgeSegmentKinematics)
+{
+  EdgeSegmentKinematics edge;
+  edge.setTebConfig(cfg);
+  edge.setInformation(Eigen::Matrix<double,5,5>::Identity());
+  checkRandomSegments(edge);
+
+  cfg.robot.min_turning_radius = 0.5;
+  cfg.optim.weight_kinematics_turning_radius = 1;
+  checkRandomSegments(edge);
+}
+
+TEST_F(EdgeJacobianTest, EdgeAcceleration)
+{
+  EdgeAcceleration edge;
+  edge.setTebConfig(cfg);
+  edge.setInformation(Eigen::Matrix2d::Identity());
+  checkRandomChains(edge, 3, 2);
+
+  cfg.trajectory.exact_arc_length = true;
+  checkRandomChains(edge, 3, 2);
+}
+
+TEST_F(EdgeJacobianTest, EdgeAccelerationStartGoal)
+{
+  EdgeAccelerationStart start_edge;
+  start_edge.setTebConfig(cfg);
+  start_edge.setInitialVelocity(boundary_vel);
+  start_edge.setInformation(Eigen::Matrix2d::Identity());
+
+  EdgeAccelerationGoal goal_edge;
+  goal_edge.setTebConfig(cfg);
+  goal_edge.setGoalVelocity(boundary_vel);
+  goal_edge.setInformation(Eigen::Matrix2d::Identity());
+
+  checkRandomSegments(start_edge);
+  checkRandomSegments(goal_edge);
+
+  cfg.trajectory.exact_arc_length = true;
+  checkRandomSegments(start_edge);
+  checkRandomSegments(goal_edge);
+}
+
+TEST_F(EdgeJacobianTest, EdgeAccelerationHolonomic)
+{
+  EdgeAccelerationHolonomic edge;
+  edge.setTebConfig(cfg);
+  edge.setInformation(Eigen::Matrix3d::Identity());
+  checkRandomChains(edge, 3, 2);
+
+  EdgeAccelerationHolonomicStart start_edge;
+  start_edge.setTebConfig(cfg);
+  start_edge.setInitialVelocity(boundary_vel);
+  start_edge.setInformation(Eigen::Matrix3d::Identity());
+  checkRandomSegments(start_edge);
+
+  EdgeAccelerationHolonomicGoal goal_edge;
+  goal_edge.setTebConfig(cfg);
+  goal_edge.setGoalVelocity(boundary_vel);
+  goal_edge.setInformation(Eigen::Matrix3d::Identity());
+  checkRandomSegments(goal_edge);
+}
+
+TEST_F(EdgeJacobianTest, AutoDiffVelocityAcceleration)
+{
+  // the analytic jacobians are verified above, the automatic differentiation must match as well
+  EdgeVelocity velocity_edge;
+  velocity_edge.setTebConfig(cfg);
+  velocity_edge.setInformation(Eigen::Matrix2d::Identity());
+  checkRandomSegments<true>(velocity_edge);
+
+  EdgeVelocityHolonomic velocity_holonomic_edge;
+  velocity_holonomic_edge.setTebConfig(cfg);
+  velocity_holonomic_edge.setInformation(Eigen::Matrix3d::Identity());
+  checkRandomSegments<true>(velocity_holonomic_edge);
+
+  EdgeAcceleration acceleration_edge;
+  acceleration_edge.setTebConfig(cfg);
+  acceleration_edge.setInformation(Eigen::Matrix2d::Identity());
+  checkRandomChains<true>(acceleration_edge, 3, 2);
+
+  EdgeAccelerationStart start_edge;
+  start_edge.setTebConfig(cfg);
+  start_edge.setInitialVelocity(boundary_vel);
+  start_edge.setInformation(Eigen::Matrix2d::Identity());
+  checkRandomSegments<true>(start_edge);
+
+  EdgeAccelerationHolonomicGoal goal_edge;
+  goal_edge.setTebConfig(cfg);
+  goal_edge.setGoalVelocity(boundary_vel);
+  goal_edge.setInformation(Eigen::Matrix3d::Identity());
+  checkRandomSegments<true>(goal_edge);
+
+  cfg.trajectory.exact_arc_length = true;
+  checkRandomSegments<true>(velocity_edge);
+  checkRandomChains<true>(acceleration_edge, 3, 2);
+}
+
+TEST_F(EdgeJacobianTest, EdgeKinematics)
+{
+  EdgeKinematicsDiffDrive diff_drive_edge;
+  diff_drive_edge.setTebConfig(cfg);
+  diff_drive_edge.setInformation(Eigen::Matrix2d::Identity());
+  checkRandomChains(diff_drive_edge, 2, 0);
+  checkRandomChains<true>(diff_drive_edge, 2, 0);
+
+  cfg.robot.min_turning_radius = 0.5;
+  EdgeKinematicsCarlike carlike_edge;
+  carlike_edge.setTebConfig(cfg);
+  carlike_edge.setInformation(Eigen::Matrix2d::Identity());
+  checkRandomChains(carlike_edge, 2, 0);
+
+  cfg.trajectory.exact_arc_length = true;
+  checkRandomChains(carlike_edge, 2, 0);
+}
+
+TEST_F(EdgeJacobianTest, EdgeViaPoint)
+{
+  Eigen::Vector2d via_point(0.3, -0.2);
+  EdgeViaPoint edge;
+  edge.setParameters(cfg, &via_point);
+  edge.setInformation(Eigen::Matrix<double,1,1>::Identity());
+  checkRandomChains(edge, 1, 0);
+}
+
+TEST_F(EdgeJacobianTest, EdgePreferRotDir)
+{
+  EdgePreferRotDir edge;
+  edge.setInformation(Eigen::Matrix<double,1,1>::Identity());
+  edge.preferLeft();
+  checkRandomChains(edge, 2, 0);
+  edge.preferRight();
+  checkRandomChains(edge, 2, 0);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,583 @@
+#include <gtest/gtest.h>
+
+#include <teb_local_planner/homotopy_class_planner.h>
+#include <teb_local_planner/h_signature.h>
+#include <teb_local_planner/equivalence_class_index.h>
+#include <teb_local_planner/trajectory_fingerprint.h>
+
+#include <limits>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace teb_local_planner;
+
+namespace
+{
+  std::complex<long double> toCplx(const Eigen::Vector2d& point)
+  {
+    return std::complex<long double>(point.x(), point.y());
+  }
+
+  ObstContainer randomPointObstacles(std::mt19937& rng, int number)
+  {
+    std::uniform_real_distribution<double> x(1., 9.);
+    std::uniform_real_distribution<double> y(-3., 3.);
+    ObstContainer obstacles;
+    for (int i = 0; i < number; ++i)
+      obstacles.push_back(ObstaclePtr(new PointObstacle(x(rng), y(rng))));
+    return obstacles;
+  }
+}
+
+TEST(TEBHomotopySearch, HcGraphAdjacency)
+{
+  HcGraph g;
+  for (int cycle = 0; cycle < 2; ++cycle) // rebuilding reuses the memory
+  {
+    g.clear();
+    for (int i = 0; i < 5; ++i)
+      g[add_vertex(g)].pos = Eigen::Vector2d(i, 0.);
+    add_edge(0, 1, g);
+    add_edge(0, 3, g);
+    add_edge(2, 4, g); // vertex 1 has no out-edges
+    add_edge(2, 1, g);
+    add_edge(3, 4, g);
+
+    ASSERT_EQ(5u, num_vertices(g));
+    ASSERT_EQ(5u, num_edges(g));
+    EXPECT_TRUE(edge(0, 3, g).second);
+    EXPECT_TRUE(edge(2, 1, g).second);
+    EXPECT_FALSE(edge(1, 2, g).second);
+    EXPECT_FALSE(edge(4, 0, g).second);
+
+    HcGraphAdjecencyIterator it, end;
+    boost::tie(it, end) = adjacent_vertices(1, g);
+    EXPECT_TRUE(it == end);
+    boost::tie(it, end) = adjacent_vertices(2, g);
+    ASSERT_EQ(2, end - it);
+    EXPECT_EQ(4u, it[0]);
+    EXPECT_EQ(1u, it[1]);
+    boost::tie(it, end) = adjacent_vertices(4, g);
+    EXPECT_TRUE(it == end);
+
+    HcGraphEdgeIterator it_edge, end_edge;
+    for (boost::tie(it_edge, end_edge) = edges(g); it_edge != end_edge; ++it_edge)
+      EXPECT_TRUE(edge(source(*it_edge, g), target(*it_edge, g), g).second);
+    EXPECT_EQ(2u, source(edge(2, 1, g).first, g));
+    EXPECT_EQ(3u, source(4, g));
+  }
+}
+
+TEST(TEBHomotopySearch, HSignatureSegmentTerms)
+{
+  TebConfig cfg;
+  std::mt19937 rng(42);
+  ObstContainer obstacles = randomPointObstacles(rng, 20);
+
+  std::uniform_real_distribution<double> y(-4., 4.);
+  for (int i = 0; i < 20; ++i)
+  {
+    std::vector<Eigen::Vector2d, Eigen::aligned_allocator<Eigen::Vector2d> > path;
+    path.push_back(Eigen::Vector2d(0., 0.));
+    for (int j = 1; j < 5; ++j)
+      path.push_back(Eigen::Vector2d(2. * j, y(rng)));
+    path.push_back(Eigen::Vector2d(10., 0.));
+
+    HSignature h(cfg);
+    h.calculateHSignature(path.begin(), path.end(), toCplx, &obstacles);
+
+    // the h-signature is the sum of the segment contributions
+    HSignatureSegmentTerms terms;
+    terms.initialize(cfg, toCplx(path.front()), toCplx(path.back()), obstacles);
+    std::complex<long double> sum = 0;
+    for (std::size_t j = 0; j + 1 < path.size(); ++j)
+      sum += terms.segment(toCplx(path[j]), toCplx(path[j+1]));
+    EXPECT_TRUE(HSignature(cfg, sum).isEqual(h));
+
+    // subdividing the segments (as done by the TEB initialization) does not change the signature
+    std::vector<Eigen::Vector2d, Eigen::aligned_allocator<Eigen::Vector2d> > dense_path;
+    for (std::size_t j = 0; j + 1 < path.size(); ++j)
+    {
+      for (int k = 0; k < 10; ++k)
+        dense_path.push_back(path[j] + 0.1 * k * (path[j+1] - path[j]));
+    }
+    dense_path.push_back(path.back());
+    HSignature h_dense(cfg);
+    h_dense.calculateHSignature(dense_path.begin(), dense_path.end(), toCplx, &obstacles);
+    EXPECT_TRUE(h_dense.isEqual(h));
+  }
+}
+
+TEST(TEBHomotopySearch, BestFirstDistinctClasses)
+{
+  for (bool dynamic_obstacles : {false, true})
+  {
+    TebConfig cfg;
+    cfg.hcp.simple_exploration = false;
+    cfg.hcp.roadmap_graph_no_samples = 40;
+    cfg.hcp.max_number_classes = 4;
+    cfg.obstacles.include_dynamic_obstacles = dynamic_obstacles;
+
+    std::mt19937 rng(42);
+    ObstContainer obstacles = randomPointObstacles(rng, 10);
+    HomotopyClassPlanner planner(cfg, &obstacles);
+    planner.exploreEquivalenceClassesAndInitTebs(PoseSE2(0., 0., 0.), PoseSE2(10., 0., 0.), cfg.obstacles.min_obstacle_dist, NULL);
+
+    const TebOptPlannerContainer& tebs = planner.getTrajectoryContainer();
+    ASSERT_FALSE(tebs.empty());
+    ASSERT_LE((int)tebs.size(), cfg.hcp.max_number_classes);
+    ASSERT_EQ(planner.getEquivalenceClassRef().size(), tebs.size());
+
+    // the classes are distinct and the paths are found in the order of their length
+    for (std::size_t i = 0; i < tebs.size(); ++i)
+    {
+      for (std::size_t j = i + 1; j < tebs.size(); ++j)
+        EXPECT_FALSE(planner.getEquivalenceClassRef()[i].first->isEqual(*planner.getEquivalenceClassRef()[j].first));
+      if (i > 0)
+        EXPECT_LE(tebs[i-1]->teb().getAccumulatedDistance(), tebs[i]->teb().getAccumulatedDistance() + 1e-6);
+    }
+  }
+}
+
+TEST(TEBHomotopySearch, PersistentRoadmap)
+{
+  TebConfig cfg;
+  cfg.hcp.simple_exploration = false;
+  cfg.hcp.roadmap_graph_no_samples = 40;
+  cfg.hcp.roadmap_graph_persistent = true;
+
+  std::mt19937 rng(42);
+  ObstContainer obstacles = randomPointObstacles(rng, 10);
+  HomotopyClassPlanner planner(cfg, &obstacles);
+  ProbRoadmapGraph graph(cfg, &planner);
+  const double dist_to_obst = cfg.obstacles.min_obstacle_dist;
+
+  graph.createGraph(PoseSE2(0., 0., 0.), PoseSE2(10., 0., 0.), dist_to_obst, cfg.hcp.obstacle_heading_threshold, NULL);
+  std::vector<Eigen::Vector2d, Eigen::aligned_allocator<Eigen::Vector2d> > first = graph.samples();
+  ASSERT_EQ((int)first.size(), cfg.hcp.roadmap_graph_no_samples);
+
+  // unchanged scene: the roadmap is reused
+  planner.clearPlanner();
+  graph.createGraph(PoseSE2(0., 0., 0.), PoseSE2(10., 0., 0.), dist_to_obst, cfg.hcp.obstacle_heading_threshold, NULL);
+  ASSERT_EQ(graph.samples().size(), first.size());
+  for (std::size_t i = 0; i < first.size(); ++i)
+    EXPECT_TRUE(graph.samples()[i].isApprox(first[i]));
+  int num_cached = 0;
+  for (int i = 0; i < (int)first.size(); ++i)
+    for (int j = 0; j < (int)first.size(); ++j)
+      num_cached += graph.isEdgeCached(i, j) ? 1 : 0;
+  EXPECT_GT(num_cached, 0);
+
+  // move one obstacle: edges close to its old and new position are checked again
+  boost::static_pointer_cast<PointObstacle>(obstacles.front())->position() = Eigen::Vector2d(5., 2.);
+  planner.clearPlanner();
+  graph.createGraph(PoseSE2(0., 0., 0.), PoseSE2(10., 0., 0.), dist_to_obst, cfg.hcp.obstacle_heading_threshold, NULL);
+
+  const HcGraph& g = graph.graph_;
+  const int n = (int)graph.samples().size();
+  for (int i = 0; i < n; ++i)
+  {
+    for (int j = 0; j < n; ++j)
+    {
+      if (i == j)
+        continue;
+      // the graph equals the one obtained by checking all edges against the current obstacles
+      Eigen::Vector2d dir = graph.samples()[j] - graph.samples()[i];
+      if (dir.normalized().x() <= cfg.hcp.obstacle_heading_threshold)
+        continue;
+      bool collision = false;
+      for (const ObstaclePtr& obst : obstacles)
+        collision = collision || obst->checkLineIntersection(graph.samples()[i], graph.samples()[j], dist_to_obst);
+      EXPECT_EQ(!collision, edge(i + 1, j + 1, g).second);
+    }
+  }
+}
+
+TEST(TEBHomotopySearch, PersistentRoadmapReshapedObstacle)
+{
+  TebConfig cfg;
+  cfg.hcp.simple_exploration = false;
+  cfg.hcp.roadmap_graph_no_samples = 40;
+  cfg.hcp.roadmap_graph_persistent = true;
+
+  std::mt19937 rng(7);
+  ObstContainer obstacles = randomPointObstacles(rng, 4);
+  boost::shared_ptr<LineObstacle> line(new LineObstacle(5., -2., 5., 2.));
+  obstacles.push_back(line);
+  HomotopyClassPlanner planner(cfg, &obstacles);
+  ProbRoadmapGraph graph(cfg, &planner);
+  const double dist_to_obst = cfg.obstacles.min_obstacle_dist;
+
+  graph.createGraph(PoseSE2(0., 0., 0.), PoseSE2(10., 0., 0.), dist_to_obst, cfg.hcp.obstacle_heading_threshold, NULL);
+
+  // rotate the line about its centroid: centroid and bounding radius stay the same
+  line->setStart(Eigen::Vector2d(3., 0.));
+  line->setEnd(Eigen::Vector2d(7., 0.));
+  planner.clearPlanner();
+  graph.createGraph(PoseSE2(0., 0., 0.), PoseSE2(10., 0., 0.), dist_to_obst, cfg.hcp.obstacle_heading_threshold, NULL);
+
+  const HcGraph& g = graph.graph_;
+  const int n = (int)graph.samples().size();
+  for (int i = 0; i < n; ++i)
+  {
+    for (int j = 0; j < n; ++j)
+    {
+      if (i == j)
+        continue;
+      Eigen::Vector2d dir = graph.samples()[j] - graph.samples()[i];
+      if (dir.normalized().x() <= cfg.hcp.obstacle_heading_threshold)
+        continue;
+      bool collision = false;
+      for (const ObstaclePtr& obst : obstacles)
+        collision = collision || obst->checkLineIntersection(graph.samples()[i], graph.samples()[j], dist_to_obst);
+      EXPECT_EQ(!collision, edge(i + 1, j + 1, g).second);
+    }
+  }
+}
+
+TEST(TEBHomotopySearch, RoadmapSampling)
+{
+  TebConfig cfg;
+  cfg.hcp.simple_exploration = false;
+  cfg.hcp.roadmap_graph_no_samples = 100;
+  cfg.hcp.roadmap_graph_persistent = false;
+
+  std::mt19937 rng(42);
+  ObstContainer obstacles = randomPointObstacles(rng, 10);
+  Point2dContainer triangle = {Eigen::Vector2d(4., -1.), Eigen::Vector2d(6., -1.), Eigen::Vector2d(5., 1.)};
+  obstacles.push_back(ObstaclePtr(new PolygonObstacle(triangle)));
+  HomotopyClassPlanner planner(cfg, &obstacles);
+  const double dist_to_obst = cfg.obstacles.min_obstacle_dist;
+
+  auto meanObstacleDistance = [&](double boundary_bias) {
+    cfg.hcp.roadmap_graph_boundary_bias = boundary_bias;
+    ProbRoadmapGraph graph(cfg, &planner);
+    planner.clearPlanner();
+    graph.createGraph(PoseSE2(0., 0., 0.), PoseSE2(10., 0., 0.), dist_to_obst, cfg.hcp.obstacle_heading_threshold, NULL);
+    EXPECT_EQ(cfg.hcp.roadmap_graph_no_samples, (int)graph.samples().size());
+    double sum = 0;
+    for (const Eigen::Vector2d& sample : graph.samples())
+    {
+      double min_dist = std::numeric_limits<double>::max();
+      for (const ObstaclePtr& obst : obstacles)
+      {
+        EXPECT_FALSE(obst->checkCollision(sample, dist_to_obst));
+        min_dist = std::min(min_dist, obst->getMinimumDistance(sample));
+      }
+      sum += min_dist;
+    }
+    return sum / graph.samples().size();
+  };
+
+  // free space sampling follows the Halton sequence and does not depend on random numbers
+  ProbRoadmapGraph graph1(cfg, &planner), graph2(cfg, &planner);
+  cfg.hcp.roadmap_graph_boundary_bias = 0.;
+  graph1.createGraph(PoseSE2(0., 0., 0.), PoseSE2(10., 0., 0.), dist_to_obst, cfg.hcp.obstacle_heading_threshold, NULL);
+  planner.clearPlanner();
+  graph2.createGraph(PoseSE2(0., 0., 0.), PoseSE2(10., 0., 0.), dist_to_obst, cfg.hcp.obstacle_heading_threshold, NULL);
+  ASSERT_EQ(graph1.samples().size(), graph2.samples().size());
+  for (std::size_t i = 0; i < graph1.samples().size(); ++i)
+    EXPECT_TRUE(graph1.samples()[i].isApprox(graph2.samples()[i]));
+
+  // boundary samples are closer to the obstacles
+  EXPECT_LT(meanObstacleDistance(1.), 0.5 * meanObstacleDistance(0.));
+}
+
+TEST(TEBHomotopySearch, RecycledPlanners)
+{
+  TebConfig cfg;
+  cfg.hcp.simple_exploration = false;
+  cfg.hcp.roadmap_graph_no_samples = 40;
+  cfg.hcp.max_number_classes = 4;
+
+  std::mt19937 rng(42);
+  ObstContainer obstacles = randomPointObstacles(rng, 10);
+  HomotopyClassPlanner planner(cfg, &obstacles);
+  planner.exploreEquivalenceClassesAndInitTebs(PoseSE2(0., 0., 0.), PoseSE2(10., 0., 0.), cfg.obstacles.min_obstacle_dist, NULL);
+  ASSERT_FALSE(planner.getTrajectoryContainer().empty());
+
+  // a path of a known class is rejected before a planner is set up
+  std::vector<Eigen::Vector2d, Eigen::aligned_allocator<Eigen::Vector2d> > path;
+  const TimedElasticBand& first_teb = planner.getTrajectoryContainer().front()->teb();
+  for (int i = 0; i < first_teb.sizePoses(); ++i)
+    path.push_back(first_teb.Pose(i).position());
+  const std::size_t num_tebs = planner.getTrajectoryContainer().size();
+  EXPECT_FALSE(planner.addAndInitNewTeb(path.begin(), path.end(), [](const Eigen::Vector2d& pos) -> const Eigen::Vector2d& {return pos;},
+                                        0., 0., NULL));
+  EXPECT_EQ(num_tebs, planner.getTrajectoryContainer().size());
+
+  std::set<const TebOptimalPlanner*> first;
+  for (const TebOptimalPlannerPtr& teb : planner.getTrajectoryContainer())
+    first.insert(teb.get());
+
+  // the planners of the removed trajectories are reused
+  planner.clearPlanner();
+  planner.exploreEquivalenceClassesAndInitTebs(PoseSE2(0., 0., 0.), PoseSE2(10., 0., 0.), cfg.obstacles.min_obstacle_dist, NULL);
+  ASSERT_FALSE(planner.getTrajectoryContainer().empty());
+  for (const TebOptimalPlannerPtr& teb : planner.getTrajectoryContainer())
+  {
+    EXPECT_EQ(1u, first.count(teb.get()));
+    EXPECT_FALSE(teb->isOptimized());
+    EXPECT_GT(teb->teb().sizePoses(), 1);
+  }
+}
+
+TEST(TEBHomotopySearch, EquivalenceClassIndex)
+{
+  TebConfig cfg;
+  std::mt19937 rng(42);
+
+  // 2d h-signatures close to the cell boundaries: the index equals a linear search
+  std::uniform_int_distribution<int> cell(-3, 3);
+  std::uniform_real_distribution<double> offset(-0.02, 0.02);
+  std::vector<EquivalenceClassPtr> classes;
+  EquivalenceClassIndex index;
+  for (int i = 0; i < 200; ++i)
+  {
+    EquivalenceClassPtr h(new HSignature(cfg, std::complex<long double>(cell(rng) * cfg.hcp.h_signature_threshold + offset(rng),
+                                                                        cell(rng) * cfg.hcp.h_signature_threshold + offset(rng))));
+    int expected = 0;
+    for (const EquivalenceClassPtr& other : classes)
+      expected += h->isEqual(*other) ? 1 : 0;
+    EXPECT_EQ(expected, index.count(*h));
+    EXPECT_EQ(expected > 0, index.contains(*h));
+    classes.push_back(h);
+    index.insert(h);
+  }
+  for (std::size_t i = 0; i < classes.size(); i += 2)
+    index.erase(classes[i]);
+  EXPECT_EQ(classes.size() / 2, index.size());
+
+  // 3d h-signatures: components close to zero match any sign, hence the lookup falls back to the other buckets
+  ObstContainer obstacles = randomPointObstacles(rng, 5);
+  std::uniform_real_distribution<double> y(-4., 4.);
+  classes.clear();
+  index.clear();
+  for (int i = 0; i < 50; ++i)
+  {
+    std::vector<Eigen::Vector2d, Eigen::aligned_allocator<Eigen::Vector2d> > path;
+    path.push_back(Eigen::Vector2d(0., 0.));
+    path.push_back(Eigen::Vector2d(5., y(rng)));
+    path.push_back(Eigen::Vector2d(10., 0.));
+    HSignature3d* h3d = new HSignature3d(cfg);
+    h3d->calculateHSignature(path.begin(), path.end(), toCplx, &obstacles, boost::none, boost::none);
+    EquivalenceClassPtr h(h3d);
+    int expected = 0;
+    for (const EquivalenceClassPtr& other : classes)
+      expected += h->isEqual(*other) ? 1 : 0;
+    EXPECT_EQ(expected, index.count(*h));
+    EXPECT_EQ(expected > 0, index.contains(*h));
+    classes.push_back(h);
+    index.insert(h);
+  }
+}
+
+TEST(TEBHomotopySearch, IncrementalHSignature)
+{
+  TebConfig cfg;
+  std::mt19937 rng(7);
+  ObstContainer obstacles = randomPointObstacles(rng, 8);
+  std::uniform_real_distribution<double> y(-2., 2.);
+  std::uniform_real_distribution<double> shift(-0.3, 0.3);
+
+  std::vector<Eigen::Vector2d, Eigen::aligned_allocator<Eigen::Vector2d> > path;
+  for (int i = 0; i <= 40; ++i)
+    path.push_back(Eigen::Vector2d(0.25 * i, 2. * std::sin(0.15 * i)));
+
+  IncrementalHSignature incremental;
+  for (int cycle = 0; cycle < 20; ++cycle)
+  {
+    if (cycle > 0)
+    {
+      path.erase(path.begin()); // robot moved: the trajectory is pruned at the front
+      path.back() += Eigen::Vector2d(0.25, 0.);
+      path[5].y() += shift(rng);
+      path[path.size() / 2].y() += shift(rng);
+      if (cycle % 5 == 0)
+        boost::static_pointer_cast<PointObstacle>(obstacles[cycle % obstacles.size()])->position().y() = y(rng);
+    }
+
+    HSignature full(cfg);
+    full.calculateHSignature(path.begin(), path.end(), toCplx, &obstacles);
+    std::complex<long double> value = incremental.update(cfg, path.begin(), path.end(), toCplx, obstacles, 1e-6, 100);
+    EXPECT_NEAR(0., std::abs(value - full.value()), 1e-6 * (1. + std::abs(full.value()))) << "cycle " << cycle;
+    if (cycle > 0)
+    {
+      EXPECT_LT(incremental.numUpdatedSegments(), 8) << "cycle " << cycle;
+    }
+  }
+}
+
+TEST(TEBHomotopySearch, TrajectoryFingerprint)
+{
+  typedef std::vector<Eigen::Vector2d, Eigen::aligned_allocator<Eigen::Vector2d> > Path;
+  auto position = [](const Eigen::Vector2d& pos) -> const Eigen::Vector2d& {return pos;};
+
+  // the fingerprint does not depend on the number of poses
+  Path coarse = {Eigen::Vector2d(0., 0.), Eigen::Vector2d(4., 0.), Eigen::Vector2d(4., 3.)};
+  Path fine;
+  for (int i = 0; i <= 40; ++i)
+    fine.push_back(Eigen::Vector2d(0.1 * i, 0.));
+  for (int i = 1; i <= 30; ++i)
+    fine.push_back(Eigen::Vector2d(4., 0.1 * i));
+  TrajectoryFingerprint fp_coarse, fp_fine;
+  fp_coarse.compute(coarse.begin(), coarse.end(), position);
+  fp_fine.compute(fine.begin(), fine.end(), position);
+  ASSERT_TRUE(fp_coarse.isValid());
+  EXPECT_NEAR(7., fp_coarse.length(), 1e-9);
+  EXPECT_NEAR(0., fp_coarse.distanceL2(fp_fine), 1e-9);
+  EXPECT_NEAR(0., fp_coarse.distanceFrechet(fp_fine), 1e-9);
+  EXPECT_DOUBLE_EQ(4., fp_coarse.x()[TrajectoryFingerprint::NumSamples-1]);
+  EXPECT_DOUBLE_EQ(3., fp_coarse.y()[TrajectoryFingerprint::NumSamples-1]);
+
+  // shifted copy
+  Path shifted = coarse;
+  for (Eigen::Vector2d& pos : shifted)
+    pos.y() += 0.5;
+  TrajectoryFingerprint fp_shifted;
+  fp_shifted.compute(shifted.begin(), shifted.end(), position);
+  EXPECT_NEAR(0.5, fp_coarse.distanceL2(fp_shifted), 1e-9);
+  EXPECT_NEAR(0.5, fp_coarse.distanceFrechet(fp_shifted), 1e-9);
+
+  // longer first leg: the Fréchet distance is bounded by the offset of the start (plus the sampling resolution)
+  Path longer = {Eigen::Vector2d(-1., 0.), Eigen::Vector2d(4., 0.), Eigen::Vector2d(4., 3.)};
+  TrajectoryFingerprint fp_longer;
+  fp_longer.compute(longer.begin(), longer.end(), position);
+  EXPECT_GE(fp_coarse.distanceFrechet(fp_longer), 1.);
+  EXPECT_LT(fp_coarse.distanceFrechet(fp_longer), 1. + fp_longer.length() / (TrajectoryFingerprint::NumSamples-1));
+  EXPECT_DOUBLE_EQ(fp_coarse.distanceFrechet(fp_longer), fp_longer.distanceFrechet(fp_coarse));
+
+  // trajectory overload
+  TimedElasticBand teb;
+  for (const Eigen::Vector2d& pos : coarse)
+    teb.addPose(pos, 0.);
+  TrajectoryFingerprint fp_teb;
+  fp_teb.compute(teb);
+  EXPECT_NEAR(0., fp_teb.distanceL2(fp_coarse), 1e-9);
+
+  TrajectoryFingerprint fp_empty;
+  EXPECT_FALSE(fp_empty.isValid());
+  EXPECT_TRUE(std::isinf(fp_empty.distanceFrechet(fp_coarse)));
+}
+
+namespace
+{
+  class RenewingHomotopyClassPlanner : public HomotopyClassPlanner
+  {
+  public:
+    RenewingHomotopyClassPlanner(const TebConfig& cfg, ObstContainer* obstacles) : HomotopyClassPlanner(cfg, obstacles) {}
+    using HomotopyClassPlanner::renewAndAnalyzeOldTebs;
+
+    // append a second planner with the same trajectory as the first one (same equivalence class)
+    void duplicateFirstTeb()
+    {
+      const TimedElasticBand& band = tebs_.front()->teb();
+      TebOptimalPlannerPtr copy = acquireTebPlanner();
+      copy->teb().addPose(band.Pose(0));
+      for (int i = 1; i < band.sizePoses(); ++i)
+        copy->teb().addPoseAndTimeDiff(band.Pose(i), band.TimeDiff(i - 1));
+      tebs_.push_back(copy);
+    }
+
+    // the cached classes must belong to the current trajectories only
+    bool cacheMatchesTebs() const
+    {
+      if (teb_eq_class_cache_.size() != tebs_.size())
+        return false;
+      for (const TebOptimalPlannerPtr& teb : tebs_)
+        if (teb_eq_class_cache_.find(teb.get()) == teb_eq_class_cache_.end())
+          return false;
+      return true;
+    }
+  };
+}
+
+TEST(TEBHomotopySearch, ReuseEquivalenceClasses)
+{
+  TebConfig cfg;
+  cfg.hcp.simple_exploration = false;
+  cfg.hcp.roadmap_graph_no_samples = 40;
+  cfg.hcp.max_number_classes = 4;
+
+  std::mt19937 rng(42);
+  ObstContainer obstacles = randomPointObstacles(rng, 10);
+  RenewingHomotopyClassPlanner planner(cfg, &obstacles);
+  planner.exploreEquivalenceClassesAndInitTebs(PoseSE2(0., 0., 0.), PoseSE2(10., 0., 0.), cfg.obstacles.min_obstacle_dist, NULL);
+  ASSERT_FALSE(planner.getTrajectoryContainer().empty());
+
+  planner.renewAndAnalyzeOldTebs(false);
+  std::vector<EquivalenceClassPtr> first;
+  for (const std::pair<EquivalenceClassPtr, bool>& eq_class : planner.getEquivalenceClassRef())
+    first.push_back(eq_class.first);
+
+  // nothing changed: the classes are reused
+  planner.renewAndAnalyzeOldTebs(false);
+  ASSERT_EQ(first.size(), planner.getEquivalenceClassRef().size());
+  for (std::size_t i = 0; i < first.size(); ++i)
+    EXPECT_EQ(first[i], planner.getEquivalenceClassRef()[i].first);
+
+  EXPECT_TRUE(planner.cacheMatchesTebs());
+
+  // an obstacle moved: the classes are recomputed
+  boost::static_pointer_cast<PointObstacle>(obstacles.front())->position() += Eigen::Vector2d(0.5, 0.);
+  planner.renewAndAnalyzeOldTebs(false);
+  for (std::size_t i = 0; i < std::min(first.size(), planner.getEquivalenceClassRef().size()); ++i)
+    EXPECT_NE(first[i], planner.getEquivalenceClassRef()[i].first);
+
+  // a trajectory in a known class is removed together with its cached class
+  const std::size_t num_tebs = planner.getTrajectoryContainer().size();
+  planner.duplicateFirstTeb();
+  planner.renewAndAnalyzeOldTebs(false);
+  EXPECT_EQ(num_tebs, planner.getTrajectoryContainer().size());
+  EXPECT_TRUE(planner.cacheMatchesTebs());
+}
+
+namespace
+{
+  class OptimizingHomotopyClassPlanner : public HomotopyClassPlanner
+  {
+  public:
+    OptimizingHomotopyClassPlanner(const TebConfig& cfg, ObstContainer* obstacles) : HomotopyClassPlanner(cfg, obstacles) {}
+    using HomotopyClassPlanner::optimizeAllTEBs;
+  };
+}
+
+TEST(TEBHomotopySearch, CandidatePruning)
+{
+  TebConfig cfg;
+  cfg.hcp.simple_exploration = false;
+  cfg.hcp.roadmap_graph_no_samples = 40;
+  cfg.hcp.max_number_classes = 6;
+  cfg.hcp.enable_multithreading = false;
+  cfg.hcp.selection_pruning_ratio = 0.5;
+  ASSERT_GT(cfg.optim.no_outer_iterations, 1);
+
+  std::mt19937 rng(42);
+  ObstContainer obstacles = randomPointObstacles(rng, 10);
+  OptimizingHomotopyClassPlanner planner(cfg, &obstacles);
+  planner.exploreEquivalenceClassesAndInitTebs(PoseSE2(0., 0., 0.), PoseSE2(10., 0., 0.), cfg.obstacles.min_obstacle_dist, NULL);
+  ASSERT_GE(planner.getTrajectoryContainer().size(), 2u);
+
+  planner.optimizeAllTEBs(cfg.optim.no_inner_iterations, cfg.optim.no_outer_iterations);
+
+  // pruned and fully optimized candidates are compared with the same (unscaled) weights
+  double min_cost = std::numeric_limits<double>::max();
+  for (const TebOptimalPlannerPtr& teb : planner.getTrajectoryContainer())
+  {
+    const double cost = teb->getCurrentCost();
+    teb->computeCurrentCost(cfg.hcp.selection_obst_cost_scale, cfg.hcp.selection_viapoint_cost_scale, cfg.hcp.selection_alternative_time_cost);
+    EXPECT_DOUBLE_EQ(teb->getCurrentCost(), cost);
+    min_cost = std::min(min_cost, cost);
+  }
+
+  TebOptimalPlannerPtr best = planner.selectBestTeb();
+  ASSERT_TRUE(best);
+  EXPECT_DOUBLE_EQ(min_cost, best->getCurrentCost());
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}